@@ -0,0 +1,1553 @@
+/*
+ * hostapd - In-process association load generator
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This program links the AP core with a driver wrapper that does not touch
+ * any radio. Frames that hostapd transmits are queued in memory and handed
+ * to a set of synthetic stations which answer them through the same event
+ * interface (EVENT_RX_MGMT, EVENT_EAPOL_RX, EVENT_TX_STATUS) a real driver
+ * uses. The stations run Open System or SAE authentication, association,
+ * and then either the 4-way handshake (RSN supplicant state machine from
+ * src/rsn_supp) or an EAP-MD5 exchange with the integrated EAP server.
+ *
+ * Per-phase latency percentiles, association rate, and CPU time per
+ * association are printed at the end of the run.
+ */
+
+#include "utils/includes.h"
+#include <sys/resource.h>
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "utils/list.h"
+#include "utils/slab.h"
+#include "crypto/crypto.h"
+#include "crypto/random.h"
+#include "crypto/md5.h"
+#include "crypto/sha1.h"
+#include "common/ieee802_11_defs.h"
+#include "common/eapol_common.h"
+#include "common/sae.h"
+#include "common/dpp.h"
+#include "eap_common/eap_defs.h"
+#include "eap_server/eap_methods.h"
+#include "rsn_supp/wpa.h"
+#include "drivers/driver.h"
+#include "ap/hostapd.h"
+#include "ap/ap_config.h"
+#include "ap/sta_info.h"
+#include "ap/wpa_auth.h"
+#include "fst/fst.h"
+#include "config_file.h"
+#include "eap_register.h"
+
+
+#define LOAD_FREQ 2412
+#define LOAD_SSID "load"
+#define LOAD_PASSPHRASE "12345678"
+#define LOAD_EAP_IDENTITY "load-user"
+#define LOAD_EAP_PASSWORD "load-password"
+
+enum load_mode {
+	LOAD_MODE_OPEN,
+	LOAD_MODE_PSK,
+	LOAD_MODE_SAE,
+	LOAD_MODE_EAP,
+};
+
+static const char * const load_mode_txt[] = {
+	"open", "psk", "sae", "eap"
+};
+
+enum load_phase {
+	LOAD_PHASE_AUTH,
+	LOAD_PHASE_ASSOC,
+	LOAD_PHASE_KEYS,
+	LOAD_PHASE_TOTAL,
+	NUM_LOAD_PHASES
+};
+
+enum load_sta_state {
+	LOAD_STA_IDLE,
+	LOAD_STA_AUTH,
+	LOAD_STA_SAE_COMMIT,
+	LOAD_STA_SAE_CONFIRM,
+	LOAD_STA_ASSOC,
+	LOAD_STA_KEYS,
+	LOAD_STA_DONE,
+	LOAD_STA_FAILED,
+	LOAD_STA_GONE,
+};
+
+struct load_ctx;
+
+struct load_sta {
+	struct load_ctx *ctx;
+	struct dl_list list; /* struct load_ctx::assoc_list */
+	u8 addr[ETH_ALEN];
+	enum load_sta_state state;
+	unsigned int retries;
+	struct os_reltime start;
+	struct os_reltime auth;
+	struct os_reltime assoc;
+
+	struct wpa_sm *wpa;
+	enum wpa_states wpa_state;
+	u8 wpa_ie[80];
+	size_t wpa_ie_len;
+
+#ifdef CONFIG_SAE
+	struct sae_data sae;
+	struct wpabuf *sae_token;
+#endif /* CONFIG_SAE */
+};
+
+struct load_frame {
+	struct dl_list list;
+	int to_ap;
+	int eapol;
+	int noack;
+	u8 addr[ETH_ALEN]; /* EAPOL source (to_ap) or destination */
+	size_t len;
+	u8 data[];
+};
+
+struct load_ctx {
+	enum load_mode mode;
+	unsigned int total;
+	unsigned int window;
+	unsigned int keep;
+	unsigned int timeout_ms;
+	unsigned int max_retries;
+
+	struct hostapd_config *conf;
+	struct hostapd_iface *iface;
+	struct hostapd_data *hapd;
+	u8 ap_addr[ETH_ALEN];
+	u8 pmk[PMK_LEN];
+	const u8 *ap_rsne;
+	size_t ap_rsne_len;
+
+	struct load_sta *sta;
+	struct dl_list frames; /* struct load_frame */
+	struct dl_list assoc_list; /* completed, still associated stations */
+	unsigned int num_assoc;
+	unsigned int started;
+	unsigned int in_flight;
+	unsigned int completed;
+	unsigned int failed;
+
+	u32 *lat[NUM_LOAD_PHASES];
+
+	unsigned int frames_to_ap;
+	unsigned int frames_from_ap;
+	unsigned int sae_tokens;
+	unsigned int retransmits;
+	unsigned int ap_disconnects;
+
+	struct os_reltime run_start;
+	struct os_reltime run_end;
+	struct rusage ru_start;
+	struct rusage ru_end;
+	u64 sta_usec;
+};
+
+static struct load_ctx *load_ctx;
+
+
+static void load_kick(struct load_ctx *ctx);
+static void load_sta_rx_mgmt(struct load_sta *sta, const u8 *buf, size_t len);
+static void load_sta_rx_eapol(struct load_sta *sta, const u8 *buf,
+			      size_t len);
+static void load_sta_check_done(struct load_sta *sta);
+
+
+static u64 load_usec(const struct os_reltime *t)
+{
+	return (u64) t->sec * 1000000ULL + t->usec;
+}
+
+
+static u32 load_usec_diff(struct os_reltime *a, struct os_reltime *b)
+{
+	struct os_reltime diff;
+
+	os_reltime_sub(a, b, &diff);
+	return (u32) load_usec(&diff);
+}
+
+
+static u64 load_rusage_usec(const struct rusage *ru)
+{
+	return (u64) (ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * 1000000ULL +
+		ru->ru_utime.tv_usec + ru->ru_stime.tv_usec;
+}
+
+
+static struct load_sta * load_get_sta(struct load_ctx *ctx, const u8 *addr)
+{
+	u32 idx;
+
+	if (addr[0] != 0x02 || addr[1] != 0x00)
+		return NULL;
+	idx = WPA_GET_BE32(&addr[2]);
+	if (idx == 0 || idx > ctx->total)
+		return NULL;
+	return &ctx->sta[idx - 1];
+}
+
+
+static int load_queue(struct load_ctx *ctx, int to_ap, int eapol,
+		      const u8 *addr, const u8 *data, size_t len, int noack)
+{
+	struct load_frame *f;
+
+	f = os_malloc(sizeof(*f) + len);
+	if (!f)
+		return -1;
+	f->to_ap = to_ap;
+	f->eapol = eapol;
+	f->noack = noack;
+	os_memcpy(f->addr, addr, ETH_ALEN);
+	f->len = len;
+	os_memcpy(f->data, data, len);
+	dl_list_add_tail(&ctx->frames, &f->list);
+	load_kick(ctx);
+	return 0;
+}
+
+
+/* Driver wrapper */
+
+static void * load_drv_hapd_init(struct hostapd_data *hapd,
+				 struct wpa_init_params *params)
+{
+	struct load_ctx *ctx = load_ctx;
+
+	os_memcpy(params->own_addr, ctx->ap_addr, ETH_ALEN);
+	return ctx;
+}
+
+
+static void load_drv_hapd_deinit(void *priv)
+{
+}
+
+
+static struct hostapd_hw_modes *
+load_drv_get_hw_feature_data(void *priv, u16 *num_modes, u16 *flags,
+			     u8 *dfs_domain)
+{
+	static const int rates[] = { 10, 20, 55, 110, 60, 90, 120, 180, 240,
+				     360, 480, 540 };
+	struct hostapd_hw_modes *mode;
+
+	*num_modes = 0;
+	*flags = 0;
+	*dfs_domain = 0;
+
+	mode = os_zalloc(sizeof(*mode));
+	if (!mode)
+		return NULL;
+	mode->mode = HOSTAPD_MODE_IEEE80211G;
+	mode->channels = os_zalloc(sizeof(struct hostapd_channel_data));
+	mode->rates = os_memdup(rates, sizeof(rates));
+	if (!mode->channels || !mode->rates) {
+		os_free(mode->channels);
+		os_free(mode->rates);
+		os_free(mode);
+		return NULL;
+	}
+	mode->channels[0].chan = 1;
+	mode->channels[0].freq = LOAD_FREQ;
+	mode->channels[0].allowed_bw = HOSTAPD_CHAN_WIDTH_20;
+	mode->num_channels = 1;
+	mode->num_rates = ARRAY_SIZE(rates);
+	*num_modes = 1;
+
+	return mode;
+}
+
+
+static int load_drv_send_mlme(void *priv, const u8 *data, size_t data_len,
+			      int noack, unsigned int freq,
+			      const u16 *csa_offs, size_t csa_offs_len,
+			      int no_encrypt, unsigned int wait)
+{
+	struct load_ctx *ctx = priv;
+	const struct ieee80211_hdr *hdr = (const struct ieee80211_hdr *) data;
+
+	if (data_len < IEEE80211_HDRLEN)
+		return -1;
+	return load_queue(ctx, 0, 0, hdr->addr1, data, data_len, noack);
+}
+
+
+static int load_drv_send_eapol(void *priv, const u8 *addr, const u8 *data,
+			       size_t data_len, int encrypt,
+			       const u8 *own_addr, u32 flags)
+{
+	struct load_ctx *ctx = priv;
+
+	return load_queue(ctx, 0, 1, addr, data, data_len, 0);
+}
+
+
+static const struct wpa_driver_ops load_driver_ops = {
+	.name = "load",
+	.desc = "in-process load generator",
+	.hapd_init = load_drv_hapd_init,
+	.hapd_deinit = load_drv_hapd_deinit,
+	.get_hw_feature_data = load_drv_get_hw_feature_data,
+	.send_mlme = load_drv_send_mlme,
+	.hapd_send_eapol = load_drv_send_eapol,
+};
+
+
+/* Frame delivery */
+
+static void load_to_ap(struct load_ctx *ctx, struct load_frame *f)
+{
+	union wpa_event_data event;
+	struct load_sta *sta;
+
+	os_memset(&event, 0, sizeof(event));
+	ctx->frames_to_ap++;
+	if (f->eapol) {
+		event.eapol_rx.src = f->addr;
+		event.eapol_rx.data = f->data;
+		event.eapol_rx.data_len = f->len;
+		wpa_supplicant_event(ctx->hapd, EVENT_EAPOL_RX, &event);
+
+		/* The station is done once the AP has authorized it */
+		sta = load_get_sta(ctx, f->addr);
+		if (sta && sta->state == LOAD_STA_KEYS)
+			load_sta_check_done(sta);
+	} else {
+		event.rx_mgmt.frame = f->data;
+		event.rx_mgmt.frame_len = f->len;
+		event.rx_mgmt.freq = LOAD_FREQ;
+		event.rx_mgmt.ssi_signal = -30;
+		wpa_supplicant_event(ctx->hapd, EVENT_RX_MGMT, &event);
+	}
+}
+
+
+static void load_from_ap(struct load_ctx *ctx, struct load_frame *f)
+{
+	struct load_sta *sta;
+	struct os_reltime start, end;
+
+	ctx->frames_from_ap++;
+	if (!f->eapol && !f->noack) {
+		const struct ieee80211_hdr *hdr;
+		union wpa_event_data event;
+		u16 fc;
+
+		hdr = (const struct ieee80211_hdr *) f->data;
+		fc = le_to_host16(hdr->frame_control);
+		os_memset(&event, 0, sizeof(event));
+		event.tx_status.type = WLAN_FC_GET_TYPE(fc);
+		event.tx_status.stype = WLAN_FC_GET_STYPE(fc);
+		event.tx_status.dst = hdr->addr1;
+		event.tx_status.data = f->data;
+		event.tx_status.data_len = f->len;
+		event.tx_status.ack = 1;
+		wpa_supplicant_event(ctx->hapd, EVENT_TX_STATUS, &event);
+	}
+
+	sta = load_get_sta(ctx, f->addr);
+	if (!sta || sta->state == LOAD_STA_IDLE ||
+	    sta->state == LOAD_STA_FAILED || sta->state == LOAD_STA_GONE)
+		return;
+
+	os_get_reltime(&start);
+	if (f->eapol)
+		load_sta_rx_eapol(sta, f->data, f->len);
+	else
+		load_sta_rx_mgmt(sta, f->data, f->len);
+	os_get_reltime(&end);
+	ctx->sta_usec += load_usec_diff(&end, &start);
+}
+
+
+/* Synthetic station */
+
+static void load_sta_timeout(void *eloop_ctx, void *timeout_ctx);
+static int load_sta_send_auth(struct load_sta *sta);
+
+
+static void load_sta_set_timeout(struct load_sta *sta)
+{
+	struct load_ctx *ctx = sta->ctx;
+
+	eloop_cancel_timeout(load_sta_timeout, ctx, sta);
+	eloop_register_timeout(ctx->timeout_ms / 1000,
+			       (ctx->timeout_ms % 1000) * 1000,
+			       load_sta_timeout, ctx, sta);
+}
+
+
+static void load_sta_free_wpa(struct load_sta *sta)
+{
+	if (sta->wpa) {
+		wpa_sm_deinit(sta->wpa);
+		sta->wpa = NULL;
+	}
+#ifdef CONFIG_SAE
+	sae_clear_data(&sta->sae);
+	wpabuf_free(sta->sae_token);
+	sta->sae_token = NULL;
+#endif /* CONFIG_SAE */
+}
+
+
+static void load_sta_finish(struct load_sta *sta, int success)
+{
+	struct load_ctx *ctx = sta->ctx;
+
+	eloop_cancel_timeout(load_sta_timeout, ctx, sta);
+	ctx->in_flight--;
+	if (!success) {
+		wpa_printf(MSG_INFO, "load: STA " MACSTR
+			   " failed in state %d", MAC2STR(sta->addr),
+			   sta->state);
+		sta->state = LOAD_STA_FAILED;
+		ctx->failed++;
+		load_kick(ctx);
+		return;
+	}
+
+	sta->state = LOAD_STA_DONE;
+	dl_list_add_tail(&ctx->assoc_list, &sta->list);
+	ctx->num_assoc++;
+	load_kick(ctx);
+}
+
+
+static void load_sta_fail(struct load_sta *sta)
+{
+	load_sta_finish(sta, 0);
+}
+
+
+static void load_sta_check_done(struct load_sta *sta)
+{
+	struct load_ctx *ctx = sta->ctx;
+	struct sta_info *ap_sta;
+	struct os_reltime now;
+	unsigned int n;
+
+	ap_sta = ap_get_sta(ctx->hapd, sta->addr);
+	if (!ap_sta || !(ap_sta->flags & WLAN_STA_AUTHORIZED))
+		return;
+
+	os_get_reltime(&now);
+	n = ctx->completed++;
+	ctx->lat[LOAD_PHASE_AUTH][n] = load_usec_diff(&sta->auth, &sta->start);
+	ctx->lat[LOAD_PHASE_ASSOC][n] = load_usec_diff(&sta->assoc,
+						       &sta->auth);
+	ctx->lat[LOAD_PHASE_KEYS][n] = load_usec_diff(&now, &sta->assoc);
+	ctx->lat[LOAD_PHASE_TOTAL][n] = load_usec_diff(&now, &sta->start);
+	load_sta_finish(sta, 1);
+}
+
+
+static struct wpabuf * load_sta_mgmt(struct load_sta *sta, u16 stype,
+				     size_t extra)
+{
+	struct wpabuf *buf;
+	struct ieee80211_hdr *hdr;
+
+	buf = wpabuf_alloc(IEEE80211_HDRLEN + extra);
+	if (!buf)
+		return NULL;
+	hdr = wpabuf_put(buf, IEEE80211_HDRLEN);
+	hdr->frame_control = IEEE80211_FC(WLAN_FC_TYPE_MGMT, stype);
+	os_memcpy(hdr->addr1, sta->ctx->ap_addr, ETH_ALEN);
+	os_memcpy(hdr->addr2, sta->addr, ETH_ALEN);
+	os_memcpy(hdr->addr3, sta->ctx->ap_addr, ETH_ALEN);
+	return buf;
+}
+
+
+static int load_sta_send_mgmt(struct load_sta *sta, struct wpabuf *buf)
+{
+	int ret;
+
+	if (!buf)
+		return -1;
+	ret = load_queue(sta->ctx, 1, 0, sta->addr, wpabuf_head(buf),
+			 wpabuf_len(buf), 0);
+	wpabuf_free(buf);
+	load_sta_set_timeout(sta);
+	return ret;
+}
+
+
+static struct wpabuf * load_sta_auth_frame(struct load_sta *sta, u16 alg,
+					   u16 trans, size_t extra)
+{
+	struct wpabuf *buf;
+
+	buf = load_sta_mgmt(sta, WLAN_FC_STYPE_AUTH, 6 + extra);
+	if (!buf)
+		return NULL;
+	wpabuf_put_le16(buf, alg);
+	wpabuf_put_le16(buf, trans);
+	wpabuf_put_le16(buf, WLAN_STATUS_SUCCESS);
+	return buf;
+}
+
+
+#ifdef CONFIG_SAE
+
+static int load_sta_send_sae_commit(struct load_sta *sta)
+{
+	struct wpabuf *buf;
+
+	buf = load_sta_auth_frame(sta, WLAN_AUTH_SAE, 1,
+				  500 + (sta->sae_token ?
+					 wpabuf_len(sta->sae_token) : 0));
+	if (!buf)
+		return -1;
+	if (sae_write_commit(&sta->sae, buf, sta->sae_token, NULL) < 0) {
+		wpabuf_free(buf);
+		return -1;
+	}
+	sta->sae.state = SAE_COMMITTED;
+	sta->state = LOAD_STA_SAE_COMMIT;
+	return load_sta_send_mgmt(sta, buf);
+}
+
+
+static int load_sta_send_sae_confirm(struct load_sta *sta)
+{
+	struct wpabuf *buf;
+
+	buf = load_sta_auth_frame(sta, WLAN_AUTH_SAE, 2, 500);
+	if (!buf)
+		return -1;
+	if (sae_write_confirm(&sta->sae, buf) < 0) {
+		wpabuf_free(buf);
+		return -1;
+	}
+	sta->sae.state = SAE_CONFIRMED;
+	sta->state = LOAD_STA_SAE_CONFIRM;
+	return load_sta_send_mgmt(sta, buf);
+}
+
+#endif /* CONFIG_SAE */
+
+
+static int load_sta_send_auth(struct load_sta *sta)
+{
+#ifdef CONFIG_SAE
+	struct load_ctx *ctx = sta->ctx;
+
+	if (ctx->mode == LOAD_MODE_SAE) {
+		if (!sta->sae.tmp &&
+		    (sae_set_group(&sta->sae, 19) < 0 ||
+		     sae_prepare_commit(sta->addr, ctx->ap_addr,
+					(const u8 *) LOAD_PASSPHRASE,
+					os_strlen(LOAD_PASSPHRASE),
+					&sta->sae) < 0))
+			return -1;
+		return load_sta_send_sae_commit(sta);
+	}
+#endif /* CONFIG_SAE */
+
+	sta->state = LOAD_STA_AUTH;
+	return load_sta_send_mgmt(sta, load_sta_auth_frame(sta, WLAN_AUTH_OPEN,
+							   1, 0));
+}
+
+
+/* RSN supplicant callbacks */
+
+static void load_supp_set_state(void *ctx, enum wpa_states state)
+{
+	struct load_sta *sta = ctx;
+
+	sta->wpa_state = state;
+}
+
+
+static enum wpa_states load_supp_get_state(void *ctx)
+{
+	struct load_sta *sta = ctx;
+
+	return sta->wpa_state;
+}
+
+
+static int load_supp_get_bssid(void *ctx, u8 *bssid)
+{
+	struct load_sta *sta = ctx;
+
+	os_memcpy(bssid, sta->ctx->ap_addr, ETH_ALEN);
+	return 0;
+}
+
+
+static int load_supp_ether_send(void *ctx, const u8 *dest, u16 proto,
+				const u8 *buf, size_t len)
+{
+	struct load_sta *sta = ctx;
+
+	return load_queue(sta->ctx, 1, 1, sta->addr, buf, len, 0);
+}
+
+
+static u8 * load_supp_alloc_eapol(void *ctx, u8 type, const void *data,
+				  u16 data_len, size_t *msg_len,
+				  void **data_pos)
+{
+	struct ieee802_1x_hdr *hdr;
+
+	*msg_len = sizeof(*hdr) + data_len;
+	hdr = os_malloc(*msg_len);
+	if (!hdr)
+		return NULL;
+
+	hdr->version = EAPOL_VERSION;
+	hdr->type = type;
+	hdr->length = host_to_be16(data_len);
+	if (data)
+		os_memcpy(hdr + 1, data, data_len);
+	else
+		os_memset(hdr + 1, 0, data_len);
+	if (data_pos)
+		*data_pos = hdr + 1;
+
+	return (u8 *) hdr;
+}
+
+
+static int load_supp_get_beacon_ie(void *ctx)
+{
+	struct load_sta *sta = ctx;
+
+	return wpa_sm_set_ap_rsn_ie(sta->wpa, sta->ctx->ap_rsne,
+				    sta->ctx->ap_rsne_len);
+}
+
+
+static int load_supp_set_key(void *ctx, enum wpa_alg alg, const u8 *addr,
+			     int key_idx, int set_tx, const u8 *seq,
+			     size_t seq_len, const u8 *key, size_t key_len,
+			     enum key_flag key_flag)
+{
+	return 0;
+}
+
+
+static int load_supp_mlme_setprotection(void *ctx, const u8 *addr,
+					int protection_type, int key_type)
+{
+	return 0;
+}
+
+
+static void load_supp_cancel_auth_timeout(void *ctx)
+{
+}
+
+
+static void * load_supp_get_network_ctx(void *ctx)
+{
+	return ctx;
+}
+
+
+static void load_supp_deauthenticate(void *ctx, u16 reason_code)
+{
+	struct load_sta *sta = ctx;
+
+	wpa_printf(MSG_INFO, "load: STA " MACSTR
+		   " supplicant requested deauthentication (reason %u)",
+		   MAC2STR(sta->addr), reason_code);
+	sta->wpa_state = WPA_DISCONNECTED;
+}
+
+
+static int load_supp_add_pmkid(void *ctx, void *network_ctx,
+			       const u8 *bssid, const u8 *pmkid,
+			       const u8 *fils_cache_id, const u8 *pmk,
+			       size_t pmk_len, u32 pmk_lifetime,
+			       u8 pmk_reauth_threshold, int akmp)
+{
+	return 0;
+}
+
+
+static int load_supp_remove_pmkid(void *ctx, void *network_ctx,
+				  const u8 *bssid, const u8 *pmkid,
+				  const u8 *fils_cache_id)
+{
+	return 0;
+}
+
+
+static int load_sta_init_wpa(struct load_sta *sta)
+{
+	struct load_ctx *ctx = sta->ctx;
+	struct wpa_sm_ctx *wctx;
+
+	wctx = os_zalloc(sizeof(*wctx));
+	if (!wctx)
+		return -1;
+	wctx->ctx = sta;
+	wctx->msg_ctx = sta;
+	wctx->set_state = load_supp_set_state;
+	wctx->get_state = load_supp_get_state;
+	wctx->get_bssid = load_supp_get_bssid;
+	wctx->ether_send = load_supp_ether_send;
+	wctx->get_beacon_ie = load_supp_get_beacon_ie;
+	wctx->alloc_eapol = load_supp_alloc_eapol;
+	wctx->set_key = load_supp_set_key;
+	wctx->mlme_setprotection = load_supp_mlme_setprotection;
+	wctx->cancel_auth_timeout = load_supp_cancel_auth_timeout;
+	wctx->get_network_ctx = load_supp_get_network_ctx;
+	wctx->deauthenticate = load_supp_deauthenticate;
+	wctx->add_pmkid = load_supp_add_pmkid;
+	wctx->remove_pmkid = load_supp_remove_pmkid;
+	sta->wpa = wpa_sm_init(wctx);
+	if (!sta->wpa)
+		return -1;
+
+	wpa_sm_set_own_addr(sta->wpa, sta->addr);
+	wpa_sm_set_param(sta->wpa, WPA_PARAM_RSN_ENABLED, 1);
+	wpa_sm_set_param(sta->wpa, WPA_PARAM_PROTO, WPA_PROTO_RSN);
+	wpa_sm_set_param(sta->wpa, WPA_PARAM_PAIRWISE, WPA_CIPHER_CCMP);
+	wpa_sm_set_param(sta->wpa, WPA_PARAM_GROUP, WPA_CIPHER_CCMP);
+	if (ctx->mode == LOAD_MODE_SAE) {
+		wpa_sm_set_param(sta->wpa, WPA_PARAM_KEY_MGMT,
+				 WPA_KEY_MGMT_SAE);
+		wpa_sm_set_param(sta->wpa, WPA_PARAM_MFP,
+				 MGMT_FRAME_PROTECTION_REQUIRED);
+		wpa_sm_set_param(sta->wpa, WPA_PARAM_MGMT_GROUP,
+				 WPA_CIPHER_AES_128_CMAC);
+	} else {
+		wpa_sm_set_param(sta->wpa, WPA_PARAM_KEY_MGMT,
+				 WPA_KEY_MGMT_PSK);
+		wpa_sm_set_param(sta->wpa, WPA_PARAM_MFP,
+				 NO_MGMT_FRAME_PROTECTION);
+	}
+	wpa_sm_set_ap_rsn_ie(sta->wpa, ctx->ap_rsne, ctx->ap_rsne_len);
+
+#ifdef CONFIG_SAE
+	if (ctx->mode == LOAD_MODE_SAE)
+		wpa_sm_set_pmk(sta->wpa, sta->sae.pmk, PMK_LEN, sta->sae.pmkid,
+			       ctx->ap_addr);
+	else
+#endif /* CONFIG_SAE */
+		wpa_sm_set_pmk(sta->wpa, ctx->pmk, PMK_LEN, NULL, NULL);
+
+	sta->wpa_ie_len = sizeof(sta->wpa_ie);
+	if (wpa_sm_set_assoc_wpa_ie_default(sta->wpa, sta->wpa_ie,
+					    &sta->wpa_ie_len) < 0)
+		return -1;
+
+	return 0;
+}
+
+
+static int load_sta_send_assoc(struct load_sta *sta)
+{
+	struct load_ctx *ctx = sta->ctx;
+	struct wpabuf *buf;
+	u16 capab = WLAN_CAPABILITY_ESS;
+	static const u8 rates[] = { 0x82, 0x84, 0x8b, 0x96,
+				    0x0c, 0x12, 0x18, 0x24 };
+	static const u8 ext_rates[] = { 0x30, 0x48, 0x60, 0x6c };
+
+	if ((ctx->mode == LOAD_MODE_PSK || ctx->mode == LOAD_MODE_SAE) &&
+	    !sta->wpa && load_sta_init_wpa(sta) < 0)
+		return -1;
+	if (sta->wpa)
+		capab |= WLAN_CAPABILITY_PRIVACY;
+
+	buf = load_sta_mgmt(sta, WLAN_FC_STYPE_ASSOC_REQ,
+			    4 + 2 + os_strlen(LOAD_SSID) + 2 + sizeof(rates) +
+			    2 + sizeof(ext_rates) + sta->wpa_ie_len);
+	if (!buf)
+		return -1;
+	wpabuf_put_le16(buf, capab);
+	wpabuf_put_le16(buf, 10); /* Listen Interval */
+	wpabuf_put_u8(buf, WLAN_EID_SSID);
+	wpabuf_put_u8(buf, os_strlen(LOAD_SSID));
+	wpabuf_put_str(buf, LOAD_SSID);
+	wpabuf_put_u8(buf, WLAN_EID_SUPP_RATES);
+	wpabuf_put_u8(buf, sizeof(rates));
+	wpabuf_put_data(buf, rates, sizeof(rates));
+	wpabuf_put_u8(buf, WLAN_EID_EXT_SUPP_RATES);
+	wpabuf_put_u8(buf, sizeof(ext_rates));
+	wpabuf_put_data(buf, ext_rates, sizeof(ext_rates));
+	if (sta->wpa)
+		wpabuf_put_data(buf, sta->wpa_ie, sta->wpa_ie_len);
+
+	sta->state = LOAD_STA_ASSOC;
+	return load_sta_send_mgmt(sta, buf);
+}
+
+
+static void load_sta_authenticated(struct load_sta *sta)
+{
+	os_get_reltime(&sta->auth);
+	sta->retries = 0;
+	if (load_sta_send_assoc(sta) < 0)
+		load_sta_fail(sta);
+}
+
+
+#ifdef CONFIG_SAE
+static void load_sta_rx_sae(struct load_sta *sta, u16 trans, u16 status,
+			    const u8 *pos, size_t len)
+{
+	struct load_ctx *ctx = sta->ctx;
+
+	if (trans == 1 && status == WLAN_STATUS_ANTI_CLOGGING_TOKEN_REQ) {
+		if (sta->state != LOAD_STA_SAE_COMMIT || len < 2)
+			return;
+		ctx->sae_tokens++;
+		wpabuf_free(sta->sae_token);
+		sta->sae_token = wpabuf_alloc_copy(pos + 2, len - 2);
+		if (!sta->sae_token || load_sta_send_sae_commit(sta) < 0)
+			load_sta_fail(sta);
+		return;
+	}
+
+	if (status != WLAN_STATUS_SUCCESS) {
+		load_sta_fail(sta);
+		return;
+	}
+
+	if (trans == 1) {
+		if (sta->state != LOAD_STA_SAE_COMMIT)
+			return; /* retransmitted commit */
+		if (sae_parse_commit(&sta->sae, pos, len, NULL, NULL, NULL,
+				     0) != WLAN_STATUS_SUCCESS ||
+		    sae_process_commit(&sta->sae) < 0 ||
+		    load_sta_send_sae_confirm(sta) < 0)
+			load_sta_fail(sta);
+		return;
+	}
+
+	if (trans != 2 || sta->state != LOAD_STA_SAE_CONFIRM)
+		return;
+	if (sae_check_confirm(&sta->sae, pos, len) < 0) {
+		load_sta_fail(sta);
+		return;
+	}
+	sta->sae.state = SAE_ACCEPTED;
+	sae_clear_temp_data(&sta->sae);
+	load_sta_authenticated(sta);
+}
+#endif /* CONFIG_SAE */
+
+
+static void load_sta_rx_auth(struct load_sta *sta,
+			     const struct ieee80211_mgmt *mgmt, size_t len)
+{
+	u16 alg, trans, status;
+
+	if (len < IEEE80211_HDRLEN + sizeof(mgmt->u.auth))
+		return;
+	alg = le_to_host16(mgmt->u.auth.auth_alg);
+	trans = le_to_host16(mgmt->u.auth.auth_transaction);
+	status = le_to_host16(mgmt->u.auth.status_code);
+
+#ifdef CONFIG_SAE
+	if (alg == WLAN_AUTH_SAE && sta->ctx->mode == LOAD_MODE_SAE) {
+		load_sta_rx_sae(sta, trans, status, mgmt->u.auth.variable,
+				len - IEEE80211_HDRLEN - sizeof(mgmt->u.auth));
+		return;
+	}
+#endif /* CONFIG_SAE */
+
+	if (alg != WLAN_AUTH_OPEN || trans != 2 ||
+	    sta->state != LOAD_STA_AUTH)
+		return;
+	if (status != WLAN_STATUS_SUCCESS) {
+		load_sta_fail(sta);
+		return;
+	}
+	load_sta_authenticated(sta);
+}
+
+
+static void load_sta_rx_assoc_resp(struct load_sta *sta,
+				   const struct ieee80211_mgmt *mgmt,
+				   size_t len)
+{
+	if (sta->state != LOAD_STA_ASSOC ||
+	    len < IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_resp))
+		return;
+	if (le_to_host16(mgmt->u.assoc_resp.status_code) !=
+	    WLAN_STATUS_SUCCESS) {
+		load_sta_fail(sta);
+		return;
+	}
+
+	os_get_reltime(&sta->assoc);
+	sta->retries = 0;
+	sta->state = LOAD_STA_KEYS;
+	if (sta->wpa)
+		wpa_sm_notify_assoc(sta->wpa, sta->ctx->ap_addr);
+	load_sta_set_timeout(sta);
+	load_sta_check_done(sta);
+}
+
+
+static void load_sta_rx_mgmt(struct load_sta *sta, const u8 *buf, size_t len)
+{
+	const struct ieee80211_mgmt *mgmt = (const struct ieee80211_mgmt *) buf;
+	u16 fc;
+
+	fc = le_to_host16(mgmt->frame_control);
+	if (WLAN_FC_GET_TYPE(fc) != WLAN_FC_TYPE_MGMT)
+		return;
+
+	switch (WLAN_FC_GET_STYPE(fc)) {
+	case WLAN_FC_STYPE_AUTH:
+		load_sta_rx_auth(sta, mgmt, len);
+		break;
+	case WLAN_FC_STYPE_ASSOC_RESP:
+		load_sta_rx_assoc_resp(sta, mgmt, len);
+		break;
+	case WLAN_FC_STYPE_DEAUTH:
+	case WLAN_FC_STYPE_DISASSOC:
+		if (sta->state == LOAD_STA_DONE) {
+			dl_list_del(&sta->list);
+			sta->ctx->num_assoc--;
+			sta->ctx->ap_disconnects++;
+			sta->state = LOAD_STA_GONE;
+		} else {
+			load_sta_fail(sta);
+		}
+		break;
+	}
+}
+
+
+static void load_sta_send_eap(struct load_sta *sta, u8 id, u8 type,
+			      const u8 *data, size_t data_len)
+{
+	struct wpabuf *buf;
+	size_t len = sizeof(struct eap_hdr) + 1 + data_len;
+	struct ieee802_1x_hdr *hdr;
+	struct eap_hdr *eap;
+
+	buf = wpabuf_alloc(sizeof(*hdr) + len);
+	if (!buf)
+		return;
+	hdr = wpabuf_put(buf, sizeof(*hdr));
+	hdr->version = EAPOL_VERSION;
+	hdr->type = IEEE802_1X_TYPE_EAP_PACKET;
+	hdr->length = host_to_be16(len);
+	eap = wpabuf_put(buf, sizeof(*eap));
+	eap->code = EAP_CODE_RESPONSE;
+	eap->identifier = id;
+	eap->length = host_to_be16(len);
+	wpabuf_put_u8(buf, type);
+	wpabuf_put_data(buf, data, data_len);
+	load_queue(sta->ctx, 1, 1, sta->addr, wpabuf_head(buf),
+		   wpabuf_len(buf), 0);
+	wpabuf_free(buf);
+}
+
+
+static void load_sta_rx_eap(struct load_sta *sta, const u8 *buf, size_t len)
+{
+	const struct eap_hdr *eap = (const struct eap_hdr *) buf;
+	const u8 *pos, *addr[3];
+	size_t elen, vlen, alen[3];
+	u8 resp[1 + MD5_MAC_LEN];
+
+	if (len < sizeof(*eap))
+		return;
+	elen = be_to_host16(eap->length);
+	if (elen < sizeof(*eap) || elen > len)
+		return;
+
+	if (eap->code == EAP_CODE_SUCCESS) {
+		load_sta_check_done(sta);
+		return;
+	}
+	if (eap->code == EAP_CODE_FAILURE) {
+		load_sta_fail(sta);
+		return;
+	}
+	if (eap->code != EAP_CODE_REQUEST || elen < sizeof(*eap) + 1)
+		return;
+
+	pos = (const u8 *) (eap + 1);
+	switch (*pos) {
+	case EAP_TYPE_IDENTITY:
+		load_sta_send_eap(sta, eap->identifier, EAP_TYPE_IDENTITY,
+				  (const u8 *) LOAD_EAP_IDENTITY,
+				  os_strlen(LOAD_EAP_IDENTITY));
+		break;
+	case EAP_TYPE_MD5:
+		pos++;
+		if (elen < sizeof(*eap) + 2)
+			return;
+		vlen = *pos++;
+		if (vlen == 0 || sizeof(*eap) + 2 + vlen > elen)
+			return;
+		/* Response = MD5(Identifier || Secret || Challenge) */
+		addr[0] = &eap->identifier;
+		alen[0] = 1;
+		addr[1] = (const u8 *) LOAD_EAP_PASSWORD;
+		alen[1] = os_strlen(LOAD_EAP_PASSWORD);
+		addr[2] = pos;
+		alen[2] = vlen;
+		resp[0] = MD5_MAC_LEN;
+		if (md5_vector(3, addr, alen, &resp[1]) < 0)
+			return;
+		load_sta_send_eap(sta, eap->identifier, EAP_TYPE_MD5, resp,
+				  sizeof(resp));
+		break;
+	default:
+		/* Legacy Nak proposing EAP-MD5 */
+		resp[0] = EAP_TYPE_MD5;
+		load_sta_send_eap(sta, eap->identifier, EAP_TYPE_NAK, resp, 1);
+		break;
+	}
+}
+
+
+static void load_sta_rx_eapol(struct load_sta *sta, const u8 *buf,
+			      size_t len)
+{
+	const struct ieee802_1x_hdr *hdr = (const struct ieee802_1x_hdr *) buf;
+
+	if (sta->state != LOAD_STA_KEYS || len < sizeof(*hdr))
+		return;
+
+	if (sta->wpa) {
+		wpa_sm_rx_eapol(sta->wpa, sta->ctx->ap_addr, buf, len);
+		if (sta->wpa_state == WPA_DISCONNECTED)
+			load_sta_fail(sta);
+		return;
+	}
+
+	if (hdr->type == IEEE802_1X_TYPE_EAP_PACKET &&
+	    be_to_host16(hdr->length) <= len - sizeof(*hdr))
+		load_sta_rx_eap(sta, (const u8 *) (hdr + 1),
+				be_to_host16(hdr->length));
+}
+
+
+static void load_sta_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct load_ctx *ctx = eloop_ctx;
+	struct load_sta *sta = timeout_ctx;
+	int res = 0;
+
+	if (sta->retries++ >= ctx->max_retries) {
+		load_sta_fail(sta);
+		return;
+	}
+
+	ctx->retransmits++;
+	switch (sta->state) {
+	case LOAD_STA_AUTH:
+	case LOAD_STA_SAE_COMMIT:
+		res = load_sta_send_auth(sta);
+		break;
+#ifdef CONFIG_SAE
+	case LOAD_STA_SAE_CONFIRM:
+		res = load_sta_send_sae_confirm(sta);
+		break;
+#endif /* CONFIG_SAE */
+	case LOAD_STA_ASSOC:
+		res = load_sta_send_assoc(sta);
+		break;
+	default:
+		/* The AP retransmits EAPOL frames; just keep waiting */
+		load_sta_set_timeout(sta);
+		break;
+	}
+	if (res < 0)
+		load_sta_fail(sta);
+}
+
+
+static int load_sta_start(struct load_ctx *ctx, struct load_sta *sta)
+{
+	struct os_reltime start, end;
+	int res;
+
+	os_get_reltime(&start);
+	sta->start = start;
+	ctx->in_flight++;
+	res = load_sta_send_auth(sta);
+	os_get_reltime(&end);
+	ctx->sta_usec += load_usec_diff(&end, &start);
+	if (res < 0)
+		load_sta_fail(sta);
+	return res;
+}
+
+
+static void load_sta_deauth(struct load_ctx *ctx, struct load_sta *sta)
+{
+	struct wpabuf *buf;
+
+	dl_list_del(&sta->list);
+	ctx->num_assoc--;
+	sta->state = LOAD_STA_GONE;
+	load_sta_free_wpa(sta);
+
+	buf = load_sta_mgmt(sta, WLAN_FC_STYPE_DEAUTH, 2);
+	if (!buf)
+		return;
+	wpabuf_put_le16(buf, WLAN_REASON_DEAUTH_LEAVING);
+	load_queue(ctx, 1, 0, sta->addr, wpabuf_head(buf), wpabuf_len(buf), 0);
+	wpabuf_free(buf);
+}
+
+
+/* Run loop */
+
+static void load_pump(void *eloop_ctx, void *timeout_ctx)
+{
+	struct load_ctx *ctx = eloop_ctx;
+	struct load_frame *f;
+	struct load_sta *sta;
+	unsigned int budget;
+
+	while (ctx->num_assoc > ctx->keep) {
+		sta = dl_list_first(&ctx->assoc_list, struct load_sta, list);
+		load_sta_deauth(ctx, sta);
+	}
+
+	while (ctx->in_flight < ctx->window && ctx->started < ctx->total) {
+		sta = &ctx->sta[ctx->started++];
+		load_sta_start(ctx, sta);
+	}
+
+	/* Process only the frames that are already queued so that timeouts
+	 * registered by hostapd get a chance to run between the rounds. */
+	budget = dl_list_len(&ctx->frames);
+	while (budget-- > 0 &&
+	       (f = dl_list_first(&ctx->frames, struct load_frame, list))) {
+		dl_list_del(&f->list);
+		if (f->to_ap)
+			load_to_ap(ctx, f);
+		else
+			load_from_ap(ctx, f);
+		os_free(f);
+	}
+
+	/* Free the supplicant state of stations that completed during this
+	 * round outside the supplicant callbacks */
+	dl_list_for_each_reverse(sta, &ctx->assoc_list, struct load_sta, list) {
+		if (!sta->wpa)
+			break;
+		load_sta_free_wpa(sta);
+	}
+
+	if (ctx->completed + ctx->failed >= ctx->total) {
+		os_get_reltime(&ctx->run_end);
+		getrusage(RUSAGE_SELF, &ctx->ru_end);
+		eloop_terminate();
+		return;
+	}
+
+	if (!dl_list_empty(&ctx->frames) ||
+	    (ctx->in_flight < ctx->window && ctx->started < ctx->total))
+		load_kick(ctx);
+}
+
+
+static void load_kick(struct load_ctx *ctx)
+{
+	if (!eloop_is_timeout_registered(load_pump, ctx, NULL))
+		eloop_register_timeout(0, 0, load_pump, ctx, NULL);
+}
+
+
+static void load_periodic(void *eloop_ctx, void *timeout_ctx)
+{
+	struct load_ctx *ctx = eloop_ctx;
+
+	eloop_register_timeout(1, 0, load_periodic, ctx, NULL);
+	hostapd_periodic_iface(ctx->iface);
+}
+
+
+/* Reporting */
+
+static int load_cmp_u32(const void *a, const void *b)
+{
+	u32 x = *(const u32 *) a, y = *(const u32 *) b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+
+static u32 load_percentile(const u32 *v, unsigned int n, unsigned int pct)
+{
+	unsigned int i;
+
+	if (n == 0)
+		return 0;
+	i = (n * pct + 99) / 100;
+	if (i > 0)
+		i--;
+	return v[i];
+}
+
+
+static void load_report(struct load_ctx *ctx)
+{
+	static const char * const names[NUM_LOAD_PHASES] = {
+		"auth", "assoc", "keys", "total"
+	};
+	unsigned int i, n = ctx->completed;
+	u64 elapsed, cpu;
+
+	elapsed = load_usec_diff(&ctx->run_end, &ctx->run_start);
+	cpu = load_rusage_usec(&ctx->ru_end) - load_rusage_usec(&ctx->ru_start);
+
+	printf("mode=%s stations=%u window=%u completed=%u failed=%u\n",
+	       load_mode_txt[ctx->mode], ctx->total, ctx->window, n,
+	       ctx->failed);
+	printf("elapsed_usec=%llu assoc_per_sec=%.1f\n",
+	       (unsigned long long) elapsed,
+	       elapsed ? n * 1000000.0 / elapsed : 0.0);
+	printf("cpu_usec_per_assoc=%.1f sta_usec_per_assoc=%.1f\n",
+	       n ? (double) cpu / n : 0.0,
+	       n ? (double) ctx->sta_usec / n : 0.0);
+	printf("frames_to_ap=%u frames_from_ap=%u sae_tokens=%u "
+	       "retransmits=%u ap_disconnects=%u\n",
+	       ctx->frames_to_ap, ctx->frames_from_ap, ctx->sae_tokens,
+	       ctx->retransmits, ctx->ap_disconnects);
+
+	printf("%-6s %10s %10s %10s %10s   (usec)\n",
+	       "phase", "p50", "p90", "p99", "max");
+	for (i = 0; i < NUM_LOAD_PHASES; i++) {
+		u32 *v = ctx->lat[i];
+
+		if (i == LOAD_PHASE_KEYS && ctx->mode == LOAD_MODE_OPEN)
+			continue;
+		qsort(v, n, sizeof(u32), load_cmp_u32);
+		printf("%-6s %10u %10u %10u %10u\n", names[i],
+		       load_percentile(v, n, 50), load_percentile(v, n, 90),
+		       load_percentile(v, n, 99), n ? v[n - 1] : 0);
+	}
+}
+
+
+/* Setup */
+
+static int load_set(struct hostapd_config *conf, const char *field,
+		    const char *value)
+{
+	char buf[100];
+
+	os_strlcpy(buf, value, sizeof(buf));
+	return hostapd_set_iface(conf, conf->bss[0], field, buf);
+}
+
+
+static struct hostapd_config * load_config_read(const char *fname)
+{
+	struct load_ctx *ctx = load_ctx;
+	struct hostapd_config *conf;
+	struct hostapd_bss_config *bss;
+	struct hostapd_eap_user *user;
+	char buf[20];
+	int ret = 0;
+
+	conf = hostapd_config_defaults();
+	if (!conf)
+		return NULL;
+	bss = conf->bss[0];
+	conf->driver = &load_driver_ops;
+	bss->logger_syslog = 0;
+	bss->logger_stdout = 0;
+	os_strlcpy(bss->iface, "load0", sizeof(bss->iface));
+
+	os_snprintf(buf, sizeof(buf), "%u", ctx->keep + ctx->window + 1);
+	ret |= load_set(conf, "hw_mode", "g");
+	ret |= load_set(conf, "channel", "1");
+	ret |= load_set(conf, "ssid", LOAD_SSID);
+	ret |= load_set(conf, "max_num_sta", buf);
+
+	switch (ctx->mode) {
+	case LOAD_MODE_OPEN:
+		break;
+	case LOAD_MODE_PSK:
+		ret |= load_set(conf, "wpa_passphrase", LOAD_PASSPHRASE);
+		ret |= load_set(conf, "wpa_key_mgmt", "WPA-PSK");
+		ret |= load_set(conf, "rsn_pairwise", "CCMP");
+		ret |= load_set(conf, "wpa", "2");
+		break;
+	case LOAD_MODE_SAE:
+		ret |= load_set(conf, "sae_password", LOAD_PASSPHRASE);
+		ret |= load_set(conf, "wpa_key_mgmt", "SAE");
+		ret |= load_set(conf, "rsn_pairwise", "CCMP");
+		ret |= load_set(conf, "ieee80211w", "2");
+		ret |= load_set(conf, "wpa", "2");
+		break;
+	case LOAD_MODE_EAP:
+		user = os_zalloc(sizeof(*user));
+		if (!user)
+			break;
+		user->identity = (u8 *) os_strdup(LOAD_EAP_IDENTITY);
+		user->identity_len = os_strlen(LOAD_EAP_IDENTITY);
+		user->password = (u8 *) os_strdup(LOAD_EAP_PASSWORD);
+		user->password_len = os_strlen(LOAD_EAP_PASSWORD);
+		user->methods[0].vendor = EAP_VENDOR_IETF;
+		user->methods[0].method = EAP_TYPE_MD5;
+		bss->eap_user = user;
+		ret |= load_set(conf, "eap_server", "1");
+		ret |= load_set(conf, "ieee8021x", "1");
+		break;
+	}
+
+	if (ret || !bss->ssid.ssid_set ||
+	    (ctx->mode == LOAD_MODE_EAP && !bss->eap_user)) {
+		hostapd_config_free(conf);
+		return NULL;
+	}
+
+	return conf;
+}
+
+
+static int load_driver_init(struct hostapd_iface *iface)
+{
+	struct hostapd_data *hapd = iface->bss[0];
+	struct wpa_init_params params;
+
+	os_memset(&params, 0, sizeof(params));
+	params.ifname = hapd->conf->iface;
+	params.own_addr = hapd->own_addr;
+	hapd->drv_priv = hapd->driver->hapd_init(hapd, &params);
+	return hapd->drv_priv ? 0 : -1;
+}
+
+
+static void usage(void)
+{
+	printf("usage: ap_load [-dh] [-m <open|psk|sae|eap>] [-n <stations>] "
+	       "[-w <window>]\n"
+	       "               [-k <keep>] [-t <timeout ms>] "
+	       "[-r <retries>]\n"
+	       "\n"
+	       "options:\n"
+	       "   -h   show this usage\n"
+	       "   -d   increase debugging verbosity (-dd even more)\n"
+	       "   -m   security mode (default: psk)\n"
+	       "   -n   number of stations to associate (default: 1000)\n"
+	       "   -w   maximum number of concurrent attempts "
+	       "(default: 64)\n"
+	       "   -k   number of stations kept associated before the "
+	       "oldest\n"
+	       "        ones are deauthenticated (default: 1000)\n"
+	       "   -t   per-step station timeout (default: 5000)\n"
+	       "   -r   retransmissions before a station gives up "
+	       "(default: 3)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct load_ctx ctx;
+	struct hapd_interfaces interfaces;
+	int c, debug = 0, ret = 1;
+	unsigned int i;
+#ifdef CONFIG_DPP
+	struct dpp_global_config dpp_conf;
+#endif /* CONFIG_DPP */
+
+	if (os_program_init())
+		return -1;
+
+	os_memset(&ctx, 0, sizeof(ctx));
+	ctx.mode = LOAD_MODE_PSK;
+	ctx.total = 1000;
+	ctx.window = 64;
+	ctx.keep = 1000;
+	ctx.timeout_ms = 5000;
+	ctx.max_retries = 3;
+	dl_list_init(&ctx.frames);
+	dl_list_init(&ctx.assoc_list);
+	os_memcpy(ctx.ap_addr, "\x02\xff\x00\x00\x00\x01", ETH_ALEN);
+	load_ctx = &ctx;
+
+	for (;;) {
+		c = getopt(argc, argv, "dhk:m:n:r:t:w:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'd':
+			debug++;
+			break;
+		case 'k':
+			ctx.keep = atoi(optarg);
+			break;
+		case 'm':
+			for (i = 0; i < ARRAY_SIZE(load_mode_txt); i++) {
+				if (os_strcmp(optarg, load_mode_txt[i]) == 0)
+					break;
+			}
+			if (i == ARRAY_SIZE(load_mode_txt)) {
+				usage();
+				return -1;
+			}
+			ctx.mode = i;
+			break;
+		case 'n':
+			ctx.total = atoi(optarg);
+			break;
+		case 'r':
+			ctx.max_retries = atoi(optarg);
+			break;
+		case 't':
+			ctx.timeout_ms = atoi(optarg);
+			break;
+		case 'w':
+			ctx.window = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (ctx.total == 0 || ctx.window == 0 || ctx.timeout_ms == 0 ||
+	    ctx.keep + ctx.window >= MAX_STA_COUNT) {
+		usage();
+		return -1;
+	}
+#ifndef NEED_AP_MLME
+	fprintf(stderr, "AP MLME support not included in the build\n");
+	return -1;
+#endif /* NEED_AP_MLME */
+#ifndef CONFIG_SAE
+	if (ctx.mode == LOAD_MODE_SAE) {
+		fprintf(stderr, "SAE support not included in the build\n");
+		return -1;
+	}
+#endif /* CONFIG_SAE */
+
+	wpa_debug_level = debug > 1 ? MSG_DEBUG :
+		(debug ? MSG_INFO : MSG_WARNING);
+
+	ctx.sta = os_calloc(ctx.total, sizeof(struct load_sta));
+	for (i = 0; i < NUM_LOAD_PHASES; i++)
+		ctx.lat[i] = os_calloc(ctx.total, sizeof(u32));
+	if (!ctx.sta || !ctx.lat[0] || !ctx.lat[1] || !ctx.lat[2] ||
+	    !ctx.lat[3])
+		goto out_free;
+	for (i = 0; i < ctx.total; i++) {
+		ctx.sta[i].ctx = &ctx;
+		ctx.sta[i].addr[0] = 0x02;
+		WPA_PUT_BE32(&ctx.sta[i].addr[2], i + 1);
+	}
+	if (ctx.mode == LOAD_MODE_PSK &&
+	    pbkdf2_sha1(LOAD_PASSPHRASE, (const u8 *) LOAD_SSID,
+			os_strlen(LOAD_SSID), 4096, ctx.pmk, PMK_LEN) < 0)
+		goto out_free;
+
+	os_memset(&interfaces, 0, sizeof(interfaces));
+	interfaces.config_read_cb = load_config_read;
+	interfaces.for_each_interface = hostapd_for_each_interface;
+	interfaces.driver_init = load_driver_init;
+	interfaces.global_ctrl_sock = -1;
+	dl_list_init(&interfaces.global_ctrl_dst);
+#ifdef CONFIG_ETH_P_OUI
+	dl_list_init(&interfaces.eth_p_oui);
+#endif /* CONFIG_ETH_P_OUI */
+#ifdef CONFIG_DPP
+	os_memset(&dpp_conf, 0, sizeof(dpp_conf));
+	dpp_conf.cb_ctx = &interfaces;
+	interfaces.dpp = dpp_global_init(&dpp_conf);
+	if (!interfaces.dpp)
+		goto out_free;
+#endif /* CONFIG_DPP */
+
+	if (eap_server_register_methods() || eloop_init()) {
+		wpa_printf(MSG_ERROR, "Failed to initialize");
+		goto out_global;
+	}
+	interfaces.eloop_initialized = 1;
+	random_init(NULL);
+
+	ctx.iface = hostapd_init(&interfaces, "ap_load");
+	if (!ctx.iface)
+		goto out;
+	ctx.iface->interfaces = &interfaces;
+	interfaces.iface = &ctx.iface;
+	interfaces.count = 1;
+	interfaces.terminate_on_error = 1;
+	ctx.hapd = ctx.iface->bss[0];
+	if (load_driver_init(ctx.iface) ||
+	    hostapd_setup_interface(ctx.iface)) {
+		wpa_printf(MSG_ERROR, "Failed to set up the AP");
+		goto out;
+	}
+	if (ctx.hapd->wpa_auth) {
+		ctx.ap_rsne = wpa_auth_get_wpa_ie(ctx.hapd->wpa_auth,
+						  &ctx.ap_rsne_len);
+		if (!ctx.ap_rsne || ctx.ap_rsne_len < 2 ||
+		    ctx.ap_rsne[0] != WLAN_EID_RSN)
+			goto out;
+		ctx.ap_rsne_len = 2 + ctx.ap_rsne[1];
+	}
+
+	os_get_reltime(&ctx.run_start);
+	getrusage(RUSAGE_SELF, &ctx.ru_start);
+	eloop_register_timeout(1, 0, load_periodic, &ctx, NULL);
+	load_kick(&ctx);
+	eloop_run();
+
+	load_report(&ctx);
+	ret = ctx.failed ? 2 : 0;
+
+out:
+	eloop_cancel_timeout(load_periodic, &ctx, NULL);
+	eloop_cancel_timeout(load_pump, &ctx, NULL);
+	for (i = 0; i < ctx.total; i++) {
+		eloop_cancel_timeout(load_sta_timeout, &ctx, &ctx.sta[i]);
+		load_sta_free_wpa(&ctx.sta[i]);
+	}
+	while (!dl_list_empty(&ctx.frames)) {
+		struct load_frame *f;
+
+		f = dl_list_first(&ctx.frames, struct load_frame, list);
+		dl_list_del(&f->list);
+		os_free(f);
+	}
+	if (ctx.iface) {
+		hostapd_interface_deinit_free(ctx.iface);
+		ctx.iface = NULL;
+	}
+	random_deinit();
+	if (interfaces.eloop_initialized)
+		eloop_destroy();
+out_global:
+	eap_server_unregister_methods();
+#ifdef CONFIG_DPP
+	dpp_global_deinit(interfaces.dpp);
+#endif /* CONFIG_DPP */
+out_free:
+	os_free(ctx.sta);
+	for (i = 0; i < NUM_LOAD_PHASES; i++)
+		os_free(ctx.lat[i]);
+	fst_global_deinit();
+	slab_flush();
+	wpabuf_pool_flush();
+	os_program_deinit();
+
+	return ret;
+}
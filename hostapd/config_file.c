@@ -118,54 +118,7 @@ static int hostapd_config_read_vlan_file(struct hostapd_bss_config *bss,
 #endif /* CONFIG_NO_VLAN */
 
 
-int hostapd_acl_comp(const void *a, const void *b)
-{
-	const struct mac_acl_entry *aa = a;
-	const struct mac_acl_entry *bb = b;
-	return os_memcmp(aa->addr, bb->addr, sizeof(macaddr));
-}
-
-
-int hostapd_add_acl_maclist(struct mac_acl_entry **acl, int *num,
-			    int vlan_id, const u8 *addr)
-{
-	struct mac_acl_entry *newacl;
-
-	newacl = os_realloc_array(*acl, *num + 1, sizeof(**acl));
-	if (!newacl) {
-		wpa_printf(MSG_ERROR, "MAC list reallocation failed");
-		return -1;
-	}
-
-	*acl = newacl;
-	os_memcpy((*acl)[*num].addr, addr, ETH_ALEN);
-	os_memset(&(*acl)[*num].vlan_id, 0, sizeof((*acl)[*num].vlan_id));
-	(*acl)[*num].vlan_id.untagged = vlan_id;
-	(*acl)[*num].vlan_id.notempty = !!vlan_id;
-	(*num)++;
-
-	return 0;
-}
-
-
-void hostapd_remove_acl_mac(struct mac_acl_entry **acl, int *num,
-			    const u8 *addr)
-{
-	int i = 0;
-
-	while (i < *num) {
-		if (os_memcmp((*acl)[i].addr, addr, ETH_ALEN) == 0) {
-			os_remove_in_array(*acl, *num, sizeof(**acl), i);
-			(*num)--;
-		} else {
-			i++;
-		}
-	}
-}
-
-
-static int hostapd_config_read_maclist(const char *fname,
-				       struct mac_acl_entry **acl, int *num)
+static int hostapd_config_read_maclist(const char *fname, struct mac_acl *acl)
 {
 	FILE *f;
 	char buf[128], *pos;
@@ -210,7 +163,7 @@ static int hostapd_config_read_maclist(const char *fname,
 		}
 
 		if (rem) {
-			hostapd_remove_acl_mac(acl, num, addr);
+			mac_acl_del(acl, addr);
 			continue;
 		}
 		vlan_id = 0;
@@ -222,7 +175,8 @@ static int hostapd_config_read_maclist(const char *fname,
 		if (*pos != '\0')
 			vlan_id = atoi(pos);
 
-		if (hostapd_add_acl_maclist(acl, num, vlan_id, addr) < 0) {
+		if (mac_acl_add(acl, addr, vlan_id) < 0) {
+			wpa_printf(MSG_ERROR, "MAC list allocation failed");
 			fclose(f);
 			return -1;
 		}
@@ -230,9 +184,6 @@ static int hostapd_config_read_maclist(const char *fname,
 
 	fclose(f);
 
-	if (*acl)
-		qsort(*acl, *num, sizeof(**acl), hostapd_acl_comp);
-
 	return 0;
 }
 
@@ -2436,16 +2387,20 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->macaddr_acl = acl;
+	} else if (os_strcmp(buf, "radius_acl_cache_ttl") == 0) {
+		bss->radius_acl_cache_ttl = atoi(pos);
+	} else if (os_strcmp(buf, "radius_acl_negative_ttl") == 0) {
+		bss->radius_acl_negative_ttl = atoi(pos);
+	} else if (os_strcmp(buf, "radius_acl_prefetch") == 0) {
+		bss->radius_acl_prefetch = atoi(pos);
 	} else if (os_strcmp(buf, "accept_mac_file") == 0) {
-		if (hostapd_config_read_maclist(pos, &bss->accept_mac,
-						&bss->num_accept_mac)) {
+		if (hostapd_config_read_maclist(pos, &bss->accept_mac)) {
 			wpa_printf(MSG_ERROR, "Line %d: Failed to read accept_mac_file '%s'",
 				   line, pos);
 			return 1;
 		}
 	} else if (os_strcmp(buf, "deny_mac_file") == 0) {
-		if (hostapd_config_read_maclist(pos, &bss->deny_mac,
-						&bss->num_deny_mac)) {
+		if (hostapd_config_read_maclist(pos, &bss->deny_mac)) {
 			wpa_printf(MSG_ERROR, "Line %d: Failed to read deny_mac_file '%s'",
 				   line, pos);
 			return 1;
@@ -2541,6 +2496,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->crl_reload_interval = atoi(pos);
 	} else if (os_strcmp(buf, "tls_session_lifetime") == 0) {
 		bss->tls_session_lifetime = atoi(pos);
+	} else if (os_strcmp(buf, "tls_session_cache_file") == 0) {
+		os_free(bss->tls_session_cache_file);
+		bss->tls_session_cache_file = os_strdup(pos);
 	} else if (os_strcmp(buf, "tls_flags") == 0) {
 		bss->tls_flags = parse_tls_flags(pos);
 	} else if (os_strcmp(buf, "max_auth_rounds") == 0) {
@@ -2808,6 +2766,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->radius->retry_primary_interval = atoi(pos);
 	} else if (os_strcmp(buf, "radius_acct_interim_interval") == 0) {
 		bss->acct_interim_interval = atoi(pos);
+	} else if (os_strcmp(buf, "radius_acct_interim_window") == 0) {
+		bss->radius_acct_interim_window = atoi(pos);
 	} else if (os_strcmp(buf, "radius_request_cui") == 0) {
 		bss->radius_request_cui = atoi(pos);
 	} else if (os_strcmp(buf, "radius_auth_req_attr") == 0) {
@@ -3262,6 +3222,21 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->chan_util_avg_period = val;
+#ifdef CONFIG_STATS_SHM
+	} else if (os_strcmp(buf, "stats_shm") == 0) {
+		os_free(bss->stats_shm);
+		bss->stats_shm = os_strdup(pos);
+	} else if (os_strcmp(buf, "stats_shm_interval") == 0) {
+		int val = atoi(pos);
+
+		if (val < 10) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid stats_shm_interval %d",
+				   line, val);
+			return 1;
+		}
+		bss->stats_shm_interval = val;
+#endif /* CONFIG_STATS_SHM */
 	} else if (os_strcmp(buf, "rts_threshold") == 0) {
 		conf->rts_threshold = atoi(pos);
 		if (conf->rts_threshold < -1 || conf->rts_threshold > 65535) {
@@ -4065,6 +4040,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 #ifdef CONFIG_PROXYARP
 	} else if (os_strcmp(buf, "proxy_arp") == 0) {
 		bss->proxy_arp = atoi(pos);
+	} else if (os_strcmp(buf, "ndisc_mcast_targeted") == 0) {
+		bss->ndisc_mcast_targeted = atoi(pos);
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_HS20
 	} else if (os_strcmp(buf, "hs20") == 0) {
@@ -4754,7 +4731,7 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 {
 	struct hostapd_config *conf;
 	FILE *f;
-	char buf[4096], *pos;
+	char buf[4096], *pos, *value;
 	int line = 0;
 	int errors = 0;
 	size_t i;
@@ -4811,7 +4788,16 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		}
 		*pos = '\0';
 		pos++;
-		errors += hostapd_config_fill(conf, bss, buf, pos, line);
+		value = os_strdup(pos);
+		if (!value) {
+			errors++;
+			continue;
+		}
+		if (hostapd_config_fill(conf, bss, buf, pos, line))
+			errors++;
+		else if (hostapd_config_add_param(conf->last_bss, buf, value))
+			errors++;
+		str_clear_free(value);
 	}
 
 	fclose(f);
@@ -4841,13 +4827,22 @@ int hostapd_set_iface(struct hostapd_config *conf,
 {
 	int errors;
 	size_t i;
+	char *param;
 
+	param = os_strdup(value);
+	if (!param)
+		return -1;
 	errors = hostapd_config_fill(conf, bss, field, value, 0);
 	if (errors) {
 		wpa_printf(MSG_INFO, "Failed to set configuration field '%s' "
 			   "to value '%s'", field, value);
+		str_clear_free(param);
 		return -1;
 	}
+	errors = hostapd_config_set_runtime_param(bss, field, param);
+	str_clear_free(param);
+	if (errors)
+		return -1;
 
 	for (i = 0; i < conf->num_bss; i++)
 		hostapd_set_security_params(conf->bss[i], 0);
@@ -29,6 +29,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/slab.h"
 #include "utils/module_tests.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
@@ -50,6 +51,8 @@
 #include "ap/wpa_auth.h"
 #include "ap/pmksa_cache_auth.h"
 #include "ap/ieee802_11.h"
+#include "ap/ieee802_11_auth.h"
+#include "ap/accounting.h"
 #include "ap/sta_info.h"
 #include "ap/wps_hostapd.h"
 #include "ap/ctrl_iface_ap.h"
@@ -1362,43 +1365,6 @@ static int hostapd_ctrl_iface_get_config(struct hostapd_data *hapd,
 }
 
 
-static void hostapd_disassoc_accept_mac(struct hostapd_data *hapd)
-{
-	struct sta_info *sta;
-	struct vlan_description vlan_id;
-
-	if (hapd->conf->macaddr_acl != DENY_UNLESS_ACCEPTED)
-		return;
-
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (!hostapd_maclist_found(hapd->conf->accept_mac,
-					   hapd->conf->num_accept_mac,
-					   sta->addr, &vlan_id) ||
-		    (vlan_id.notempty &&
-		     vlan_compare(&vlan_id, sta->vlan_desc)))
-			ap_sta_disconnect(hapd, sta, sta->addr,
-					  WLAN_REASON_UNSPECIFIED);
-	}
-}
-
-
-static void hostapd_disassoc_deny_mac(struct hostapd_data *hapd)
-{
-	struct sta_info *sta;
-	struct vlan_description vlan_id;
-
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (hostapd_maclist_found(hapd->conf->deny_mac,
-					  hapd->conf->num_deny_mac, sta->addr,
-					  &vlan_id) &&
-		    (!vlan_id.notempty ||
-		     !vlan_compare(&vlan_id, sta->vlan_desc)))
-			ap_sta_disconnect(hapd, sta, sta->addr,
-					  WLAN_REASON_UNSPECIFIED);
-	}
-}
-
-
 static int hostapd_ctrl_iface_set_band(struct hostapd_data *hapd,
 				       const char *bands)
 {
@@ -1637,42 +1603,6 @@ static int hostapd_ctrl_iface_disable(struct hostapd_iface *iface)
 }
 
 
-static int
-hostapd_ctrl_iface_kick_mismatch_psk_sta_iter(struct hostapd_data *hapd,
-					      struct sta_info *sta, void *ctx)
-{
-	struct hostapd_wpa_psk *psk;
-	const u8 *pmk;
-	int pmk_len;
-	int pmk_match;
-	int sta_match;
-	int bss_match;
-	int reason;
-
-	pmk = wpa_auth_get_pmk(sta->wpa_sm, &pmk_len);
-
-	for (psk = hapd->conf->ssid.wpa_psk; pmk && psk; psk = psk->next) {
-		pmk_match = PMK_LEN == pmk_len &&
-			os_memcmp(psk->psk, pmk, pmk_len) == 0;
-		sta_match = psk->group == 0 &&
-			os_memcmp(sta->addr, psk->addr, ETH_ALEN) == 0;
-		bss_match = psk->group == 1;
-
-		if (pmk_match && (sta_match || bss_match))
-			return 0;
-	}
-
-	wpa_printf(MSG_INFO, "STA " MACSTR
-		   " PSK/passphrase no longer valid - disconnect",
-		   MAC2STR(sta->addr));
-	reason = WLAN_REASON_PREV_AUTH_NOT_VALID;
-	hostapd_drv_sta_deauth(hapd, sta->addr, reason);
-	ap_sta_deauthenticate(hapd, sta, reason);
-
-	return 0;
-}
-
-
 static int hostapd_ctrl_iface_reload_wpa_psk(struct hostapd_data *hapd)
 {
 	struct hostapd_bss_config *conf = hapd->conf;
@@ -1687,13 +1617,40 @@ static int hostapd_ctrl_iface_reload_wpa_psk(struct hostapd_data *hapd)
 		return -1;
 	}
 
-	ap_for_each_sta(hapd, hostapd_ctrl_iface_kick_mismatch_psk_sta_iter,
-			NULL);
+	hostapd_kick_mismatch_psk_sta(hapd);
 
 	return 0;
 }
 
 
+static int hostapd_ctrl_iface_reload_status(struct hostapd_iface *iface,
+					    char *buf, size_t buflen)
+{
+	struct hostapd_reload_status *status = &iface->reload;
+	struct os_reltime now, age;
+	int ret;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &status->time, &age);
+
+	ret = os_snprintf(buf, buflen,
+			  "reloads=%u\n"
+			  "mode=%s\n"
+			  "age=%ld\n"
+			  "applied=%s\n"
+			  "restart=%s\n"
+			  "disconnected=%u\n",
+			  status->count,
+			  hostapd_reload_mode_txt(status->mode),
+			  status->count ? (long) age.sec : 0,
+			  status->applied, status->restart,
+			  status->disconnected);
+	if (os_snprintf_error(buflen, ret))
+		return -1;
+	return ret;
+}
+
+
 #ifdef CONFIG_TESTING_OPTIONS
 
 static int hostapd_ctrl_iface_radar(struct hostapd_data *hapd, char *cmd)
@@ -2862,6 +2819,10 @@ static int hostapd_ctrl_iface_mib(struct hostapd_data *hapd, char *reply,
 					     reply_size);
 	}
 #endif /* RADIUS_SERVER */
+#ifdef EAP_TLS_FUNCS
+	if (os_strcmp(param, "tls") == 0 && hapd->ssl_ctx)
+		return tls_get_stats(hapd->ssl_ctx, reply, reply_size);
+#endif /* EAP_TLS_FUNCS */
 	return -1;
 }
 
@@ -3379,61 +3340,62 @@ static int hostapd_ctrl_driver_flags2(struct hostapd_iface *iface, char *buf,
 }
 
 
-static int hostapd_ctrl_iface_acl_del_mac(struct mac_acl_entry **acl, int *num,
+static int hostapd_ctrl_iface_acl_del_mac(struct mac_acl *acl,
 					  const char *txtaddr)
 {
 	u8 addr[ETH_ALEN];
-	struct vlan_description vlan_id;
 
-	if (!(*num))
+	if (!mac_acl_count(acl))
 		return 0;
 
 	if (hwaddr_aton(txtaddr, addr))
 		return -1;
 
-	if (hostapd_maclist_found(*acl, *num, addr, &vlan_id))
-		hostapd_remove_acl_mac(acl, num, addr);
+	mac_acl_del(acl, addr);
 
 	return 0;
 }
 
 
-static void hostapd_ctrl_iface_acl_clear_list(struct mac_acl_entry **acl,
-					      int *num)
+struct acl_show_ctx {
+	char *pos;
+	char *end;
+};
+
+
+static int hostapd_ctrl_iface_acl_show_entry(const struct mac_acl_entry *entry,
+					     void *ctx)
 {
-	while (*num)
-		hostapd_remove_acl_mac(acl, num, (*acl)[0].addr);
+	struct acl_show_ctx *show = ctx;
+	int ret;
+
+	ret = os_snprintf(show->pos, show->end - show->pos,
+			  MACSTR " VLAN_ID=%d\n",
+			  MAC2STR(entry->addr), entry->vlan_id);
+	if (os_snprintf_error(show->end - show->pos, ret))
+		return 1;
+	show->pos += ret;
+	return 0;
 }
 
 
-static int hostapd_ctrl_iface_acl_show_mac(struct mac_acl_entry *acl, int num,
+static int hostapd_ctrl_iface_acl_show_mac(const struct mac_acl *acl,
 					   char *buf, size_t buflen)
 {
-	int i = 0, len = 0, ret = 0;
+	struct acl_show_ctx show;
 
-	if (!acl)
-		return 0;
-
-	while (i < num) {
-		ret = os_snprintf(buf + len, buflen - len,
-				  MACSTR " VLAN_ID=%d\n",
-				  MAC2STR(acl[i].addr),
-				  acl[i].vlan_id.untagged);
-		if (ret < 0 || (size_t) ret >= buflen - len)
-			return len;
-		i++;
-		len += ret;
-	}
-	return len;
+	show.pos = buf;
+	show.end = buf + buflen;
+	mac_acl_for_each(acl, hostapd_ctrl_iface_acl_show_entry, &show);
+	return show.pos - buf;
 }
 
 
-static int hostapd_ctrl_iface_acl_add_mac(struct mac_acl_entry **acl, int *num,
+static int hostapd_ctrl_iface_acl_add_mac(struct mac_acl *acl,
 					  const char *cmd)
 {
 	u8 addr[ETH_ALEN];
-	struct vlan_description vlan_id;
-	int ret = 0, vlanid = 0;
+	int vlanid = 0;
 	const char *pos;
 
 	if (hwaddr_aton(cmd, addr))
@@ -3443,13 +3405,102 @@ static int hostapd_ctrl_iface_acl_add_mac(struct mac_acl_entry **acl, int *num,
 	if (pos)
 		vlanid = atoi(pos + 8);
 
-	if (!hostapd_maclist_found(*acl, *num, addr, &vlan_id)) {
-		ret = hostapd_add_acl_maclist(acl, num, vlanid, addr);
-		if (ret != -1 && *acl)
-			qsort(*acl, *num, sizeof(**acl), hostapd_acl_comp);
+	return mac_acl_add(acl, addr, vlanid);
+}
+
+
+/*
+ * Parse a space separated list of <addr>[/<VLAN ID>] entries. Returns the
+ * number of entries or -1 if any of them is invalid.
+ */
+static int hostapd_ctrl_iface_acl_parse_list(const char *cmd,
+					     int (*cb)(struct mac_acl *acl,
+						       const u8 *addr,
+						       int vlan_id),
+					     struct mac_acl *acl)
+{
+	const char *pos = cmd;
+	u8 addr[ETH_ALEN];
+	int vlan_id, count = 0;
+
+	while (*pos) {
+		while (*pos == ' ')
+			pos++;
+		if (!*pos)
+			break;
+		if (hwaddr_aton(pos, addr))
+			return -1;
+		pos += 17;
+		vlan_id = 0;
+		if (*pos == '/') {
+			pos++;
+			if (*pos < '0' || *pos > '9')
+				return -1;
+			vlan_id = atoi(pos);
+			while (*pos >= '0' && *pos <= '9')
+				pos++;
+		}
+		if (*pos && *pos != ' ')
+			return -1;
+		if (cb && cb(acl, addr, vlan_id) < 0)
+			return -1;
+		count++;
 	}
 
-	return ret < 0 ? -1 : 0;
+	return count;
+}
+
+
+static int hostapd_ctrl_iface_acl_add_entry(struct mac_acl *acl,
+					    const u8 *addr, int vlan_id)
+{
+	return mac_acl_add(acl, addr, vlan_id);
+}
+
+
+static int hostapd_ctrl_iface_acl_del_entry(struct mac_acl *acl,
+					    const u8 *addr, int vlan_id)
+{
+	mac_acl_del(acl, addr);
+	return 0;
+}
+
+
+/*
+ * ADD_MACS/DEL_MACS: Update a MAC ACL with a batch of addresses. The whole
+ * command is validated before the list is modified so that a syntax error
+ * does not leave a partially applied update behind. Added addresses are
+ * collected into a separate list first and moved into the ACL only once all
+ * of them have been allocated.
+ */
+static int hostapd_ctrl_iface_acl_update(struct mac_acl *acl, const char *cmd,
+					 int add, char *buf, size_t buflen)
+{
+	struct mac_acl tmp;
+	int count, ret;
+
+	if (hostapd_ctrl_iface_acl_parse_list(cmd, NULL, NULL) < 0)
+		return -1;
+	if (add) {
+		os_memset(&tmp, 0, sizeof(tmp));
+		count = hostapd_ctrl_iface_acl_parse_list(
+			cmd, hostapd_ctrl_iface_acl_add_entry, &tmp);
+		if (count < 0) {
+			mac_acl_clear(&tmp);
+			return -1;
+		}
+		mac_acl_merge(acl, &tmp);
+	} else {
+		count = hostapd_ctrl_iface_acl_parse_list(
+			cmd, hostapd_ctrl_iface_acl_del_entry, acl);
+		if (count < 0)
+			return -1;
+	}
+
+	ret = os_snprintf(buf, buflen, "%d\n", count);
+	if (os_snprintf_error(buflen, ret))
+		return -1;
+	return ret;
 }
 
 
@@ -3519,6 +3570,16 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+#ifdef CONFIG_ELOOP_PROFILE
+	} else if (os_strcmp(buf, "ELOOP_PROFILE") == 0) {
+		reply_len = eloop_profile_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_PROFILE RESET") == 0) {
+		eloop_profile_reset();
+#endif /* CONFIG_ELOOP_PROFILE */
+#ifdef CONFIG_STA_SLAB
+	} else if (os_strcmp(buf, "SLAB_STATS") == 0) {
+		reply_len = slab_stats(reply, reply_size);
+#endif /* CONFIG_STA_SLAB */
 	} else if (os_strcmp(buf, "STATUS") == 0) {
 		reply_len = hostapd_ctrl_iface_status(hapd, reply,
 						      reply_size);
@@ -3552,6 +3613,14 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 			else
 				reply_len += res;
 		}
+		if (reply_len >= 0)
+			reply_len += hostapd_acl_get_mib(hapd,
+							 reply + reply_len,
+							 reply_size - reply_len);
+		if (reply_len >= 0)
+			reply_len += accounting_get_mib(hapd,
+							reply + reply_len,
+							reply_size - reply_len);
 #endif /* CONFIG_NO_RADIUS */
 	} else if (os_strncmp(buf, "MIB ", 4) == 0) {
 		reply_len = hostapd_ctrl_iface_mib(hapd, reply, reply_size,
@@ -3565,12 +3634,19 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "STA-NEXT ", 9) == 0) {
 		reply_len = hostapd_ctrl_iface_sta_next(hapd, buf + 9, reply,
 							reply_size);
+	} else if (os_strcmp(buf, "STA-DUMP") == 0 ||
+		   os_strncmp(buf, "STA-DUMP ", 9) == 0) {
+		reply_len = hostapd_ctrl_iface_sta_dump(hapd, buf + 8, reply,
+							reply_size);
 	} else if (os_strcmp(buf, "ATTACH") == 0) {
 		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, NULL))
 			reply_len = -1;
 	} else if (os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, buf + 7))
 			reply_len = -1;
+	} else if (os_strcmp(buf, "MONITOR_STATS") == 0) {
+		reply_len = ctrl_iface_monitor_stats(&hapd->ctrl_dst, reply,
+						     reply_size);
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (hostapd_ctrl_iface_detach(hapd, from, fromlen))
 			reply_len = -1;
@@ -3688,6 +3764,9 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strcmp(buf, "RELOAD_WPA_PSK") == 0) {
 		if (hostapd_ctrl_iface_reload_wpa_psk(hapd))
 			reply_len = -1;
+	} else if (os_strcmp(buf, "RELOAD_STATUS") == 0) {
+		reply_len = hostapd_ctrl_iface_reload_status(hapd->iface, reply,
+							     reply_size);
 	} else if (os_strncmp(buf, "RELOAD", 6) == 0) {
 		if (hostapd_ctrl_iface_reload(hapd->iface))
 			reply_len = -1;
@@ -3827,47 +3906,57 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "ACCEPT_ACL ", 11) == 0) {
 		if (os_strncmp(buf + 11, "ADD_MAC ", 8) == 0) {
 			if (hostapd_ctrl_iface_acl_add_mac(
-				    &hapd->conf->accept_mac,
-				    &hapd->conf->num_accept_mac, buf + 19))
+				    &hapd->conf->accept_mac, buf + 19))
 				reply_len = -1;
 		} else if (os_strncmp((buf + 11), "DEL_MAC ", 8) == 0) {
 			if (!hostapd_ctrl_iface_acl_del_mac(
-				    &hapd->conf->accept_mac,
-				    &hapd->conf->num_accept_mac, buf + 19))
+				    &hapd->conf->accept_mac, buf + 19))
 				hostapd_disassoc_accept_mac(hapd);
 			else
 				reply_len = -1;
+		} else if (os_strncmp(buf + 11, "ADD_MACS ", 9) == 0) {
+			reply_len = hostapd_ctrl_iface_acl_update(
+				&hapd->conf->accept_mac, buf + 20, 1,
+				reply, reply_size);
+		} else if (os_strncmp(buf + 11, "DEL_MACS ", 9) == 0) {
+			reply_len = hostapd_ctrl_iface_acl_update(
+				&hapd->conf->accept_mac, buf + 20, 0,
+				reply, reply_size);
+			if (reply_len > 0)
+				hostapd_disassoc_accept_mac(hapd);
 		} else if (os_strcmp(buf + 11, "SHOW") == 0) {
 			reply_len = hostapd_ctrl_iface_acl_show_mac(
-				hapd->conf->accept_mac,
-				hapd->conf->num_accept_mac, reply, reply_size);
+				&hapd->conf->accept_mac, reply, reply_size);
 		} else if (os_strcmp(buf + 11, "CLEAR") == 0) {
-			hostapd_ctrl_iface_acl_clear_list(
-				&hapd->conf->accept_mac,
-				&hapd->conf->num_accept_mac);
+			mac_acl_clear(&hapd->conf->accept_mac);
 			hostapd_disassoc_accept_mac(hapd);
 		}
 	} else if (os_strncmp(buf, "DENY_ACL ", 9) == 0) {
 		if (os_strncmp(buf + 9, "ADD_MAC ", 8) == 0) {
 			if (!hostapd_ctrl_iface_acl_add_mac(
-				    &hapd->conf->deny_mac,
-				    &hapd->conf->num_deny_mac, buf + 17))
+				    &hapd->conf->deny_mac, buf + 17))
 				hostapd_disassoc_deny_mac(hapd);
 			else
 				reply_len = -1;
 		} else if (os_strncmp(buf + 9, "DEL_MAC ", 8) == 0) {
 			if (hostapd_ctrl_iface_acl_del_mac(
-				    &hapd->conf->deny_mac,
-				    &hapd->conf->num_deny_mac, buf + 17))
+				    &hapd->conf->deny_mac, buf + 17))
 				reply_len = -1;
+		} else if (os_strncmp(buf + 9, "ADD_MACS ", 9) == 0) {
+			reply_len = hostapd_ctrl_iface_acl_update(
+				&hapd->conf->deny_mac, buf + 18, 1,
+				reply, reply_size);
+			if (reply_len > 0)
+				hostapd_disassoc_deny_mac(hapd);
+		} else if (os_strncmp(buf + 9, "DEL_MACS ", 9) == 0) {
+			reply_len = hostapd_ctrl_iface_acl_update(
+				&hapd->conf->deny_mac, buf + 18, 0,
+				reply, reply_size);
 		} else if (os_strcmp(buf + 9, "SHOW") == 0) {
 			reply_len = hostapd_ctrl_iface_acl_show_mac(
-				hapd->conf->deny_mac,
-				hapd->conf->num_deny_mac, reply, reply_size);
+				&hapd->conf->deny_mac, reply, reply_size);
 		} else if (os_strcmp(buf + 9, "CLEAR") == 0) {
-			hostapd_ctrl_iface_acl_clear_list(
-				&hapd->conf->deny_mac,
-				&hapd->conf->num_deny_mac);
+			mac_acl_clear(&hapd->conf->deny_mac);
 		}
 #ifdef CONFIG_DPP
 	} else if (os_strncmp(buf, "DPP_QR_CODE ", 12) == 0) {
@@ -4034,6 +4123,51 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 }
 
 
+#define CTRL_IFACE_REPLY_SIZE 4096
+#define CTRL_IFACE_MAX_REPLY_SIZE 65000
+
+/*
+ * Bulk commands may request a larger reply buffer with bufsize=<octets> to
+ * match the receive buffer the client has allocated for the response. The
+ * command may be prefixed with a cookie (UDP) and IFNAME=<ifname> (global
+ * control interface).
+ */
+static int hostapd_ctrl_iface_reply_size(const char *cmd)
+{
+	const char *pos;
+	int val;
+
+#ifdef CONFIG_CTRL_IFACE_UDP
+	if (os_strncmp(cmd, "COOKIE=", 7) == 0) {
+		cmd = os_strchr(cmd, ' ');
+		if (!cmd)
+			return CTRL_IFACE_REPLY_SIZE;
+		while (*cmd == ' ')
+			cmd++;
+	}
+#endif /* CONFIG_CTRL_IFACE_UDP */
+	if (os_strncmp(cmd, "IFNAME=", 7) == 0) {
+		cmd = os_strchr(cmd, ' ');
+		if (!cmd)
+			return CTRL_IFACE_REPLY_SIZE;
+		cmd++;
+	}
+
+	if (os_strcmp(cmd, "STA-DUMP") != 0 &&
+	    os_strncmp(cmd, "STA-DUMP ", 9) != 0)
+		return CTRL_IFACE_REPLY_SIZE;
+	pos = os_strstr(cmd, " bufsize=");
+	if (!pos)
+		return CTRL_IFACE_REPLY_SIZE;
+	val = atoi(pos + 9);
+	if (val < CTRL_IFACE_REPLY_SIZE)
+		return CTRL_IFACE_REPLY_SIZE;
+	if (val > CTRL_IFACE_MAX_REPLY_SIZE)
+		return CTRL_IFACE_MAX_REPLY_SIZE;
+	return val;
+}
+
+
 static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 				       void *sock_ctx)
 {
@@ -4043,7 +4177,7 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	struct sockaddr_storage from;
 	socklen_t fromlen = sizeof(from);
 	char *reply, *pos = buf;
-	const int reply_size = 4096;
+	int reply_size;
 	int reply_len;
 	int level = MSG_DEBUG;
 #ifdef CONFIG_CTRL_IFACE_UDP
@@ -4059,6 +4193,7 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	}
 	buf[res] = '\0';
 
+	reply_size = hostapd_ctrl_iface_reply_size(buf);
 	reply = os_malloc(reply_size);
 	if (reply == NULL) {
 		if (sendto(sock, "FAIL\n", 5, 0, (struct sockaddr *) &from,
@@ -4405,14 +4540,13 @@ fail:
 
 void hostapd_ctrl_iface_deinit(struct hostapd_data *hapd)
 {
-	struct wpa_ctrl_dst *dst, *prev;
-
 	if (hapd->ctrl_sock > -1) {
 #ifndef CONFIG_CTRL_IFACE_UDP
 		char *fname;
 #endif /* !CONFIG_CTRL_IFACE_UDP */
 
 		eloop_unregister_read_sock(hapd->ctrl_sock);
+		ctrl_iface_flush_batches(&hapd->ctrl_sock, &hapd->ctrl_dst);
 		close(hapd->ctrl_sock);
 		hapd->ctrl_sock = -1;
 #ifndef CONFIG_CTRL_IFACE_UDP
@@ -4437,9 +4571,7 @@ void hostapd_ctrl_iface_deinit(struct hostapd_data *hapd)
 #endif /* !CONFIG_CTRL_IFACE_UDP */
 	}
 
-	dl_list_for_each_safe(dst, prev, &hapd->ctrl_dst, struct wpa_ctrl_dst,
-			      list)
-		os_free(dst);
+	ctrl_iface_free_dsts(&hapd->ctrl_dst);
 
 #ifdef CONFIG_TESTING_OPTIONS
 	l2_packet_deinit(hapd->l2_test);
@@ -4777,7 +4909,7 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	socklen_t fromlen = sizeof(from);
 	char *reply;
 	int reply_len;
-	const int reply_size = 4096;
+	int reply_size;
 #ifdef CONFIG_CTRL_IFACE_UDP
 	unsigned char lcookie[CTRL_IFACE_COOKIE_LEN];
 #endif /* CONFIG_CTRL_IFACE_UDP */
@@ -4792,6 +4924,7 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	buf[res] = '\0';
 	wpa_printf(MSG_DEBUG, "Global ctrl_iface command: %s", buf);
 
+	reply_size = hostapd_ctrl_iface_reply_size(buf);
 	reply = os_malloc(reply_size);
 	if (reply == NULL) {
 		if (sendto(sock, "FAIL\n", 5, 0, (struct sockaddr *) &from,
@@ -4856,6 +4989,16 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 			reply_len = -1;
 	} else if (os_strcmp(buf, "FLUSH") == 0) {
 		hostapd_ctrl_iface_flush(interfaces);
+#ifdef CONFIG_ELOOP_PROFILE
+	} else if (os_strcmp(buf, "ELOOP_PROFILE") == 0) {
+		reply_len = eloop_profile_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_PROFILE RESET") == 0) {
+		eloop_profile_reset();
+#endif /* CONFIG_ELOOP_PROFILE */
+#ifdef CONFIG_STA_SLAB
+	} else if (os_strcmp(buf, "SLAB_STATS") == 0) {
+		reply_len = slab_stats(reply, reply_size);
+#endif /* CONFIG_STA_SLAB */
 	} else if (os_strncmp(buf, "ADD ", 4) == 0) {
 		if (hostapd_ctrl_iface_add(interfaces, buf + 4) < 0)
 			reply_len = -1;
@@ -4870,6 +5013,9 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 		if (hostapd_global_ctrl_iface_attach(interfaces, &from,
 						     fromlen, buf + 7))
 			reply_len = -1;
+	} else if (os_strcmp(buf, "MONITOR_STATS") == 0) {
+		reply_len = ctrl_iface_monitor_stats(
+			&interfaces->global_ctrl_dst, reply, reply_size);
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (hostapd_global_ctrl_iface_detach(interfaces, &from,
 			fromlen))
@@ -5150,10 +5296,10 @@ void hostapd_global_ctrl_iface_deinit(struct hapd_interfaces *interfaces)
 #ifndef CONFIG_CTRL_IFACE_UDP
 	char *fname = NULL;
 #endif /* CONFIG_CTRL_IFACE_UDP */
-	struct wpa_ctrl_dst *dst, *prev;
-
 	if (interfaces->global_ctrl_sock > -1) {
 		eloop_unregister_read_sock(interfaces->global_ctrl_sock);
+		ctrl_iface_flush_batches(&interfaces->global_ctrl_sock,
+					 &interfaces->global_ctrl_dst);
 		close(interfaces->global_ctrl_sock);
 		interfaces->global_ctrl_sock = -1;
 #ifndef CONFIG_CTRL_IFACE_UDP
@@ -5182,9 +5328,7 @@ void hostapd_global_ctrl_iface_deinit(struct hapd_interfaces *interfaces)
 	os_free(interfaces->global_iface_path);
 	interfaces->global_iface_path = NULL;
 
-	dl_list_for_each_safe(dst, prev, &interfaces->global_ctrl_dst,
-			      struct wpa_ctrl_dst, list)
-		os_free(dst);
+	ctrl_iface_free_dsts(&interfaces->global_ctrl_dst);
 }
 
 
@@ -5200,15 +5344,17 @@ static int hostapd_ctrl_check_event_enabled(struct wpa_ctrl_dst *dst,
 }
 
 
-static void hostapd_ctrl_iface_send_internal(int sock, struct dl_list *ctrl_dst,
+static void hostapd_ctrl_iface_send_internal(int *sockp,
+					     struct dl_list *ctrl_dst,
 					     const char *ifname, int level,
 					     const char *buf, size_t len)
 {
 	struct wpa_ctrl_dst *dst, *next;
 	struct msghdr msg;
-	int idx, res;
+	int idx, res, iovlen;
 	struct iovec io[5];
 	char levelstr[10];
+	int sock = *sockp;
 
 	if (sock < 0 || dl_list_empty(ctrl_dst))
 		return;
@@ -5237,11 +5383,20 @@ static void hostapd_ctrl_iface_send_internal(int sock, struct dl_list *ctrl_dst,
 	os_memset(&msg, 0, sizeof(msg));
 	msg.msg_iov = io;
 	msg.msg_iovlen = idx;
+	iovlen = idx;
 
 	idx = 0;
 	dl_list_for_each_safe(dst, next, ctrl_dst, struct wpa_ctrl_dst, list) {
 		if ((level >= dst->debug_level) &&
-		     hostapd_ctrl_check_event_enabled(dst, buf)) {
+		     hostapd_ctrl_check_event_enabled(dst, buf) &&
+		     ctrl_iface_event_filter(dst, buf, len)) {
+			if (dst->batch) {
+				ctrl_iface_batch_event(sockp, ctrl_dst, dst,
+						       io, iovlen);
+				idx++;
+				continue;
+			}
+			dst->seq++;
 			sockaddr_print(MSG_DEBUG, "CTRL_IFACE monitor send",
 				       &dst->addr, dst->addrlen);
 			msg.msg_name = &dst->addr;
@@ -5251,14 +5406,18 @@ static void hostapd_ctrl_iface_send_internal(int sock, struct dl_list *ctrl_dst,
 				wpa_printf(MSG_INFO, "CTRL_IFACE monitor[%d]: "
 					   "%d - %s",
 					   idx, errno, strerror(errno));
+				dst->lost++;
 				dst->errors++;
-				if (dst->errors > 10 || _errno == ENOENT) {
+				if (dst->errors > 10 || _errno == ENOENT ||
+				    _errno == EPERM) {
 					ctrl_iface_detach(ctrl_dst,
 							  &dst->addr,
 							  dst->addrlen);
 				}
-			} else
+			} else {
+				dst->sent++;
 				dst->errors = 0;
+			}
 		}
 		idx++;
 	}
@@ -5271,7 +5430,7 @@ static void hostapd_ctrl_iface_send(struct hostapd_data *hapd, int level,
 {
 	if (type != WPA_MSG_NO_GLOBAL) {
 		hostapd_ctrl_iface_send_internal(
-			hapd->iface->interfaces->global_ctrl_sock,
+			&hapd->iface->interfaces->global_ctrl_sock,
 			&hapd->iface->interfaces->global_ctrl_dst,
 			type != WPA_MSG_PER_INTERFACE ?
 			NULL : hapd->conf->iface,
@@ -5280,7 +5439,7 @@ static void hostapd_ctrl_iface_send(struct hostapd_data *hapd, int level,
 
 	if (type != WPA_MSG_ONLY_GLOBAL) {
 		hostapd_ctrl_iface_send_internal(
-			hapd->ctrl_sock, &hapd->ctrl_dst,
+			&hapd->ctrl_sock, &hapd->ctrl_dst,
 			NULL, level, buf, len);
 	}
 }
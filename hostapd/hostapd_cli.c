@@ -252,6 +252,20 @@ static int hostapd_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int hostapd_cli_cmd_eloop_profile(struct wpa_ctrl *ctrl, int argc,
+					 char *argv[])
+{
+	return hostapd_cli_cmd(ctrl, "ELOOP_PROFILE", 0, argc, argv);
+}
+
+
+static int hostapd_cli_cmd_slab_stats(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "SLAB_STATS");
+}
+
+
 static int hostapd_cli_cmd_status(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	if (argc > 0 && os_strcmp(argv[0], "driver") == 0)
@@ -790,6 +804,47 @@ static int hostapd_cli_cmd_list_sta(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+#define STA_DUMP_BUFSIZE 65000
+
+static int hostapd_cli_cmd_sta_dump(struct wpa_ctrl *ctrl, int argc,
+				    char *argv[])
+{
+	char cmd[256], *buf;
+	size_t len;
+	int ret, res;
+
+	if (ctrl_conn == NULL) {
+		printf("Not connected to hostapd - command dropped.\n");
+		return -1;
+	}
+
+	if (write_cmd(cmd, sizeof(cmd), "STA-DUMP", argc, argv) < 0)
+		return -1;
+	res = os_snprintf(cmd + os_strlen(cmd), sizeof(cmd) - os_strlen(cmd),
+			  " bufsize=%d", STA_DUMP_BUFSIZE);
+	if (os_snprintf_error(sizeof(cmd) - os_strlen(cmd), res))
+		return -1;
+
+	buf = os_malloc(STA_DUMP_BUFSIZE + 1);
+	if (!buf)
+		return -1;
+	len = STA_DUMP_BUFSIZE;
+	ret = wpa_ctrl_request(ctrl, cmd, os_strlen(cmd), buf, &len,
+			       hostapd_cli_msg_cb);
+	if (ret == -2) {
+		printf("'%s' command timed out.\n", cmd);
+	} else if (ret < 0) {
+		printf("'%s' command failed.\n", cmd);
+	} else {
+		buf[len] = '\0';
+		printf("%s", buf);
+	}
+	os_free(buf);
+
+	return ret;
+}
+
+
 static int hostapd_cli_cmd_help(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	print_help(stdout, argc > 0 ? argv[0] : NULL);
@@ -926,6 +981,13 @@ static int hostapd_cli_cmd_level(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int hostapd_cli_cmd_monitor_stats(struct wpa_ctrl *ctrl, int argc,
+					 char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "MONITOR_STATS");
+}
+
+
 static void update_stations(struct wpa_ctrl *ctrl)
 {
 	char addr[32], cmd[64];
@@ -1541,6 +1603,13 @@ static int hostapd_cli_cmd_reload_wpa_psk(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int hostapd_cli_cmd_reload_status(struct wpa_ctrl *ctrl, int argc,
+					 char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "RELOAD_STATUS");
+}
+
+
 #ifdef ANDROID
 static int hostapd_cli_cmd_driver(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
@@ -1563,6 +1632,10 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	  "= get MIB variables (dot1x, dot11, radius)" },
 	{ "relog", hostapd_cli_cmd_relog, NULL,
 	  "= reload/truncate debug log output file" },
+	{ "eloop_profile", hostapd_cli_cmd_eloop_profile, NULL,
+	  "[RESET] = show or clear event loop handler profiling data" },
+	{ "slab_stats", hostapd_cli_cmd_slab_stats, NULL,
+	  "= show per-station object cache statistics" },
 	{ "status", hostapd_cli_cmd_status, NULL,
 	  "= show interface status info" },
 	{ "sta", hostapd_cli_cmd_sta, hostapd_complete_stations,
@@ -1571,6 +1644,9 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	   "= get MIB variables for all stations" },
 	{ "list_sta", hostapd_cli_cmd_list_sta, NULL,
 	   "= list all stations" },
+	{ "sta_dump", hostapd_cli_cmd_sta_dump, NULL,
+	  "[after=<addr>] [max=<count>] [fields=<list>] [format=<kv|json>] "
+	  "[since=<gen>] = dump multiple stations in a single reply" },
 	{ "new_sta", hostapd_cli_cmd_new_sta, NULL,
 	  "<addr> = add a new station" },
 	{ "deauthenticate", hostapd_cli_cmd_deauthenticate,
@@ -1631,6 +1707,8 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	  "<params..> = send unprocessed command" },
 	{ "level", hostapd_cli_cmd_level, NULL,
 	  "<debug level> = change debug level" },
+	{ "monitor_stats", hostapd_cli_cmd_monitor_stats, NULL,
+	  "= show event delivery statistics of attached monitors" },
 	{ "license", hostapd_cli_cmd_license, NULL,
 	  "= show full hostapd_cli license" },
 	{ "quit", hostapd_cli_cmd_quit, NULL,
@@ -1740,6 +1818,8 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	  "<addr> [req_mode=] <measurement request hexdump>  = send a Beacon report request to a station" },
 	{ "reload_wpa_psk", hostapd_cli_cmd_reload_wpa_psk, NULL,
 	  "= reload wpa_psk_file only" },
+	{ "reload_status", hostapd_cli_cmd_reload_status, NULL,
+	  "= show changes applied by the last configuration reload" },
 #ifdef ANDROID
 	{ "driver", hostapd_cli_cmd_driver, NULL,
 	  "<driver sub command> [<hex formatted data>] = send driver command data" },
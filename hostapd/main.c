@@ -14,6 +14,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/slab.h"
 #include "utils/uuid.h"
 #include "crypto/random.h"
 #include "crypto/tls.h"
@@ -933,6 +934,8 @@ int main(int argc, char *argv[])
 
 	fst_global_deinit();
 
+	slab_flush();
+	wpabuf_pool_flush();
 	os_program_deinit();
 
 	return ret;
@@ -0,0 +1,251 @@
+/*
+ * Reader for the shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "common/stats_shm.h"
+
+
+static void print_radius(const char *name, const struct stats_shm_radius *r)
+{
+	char addr[INET6_ADDRSTRLEN];
+
+	if (!r->valid)
+		return;
+
+	addr[0] = '\0';
+	if (r->af == 4)
+		inet_ntop(AF_INET, r->addr, addr, sizeof(addr));
+#ifdef AF_INET6
+	else if (r->af == 6)
+		inet_ntop(AF_INET6, r->addr, addr, sizeof(addr));
+#endif /* AF_INET6 */
+
+	printf("%s_server=%s:%u\n"
+	       "%s_round_trip_time=%d\n"
+	       "%s_requests=%u\n"
+	       "%s_retransmissions=%u\n"
+	       "%s_access_accepts=%u\n"
+	       "%s_access_rejects=%u\n"
+	       "%s_access_challenges=%u\n"
+	       "%s_responses=%u\n"
+	       "%s_malformed_responses=%u\n"
+	       "%s_bad_authenticators=%u\n"
+	       "%s_timeouts=%u\n"
+	       "%s_unknown_types=%u\n"
+	       "%s_packets_dropped=%u\n",
+	       name, addr, r->port,
+	       name, r->round_trip_time,
+	       name, r->requests,
+	       name, r->retransmissions,
+	       name, r->access_accepts,
+	       name, r->access_rejects,
+	       name, r->access_challenges,
+	       name, r->responses,
+	       name, r->malformed_responses,
+	       name, r->bad_authenticators,
+	       name, r->timeouts,
+	       name, r->unknown_types,
+	       name, r->packets_dropped);
+}
+
+
+static void print_ap(const struct stats_shm_hdr *hdr, const u8 *snap)
+{
+	const struct stats_shm_ap *ap;
+	const struct stats_shm_sta *sta;
+	unsigned int i;
+
+	if (hdr->data_len < sizeof(*ap) || hdr->rec_len < sizeof(*sta))
+		return;
+	ap = (const struct stats_shm_ap *) (snap + hdr->data_off);
+
+	printf("ifname=%s\n"
+	       "bssid=" MACSTR "\n"
+	       "ssid=%s\n"
+	       "state=%u\n"
+	       "freq=%u\n"
+	       "channel=%u\n"
+	       "num_sta=%u\n"
+	       "num_sta_authorized=%u\n"
+	       "max_num_sta=%u\n"
+	       "rx_bytes=%llu\n"
+	       "tx_bytes=%llu\n"
+	       "rx_packets=%llu\n"
+	       "tx_packets=%llu\n",
+	       ap->ifname, MAC2STR(ap->bssid),
+	       wpa_ssid_txt(ap->ssid, ap->ssid_len <= sizeof(ap->ssid) ?
+			    ap->ssid_len : 0),
+	       ap->state, ap->freq, ap->channel, ap->num_sta,
+	       ap->num_sta_authorized, ap->max_num_sta,
+	       (unsigned long long) ap->rx_bytes,
+	       (unsigned long long) ap->tx_bytes,
+	       (unsigned long long) ap->rx_packets,
+	       (unsigned long long) ap->tx_packets);
+	if (ap->drv_data_age_ms != STATS_SHM_AGE_UNKNOWN)
+		printf("drv_data_age_ms=%u\n", ap->drv_data_age_ms);
+	print_radius("radius_auth", &ap->radius_auth);
+	print_radius("radius_acct", &ap->radius_acct);
+
+	for (i = 0; i < hdr->num_rec && i < hdr->max_rec; i++) {
+		sta = (const struct stats_shm_sta *)
+			(snap + hdr->rec_off + i * hdr->rec_len);
+		printf("sta=" MACSTR " aid=%u flags=0x%x connected_time=%u",
+		       MAC2STR(sta->addr), sta->aid, sta->flags,
+		       sta->connected_sec);
+		if (sta->info & STATS_SHM_STA_DRV_DATA)
+			printf(" inactive_msec=%u rx_bytes=%llu tx_bytes=%llu rx_packets=%llu tx_packets=%llu tx_rate=%u rx_rate=%u tx_retry_failed=%u signal=%d",
+			       sta->inactive_msec,
+			       (unsigned long long) sta->rx_bytes,
+			       (unsigned long long) sta->tx_bytes,
+			       (unsigned long long) sta->rx_packets,
+			       (unsigned long long) sta->tx_packets,
+			       sta->tx_rate, sta->rx_rate,
+			       sta->tx_retry_failed, sta->signal);
+		printf("\n");
+	}
+}
+
+
+static void print_iface(const struct stats_shm_hdr *hdr, const u8 *snap)
+{
+	const struct stats_shm_iface *rec;
+
+	if (hdr->data_len < sizeof(*rec))
+		return;
+	rec = (const struct stats_shm_iface *) (snap + hdr->data_off);
+
+	printf("ifname=%s\n"
+	       "wpa_state=%u\n"
+	       "bssid=" MACSTR "\n"
+	       "ssid=%s\n"
+	       "freq=%u\n"
+	       "signal=%d\n"
+	       "avg_signal=%d\n"
+	       "noise=%d\n"
+	       "txrate=%d\n"
+	       "connected_time=%u\n"
+	       "rx_bytes=%llu\n"
+	       "tx_bytes=%llu\n"
+	       "rx_packets=%llu\n"
+	       "tx_packets=%llu\n"
+	       "tx_retry_failed=%u\n",
+	       rec->ifname, rec->wpa_state, MAC2STR(rec->bssid),
+	       wpa_ssid_txt(rec->ssid, rec->ssid_len <= sizeof(rec->ssid) ?
+			    rec->ssid_len : 0),
+	       rec->freq, rec->signal, rec->avg_signal, rec->noise,
+	       rec->txrate, rec->connected_sec,
+	       (unsigned long long) rec->rx_bytes,
+	       (unsigned long long) rec->tx_bytes,
+	       (unsigned long long) rec->rx_packets,
+	       (unsigned long long) rec->tx_packets,
+	       rec->tx_retry_failed);
+}
+
+
+static void usage(void)
+{
+	printf("Reader for hostapd/wpa_supplicant shared memory statistics\n"
+	       "\n"
+	       "usage:\n"
+	       "stats_shm_reader [-h] [-i<interval in ms>] [-c<count>] <file>\n"
+	       "\n"
+	       "options:\n"
+	       "  -h = show this usage help\n"
+	       "  -i<interval in ms> = print a new snapshot periodically\n"
+	       "  -c<count> = number of snapshots to print with -i\n"
+	       "              (default: until terminated)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct stats_shm *shm;
+	const struct stats_shm_hdr *hdr;
+	unsigned int interval = 0, count = 0, i;
+	u8 *snap;
+	size_t len;
+	int c, ret = -1;
+
+	for (;;) {
+		c = getopt(argc, argv, "c:hi:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'c':
+			count = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'i':
+			interval = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (optind + 1 != argc) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+
+	shm = stats_shm_open(argv[optind]);
+	if (!shm) {
+		fprintf(stderr, "Could not open statistics file %s\n",
+			argv[optind]);
+		goto fail;
+	}
+	len = stats_shm_len(shm);
+	snap = os_malloc(len);
+	if (!snap)
+		goto fail;
+	hdr = (const struct stats_shm_hdr *) snap;
+
+	for (i = 0; ; i++) {
+		if (stats_shm_read(shm, snap, len, 1000) < 0) {
+			fprintf(stderr, "Could not read a consistent snapshot\n");
+			break;
+		}
+
+		printf("type=%s\n"
+		       "pid=%u\n"
+		       "update_count=%u\n"
+		       "update_time=%llu.%06llu\n"
+		       "interval_ms=%u\n",
+		       hdr->type == STATS_SHM_TYPE_AP ? "ap" :
+		       (hdr->type == STATS_SHM_TYPE_STA ? "sta" : "unknown"),
+		       hdr->pid, hdr->update_count,
+		       (unsigned long long) hdr->update_time_usec / 1000000,
+		       (unsigned long long) hdr->update_time_usec % 1000000,
+		       hdr->interval_ms);
+		if (hdr->type == STATS_SHM_TYPE_AP)
+			print_ap(hdr, snap);
+		else if (hdr->type == STATS_SHM_TYPE_STA)
+			print_iface(hdr, snap);
+		fflush(stdout);
+
+		if (!interval || (count && i + 1 >= count)) {
+			ret = 0;
+			break;
+		}
+		printf("\n");
+		os_sleep(interval / 1000, (interval % 1000) * 1000);
+	}
+
+	os_free(snap);
+fail:
+	stats_shm_destroy(shm);
+	os_program_deinit();
+	return ret;
+}
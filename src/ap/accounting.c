@@ -26,6 +26,34 @@
  * STA is not using interim accounting. This detects wrap arounds for
  * input/output octets and updates Acct-{Input,Output}-Gigawords. */
 #define ACCT_DEFAULT_UPDATE_INTERVAL 300
+/* Maximum age of bulk station data that can be used for interim updates */
+#define ACCT_STA_DATA_MAX_AGE_MS 1000
+/* Number of one second slots in the interim update schedule. A station that is
+ * due further in the future than this stays in its slot until the slot comes
+ * around for the correct second. */
+#define ACCT_SCHED_SLOTS 64
+/* The first update of a station is moved earlier by a random amount of up to
+ * 1/N of the interval to spread out stations that connected at the same time,
+ * e.g., after a restart. */
+#define ACCT_SCHED_JITTER_DIV 4
+/* Fetch driver data for all stations at once if at least 1/N of the associated
+ * stations are due in the same slot; otherwise, query them individually. */
+#define ACCT_SCHED_BULK_DIV 16
+
+struct accounting_sched {
+	struct dl_list slot[ACCT_SCHED_SLOTS]; /* struct sta_info::acct_list */
+	struct dl_list ready; /* due, waiting for room in the in-flight window */
+	unsigned int num_sta;
+	os_time_t last_slot; /* os_reltime seconds of the last processed slot */
+
+	unsigned int interim_sent;
+	unsigned int stats_updates;
+	unsigned int bulk_fetches;
+	unsigned int window_full;
+	unsigned int skew_count;
+	unsigned int skew_max_ms;
+	u64 skew_total_ms;
+};
 
 static void accounting_sta_interim(struct hostapd_data *hapd,
 				   struct sta_info *sta);
@@ -169,9 +197,17 @@ static struct radius_msg * accounting_msg(struct hostapd_data *hapd,
 
 static int accounting_sta_update_stats(struct hostapd_data *hapd,
 				       struct sta_info *sta,
-				       struct hostap_sta_driver_data *data)
+				       struct hostap_sta_driver_data *data,
+				       int stop)
 {
-	if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
+	/*
+	 * Interim updates can use recent data from a bulk fetch (e.g., from
+	 * airtime policy updates) instead of a separate driver request. The
+	 * final counters are always fetched for the station.
+	 */
+	if (stop ? hostapd_drv_read_sta_data(hapd, data, sta->addr) :
+	    hostapd_drv_read_sta_data_cached(hapd, data, sta->addr,
+					     ACCT_STA_DATA_MAX_AGE_MS))
 		return -1;
 
 	if (!data->bytes_64bit) {
@@ -198,23 +234,206 @@ static int accounting_sta_update_stats(struct hostapd_data *hapd,
 }
 
 
-static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx)
+static struct accounting_sched *
+accounting_sched_get(struct hostapd_data *hapd)
 {
-	struct hostapd_data *hapd = eloop_ctx;
-	struct sta_info *sta = timeout_ctx;
+	struct accounting_sched *sched = hapd->acct_sched;
+	struct os_reltime now;
+	unsigned int i;
+
+	if (sched)
+		return sched;
+
+	sched = os_zalloc(sizeof(*sched));
+	if (!sched)
+		return NULL;
+	for (i = 0; i < ACCT_SCHED_SLOTS; i++)
+		dl_list_init(&sched->slot[i]);
+	dl_list_init(&sched->ready);
+	os_get_reltime(&now);
+	sched->last_slot = now.sec;
+	hapd->acct_sched = sched;
+	return sched;
+}
+
+
+static void accounting_sched_timer(void *eloop_ctx, void *timeout_ctx);
+static void accounting_sched_pending(void *eloop_ctx, void *timeout_ctx);
+
+
+static void accounting_sched_sta(struct hostapd_data *hapd,
+				 struct sta_info *sta, os_time_t due)
+{
+	struct accounting_sched *sched = hapd->acct_sched;
+
+	if (sta->acct_list.next) {
+		dl_list_del(&sta->acct_list);
+	} else if (sched->num_sta++ == 0) {
+		struct os_reltime now;
+
+		os_get_reltime(&now);
+		sched->last_slot = now.sec;
+		eloop_register_timeout(1, 0, accounting_sched_timer, hapd,
+				       NULL);
+	}
+
+	sta->acct_next_update = due;
+	if (due <= sched->last_slot)
+		dl_list_add_tail(&sched->ready, &sta->acct_list);
+	else
+		dl_list_add_tail(&sched->slot[due % ACCT_SCHED_SLOTS],
+				 &sta->acct_list);
+}
+
+
+static void accounting_sched_del(struct hostapd_data *hapd,
+				 struct sta_info *sta)
+{
+	struct accounting_sched *sched = hapd->acct_sched;
+
+	if (!sched || !sta->acct_list.next)
+		return;
+
+	dl_list_del(&sta->acct_list);
+	if (--sched->num_sta == 0) {
+		eloop_cancel_timeout(accounting_sched_timer, hapd, NULL);
+		eloop_cancel_timeout(accounting_sched_pending, hapd, NULL);
+	}
+}
+
+
+static void accounting_sched_skew(struct accounting_sched *sched,
+				  struct sta_info *sta,
+				  const struct os_reltime *now)
+{
+	unsigned int skew_ms;
+
+	if (now->sec < sta->acct_next_update)
+		return;
+	skew_ms = (now->sec - sta->acct_next_update) * 1000 +
+		now->usec / 1000;
+	sched->skew_count++;
+	sched->skew_total_ms += skew_ms;
+	if (skew_ms > sched->skew_max_ms)
+		sched->skew_max_ms = skew_ms;
+}
+
+
+/* Send the updates that are due as long as the in-flight window allows */
+static void accounting_sched_run(struct hostapd_data *hapd)
+{
+	struct accounting_sched *sched = hapd->acct_sched;
+	struct sta_info *sta, *n;
+	struct os_reltime now;
+	size_t window, pending = 0;
+	unsigned int num_due = 0;
+	bool window_full = false;
+	os_time_t next;
 	int interval;
 
-	if (sta->acct_interim_interval) {
-		accounting_sta_interim(hapd, sta);
-		interval = sta->acct_interim_interval;
-	} else {
-		struct hostap_sta_driver_data data;
-		accounting_sta_update_stats(hapd, sta, &data);
-		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
+	if (!sched || dl_list_empty(&sched->ready))
+		return;
+
+	window = hapd->conf->radius_acct_interim_window;
+	if (window)
+		pending = radius_client_num_pending(hapd->radius,
+						    RADIUS_ACCT_INTERIM);
+
+	dl_list_for_each(sta, &sched->ready, struct sta_info, acct_list)
+		num_due++;
+	if (num_due > 1 &&
+	    num_due * ACCT_SCHED_BULK_DIV >= (unsigned int) hapd->num_sta &&
+	    hostapd_drv_read_all_sta_data(hapd, ACCT_STA_DATA_MAX_AGE_MS) == 0)
+		sched->bulk_fetches++;
+
+	os_get_reltime(&now);
+	dl_list_for_each_safe(sta, n, &sched->ready, struct sta_info,
+			      acct_list) {
+		if (sta->acct_interim_interval && window &&
+		    pending >= window) {
+			window_full = true;
+			continue;
+		}
+
+		accounting_sched_skew(sched, sta, &now);
+		if (sta->acct_interim_interval) {
+			accounting_sta_interim(hapd, sta);
+			sched->interim_sent++;
+			pending++;
+			interval = sta->acct_interim_interval;
+		} else {
+			struct hostap_sta_driver_data data;
+
+			accounting_sta_update_stats(hapd, sta, &data, 0);
+			sched->stats_updates++;
+			interval = ACCT_DEFAULT_UPDATE_INTERVAL;
+		}
+
+		/* Keep the phase of the schedule unless the update was delayed
+		 * by more than a full interval. */
+		next = sta->acct_next_update + interval;
+		if (next <= now.sec)
+			next = now.sec + interval;
+		accounting_sched_sta(hapd, sta, next);
 	}
 
-	eloop_register_timeout(interval, 0, accounting_interim_update,
-			       hapd, sta);
+	if (window_full) {
+		sched->window_full++;
+		wpa_printf(MSG_DEBUG,
+			   "Accounting: %zu interim updates pending - delay remaining updates",
+			   pending);
+	}
+}
+
+
+static void accounting_sched_timer(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct accounting_sched *sched = hapd->acct_sched;
+	struct sta_info *sta, *n;
+	struct os_reltime now;
+	unsigned int i;
+	os_time_t t;
+
+	os_get_reltime(&now);
+
+	/* Process all slots since the previous run in case the event loop was
+	 * delayed; a single pass over the slots covers any longer delay. */
+	t = sched->last_slot;
+	for (i = 0; t < now.sec && i < ACCT_SCHED_SLOTS; i++) {
+		t++;
+		dl_list_for_each_safe(sta, n, &sched->slot[t % ACCT_SCHED_SLOTS],
+				      struct sta_info, acct_list) {
+			if (sta->acct_next_update > now.sec)
+				continue;
+			dl_list_del(&sta->acct_list);
+			dl_list_add_tail(&sched->ready, &sta->acct_list);
+		}
+	}
+	sched->last_slot = now.sec;
+
+	accounting_sched_run(hapd);
+
+	if (sched->num_sta)
+		eloop_register_timeout(1, 0, accounting_sched_timer, hapd,
+				       NULL);
+}
+
+
+static void accounting_sched_pending(void *eloop_ctx, void *timeout_ctx)
+{
+	accounting_sched_run(eloop_ctx);
+}
+
+
+static void accounting_sched_kick(struct hostapd_data *hapd)
+{
+	struct accounting_sched *sched = hapd->acct_sched;
+
+	if (sched && !dl_list_empty(&sched->ready) &&
+	    !eloop_is_timeout_registered(accounting_sched_pending, hapd, NULL))
+		eloop_register_timeout(0, 0, accounting_sched_pending, hapd,
+				       NULL);
 }
 
 
@@ -250,8 +469,16 @@ void accounting_sta_start(struct hostapd_data *hapd, struct sta_info *sta)
 		interval = sta->acct_interim_interval;
 	else
 		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
-	eloop_register_timeout(interval, 0, accounting_interim_update,
-			       hapd, sta);
+	if (accounting_sched_get(hapd)) {
+		os_time_t due;
+
+		due = sta->acct_session_start.sec + interval -
+			os_random() % (interval / ACCT_SCHED_JITTER_DIV + 1);
+		accounting_sched_sta(hapd, sta, due);
+	} else {
+		wpa_printf(MSG_INFO,
+			   "Could not schedule interim accounting updates");
+	}
 
 	msg = accounting_msg(hapd, sta, RADIUS_ACCT_STATUS_TYPE_START);
 	if (msg &&
@@ -290,7 +517,7 @@ static void accounting_sta_report(struct hostapd_data *hapd,
 		goto fail;
 	}
 
-	if (accounting_sta_update_stats(hapd, sta, &data) == 0) {
+	if (accounting_sta_update_stats(hapd, sta, &data, stop) == 0) {
 		if (!radius_msg_add_attr_int32(msg,
 					       RADIUS_ATTR_ACCT_INPUT_PACKETS,
 					       data.rx_packets)) {
@@ -382,7 +609,7 @@ void accounting_sta_stop(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	if (sta->acct_session_started) {
 		accounting_sta_report(hapd, sta, 1);
-		eloop_cancel_timeout(accounting_interim_update, hapd, sta);
+		accounting_sched_del(hapd, sta);
 		hostapd_logger(hapd, sta->addr, HOSTAPD_MODULE_RADIUS,
 			       HOSTAPD_LEVEL_INFO,
 			       "stopped accounting session %016llX",
@@ -423,6 +650,9 @@ accounting_receive(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_INVALID_AUTHENTICATOR;
 	}
 
+	/* The response may have opened room for delayed interim updates */
+	accounting_sched_kick(data);
+
 	return RADIUS_RX_PROCESSED;
 }
 
@@ -457,6 +687,28 @@ static void accounting_report_state(struct hostapd_data *hapd, int on)
 }
 
 
+/* Move the next update of the station earlier if it is not due within
+ * wait_time seconds. Returns 1 if rescheduled, 0 if not, -1 if the station is
+ * not in the schedule. */
+static int accounting_sched_deplete(struct hostapd_data *hapd,
+				    struct sta_info *sta,
+				    unsigned int wait_time)
+{
+	struct os_reltime now;
+
+	if (!hapd->acct_sched || !sta->acct_list.next)
+		return -1;
+
+	os_get_reltime(&now);
+	if (sta->acct_next_update <= now.sec + (os_time_t) wait_time)
+		return 0;
+
+	accounting_sched_sta(hapd, sta, now.sec + wait_time);
+	accounting_sched_kick(hapd);
+	return 1;
+}
+
+
 static void accounting_interim_error_cb(const u8 *addr, void *ctx)
 {
 	struct hostapd_data *hapd = ctx;
@@ -494,8 +746,7 @@ static void accounting_interim_error_cb(const u8 *addr, void *ctx)
 		for (i = 1; i < sta->acct_interim_errors; i++)
 			wait_time *= 2;
 	}
-	res = eloop_deplete_timeout(wait_time, 0, accounting_interim_update,
-				    hapd, sta);
+	res = accounting_sched_deplete(hapd, sta, wait_time);
 	if (res == 1)
 		wpa_printf(MSG_DEBUG,
 			   "Interim RADIUS accounting update failed for " MACSTR
@@ -543,5 +794,63 @@ int accounting_init(struct hostapd_data *hapd)
  */
 void accounting_deinit(struct hostapd_data *hapd)
 {
+	struct accounting_sched *sched = hapd->acct_sched;
+	struct sta_info *sta, *n;
+	unsigned int i;
+
 	accounting_report_state(hapd, 0);
+
+	if (!sched)
+		return;
+	for (i = 0; i < ACCT_SCHED_SLOTS; i++) {
+		dl_list_for_each_safe(sta, n, &sched->slot[i], struct sta_info,
+				      acct_list)
+			dl_list_del(&sta->acct_list);
+	}
+	dl_list_for_each_safe(sta, n, &sched->ready, struct sta_info,
+			      acct_list)
+		dl_list_del(&sta->acct_list);
+	eloop_cancel_timeout(accounting_sched_timer, hapd, NULL);
+	eloop_cancel_timeout(accounting_sched_pending, hapd, NULL);
+	os_free(sched);
+	hapd->acct_sched = NULL;
+}
+
+
+/**
+ * accounting_get_mib - Get interim accounting schedule statistics
+ * @hapd: hostapd BSS data
+ * @buf: Buffer for returning the text
+ * @buflen: Length of the buffer in octets
+ * Returns: Number of octets written to buf
+ */
+int accounting_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
+{
+	struct accounting_sched *sched = hapd->acct_sched;
+	int ret;
+
+	if (!sched)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "radiusAcctScheduledStations=%u\n"
+			  "radiusAcctInterimSent=%u\n"
+			  "radiusAcctInterimPending=%zu\n"
+			  "radiusAcctInterimWindowFull=%u\n"
+			  "radiusAcctStatsUpdates=%u\n"
+			  "radiusAcctBulkFetches=%u\n"
+			  "radiusAcctScheduleSkewAvgMs=%u\n"
+			  "radiusAcctScheduleSkewMaxMs=%u\n",
+			  sched->num_sta, sched->interim_sent,
+			  radius_client_num_pending(hapd->radius,
+						    RADIUS_ACCT_INTERIM),
+			  sched->window_full, sched->stats_updates,
+			  sched->bulk_fetches,
+			  sched->skew_count ?
+			  (unsigned int) (sched->skew_total_ms /
+					  sched->skew_count) : 0,
+			  sched->skew_max_ms);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
 }
@@ -70,14 +70,22 @@ static void set_new_backlog_time(struct hostapd_data *hapd,
 static void count_backlogged_sta(struct hostapd_data *hapd)
 {
 	struct sta_info *sta;
-	struct hostap_sta_driver_data data = {};
+	struct hostap_sta_driver_data data;
 	unsigned int num_backlogged = 0;
+	unsigned int max_age = hapd->iconf->airtime_update_interval;
 	struct os_reltime now;
 
+	/* Fetch the data for all stations with a single driver request if
+	 * possible; stations missing from it are queried separately. */
+	if (hapd->num_sta > 1)
+		hostapd_drv_read_all_sta_data(hapd, 0);
+
 	os_get_reltime(&now);
 
 	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (hostapd_drv_read_sta_data(hapd, &data, sta->addr))
+		os_memset(&data, 0, sizeof(data));
+		if (hostapd_drv_read_sta_data_cached(hapd, &data, sta->addr,
+						     max_age))
 			continue;
 #ifdef CONFIG_TESTING_OPTIONS
 		if (hapd->force_backlog_bytes)
@@ -65,6 +65,9 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->auth_algs = WPA_AUTH_ALG_OPEN;
 #endif /* CONFIG_WEP */
 	bss->eap_reauth_period = 3600;
+#ifdef CONFIG_STATS_SHM
+	bss->stats_shm_interval = 1000;
+#endif /* CONFIG_STATS_SHM */
 
 	bss->wpa_group_rekey = 600;
 	bss->wpa_gmk_rekey = 86400;
@@ -120,6 +123,9 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 #endif /* CONFIG_IEEE80211R_AP */
 
 	bss->radius_das_time_window = 300;
+	bss->radius_acl_cache_ttl = 30;
+	bss->radius_acl_negative_ttl = 30;
+	bss->radius_acct_interim_window = 16;
 
 	bss->anti_clogging_threshold = 5;
 	bss->sae_sync = 5;
@@ -749,6 +755,19 @@ static void hostapd_dpp_controller_conf_free(struct dpp_controller_conf *conf)
 #endif /* CONFIG_DPP2 */
 
 
+static void hostapd_config_free_params(struct hostapd_bss_config *conf)
+{
+	size_t i;
+
+	for (i = 0; i < conf->num_params; i++)
+		str_clear_free(conf->params[i]);
+	os_free(conf->params);
+	conf->params = NULL;
+	conf->num_params = 0;
+	conf->num_file_params = 0;
+}
+
+
 void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 {
 #if defined(CONFIG_WPS) || defined(CONFIG_HS20)
@@ -777,8 +796,8 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 
 	os_free(conf->eap_req_id_text);
 	os_free(conf->erp_domain);
-	os_free(conf->accept_mac);
-	os_free(conf->deny_mac);
+	mac_acl_clear(&conf->accept_mac);
+	mac_acl_clear(&conf->deny_mac);
 	os_free(conf->nas_identifier);
 	if (conf->radius) {
 		hostapd_config_free_radius(conf->radius->auth_servers,
@@ -792,6 +811,9 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->radius_req_attr_sqlite);
 	os_free(conf->rsn_preauth_interfaces);
 	os_free(conf->ctrl_interface);
+#ifdef CONFIG_STATS_SHM
+	os_free(conf->stats_shm);
+#endif /* CONFIG_STATS_SHM */
 	os_free(conf->ca_cert);
 	os_free(conf->server_cert);
 	os_free(conf->server_cert2);
@@ -800,6 +822,7 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->private_key_passwd);
 	os_free(conf->private_key_passwd2);
 	os_free(conf->check_cert_subject);
+	os_free(conf->tls_session_cache_file);
 	os_free(conf->ocsp_stapling_response);
 	os_free(conf->ocsp_stapling_response_multi);
 	os_free(conf->dh_file);
@@ -971,6 +994,8 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->pasn_groups);
 #endif /* CONFIG_PASN */
 
+	hostapd_config_free_params(conf);
+
 	os_free(conf);
 }
 
@@ -1006,37 +1031,26 @@ void hostapd_config_free(struct hostapd_config *conf)
 
 /**
  * hostapd_maclist_found - Find a MAC address from a list
- * @list: MAC address list
- * @num_entries: Number of addresses in the list
+ * @acl: MAC address list
  * @addr: Address to search for
  * @vlan_id: Buffer for returning VLAN ID or %NULL if not needed
  * Returns: 1 if address is in the list or 0 if not.
- *
- * Perform a binary search for given MAC address from a pre-sorted list.
  */
-int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
-			  const u8 *addr, struct vlan_description *vlan_id)
+int hostapd_maclist_found(const struct mac_acl *acl, const u8 *addr,
+			  struct vlan_description *vlan_id)
 {
-	int start, end, middle, res;
+	const struct mac_acl_entry *entry;
 
-	start = 0;
-	end = num_entries - 1;
+	entry = mac_acl_get(acl, addr);
+	if (!entry)
+		return 0;
 
-	while (start <= end) {
-		middle = (start + end) / 2;
-		res = os_memcmp(list[middle].addr, addr, ETH_ALEN);
-		if (res == 0) {
-			if (vlan_id)
-				*vlan_id = list[middle].vlan_id;
-			return 1;
-		}
-		if (res < 0)
-			start = middle + 1;
-		else
-			end = middle - 1;
+	if (vlan_id) {
+		os_memset(vlan_id, 0, sizeof(*vlan_id));
+		vlan_id->untagged = entry->vlan_id;
+		vlan_id->notempty = !!entry->vlan_id;
 	}
-
-	return 0;
+	return 1;
 }
 
 
@@ -1646,3 +1660,183 @@ bool hostapd_sae_pk_exclusively(struct hostapd_bss_config *conf)
 	return with_pk;
 }
 #endif /* CONFIG_SAE_PK */
+
+
+static int param_append(struct hostapd_bss_config *bss, const char *name,
+			const char *value)
+{
+	char **params, *param;
+	size_t len;
+	int res;
+
+	params = os_realloc_array(bss->params, bss->num_params + 1,
+				  sizeof(char *));
+	if (!params)
+		return -1;
+	bss->params = params;
+
+	len = os_strlen(name) + 1 + os_strlen(value) + 1;
+	param = os_malloc(len);
+	if (!param)
+		return -1;
+	res = os_snprintf(param, len, "%s=%s", name, value);
+	if (os_snprintf_error(len, res)) {
+		os_free(param);
+		return -1;
+	}
+	bss->params[bss->num_params++] = param;
+	return 0;
+}
+
+
+/**
+ * hostapd_config_add_param - Record a configuration file parameter
+ * @bss: BSS configuration
+ * @name: Parameter name
+ * @value: Parameter value
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is called for each parameter that has been successfully set from the
+ * configuration file so that the resulting configuration can later be
+ * compared with a reloaded one. This must not be used once parameters have
+ * been set at runtime.
+ */
+int hostapd_config_add_param(struct hostapd_bss_config *bss, const char *name,
+			     const char *value)
+{
+	if (param_append(bss, name, value) < 0)
+		return -1;
+	bss->num_file_params = bss->num_params;
+	return 0;
+}
+
+
+static size_t param_name_len(const char *param)
+{
+	const char *pos = os_strchr(param, '=');
+
+	return pos ? (size_t) (pos - param) : os_strlen(param);
+}
+
+
+static int param_name_match(const char *param, const char *name,
+			    size_t name_len)
+{
+	return param_name_len(param) == name_len &&
+		os_strncmp(param, name, name_len) == 0;
+}
+
+
+/* Returns the index of the first parameter with the given name at or after
+ * start, or num_params if there is none */
+static size_t param_find(const struct hostapd_bss_config *bss, size_t start,
+			 const char *name, size_t name_len)
+{
+	size_t i;
+
+	for (i = start; i < bss->num_params; i++) {
+		if (param_name_match(bss->params[i], name, name_len))
+			break;
+	}
+	return i;
+}
+
+
+/**
+ * hostapd_config_set_runtime_param - Record a parameter set at runtime
+ * @bss: BSS configuration
+ * @name: Parameter name
+ * @value: Parameter value
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is called for each parameter that has been successfully set through
+ * the control interface. A new value replaces the one recorded from an
+ * earlier runtime change of the same parameter. If the parameter is set back
+ * to the last value from the configuration file, the runtime record is
+ * removed so that the parameter is not reported as changed on reload.
+ */
+int hostapd_config_set_runtime_param(struct hostapd_bss_config *bss,
+				     const char *name, const char *value)
+{
+	size_t name_len = os_strlen(name);
+	size_t i, file;
+
+	i = param_find(bss, bss->num_file_params, name, name_len);
+	if (i < bss->num_params) {
+		str_clear_free(bss->params[i]);
+		os_memmove(&bss->params[i], &bss->params[i + 1],
+			   (bss->num_params - i - 1) * sizeof(char *));
+		bss->num_params--;
+	}
+
+	file = bss->num_file_params;
+	for (i = param_find(bss, 0, name, name_len); i < bss->num_file_params;
+	     i = param_find(bss, i + 1, name, name_len))
+		file = i;
+	if (file < bss->num_file_params &&
+	    os_strcmp(bss->params[file] + name_len + 1, value) == 0)
+		return 0;
+
+	return param_append(bss, name, value);
+}
+
+
+/* Compare the sequences of values the parameter was set to in a and b */
+static int param_values_differ(const struct hostapd_bss_config *a,
+			       const struct hostapd_bss_config *b,
+			       const char *name, size_t name_len)
+{
+	size_t i, j;
+
+	i = param_find(a, 0, name, name_len);
+	j = param_find(b, 0, name, name_len);
+	while (i < a->num_params && j < b->num_params) {
+		if (os_strcmp(a->params[i], b->params[j]) != 0)
+			return 1;
+		i = param_find(a, i + 1, name, name_len);
+		j = param_find(b, j + 1, name, name_len);
+	}
+	return i < a->num_params || j < b->num_params;
+}
+
+
+/**
+ * hostapd_config_diff_params - Find parameters that differ between configs
+ * @a: BSS configuration
+ * @b: BSS configuration
+ * @cb: Callback function to call for each differing parameter
+ * @ctx: Context data for the callback
+ *
+ * The parameters recorded with hostapd_config_add_param() are compared by
+ * name. A parameter is reported once if it was set to a different sequence of
+ * values (including being set in only one of the configurations). Since
+ * changes made through the control interface are recorded as well, a
+ * parameter that was modified at runtime is reported even if the
+ * configuration file did not change.
+ */
+void hostapd_config_diff_params(const struct hostapd_bss_config *a,
+				const struct hostapd_bss_config *b,
+				void (*cb)(void *ctx, const char *name,
+					   size_t name_len),
+				void *ctx)
+{
+	size_t i, len;
+	const char *name;
+
+	for (i = 0; i < a->num_params; i++) {
+		name = a->params[i];
+		len = param_name_len(name);
+		if (param_find(a, 0, name, len) != i)
+			continue; /* already compared */
+		if (param_values_differ(a, b, name, len))
+			cb(ctx, name, len);
+	}
+
+	for (i = 0; i < b->num_params; i++) {
+		name = b->params[i];
+		len = param_name_len(name);
+		if (param_find(b, 0, name, len) == i &&
+		    param_find(a, 0, name, len) == a->num_params)
+			cb(ctx, name, len);
+	}
+}
@@ -19,6 +19,7 @@
 #include "wps/wps.h"
 #include "fst/fst.h"
 #include "vlan.h"
+#include "mac_acl.h"
 
 /**
  * mesh_conf - local MBSS state and settings
@@ -59,11 +60,6 @@ struct mesh_conf {
 
 typedef u8 macaddr[ETH_ALEN];
 
-struct mac_acl_entry {
-	macaddr addr;
-	struct vlan_description vlan_id;
-};
-
 struct hostapd_radius_servers;
 struct ft_remote_r0kh;
 struct ft_remote_r1kh;
@@ -290,6 +286,11 @@ struct hostapd_bss_config {
 	unsigned int bss_load_update_period;
 	unsigned int chan_util_avg_period;
 
+#ifdef CONFIG_STATS_SHM
+	char *stats_shm; /* file for the shared memory statistics region */
+	unsigned int stats_shm_interval; /* update interval in ms */
+#endif /* CONFIG_STATS_SHM */
+
 	int ieee802_1x; /* use IEEE 802.1X */
 	int eapol_version;
 	int eap_server; /* Use internal EAP server instead of external
@@ -303,6 +304,7 @@ struct hostapd_bss_config {
 	char *nas_identifier;
 	struct hostapd_radius_servers *radius;
 	int acct_interim_interval;
+	int radius_acct_interim_window;
 	int radius_request_cui;
 	struct hostapd_radius_attr *radius_auth_req_attr;
 	struct hostapd_radius_attr *radius_acct_req_attr;
@@ -337,10 +339,11 @@ struct hostapd_bss_config {
 		DENY_UNLESS_ACCEPTED = 1,
 		USE_EXTERNAL_RADIUS_AUTH = 2
 	} macaddr_acl;
-	struct mac_acl_entry *accept_mac;
-	int num_accept_mac;
-	struct mac_acl_entry *deny_mac;
-	int num_deny_mac;
+	struct mac_acl accept_mac;
+	struct mac_acl deny_mac;
+	int radius_acl_cache_ttl;
+	int radius_acl_negative_ttl;
+	int radius_acl_prefetch;
 	int wds_sta;
 	int isolate;
 	int start_disabled;
@@ -418,6 +421,7 @@ struct hostapd_bss_config {
 	int check_crl_strict;
 	unsigned int crl_reload_interval;
 	unsigned int tls_session_lifetime;
+	char *tls_session_cache_file;
 	unsigned int tls_flags;
 	unsigned int max_auth_rounds;
 	unsigned int max_auth_rounds_short;
@@ -600,6 +604,7 @@ struct hostapd_bss_config {
 	int osen;
 	int proxy_arp;
 	int na_mcast_to_ucast;
+	int ndisc_mcast_targeted;
 
 #ifdef CONFIG_HS20
 	int hs20;
@@ -905,6 +910,17 @@ struct hostapd_bss_config {
 	u8 ext_capa[EXT_CAPA_MAX_LEN];
 
 	u8 rnr;
+
+	/*
+	 * Configuration parameters ("name=value") in the order they were set
+	 * from the configuration file or the control interface; used to find
+	 * the changed parameters when the configuration is reloaded. The first
+	 * num_file_params entries are from the configuration file and the
+	 * following ones from the control interface (at most one per name).
+	 */
+	char **params;
+	size_t num_params;
+	size_t num_file_params;
 };
 
 /**
@@ -1181,8 +1197,8 @@ void hostapd_config_free_eap_users(struct hostapd_eap_user *user);
 void hostapd_config_clear_wpa_psk(struct hostapd_wpa_psk **p);
 void hostapd_config_free_bss(struct hostapd_bss_config *conf);
 void hostapd_config_free(struct hostapd_config *conf);
-int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
-			  const u8 *addr, struct vlan_description *vlan_id);
+int hostapd_maclist_found(const struct mac_acl *acl, const u8 *addr,
+			  struct vlan_description *vlan_id);
 int hostapd_rate_found(int *list, int rate);
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *p2p_dev_addr,
@@ -1202,5 +1218,14 @@ int hostapd_sae_pw_id_in_use(struct hostapd_bss_config *conf);
 bool hostapd_sae_pk_in_use(struct hostapd_bss_config *conf);
 bool hostapd_sae_pk_exclusively(struct hostapd_bss_config *conf);
 int hostapd_setup_sae_pt(struct hostapd_bss_config *conf);
+int hostapd_config_add_param(struct hostapd_bss_config *bss, const char *name,
+			     const char *value);
+int hostapd_config_set_runtime_param(struct hostapd_bss_config *bss,
+				     const char *name, const char *value);
+void hostapd_config_diff_params(const struct hostapd_bss_config *a,
+				const struct hostapd_bss_config *b,
+				void (*cb)(void *ctx, const char *name,
+					   size_t name_len),
+				void *ctx);
 
 #endif /* HOSTAPD_CONFIG_H */
@@ -276,6 +276,8 @@ int hostapd_set_authorized(struct hostapd_data *hapd,
 int hostapd_set_sta_flags(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	int set_flags, total_flags, flags_and, flags_or;
+
+	ap_sta_mark_changed(hapd, sta);
 	total_flags = hostapd_sta_flags_to_drv(sta->flags);
 	set_flags = WPA_STA_SHORT_PREAMBLE | WPA_STA_WMM | WPA_STA_MFP;
 	if (((!hapd->conf->ieee802_1x && !hapd->conf->wpa) ||
@@ -420,10 +422,20 @@ int hostapd_sta_add(struct hostapd_data *hapd,
 		    size_t he_capab_len,
 		    const struct ieee80211_he_6ghz_band_cap *he_6ghz_capab,
 		    u32 flags, u8 qosinfo, u8 vht_opmode, int supp_p2p_ps,
-		    int set)
+		    int set, int remove_old)
 {
 	struct hostapd_sta_add_params params;
 
+	/*
+	 * Drivers that can replace the STA entry as part of sta_add() save a
+	 * separate round trip for removing the old entry.
+	 */
+	if (remove_old && (set || !(hapd->iface->drv_flags2 &
+				    WPA_DRIVER_FLAGS2_STA_ADD_REMOVE_OLD))) {
+		hostapd_drv_sta_remove(hapd, addr);
+		remove_old = 0;
+	}
+
 	if (hapd->driver == NULL)
 		return 0;
 	if (hapd->driver->sta_add == NULL)
@@ -447,6 +459,7 @@ int hostapd_sta_add(struct hostapd_data *hapd,
 	params.qosinfo = qosinfo;
 	params.support_p2p_ps = supp_p2p_ps;
 	params.set = set;
+	params.remove_old = remove_old;
 	return hapd->driver->sta_add(hapd->drv_priv, &params);
 }
 
@@ -997,3 +1010,134 @@ int hostapd_drv_dpp_listen(struct hostapd_data *hapd, bool enable)
 		return 0;
 	return hapd->driver->dpp_listen(hapd->drv_priv, enable);
 }
+
+
+static int sta_data_entry_cmp(const void *a, const void *b)
+{
+	const struct hostap_sta_data_entry *ea = a, *eb = b;
+
+	return os_memcmp(ea->addr, eb->addr, ETH_ALEN);
+}
+
+
+/**
+ * hostapd_drv_sta_data_age - Get the age of the cached station data
+ * @hapd: Pointer to BSS data
+ * Returns: Milliseconds since the data was fetched with
+ *	hostapd_drv_read_all_sta_data() or -1 if no data is available
+ */
+int hostapd_drv_sta_data_age(struct hostapd_data *hapd)
+{
+	struct os_reltime now;
+	u64 age_ms;
+
+	if (!os_reltime_initialized(&hapd->sta_data_time))
+		return -1;
+
+	/* os_time_t is unsigned, so do not use os_reltime_sub() here */
+	os_get_reltime(&now);
+	age_ms = (now.sec * 1000000ULL + now.usec -
+		  (hapd->sta_data_time.sec * 1000000ULL +
+		   hapd->sta_data_time.usec)) / 1000;
+	return age_ms > 0x7fffffff ? 0x7fffffff : (int) age_ms;
+}
+
+
+static bool sta_data_fresh(struct hostapd_data *hapd, unsigned int max_age_ms)
+{
+	int age = hostapd_drv_sta_data_age(hapd);
+
+	return age >= 0 && (unsigned int) age <= max_age_ms;
+}
+
+
+/**
+ * hostapd_drv_read_all_sta_data - Fetch driver data for all stations
+ * @hapd: Pointer to BSS data
+ * @max_age_ms: Do not refresh data that is at most this old (0 = always
+ *	refresh)
+ * Returns: 0 on success, -1 on failure or if the driver does not support this
+ *
+ * The data is stored in hapd->sta_data for lookups with
+ * hostapd_drv_read_sta_data_cached().
+ */
+int hostapd_drv_read_all_sta_data(struct hostapd_data *hapd,
+				  unsigned int max_age_ms)
+{
+	struct hostap_sta_data_list *list = &hapd->sta_data;
+
+	if (max_age_ms && sta_data_fresh(hapd, max_age_ms))
+		return 0;
+
+	list->num = 0;
+	os_memset(&hapd->sta_data_time, 0, sizeof(hapd->sta_data_time));
+	if (!hapd->driver || !hapd->driver->read_all_sta_data ||
+	    !hapd->drv_priv)
+		return -1;
+	if (hapd->driver->read_all_sta_data(hapd->drv_priv, list) < 0) {
+		list->num = 0;
+		return -1;
+	}
+
+	qsort(list->entries, list->num, sizeof(list->entries[0]),
+	      sta_data_entry_cmp);
+	os_get_reltime(&hapd->sta_data_time);
+	return 0;
+}
+
+
+/**
+ * hostapd_drv_sta_data_lookup - Find a station in the cached driver data
+ * @hapd: Pointer to BSS data
+ * @data: Buffer for returning station information
+ * @addr: MAC address of the station
+ * @max_age_ms: Maximum age of data from hostapd_drv_read_all_sta_data()
+ * Returns: 0 on success, -1 if the station is not included in recent enough
+ *	data
+ *
+ * Unlike hostapd_drv_read_sta_data_cached(), this never requests the data
+ * from the driver.
+ */
+int hostapd_drv_sta_data_lookup(struct hostapd_data *hapd,
+				struct hostap_sta_driver_data *data,
+				const u8 *addr, unsigned int max_age_ms)
+{
+	struct hostap_sta_data_list *list = &hapd->sta_data;
+	const struct hostap_sta_data_entry *entry;
+	struct hostap_sta_data_entry key;
+
+	if (!list->num || !sta_data_fresh(hapd, max_age_ms))
+		return -1;
+
+	os_memcpy(key.addr, addr, ETH_ALEN);
+	entry = bsearch(&key, list->entries, list->num,
+			sizeof(list->entries[0]), sta_data_entry_cmp);
+	if (!entry)
+		return -1;
+	os_memcpy(data, &entry->data, sizeof(*data));
+	return 0;
+}
+
+
+/**
+ * hostapd_drv_read_sta_data_cached - Fetch driver data for a station
+ * @hapd: Pointer to BSS data
+ * @data: Buffer for returning station information
+ * @addr: MAC address of the station
+ * @max_age_ms: Maximum age of data from hostapd_drv_read_all_sta_data()
+ * Returns: 0 on success, -1 on failure
+ *
+ * The station data is returned from the latest
+ * hostapd_drv_read_all_sta_data() call if that is recent enough and includes
+ * the station. Otherwise, the data is fetched from the driver for this
+ * station only.
+ */
+int hostapd_drv_read_sta_data_cached(struct hostapd_data *hapd,
+				     struct hostap_sta_driver_data *data,
+				     const u8 *addr, unsigned int max_age_ms)
+{
+	if (hostapd_drv_sta_data_lookup(hapd, data, addr, max_age_ms) == 0)
+		return 0;
+
+	return hostapd_drv_read_sta_data(hapd, data, addr);
+}
@@ -45,7 +45,7 @@ int hostapd_sta_add(struct hostapd_data *hapd,
 		    size_t he_capab_len,
 		    const struct ieee80211_he_6ghz_band_cap *he_6ghz_capab,
 		    u32 flags, u8 qosinfo, u8 vht_opmode, int supp_p2p_ps,
-		    int set);
+		    int set, int remove_old);
 int hostapd_set_privacy(struct hostapd_data *hapd, int enabled);
 int hostapd_set_generic_elem(struct hostapd_data *hapd, const u8 *elem,
 			     size_t elem_len);
@@ -135,6 +135,15 @@ int hostapd_drv_do_acs(struct hostapd_data *hapd);
 int hostapd_drv_update_dh_ie(struct hostapd_data *hapd, const u8 *peer,
 			     u16 reason_code, const u8 *ie, size_t ielen);
 int hostapd_drv_dpp_listen(struct hostapd_data *hapd, bool enable);
+int hostapd_drv_read_all_sta_data(struct hostapd_data *hapd,
+				  unsigned int max_age_ms);
+int hostapd_drv_sta_data_age(struct hostapd_data *hapd);
+int hostapd_drv_sta_data_lookup(struct hostapd_data *hapd,
+				struct hostap_sta_driver_data *data,
+				const u8 *addr, unsigned int max_age_ms);
+int hostapd_drv_read_sta_data_cached(struct hostapd_data *hapd,
+				     struct hostap_sta_driver_data *data,
+				     const u8 *addr, unsigned int max_age_ms);
 
 
 #include "drivers/driver.h"
@@ -167,6 +176,23 @@ static inline int hostapd_drv_set_sta_vlan(const char *ifname,
 					  vlan_id);
 }
 
+static inline int hostapd_drv_sta_batch_start(struct hostapd_data *hapd,
+					      const u8 *addr)
+{
+	if (!hapd->driver || !hapd->driver->sta_batch_start ||
+	    !hapd->drv_priv)
+		return -1;
+	return hapd->driver->sta_batch_start(hapd->drv_priv, addr);
+}
+
+static inline int hostapd_drv_sta_batch_commit(struct hostapd_data *hapd)
+{
+	if (!hapd->driver || !hapd->driver->sta_batch_commit ||
+	    !hapd->drv_priv)
+		return -1;
+	return hapd->driver->sta_batch_commit(hapd->drv_priv);
+}
+
 static inline int hostapd_drv_get_inact_sec(struct hostapd_data *hapd,
 					    const u8 *addr)
 {
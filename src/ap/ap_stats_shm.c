@@ -0,0 +1,194 @@
+/*
+ * hostapd / Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "common/stats_shm.h"
+#include "radius/radius_client.h"
+#include "hostapd.h"
+#include "ap_config.h"
+#include "ap_drv_ops.h"
+#include "sta_info.h"
+#include "ap_stats_shm.h"
+
+
+#ifndef CONFIG_NO_RADIUS
+static void stats_shm_radius(struct stats_shm_radius *rec,
+			     const struct hostapd_radius_server *srv)
+{
+	os_memset(rec, 0, sizeof(*rec));
+	if (!srv)
+		return;
+
+	rec->valid = 1;
+	rec->port = srv->port;
+	if (srv->addr.af == AF_INET) {
+		rec->af = 4;
+		os_memcpy(rec->addr, &srv->addr.u.v4, 4);
+#ifdef CONFIG_IPV6
+	} else if (srv->addr.af == AF_INET6) {
+		rec->af = 6;
+		os_memcpy(rec->addr, &srv->addr.u.v6, 16);
+#endif /* CONFIG_IPV6 */
+	}
+	rec->requests = srv->requests;
+	rec->retransmissions = srv->retransmissions;
+	rec->access_accepts = srv->access_accepts;
+	rec->access_rejects = srv->access_rejects;
+	rec->access_challenges = srv->access_challenges;
+	rec->responses = srv->responses;
+	rec->malformed_responses = srv->malformed_responses;
+	rec->bad_authenticators = srv->bad_authenticators;
+	rec->timeouts = srv->timeouts;
+	rec->unknown_types = srv->unknown_types;
+	rec->packets_dropped = srv->packets_dropped;
+	rec->round_trip_time = srv->round_trip_time;
+}
+#endif /* CONFIG_NO_RADIUS */
+
+
+static void stats_shm_sta(struct hostapd_data *hapd, struct stats_shm_ap *ap,
+			  struct stats_shm_sta *rec, struct sta_info *sta,
+			  unsigned int max_age_ms)
+{
+	struct hostap_sta_driver_data data;
+	struct os_reltime age;
+
+	os_memset(rec, 0, sizeof(*rec));
+	os_memcpy(rec->addr, sta->addr, ETH_ALEN);
+	rec->aid = sta->aid;
+	rec->flags = sta->flags;
+	if (sta->connected_time.sec) {
+		os_reltime_age(&sta->connected_time, &age);
+		rec->connected_sec = age.sec;
+	}
+
+	/* Stations that are not in the snapshot (e.g., added after it was
+	 * taken) are exported without driver data */
+	os_memset(&data, 0, sizeof(data));
+	if (hostapd_drv_sta_data_lookup(hapd, &data, sta->addr,
+					max_age_ms) < 0)
+		return;
+
+	rec->info |= STATS_SHM_STA_DRV_DATA;
+	rec->rx_bytes = data.rx_bytes;
+	rec->tx_bytes = data.tx_bytes;
+	rec->rx_packets = data.rx_packets;
+	rec->tx_packets = data.tx_packets;
+	if (data.flags & STA_DRV_DATA_CONN_TIME)
+		rec->connected_sec = data.connected_sec;
+	rec->inactive_msec = data.inactive_msec;
+	rec->tx_rate = data.current_tx_rate;
+	rec->rx_rate = data.current_rx_rate;
+	rec->tx_retry_failed = data.tx_retry_failed;
+	rec->signal = data.signal;
+
+	ap->rx_bytes += data.rx_bytes;
+	ap->tx_bytes += data.tx_bytes;
+	ap->rx_packets += data.rx_packets;
+	ap->tx_packets += data.tx_packets;
+}
+
+
+static void hostapd_stats_shm_update(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct hostapd_bss_config *conf = hapd->conf;
+	unsigned int interval = conf->stats_shm_interval;
+	struct stats_shm *shm = hapd->stats_shm;
+	struct stats_shm_ap *ap;
+	struct stats_shm_sta *rec;
+	struct sta_info *sta;
+	unsigned int num = 0;
+	int age;
+
+	/* Fetch the driver data for all stations with a single request. The
+	 * stations are not queried individually, so that an update does not
+	 * block for a round trip per station. */
+	hostapd_drv_read_all_sta_data(hapd, interval);
+	age = hostapd_drv_sta_data_age(hapd);
+
+	stats_shm_write_begin(shm);
+
+	ap = stats_shm_data(shm);
+	os_memset(ap, 0, sizeof(*ap));
+	os_strlcpy(ap->ifname, conf->iface, sizeof(ap->ifname));
+	os_memcpy(ap->bssid, hapd->own_addr, ETH_ALEN);
+	ap->ssid_len = conf->ssid.ssid_len;
+	os_memcpy(ap->ssid, conf->ssid.ssid, conf->ssid.ssid_len);
+	ap->state = hapd->iface->state;
+	ap->freq = hapd->iface->freq;
+	ap->channel = hapd->iconf->channel;
+	ap->num_sta = hapd->num_sta;
+	ap->max_num_sta = conf->max_num_sta;
+	ap->drv_data_age_ms = age < 0 ? STATS_SHM_AGE_UNKNOWN : (u32) age;
+#ifndef CONFIG_NO_RADIUS
+	if (conf->radius) {
+		stats_shm_radius(&ap->radius_auth, conf->radius->auth_server);
+		stats_shm_radius(&ap->radius_acct, conf->radius->acct_server);
+	}
+#endif /* CONFIG_NO_RADIUS */
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (sta->flags & WLAN_STA_AUTHORIZED)
+			ap->num_sta_authorized++;
+		rec = stats_shm_rec(shm, num);
+		if (!rec)
+			continue;
+		stats_shm_sta(hapd, ap, rec, sta, interval);
+		num++;
+	}
+
+	stats_shm_write_end(shm, num);
+
+	eloop_register_timeout(interval / 1000, (interval % 1000) * 1000,
+			       hostapd_stats_shm_update, hapd, NULL);
+}
+
+
+/**
+ * hostapd_stats_shm_init - Start exporting statistics for a BSS
+ * @hapd: Pointer to BSS data
+ * Returns: 0 on success, -1 on failure
+ *
+ * The region is created if stats_shm is set in the BSS configuration and it
+ * is then refreshed every stats_shm_interval milliseconds.
+ */
+int hostapd_stats_shm_init(struct hostapd_data *hapd)
+{
+	struct hostapd_bss_config *conf = hapd->conf;
+
+	if (!conf->stats_shm || hapd->stats_shm)
+		return 0;
+
+	hapd->stats_shm = stats_shm_create(conf->stats_shm, STATS_SHM_TYPE_AP,
+					   sizeof(struct stats_shm_ap),
+					   sizeof(struct stats_shm_sta),
+					   conf->max_num_sta,
+					   conf->stats_shm_interval);
+	if (!hapd->stats_shm) {
+		wpa_printf(MSG_ERROR,
+			   "Could not create shared memory statistics file %s",
+			   conf->stats_shm);
+		return -1;
+	}
+
+	hostapd_stats_shm_update(hapd, NULL);
+	return 0;
+}
+
+
+void hostapd_stats_shm_deinit(struct hostapd_data *hapd)
+{
+	if (!hapd->stats_shm)
+		return;
+	eloop_cancel_timeout(hostapd_stats_shm_update, hapd, NULL);
+	stats_shm_destroy(hapd->stats_shm);
+	hapd->stats_shm = NULL;
+}
@@ -0,0 +1,29 @@
+/*
+ * hostapd / Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef AP_STATS_SHM_H
+#define AP_STATS_SHM_H
+
+#ifdef CONFIG_STATS_SHM
+
+int hostapd_stats_shm_init(struct hostapd_data *hapd);
+void hostapd_stats_shm_deinit(struct hostapd_data *hapd);
+
+#else /* CONFIG_STATS_SHM */
+
+static inline int hostapd_stats_shm_init(struct hostapd_data *hapd)
+{
+	return 0;
+}
+
+static inline void hostapd_stats_shm_deinit(struct hostapd_data *hapd)
+{
+}
+
+#endif /* CONFIG_STATS_SHM */
+
+#endif /* AP_STATS_SHM_H */
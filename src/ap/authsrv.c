@@ -9,6 +9,7 @@
 #include "utils/includes.h"
 
 #include "utils/common.h"
+#include "utils/eloop.h"
 #include "crypto/tls.h"
 #include "eap_server/eap.h"
 #include "eap_server/eap_sim_db.h"
@@ -227,6 +228,20 @@ static struct eap_config * authsrv_eap_config(struct hostapd_data *hapd)
 }
 
 
+#ifdef EAP_TLS_FUNCS
+static void authsrv_crl_reload_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+
+	if (tls_global_crl_reload(hapd->ssl_ctx) < 0)
+		wpa_printf(MSG_INFO,
+			   "CRL reload failed - continue using the previous certificate store");
+	eloop_register_timeout(hapd->conf->crl_reload_interval, 0,
+			       authsrv_crl_reload_timeout, hapd, NULL);
+}
+#endif /* EAP_TLS_FUNCS */
+
+
 int authsrv_init(struct hostapd_data *hapd)
 {
 #ifdef EAP_TLS_FUNCS
@@ -239,6 +254,7 @@ int authsrv_init(struct hostapd_data *hapd)
 
 		os_memset(&conf, 0, sizeof(conf));
 		conf.tls_session_lifetime = hapd->conf->tls_session_lifetime;
+		conf.session_cache_file = hapd->conf->tls_session_cache_file;
 		if (hapd->conf->crl_reload_interval > 0 &&
 		    hapd->conf->check_crl <= 0) {
 			wpa_printf(MSG_INFO,
@@ -289,6 +305,14 @@ int authsrv_init(struct hostapd_data *hapd)
 			authsrv_deinit(hapd);
 			return -1;
 		}
+
+		/* Reload CRLs from the event loop instead of during
+		 * tls_connection_init() so that handshakes are not delayed. */
+		if (hapd->conf->crl_reload_interval > 0 &&
+		    hapd->conf->check_crl > 0)
+			eloop_register_timeout(hapd->conf->crl_reload_interval,
+					       0, authsrv_crl_reload_timeout,
+					       hapd, NULL);
 	}
 #endif /* EAP_TLS_FUNCS */
 
@@ -333,6 +357,7 @@ void authsrv_deinit(struct hostapd_data *hapd)
 #endif /* RADIUS_SERVER */
 
 #ifdef EAP_TLS_FUNCS
+	eloop_cancel_timeout(authsrv_crl_reload_timeout, hapd, NULL);
 	if (hapd->ssl_ctx) {
 		tls_deinit(hapd->ssl_ctx);
 		hapd->ssl_ctx = NULL;
@@ -274,6 +274,17 @@ static int hostapd_ctrl_iface_sta_mib(struct hostapd_data *hapd,
 
 	len += hostapd_get_sta_info(hapd, sta, buf + len, buflen - len);
 
+#ifdef CONFIG_MESH
+	if (sta->my_lid) {
+		res = os_snprintf(buf + len, buflen - len,
+				  "plink_state=%d\nmy_lid=0x%x\npeer_lid=0x%x\n",
+				  sta->plink_state, sta->my_lid,
+				  sta->peer_lid);
+		if (!os_snprintf_error(buflen - len, res))
+			len += res;
+	}
+#endif /* CONFIG_MESH */
+
 #ifdef CONFIG_SAE
 	if (sta->sae && sta->sae->state == SAE_ACCEPTED) {
 		res = os_snprintf(buf + len, buflen - len, "sae_group=%d\n",
@@ -385,6 +396,11 @@ static int hostapd_ctrl_iface_sta_mib(struct hostapd_data *hapd,
 			len += ret;
 	}
 
+	ret = os_snprintf(buf + len, buflen - len, "mem_usage=%zu\n",
+			  ap_sta_mem_usage(sta));
+	if (!os_snprintf_error(buflen - len, ret))
+		len += ret;
+
 	return len;
 }
 
@@ -460,6 +476,514 @@ int hostapd_ctrl_iface_sta_next(struct hostapd_data *hapd, const char *txtaddr,
 }
 
 
+/* Fields that can be selected for STA-DUMP */
+#define STA_DUMP_FLAGS		BIT(0)
+#define STA_DUMP_AID		BIT(1)
+#define STA_DUMP_CAPAB		BIT(2)
+#define STA_DUMP_LISTEN_INT	BIT(3)
+#define STA_DUMP_VLAN_ID	BIT(4)
+#define STA_DUMP_KEYID		BIT(5)
+#define STA_DUMP_CONN_TIME	BIT(6)
+#define STA_DUMP_GEN		BIT(7)
+#define STA_DUMP_PACKETS	BIT(8)
+#define STA_DUMP_BYTES		BIT(9)
+#define STA_DUMP_INACTIVE	BIT(10)
+#define STA_DUMP_SIGNAL		BIT(11)
+#define STA_DUMP_RATES		BIT(12)
+#define STA_DUMP_MEM		BIT(13)
+
+#define STA_DUMP_DRV_DATA (STA_DUMP_PACKETS | STA_DUMP_BYTES | \
+			   STA_DUMP_INACTIVE | STA_DUMP_SIGNAL | \
+			   STA_DUMP_RATES)
+#define STA_DUMP_DEFAULT (STA_DUMP_FLAGS | STA_DUMP_AID | STA_DUMP_VLAN_ID | \
+			  STA_DUMP_CONN_TIME)
+
+/* Space reserved in front of and after the STA-DUMP body */
+#define STA_DUMP_HDR_LEN 160
+#define STA_DUMP_TRAILER_LEN 4
+#define STA_DUMP_DEFAULT_MAX 256
+/* Driver data for all stations is fetched once and reused for the following
+ * pages of the same dump if they are requested within this time */
+#define STA_DUMP_DRV_DATA_MAX_AGE_MS 1000
+
+static const struct {
+	const char *name;
+	unsigned int field;
+} sta_dump_fields[] = {
+	{ "flags", STA_DUMP_FLAGS },
+	{ "aid", STA_DUMP_AID },
+	{ "capability", STA_DUMP_CAPAB },
+	{ "listen_interval", STA_DUMP_LISTEN_INT },
+	{ "vlan_id", STA_DUMP_VLAN_ID },
+	{ "keyid", STA_DUMP_KEYID },
+	{ "connected_time", STA_DUMP_CONN_TIME },
+	{ "gen", STA_DUMP_GEN },
+	{ "packets", STA_DUMP_PACKETS },
+	{ "bytes", STA_DUMP_BYTES },
+	{ "inactive_msec", STA_DUMP_INACTIVE },
+	{ "signal", STA_DUMP_SIGNAL },
+	{ "rates", STA_DUMP_RATES },
+	{ "mem_usage", STA_DUMP_MEM },
+	{ "all", ~0U },
+};
+
+
+static int sta_dump_parse_fields(const char *pos, unsigned int *fields)
+{
+	const char *end;
+	size_t i, len;
+
+	*fields = 0;
+	while (*pos && *pos != ' ') {
+		end = pos;
+		while (*end && *end != ',' && *end != ' ')
+			end++;
+		len = end - pos;
+		for (i = 0; i < ARRAY_SIZE(sta_dump_fields); i++) {
+			if (os_strlen(sta_dump_fields[i].name) == len &&
+			    os_strncmp(sta_dump_fields[i].name, pos, len) == 0)
+				break;
+		}
+		if (i == ARRAY_SIZE(sta_dump_fields)) {
+			wpa_printf(MSG_DEBUG, "CTRL: Unknown STA-DUMP field '%.*s'",
+				   (int) len, pos);
+			return -1;
+		}
+		*fields |= sta_dump_fields[i].field;
+		pos = end;
+		if (*pos == ',')
+			pos++;
+	}
+
+	return *fields ? 0 : -1;
+}
+
+
+static int sta_dump_token_eq(const char *pos, size_t len, const char *str)
+{
+	return os_strlen(str) == len && os_strncmp(pos, str, len) == 0;
+}
+
+
+static int sta_dump_parse_uint(const char *pos, const char *end,
+			       unsigned int *val)
+{
+	unsigned long res;
+	char *tmp;
+
+	if (pos == end || *pos < '0' || *pos > '9')
+		return -1;
+	res = strtoul(pos, &tmp, 10);
+	if (tmp != end || res != (unsigned int) res)
+		return -1;
+	*val = res;
+	return 0;
+}
+
+
+/* Find the sta_list position of the most recently removed station addr */
+static int sta_dump_removed_seq(struct hostapd_data *hapd, const u8 *addr,
+				unsigned int *list_seq)
+{
+	struct sta_removed_entry *e, *found = NULL;
+	unsigned int i;
+
+	for (i = 0; i < STA_REMOVED_TRACK; i++) {
+		e = &hapd->sta_removed[i];
+		if (e->gen && os_memcmp(e->addr, addr, ETH_ALEN) == 0 &&
+		    (!found || e->gen > found->gen))
+			found = e;
+	}
+	if (!found)
+		return -1;
+	*list_seq = found->list_seq;
+	return 0;
+}
+
+
+static int sta_dump_add(char *buf, size_t buflen, size_t *len, int json,
+			const char *name, const char *val, int quote)
+{
+	int ret;
+
+	if (json)
+		ret = os_snprintf(buf + *len, buflen - *len, ",\"%s\":%s%s%s",
+				  name, quote ? "\"" : "", val,
+				  quote ? "\"" : "");
+	else
+		ret = os_snprintf(buf + *len, buflen - *len, " %s=%s",
+				  name, val);
+	if (os_snprintf_error(buflen - *len, ret))
+		return -1;
+	*len += ret;
+	return 0;
+}
+
+
+static int hostapd_ctrl_iface_sta_dump_entry(struct hostapd_data *hapd,
+					     struct sta_info *sta,
+					     unsigned int fields, int json,
+					     int first, char *buf,
+					     size_t buflen)
+{
+	struct hostap_sta_driver_data data;
+	int have_data = 0;
+	const char *keyid;
+	char val[100];
+	size_t len = 0;
+	int ret;
+
+	if ((fields & STA_DUMP_DRV_DATA) &&
+	    hostapd_drv_read_sta_data_cached(hapd, &data, sta->addr,
+					     STA_DUMP_DRV_DATA_MAX_AGE_MS) == 0)
+		have_data = 1;
+
+	if (json)
+		ret = os_snprintf(buf, buflen, "%s{\"addr\":\"" MACSTR "\"",
+				  first ? "" : ",", MAC2STR(sta->addr));
+	else
+		ret = os_snprintf(buf, buflen, "addr=" MACSTR,
+				  MAC2STR(sta->addr));
+	if (os_snprintf_error(buflen, ret))
+		return -1;
+	len = ret;
+
+	if (fields & STA_DUMP_FLAGS) {
+		if (ap_sta_flags_txt(sta->flags, val, sizeof(val)) < 0 ||
+		    sta_dump_add(buf, buflen, &len, json, "flags", val, 1) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_AID) {
+		os_snprintf(val, sizeof(val), "%u", sta->aid);
+		if (sta_dump_add(buf, buflen, &len, json, "aid", val, 0) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_CAPAB) {
+		os_snprintf(val, sizeof(val), "%u", sta->capability);
+		if (sta_dump_add(buf, buflen, &len, json, "capability", val,
+				 0) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_LISTEN_INT) {
+		os_snprintf(val, sizeof(val), "%u", sta->listen_interval);
+		if (sta_dump_add(buf, buflen, &len, json, "listen_interval",
+				 val, 0) < 0)
+			return -1;
+	}
+
+	if ((fields & STA_DUMP_VLAN_ID) && sta->vlan_id > 0) {
+		os_snprintf(val, sizeof(val), "%d", sta->vlan_id);
+		if (sta_dump_add(buf, buflen, &len, json, "vlan_id", val,
+				 0) < 0)
+			return -1;
+	}
+
+	keyid = (fields & STA_DUMP_KEYID) ? ap_sta_wpa_get_keyid(hapd, sta) :
+		NULL;
+	if (keyid) {
+		printf_encode(val, sizeof(val), (const u8 *) keyid,
+			      os_strlen(keyid));
+		if (sta_dump_add(buf, buflen, &len, json, "keyid", val, 1) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_CONN_TIME) {
+		struct os_reltime age;
+		int have_time = 1;
+
+		if (sta->connected_time.sec) {
+			os_reltime_age(&sta->connected_time, &age);
+			os_snprintf(val, sizeof(val), "%lu",
+				    (unsigned long) age.sec);
+		} else if (have_data &&
+			   (data.flags & STA_DRV_DATA_CONN_TIME)) {
+			os_snprintf(val, sizeof(val), "%lu",
+				    data.connected_sec);
+		} else {
+			have_time = 0;
+		}
+		if (have_time &&
+		    sta_dump_add(buf, buflen, &len, json, "connected_time",
+				 val, 0) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_GEN) {
+		os_snprintf(val, sizeof(val), "%u", sta->change_gen);
+		if (sta_dump_add(buf, buflen, &len, json, "gen", val, 0) < 0)
+			return -1;
+	}
+
+	if (have_data && (fields & STA_DUMP_PACKETS)) {
+		os_snprintf(val, sizeof(val), "%lu", data.rx_packets);
+		if (sta_dump_add(buf, buflen, &len, json, "rx_packets", val,
+				 0) < 0)
+			return -1;
+		os_snprintf(val, sizeof(val), "%lu", data.tx_packets);
+		if (sta_dump_add(buf, buflen, &len, json, "tx_packets", val,
+				 0) < 0)
+			return -1;
+	}
+
+	if (have_data && (fields & STA_DUMP_BYTES)) {
+		os_snprintf(val, sizeof(val), "%llu", data.rx_bytes);
+		if (sta_dump_add(buf, buflen, &len, json, "rx_bytes", val,
+				 0) < 0)
+			return -1;
+		os_snprintf(val, sizeof(val), "%llu", data.tx_bytes);
+		if (sta_dump_add(buf, buflen, &len, json, "tx_bytes", val,
+				 0) < 0)
+			return -1;
+	}
+
+	if (have_data && (fields & STA_DUMP_INACTIVE)) {
+		os_snprintf(val, sizeof(val), "%lu", data.inactive_msec);
+		if (sta_dump_add(buf, buflen, &len, json, "inactive_msec", val,
+				 0) < 0)
+			return -1;
+	}
+
+	if (have_data && (fields & STA_DUMP_SIGNAL)) {
+		os_snprintf(val, sizeof(val), "%d", data.signal);
+		if (sta_dump_add(buf, buflen, &len, json, "signal", val, 0) < 0)
+			return -1;
+	}
+
+	if (have_data && (fields & STA_DUMP_RATES)) {
+		os_snprintf(val, sizeof(val), "%lu", data.current_rx_rate);
+		if (sta_dump_add(buf, buflen, &len, json, "rx_rate_info", val,
+				 0) < 0)
+			return -1;
+		os_snprintf(val, sizeof(val), "%lu", data.current_tx_rate);
+		if (sta_dump_add(buf, buflen, &len, json, "tx_rate_info", val,
+				 0) < 0)
+			return -1;
+	}
+
+	if (fields & STA_DUMP_MEM) {
+		os_snprintf(val, sizeof(val), "%zu", ap_sta_mem_usage(sta));
+		if (sta_dump_add(buf, buflen, &len, json, "mem_usage", val,
+				 0) < 0)
+			return -1;
+	}
+
+	ret = os_snprintf(buf + len, buflen - len, json ? "}" : "\n");
+	if (os_snprintf_error(buflen - len, ret))
+		return -1;
+	len += ret;
+
+	return len;
+}
+
+
+/**
+ * hostapd_ctrl_iface_sta_dump - Dump information for multiple stations
+ * @hapd: Pointer to BSS data
+ * @cmd: Command parameters
+ * @buf: Buffer for the reply
+ * @buflen: Length of buf in octets
+ * Returns: Number of octets written to buf or -1 on failure
+ *
+ * The command parameters are optional and space separated:
+ * after=<addr> continues a dump after the station that was reported as next
+ * in the previous reply, max=<count> limits the number of stations in the
+ * reply, fields=<name>[,<name>..] selects the reported station fields,
+ * format=json selects JSON encoding instead of one key=value line per station,
+ * and since=<gen> limits the reply to the stations that have changed (or were
+ * removed) after the gen value reported in an earlier reply. If the requested
+ * generation is too old to be tracked, resync=1 is indicated and all stations
+ * are reported. If the after=<addr> station has been removed since the
+ * previous reply, the dump continues from the station that followed it. If
+ * that position is no longer known, resync=1 is indicated and the dump starts
+ * from the beginning. bufsize=<octets> is handled by the control interface.
+ */
+int hostapd_ctrl_iface_sta_dump(struct hostapd_data *hapd, const char *cmd,
+				char *buf, size_t buflen)
+{
+	struct sta_info *sta, *last = NULL;
+	unsigned int fields = STA_DUMP_DEFAULT;
+	unsigned int since = 0, max_sta = STA_DUMP_DEFAULT_MAX, count = 0;
+	int json = 0, more = 0, resync = 0, first_page = 1;
+	char hdr[STA_DUMP_HDR_LEN], next[30];
+	char *body;
+	size_t body_len = 0, body_size;
+	const char *pos, *end;
+	size_t name_len;
+	u8 addr[ETH_ALEN];
+	int after = 0;
+	unsigned int i;
+	int ret, hlen;
+
+	if (buflen < STA_DUMP_HDR_LEN + STA_DUMP_TRAILER_LEN + 100)
+		return -1;
+
+	for (pos = cmd; *pos; pos = end) {
+		const char *val;
+
+		while (*pos == ' ')
+			pos++;
+		if (!*pos)
+			break;
+		end = os_strchr(pos, ' ');
+		if (!end)
+			end = pos + os_strlen(pos);
+		val = os_strchr(pos, '=');
+		if (!val || val >= end)
+			return -1;
+		name_len = val - pos;
+		val++;
+
+		if (sta_dump_token_eq(pos, name_len, "format")) {
+			if (sta_dump_token_eq(val, end - val, "json"))
+				json = 1;
+			else if (sta_dump_token_eq(val, end - val, "kv"))
+				json = 0;
+			else
+				return -1;
+		} else if (sta_dump_token_eq(pos, name_len, "fields")) {
+			if (sta_dump_parse_fields(val, &fields) < 0)
+				return -1;
+		} else if (sta_dump_token_eq(pos, name_len, "max")) {
+			if (sta_dump_parse_uint(val, end, &max_sta) < 0 ||
+			    max_sta == 0)
+				return -1;
+		} else if (sta_dump_token_eq(pos, name_len, "since")) {
+			if (sta_dump_parse_uint(val, end, &since) < 0)
+				return -1;
+		} else if (sta_dump_token_eq(pos, name_len, "after")) {
+			if (end - val != 17 || hwaddr_aton(val, addr))
+				return -1;
+			after = 1;
+		} else if (!sta_dump_token_eq(pos, name_len, "bufsize")) {
+			wpa_printf(MSG_DEBUG,
+				   "CTRL: Unknown STA-DUMP parameter '%.*s'",
+				   (int) (end - pos), pos);
+			return -1;
+		}
+	}
+
+	if (since > hapd->sta_change_gen ||
+	    (since && since < hapd->sta_removed_lost)) {
+		resync = 1;
+		since = 0;
+	}
+
+	sta = hapd->sta_list;
+	if (after) {
+		struct sta_info *prev = ap_get_sta(hapd, addr);
+		unsigned int list_seq;
+
+		first_page = 0;
+		if (prev) {
+			sta = prev->next;
+		} else if (sta_dump_removed_seq(hapd, addr, &list_seq) == 0) {
+			/* sta_list is ordered from the newest to the oldest */
+			while (sta && sta->list_seq > list_seq)
+				sta = sta->next;
+		} else {
+			wpa_printf(MSG_DEBUG,
+				   "CTRL: STA-DUMP position after " MACSTR
+				   " not known - restart", MAC2STR(addr));
+			resync = 1;
+			since = 0;
+			first_page = 1;
+		}
+	}
+
+	body = buf + STA_DUMP_HDR_LEN;
+	body_size = buflen - STA_DUMP_HDR_LEN - STA_DUMP_TRAILER_LEN;
+
+	if ((fields & STA_DUMP_DRV_DATA) && hapd->num_sta > 1)
+		hostapd_drv_read_all_sta_data(hapd,
+					      first_page ? 0 :
+					      STA_DUMP_DRV_DATA_MAX_AGE_MS);
+
+	/* Removed stations are reported only on the first page of a delta */
+	for (i = 0; since && first_page && i < STA_REMOVED_TRACK; i++) {
+		struct sta_removed_entry *e = &hapd->sta_removed[i];
+
+		if (e->gen <= since || ap_get_sta(hapd, e->addr))
+			continue;
+		if (json)
+			ret = os_snprintf(body + body_len, body_size - body_len,
+					  "%s\"" MACSTR "\"",
+					  body_len ? "," : "",
+					  MAC2STR(e->addr));
+		else
+			ret = os_snprintf(body + body_len, body_size - body_len,
+					  "addr=" MACSTR " removed=1\n",
+					  MAC2STR(e->addr));
+		if (os_snprintf_error(body_size - body_len, ret))
+			return -1;
+		body_len += ret;
+	}
+
+	if (json) {
+		ret = os_snprintf(body + body_len, body_size - body_len,
+				  "],\"stations\":[");
+		if (os_snprintf_error(body_size - body_len, ret))
+			return -1;
+		body_len += ret;
+	}
+
+	for (; sta; sta = sta->next) {
+		if (since && sta->change_gen <= since)
+			continue;
+		if (count == max_sta) {
+			more = 1;
+			break;
+		}
+		ret = hostapd_ctrl_iface_sta_dump_entry(hapd, sta, fields, json,
+							count == 0,
+							body + body_len,
+							body_size - body_len);
+		if (ret < 0) {
+			if (count == 0)
+				return -1;
+			more = 1;
+			break;
+		}
+		body_len += ret;
+		count++;
+		last = sta;
+	}
+
+	if (more && last)
+		os_snprintf(next, sizeof(next), MACSTR, MAC2STR(last->addr));
+	else
+		next[0] = '\0';
+
+	if (json)
+		hlen = os_snprintf(hdr, sizeof(hdr),
+				   "{\"gen\":%u,\"count\":%u,\"more\":%s,"
+				   "\"resync\":%s%s%s%s,\"removed\":[",
+				   hapd->sta_change_gen, count,
+				   more ? "true" : "false",
+				   resync ? "true" : "false",
+				   next[0] ? ",\"next\":\"" : "", next,
+				   next[0] ? "\"" : "");
+	else
+		hlen = os_snprintf(hdr, sizeof(hdr),
+				   "gen=%u count=%u more=%d resync=%d%s%s\n",
+				   hapd->sta_change_gen, count, more, resync,
+				   next[0] ? " next=" : "", next);
+	if (os_snprintf_error(sizeof(hdr), hlen))
+		return -1;
+
+	os_memcpy(buf, hdr, hlen);
+	os_memmove(buf + hlen, body, body_len);
+	if (json) {
+		os_memcpy(buf + hlen + body_len, "]}\n", 3);
+		body_len += 3;
+	}
+
+	return hlen + body_len;
+}
+
+
 #ifdef CONFIG_P2P_MANAGER
 static int p2p_manager_disconnect(struct hostapd_data *hapd, u16 stype,
 				  u8 minor_reason_code, const u8 *addr)
@@ -880,6 +1404,19 @@ int hostapd_ctrl_iface_status(struct hostapd_data *hapd, char *buf,
 		len += ret;
 	}
 
+#ifdef CONFIG_PROXYARP
+	if (hapd->conf->proxy_arp) {
+		ret = os_snprintf(buf + len, buflen - len,
+				  "mcast_to_ucast_converted=%u\n"
+				  "mcast_to_ucast_suppressed=%u\n",
+				  hapd->mcast_to_ucast_converted,
+				  hapd->mcast_to_ucast_suppressed);
+		if (os_snprintf_error(buflen - len, ret))
+			return len;
+		len += ret;
+	}
+#endif /* CONFIG_PROXYARP */
+
 	return len;
 }
 
@@ -124,7 +124,8 @@ int hostapd_dpp_nfc_handover_req(struct hostapd_data *hapd, const char *cmd)
 		return -1;
 	}
 
-	if (dpp_nfc_update_bi(own_bi, peer_bi) < 0)
+	if (dpp_nfc_update_bi(hapd->iface->interfaces->dpp, own_bi,
+			      peer_bi) < 0)
 		return -1;
 
 	return peer_bi->id;
@@ -2716,6 +2717,12 @@ int hostapd_dpp_controller_start(struct hostapd_data *hapd, const char *cmd)
 			config.tcp_port = atoi(pos);
 		}
 
+		pos = os_strstr(cmd, " tcp_backlog=");
+		if (pos) {
+			pos += 13;
+			config.tcp_backlog = atoi(pos);
+		}
+
 		pos = os_strstr(cmd, " role=");
 		if (pos) {
 			pos += 6;
@@ -473,7 +473,7 @@ int hostapd_notif_assoc(struct hostapd_data *hapd, const u8 *addr,
 #ifdef CONFIG_WPS
 		struct wpabuf *wps;
 
-		if (req_ies)
+		if (elems.wps_ie)
 			wps = ieee802_11_vendor_ie_concat(req_ies, req_ies_len,
 							  WPS_IE_VENDOR_TYPE);
 		else
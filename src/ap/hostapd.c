@@ -32,6 +32,7 @@
 #include "ieee802_1x.h"
 #include "ieee802_11_auth.h"
 #include "vlan_init.h"
+#include "vlan.h"
 #include "wpa_auth.h"
 #include "wps_hostapd.h"
 #include "dpp_hostapd.h"
@@ -45,6 +46,7 @@
 #include "dfs.h"
 #include "ieee802_11.h"
 #include "bss_load.h"
+#include "ap_stats_shm.h"
 #include "x_snoop.h"
 #include "dhcp_snoop.h"
 #include "ndisc_snoop.h"
@@ -63,6 +65,7 @@ static int hostapd_setup_encryption(char *iface, struct hostapd_data *hapd);
 static int hostapd_broadcast_wep_clear(struct hostapd_data *hapd);
 #endif /* CONFIG_WEP */
 static int setup_interface2(struct hostapd_iface *iface);
+static void hostapd_set_acl(struct hostapd_data *hapd);
 static void channel_list_update_timeout(void *eloop_ctx, void *timeout_ctx);
 static void hostapd_interface_setup_failure_handler(void *eloop_ctx,
 						    void *timeout_ctx);
@@ -210,11 +213,521 @@ static int hostapd_iface_conf_changed(struct hostapd_config *newconf,
 }
 
 
+/**
+ * hostapd_disassoc_accept_mac - Disconnect STAs not in the accept list
+ * @hapd: Pointer to BSS data
+ * Returns: Number of disconnected STAs
+ */
+int hostapd_disassoc_accept_mac(struct hostapd_data *hapd)
+{
+	struct sta_info *sta;
+	struct vlan_description vlan_id;
+	int count = 0;
+
+	if (hapd->conf->macaddr_acl != DENY_UNLESS_ACCEPTED)
+		return 0;
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (!hostapd_maclist_found(&hapd->conf->accept_mac, sta->addr,
+					   &vlan_id) ||
+		    (vlan_id.notempty &&
+		     vlan_compare(&vlan_id, sta->vlan_desc))) {
+			ap_sta_disconnect(hapd, sta, sta->addr,
+					  WLAN_REASON_UNSPECIFIED);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+/**
+ * hostapd_disassoc_deny_mac - Disconnect STAs that are in the deny list
+ * @hapd: Pointer to BSS data
+ * Returns: Number of disconnected STAs
+ */
+int hostapd_disassoc_deny_mac(struct hostapd_data *hapd)
+{
+	struct sta_info *sta;
+	struct vlan_description vlan_id;
+	int count = 0;
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (hostapd_maclist_found(&hapd->conf->deny_mac, sta->addr,
+					  &vlan_id) &&
+		    (!vlan_id.notempty ||
+		     !vlan_compare(&vlan_id, sta->vlan_desc))) {
+			ap_sta_disconnect(hapd, sta, sta->addr,
+					  WLAN_REASON_UNSPECIFIED);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+static int hostapd_kick_mismatch_psk_sta_iter(struct hostapd_data *hapd,
+					      struct sta_info *sta, void *ctx)
+{
+	int *count = ctx;
+	struct hostapd_wpa_psk *psk;
+	struct hostapd_sta_wpa_psk_short *sta_psk;
+	const u8 *pmk;
+	int pmk_len;
+	int pmk_match;
+	int sta_match;
+	int bss_match;
+	int reason;
+
+	/* Only STAs that used a PSK or passphrase are affected; SAE does not
+	 * derive the PMK from the PSK */
+	if (!wpa_key_mgmt_wpa_psk_no_sae(wpa_auth_sta_key_mgmt(sta->wpa_sm)))
+		return 0;
+
+	pmk = wpa_auth_get_pmk(sta->wpa_sm, &pmk_len);
+
+	for (psk = hapd->conf->ssid.wpa_psk; pmk && psk; psk = psk->next) {
+		pmk_match = PMK_LEN == pmk_len &&
+			os_memcmp(psk->psk, pmk, pmk_len) == 0;
+		sta_match = psk->group == 0 &&
+			os_memcmp(sta->addr, psk->addr, ETH_ALEN) == 0;
+		bss_match = psk->group == 1;
+
+		if (pmk_match && (sta_match || bss_match))
+			return 0;
+	}
+
+	/* A PSK from RADIUS (wpa_psk_radius) does not depend on the BSS
+	 * configuration */
+	for (sta_psk = sta->psk; pmk && sta_psk; sta_psk = sta_psk->next) {
+		if (!sta_psk->is_passphrase && PMK_LEN == pmk_len &&
+		    os_memcmp(sta_psk->psk, pmk, pmk_len) == 0)
+			return 0;
+	}
+
+	wpa_printf(MSG_INFO, "STA " MACSTR
+		   " PSK/passphrase no longer valid - disconnect",
+		   MAC2STR(sta->addr));
+	reason = WLAN_REASON_PREV_AUTH_NOT_VALID;
+	hostapd_drv_sta_deauth(hapd, sta->addr, reason);
+	ap_sta_deauthenticate(hapd, sta, reason);
+	(*count)++;
+
+	return 0;
+}
+
+
+/**
+ * hostapd_kick_mismatch_psk_sta - Disconnect STAs with no longer valid PSK
+ * @hapd: Pointer to BSS data
+ * Returns: Number of disconnected STAs
+ *
+ * This is used after the PSKs or the passphrase of the BSS have been changed.
+ */
+int hostapd_kick_mismatch_psk_sta(struct hostapd_data *hapd)
+{
+	int count = 0;
+
+	ap_for_each_sta(hapd, hostapd_kick_mismatch_psk_sta_iter, &count);
+	return count;
+}
+
+
+/* Whether the PSK lists (including the PSKs derived from the passphrase and
+ * the ones read from wpa_psk_file) differ */
+static bool hostapd_wpa_psk_changed(const struct hostapd_wpa_psk *a,
+				    const struct hostapd_wpa_psk *b)
+{
+	for (; a && b; a = a->next, b = b->next) {
+		if (a->group != b->group || a->wps != b->wps ||
+		    a->vlan_id != b->vlan_id ||
+		    os_strcmp(a->keyid, b->keyid) != 0 ||
+		    os_memcmp(a->psk, b->psk, PMK_LEN) != 0 ||
+		    os_memcmp(a->addr, b->addr, ETH_ALEN) != 0 ||
+		    os_memcmp(a->p2p_dev_addr, b->p2p_dev_addr, ETH_ALEN) != 0)
+			return true;
+	}
+
+	return a || b;
+}
+
+
+static void hostapd_swap_wpa_psk(struct hostapd_ssid *a,
+				 struct hostapd_ssid *b)
+{
+	struct hostapd_ssid tmp;
+
+	tmp.wpa_psk = a->wpa_psk;
+	tmp.wpa_passphrase = a->wpa_passphrase;
+	tmp.wpa_psk_file = a->wpa_psk_file;
+	tmp.wpa_passphrase_set = a->wpa_passphrase_set;
+	tmp.wpa_psk_set = a->wpa_psk_set;
+	a->wpa_psk = b->wpa_psk;
+	a->wpa_passphrase = b->wpa_passphrase;
+	a->wpa_psk_file = b->wpa_psk_file;
+	a->wpa_passphrase_set = b->wpa_passphrase_set;
+	a->wpa_psk_set = b->wpa_psk_set;
+	b->wpa_psk = tmp.wpa_psk;
+	b->wpa_passphrase = tmp.wpa_passphrase;
+	b->wpa_psk_file = tmp.wpa_psk_file;
+	b->wpa_passphrase_set = tmp.wpa_passphrase_set;
+	b->wpa_psk_set = tmp.wpa_psk_set;
+}
+
+
+#ifdef CONFIG_SAE
+
+static int hostapd_kick_sae_sta_iter(struct hostapd_data *hapd,
+				     struct sta_info *sta, void *ctx)
+{
+	int *count = ctx;
+	int reason;
+
+	if (!wpa_key_mgmt_sae(wpa_auth_sta_key_mgmt(sta->wpa_sm)))
+		return 0;
+
+	wpa_printf(MSG_INFO, "STA " MACSTR
+		   " SAE password no longer valid - disconnect",
+		   MAC2STR(sta->addr));
+	wpa_auth_pmksa_remove(hapd->wpa_auth, sta->addr);
+	reason = WLAN_REASON_PREV_AUTH_NOT_VALID;
+	hostapd_drv_sta_deauth(hapd, sta->addr, reason);
+	ap_sta_deauthenticate(hapd, sta, reason);
+	(*count)++;
+
+	return 0;
+}
+
+
+static bool hostapd_str_changed(const char *a, const char *b)
+{
+	if (!a || !b)
+		return a != b;
+	return os_strcmp(a, b) != 0;
+}
+
+
+/* Whether the passwords SAE authentication uses differ between the two
+ * configurations */
+static bool hostapd_sae_passwords_changed(struct hostapd_bss_config *a,
+					  struct hostapd_bss_config *b)
+{
+	struct sae_password_entry *pa, *pb;
+
+	if (hostapd_str_changed(a->ssid.wpa_passphrase,
+				b->ssid.wpa_passphrase))
+		return true;
+
+	for (pa = a->sae_passwords, pb = b->sae_passwords; pa && pb;
+	     pa = pa->next, pb = pb->next) {
+		if (hostapd_str_changed(pa->password, pb->password) ||
+		    hostapd_str_changed(pa->identifier, pb->identifier) ||
+		    os_memcmp(pa->peer_addr, pb->peer_addr, ETH_ALEN) != 0 ||
+		    pa->vlan_id != pb->vlan_id)
+			return true;
+	}
+
+	return pa || pb;
+}
+
+#endif /* CONFIG_SAE */
+
+
+#define HOSTAPD_LIVE_ACL BIT(0)
+#define HOSTAPD_LIVE_PSK BIT(1)
+#define HOSTAPD_LIVE_RADIUS BIT(2)
+#define HOSTAPD_LIVE_LIMIT BIT(3)
+#define HOSTAPD_LIVE_BEACON BIT(4)
+#define HOSTAPD_LIVE_EAP_USER BIT(5)
+#define HOSTAPD_LIVE_SAE BIT(6)
+
+/* Parameters that refer to files are applied on each reload since the file
+ * contents may have changed even if the parameters did not */
+#define HOSTAPD_LIVE_FILES \
+	(HOSTAPD_LIVE_ACL | HOSTAPD_LIVE_PSK | HOSTAPD_LIVE_EAP_USER)
+
+/*
+ * Parameters that can be changed on configuration reload without flushing
+ * all associated STAs. Changes to any other parameter (including parameters
+ * that are not recognized here) use the full reconfiguration.
+ */
+static const struct hostapd_live_param {
+	const char *name;
+	unsigned int type;
+} hostapd_live_params[] = {
+	{ "macaddr_acl", HOSTAPD_LIVE_ACL },
+	{ "accept_mac_file", HOSTAPD_LIVE_ACL },
+	{ "deny_mac_file", HOSTAPD_LIVE_ACL },
+	{ "wpa_passphrase", HOSTAPD_LIVE_PSK | HOSTAPD_LIVE_SAE },
+	{ "wpa_psk", HOSTAPD_LIVE_PSK },
+	{ "wpa_psk_file", HOSTAPD_LIVE_PSK },
+	{ "sae_password", HOSTAPD_LIVE_SAE },
+	{ "eap_user_file", HOSTAPD_LIVE_EAP_USER },
+	{ "auth_server_addr", HOSTAPD_LIVE_RADIUS },
+	{ "auth_server_addr_replace", HOSTAPD_LIVE_RADIUS },
+	{ "auth_server_port", HOSTAPD_LIVE_RADIUS },
+	{ "auth_server_shared_secret", HOSTAPD_LIVE_RADIUS },
+	{ "acct_server_addr", HOSTAPD_LIVE_RADIUS },
+	{ "acct_server_addr_replace", HOSTAPD_LIVE_RADIUS },
+	{ "acct_server_port", HOSTAPD_LIVE_RADIUS },
+	{ "acct_server_shared_secret", HOSTAPD_LIVE_RADIUS },
+	{ "radius_retry_primary_interval", HOSTAPD_LIVE_RADIUS },
+	{ "max_num_sta", HOSTAPD_LIVE_LIMIT },
+	{ "max_listen_interval", HOSTAPD_LIVE_LIMIT },
+	{ "ap_max_inactivity", HOSTAPD_LIVE_LIMIT | HOSTAPD_LIVE_BEACON },
+	{ "radius_acct_interim_interval", HOSTAPD_LIVE_LIMIT },
+	{ "radius_acct_interim_window", HOSTAPD_LIVE_LIMIT },
+	{ "radius_acl_cache_ttl", HOSTAPD_LIVE_LIMIT },
+	{ "radius_acl_negative_ttl", HOSTAPD_LIVE_LIMIT },
+	{ "radius_acl_prefetch", HOSTAPD_LIVE_LIMIT },
+	{ "vendor_elements", HOSTAPD_LIVE_BEACON },
+	{ "assocresp_elements", HOSTAPD_LIVE_BEACON },
+	{ NULL, 0 }
+};
+
+
+struct hostapd_reload_diff {
+	struct hostapd_reload_status *status;
+	unsigned int live; /* HOSTAPD_LIVE_* types of changed parameters */
+	bool restart; /* a parameter that cannot be applied live changed */
+};
+
+
+static void hostapd_reload_add_name(char *buf, size_t buflen,
+				    const char *name, size_t name_len)
+{
+	const char *pos, *end;
+	size_t len;
+	int res;
+
+	for (pos = buf; *pos; pos = *end ? end + 1 : end) {
+		end = os_strchr(pos, ' ');
+		if (!end)
+			end = pos + os_strlen(pos);
+		if ((size_t) (end - pos) == name_len &&
+		    os_strncmp(pos, name, name_len) == 0)
+			return;
+	}
+
+	len = os_strlen(buf);
+	res = os_snprintf(buf + len, buflen - len, "%s%.*s", len ? " " : "",
+			  (int) name_len, name);
+	if (os_snprintf_error(buflen - len, res))
+		buf[len] = '\0'; /* leave out names that do not fit */
+}
+
+
+static void hostapd_reload_diff_cb(void *ctx, const char *name,
+				   size_t name_len)
+{
+	struct hostapd_reload_diff *diff = ctx;
+	struct hostapd_reload_status *status = diff->status;
+	const struct hostapd_live_param *param;
+
+	for (param = hostapd_live_params; param->name; param++) {
+		if (os_strlen(param->name) == name_len &&
+		    os_strncmp(param->name, name, name_len) == 0)
+			break;
+	}
+
+	if (param->name) {
+		diff->live |= param->type;
+		hostapd_reload_add_name(status->applied,
+					sizeof(status->applied),
+					name, name_len);
+	} else {
+		diff->restart = true;
+		hostapd_reload_add_name(status->restart,
+					sizeof(status->restart),
+					name, name_len);
+	}
+}
+
+
+/*
+ * Compare the running configuration (including changes made through the
+ * control interface) with the reloaded one. Returns true if all changes can
+ * be applied without flushing the STAs; the types of live changes of each BSS
+ * are stored in live[].
+ */
+static bool hostapd_reload_classify(struct hostapd_iface *iface,
+				    struct hostapd_config *newconf,
+				    unsigned int *live)
+{
+	struct hostapd_reload_diff diff;
+	size_t j;
+
+	os_memset(&diff, 0, sizeof(diff));
+	diff.status = &iface->reload;
+
+	for (j = 0; j < iface->num_bss; j++) {
+		diff.live = 0;
+		hostapd_config_diff_params(iface->bss[j]->conf,
+					   newconf->bss[j],
+					   hostapd_reload_diff_cb, &diff);
+		live[j] = diff.live;
+		if (!iface->bss[j]->started)
+			diff.restart = true;
+	}
+
+	return !diff.restart;
+}
+
+
+/*
+ * Move the changed parameters from the reloaded configuration into the running
+ * one and disconnect the STAs that the new values do not allow anymore. The
+ * previous values are freed together with the reloaded configuration.
+ */
+static unsigned int hostapd_reload_bss_live(struct hostapd_data *hapd,
+					    struct hostapd_bss_config *conf,
+					    unsigned int live)
+{
+	struct hostapd_bss_config *cur = hapd->conf;
+	unsigned int disconnected = 0;
+	char **params;
+	size_t num_params;
+
+	if (live & HOSTAPD_LIVE_ACL) {
+		enum macaddr_acl macaddr_acl = cur->macaddr_acl;
+		struct mac_acl acl;
+
+		cur->macaddr_acl = conf->macaddr_acl;
+		conf->macaddr_acl = macaddr_acl;
+		acl = cur->accept_mac;
+		cur->accept_mac = conf->accept_mac;
+		conf->accept_mac = acl;
+		acl = cur->deny_mac;
+		cur->deny_mac = conf->deny_mac;
+		conf->deny_mac = acl;
+
+		/* The driver uses the ACL of the first BSS for the interface */
+		if (hapd == hapd->iface->bss[0])
+			hostapd_set_acl(hapd);
+
+		disconnected += hostapd_disassoc_deny_mac(hapd);
+		disconnected += hostapd_disassoc_accept_mac(hapd);
+	}
+
+	if (live & HOSTAPD_LIVE_PSK) {
+		hostapd_swap_wpa_psk(&cur->ssid, &conf->ssid);
+
+		if (hostapd_setup_wpa_psk(cur)) {
+			/* Keep using the previous PSKs; the partially set up
+			 * new ones are freed with the reloaded configuration */
+			wpa_printf(MSG_ERROR,
+				   "Failed to re-configure WPA PSK after reloading configuration - keep the previous PSKs");
+			hostapd_swap_wpa_psk(&cur->ssid, &conf->ssid);
+			if (hostapd_setup_sae_pt(cur) < 0)
+				wpa_printf(MSG_ERROR,
+					   "Failed to restore SAE password element");
+		} else if (hostapd_wpa_psk_changed(cur->ssid.wpa_psk,
+						   conf->ssid.wpa_psk)) {
+			disconnected += hostapd_kick_mismatch_psk_sta(hapd);
+		}
+	}
+
+#ifdef CONFIG_SAE
+	if ((live & HOSTAPD_LIVE_SAE) &&
+	    hostapd_sae_passwords_changed(cur, conf)) {
+		struct sae_password_entry *pw = cur->sae_passwords;
+		int count = 0;
+
+		cur->sae_passwords = conf->sae_passwords;
+		conf->sae_passwords = pw;
+
+		if (hostapd_setup_sae_pt(cur) < 0)
+			wpa_printf(MSG_ERROR,
+				   "Failed to re-configure SAE password after reloading configuration");
+		ap_for_each_sta(hapd, hostapd_kick_sae_sta_iter, &count);
+		disconnected += count;
+	}
+#endif /* CONFIG_SAE */
+
+	if (live & HOSTAPD_LIVE_EAP_USER) {
+		struct hostapd_eap_user *user = cur->eap_user;
+
+		cur->eap_user = conf->eap_user;
+		conf->eap_user = user;
+	}
+
+#ifndef CONFIG_NO_RADIUS
+	if (live & HOSTAPD_LIVE_RADIUS) {
+		struct hostapd_radius_servers *radius = cur->radius;
+
+		cur->radius = conf->radius;
+		conf->radius = radius;
+		radius_client_reconfig(hapd->radius, cur->radius);
+	}
+#endif /* CONFIG_NO_RADIUS */
+
+	if (live & HOSTAPD_LIVE_LIMIT) {
+		cur->max_num_sta = conf->max_num_sta;
+		cur->max_listen_interval = conf->max_listen_interval;
+		cur->ap_max_inactivity = conf->ap_max_inactivity;
+		cur->acct_interim_interval = conf->acct_interim_interval;
+		cur->radius_acct_interim_window =
+			conf->radius_acct_interim_window;
+		cur->radius_acl_cache_ttl = conf->radius_acl_cache_ttl;
+		cur->radius_acl_negative_ttl = conf->radius_acl_negative_ttl;
+		cur->radius_acl_prefetch = conf->radius_acl_prefetch;
+	}
+
+	if (live & HOSTAPD_LIVE_BEACON) {
+		struct wpabuf *buf;
+
+		buf = cur->vendor_elements;
+		cur->vendor_elements = conf->vendor_elements;
+		conf->vendor_elements = buf;
+		buf = cur->assocresp_elements;
+		cur->assocresp_elements = conf->assocresp_elements;
+		conf->assocresp_elements = buf;
+		ieee802_11_set_beacon(hapd);
+	}
+
+	/* The running configuration now matches the reloaded one */
+	params = cur->params;
+	num_params = cur->num_params;
+	cur->params = conf->params;
+	cur->num_params = conf->num_params;
+	conf->params = params;
+	conf->num_params = num_params;
+	num_params = cur->num_file_params;
+	cur->num_file_params = conf->num_file_params;
+	conf->num_file_params = num_params;
+
+	return disconnected;
+}
+
+
+const char * hostapd_reload_mode_txt(enum hostapd_reload_mode mode)
+{
+	switch (mode) {
+	case HOSTAPD_RELOAD_NONE:
+		return "NONE";
+	case HOSTAPD_RELOAD_UNCHANGED:
+		return "UNCHANGED";
+	case HOSTAPD_RELOAD_LIVE:
+		return "LIVE";
+	case HOSTAPD_RELOAD_RESTART:
+		return "RESTART";
+	case HOSTAPD_RELOAD_FULL:
+		return "FULL";
+	}
+
+	return "UNKNOWN";
+}
+
+
 int hostapd_reload_config(struct hostapd_iface *iface)
 {
 	struct hapd_interfaces *interfaces = iface->interfaces;
 	struct hostapd_data *hapd = iface->bss[0];
 	struct hostapd_config *newconf, *oldconf;
+	struct hostapd_reload_status *status = &iface->reload;
+	unsigned int *live;
 	size_t j;
 
 	if (iface->config_fname == NULL) {
@@ -232,13 +745,19 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 	if (newconf == NULL)
 		return -1;
 
-	hostapd_clear_old(iface);
+	status->count++;
+	os_get_reltime(&status->time);
+	status->applied[0] = '\0';
+	status->restart[0] = '\0';
+	status->disconnected = 0;
 
 	oldconf = hapd->iconf;
 	if (hostapd_iface_conf_changed(newconf, oldconf)) {
+		struct hostapd_reload_status prev = *status;
 		char *fname;
 		int res;
 
+		hostapd_clear_old(iface);
 		wpa_printf(MSG_DEBUG,
 			   "Configuration changes include interface/BSS modification - force full disable+enable sequence");
 		fname = os_strdup(iface->config_fname);
@@ -255,6 +774,8 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 				   "Failed to initialize interface on config reload");
 			return -1;
 		}
+		iface->reload = prev;
+		iface->reload.mode = HOSTAPD_RELOAD_FULL;
 		iface->interfaces = interfaces;
 		interfaces->iface[interfaces->count] = iface;
 		interfaces->count++;
@@ -264,6 +785,30 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 				   "Failed to enable interface on config reload");
 		return res;
 	}
+
+	live = os_calloc(iface->num_bss, sizeof(unsigned int));
+	if (live && hostapd_reload_classify(iface, newconf, live)) {
+		status->mode = status->applied[0] ? HOSTAPD_RELOAD_LIVE :
+			HOSTAPD_RELOAD_UNCHANGED;
+		wpa_printf(MSG_DEBUG,
+			   "Configuration reload: applying changes without flushing STAs: %s",
+			   status->applied);
+		for (j = 0; j < iface->num_bss; j++)
+			status->disconnected += hostapd_reload_bss_live(
+				iface->bss[j], newconf->bss[j],
+				live[j] | HOSTAPD_LIVE_FILES);
+		os_free(live);
+		hostapd_config_free(newconf);
+		return 0;
+	}
+	os_free(live);
+
+	status->mode = HOSTAPD_RELOAD_RESTART;
+	wpa_printf(MSG_DEBUG,
+		   "Configuration reload: changed parameters require reconfiguration: %s",
+		   status->restart);
+	hostapd_clear_old(iface);
+
 	iface->conf = newconf;
 
 	for (j = 0; j < iface->num_bss; j++) {
@@ -361,6 +906,10 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 	hapd->probereq_cb = NULL;
 	hapd->num_probereq_cb = 0;
 
+	os_free(hapd->sta_data.entries);
+	os_memset(&hapd->sta_data, 0, sizeof(hapd->sta_data));
+	os_memset(&hapd->sta_data_time, 0, sizeof(hapd->sta_data_time));
+
 #ifdef CONFIG_P2P
 	wpabuf_free(hapd->p2p_beacon_ie);
 	hapd->p2p_beacon_ie = NULL;
@@ -423,6 +972,7 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 #endif /* CONFIG_INTERWORKING */
 
 	bss_load_update_deinit(hapd);
+	hostapd_stats_shm_deinit(hapd);
 	ndisc_snoop_deinit(hapd);
 	dhcp_snoop_deinit(hapd);
 	x_snoop_deinit(hapd);
@@ -438,6 +988,8 @@ void hostapd_free_hapd_data(struct hostapd_data *hapd)
 #ifdef CONFIG_MESH
 	wpabuf_free(hapd->mesh_pending_auth);
 	hapd->mesh_pending_auth = NULL;
+	os_free(hapd->mesh_llid_map);
+	hapd->mesh_llid_map = NULL;
 	/* handling setup failure is already done */
 	hapd->setup_complete_cb = NULL;
 #endif /* CONFIG_MESH */
@@ -1400,6 +1952,9 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 	if (hapd->wpa_auth && wpa_init_keys(hapd->wpa_auth) < 0)
 		return -1;
 
+	if (hostapd_stats_shm_init(hapd) < 0)
+		return -1;
+
 	if (hapd->driver && hapd->driver->set_operstate)
 		hapd->driver->set_operstate(hapd->drv_priv, 1);
 
@@ -1431,24 +1986,31 @@ static void hostapd_tx_queue_params(struct hostapd_iface *iface)
 }
 
 
+static int hostapd_acl_params_add(const struct mac_acl_entry *entry,
+				  void *ctx)
+{
+	struct hostapd_acl_params *acl_params = ctx;
+
+	os_memcpy(acl_params->mac_acl[acl_params->num_mac_acl++].addr,
+		  entry->addr, ETH_ALEN);
+	return 0;
+}
+
+
 static int hostapd_set_acl_list(struct hostapd_data *hapd,
-				struct mac_acl_entry *mac_acl,
-				int n_entries, u8 accept_acl)
+				const struct mac_acl *mac_acl, u8 accept_acl)
 {
 	struct hostapd_acl_params *acl_params;
-	int i, err;
+	int err;
 
 	acl_params = os_zalloc(sizeof(*acl_params) +
-			       (n_entries * sizeof(acl_params->mac_acl[0])));
+			       (mac_acl_count(mac_acl) *
+				sizeof(acl_params->mac_acl[0])));
 	if (!acl_params)
 		return -ENOMEM;
 
-	for (i = 0; i < n_entries; i++)
-		os_memcpy(acl_params->mac_acl[i].addr, mac_acl[i].addr,
-			  ETH_ALEN);
-
+	mac_acl_for_each(mac_acl, hostapd_acl_params_add, acl_params);
 	acl_params->acl_policy = accept_acl;
-	acl_params->num_mac_acl = n_entries;
 
 	err = hostapd_drv_set_acl(hapd, acl_params);
 
@@ -1469,8 +2031,7 @@ static void hostapd_set_acl(struct hostapd_data *hapd)
 
 	if (conf->bss[0]->macaddr_acl == DENY_UNLESS_ACCEPTED) {
 		accept_acl = 1;
-		err = hostapd_set_acl_list(hapd, conf->bss[0]->accept_mac,
-					   conf->bss[0]->num_accept_mac,
+		err = hostapd_set_acl_list(hapd, &conf->bss[0]->accept_mac,
 					   accept_acl);
 		if (err) {
 			wpa_printf(MSG_DEBUG, "Failed to set accept acl");
@@ -1478,8 +2039,7 @@ static void hostapd_set_acl(struct hostapd_data *hapd)
 		}
 	} else if (conf->bss[0]->macaddr_acl == ACCEPT_UNLESS_DENIED) {
 		accept_acl = 0;
-		err = hostapd_set_acl_list(hapd, conf->bss[0]->deny_mac,
-					   conf->bss[0]->num_deny_mac,
+		err = hostapd_set_acl_list(hapd, &conf->bss[0]->deny_mac,
 					   accept_acl);
 		if (err) {
 			wpa_printf(MSG_DEBUG, "Failed to set deny acl");
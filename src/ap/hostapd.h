@@ -33,6 +33,7 @@ struct hostapd_data;
 struct sta_info;
 struct ieee80211_ht_capabilities;
 struct full_dynamic_vlan;
+struct stats_shm;
 enum wps_event;
 union wps_event_data;
 #ifdef CONFIG_MESH
@@ -178,6 +179,32 @@ struct hostapd_data {
 #define AID_WORDS ((2008 + 31) / 32)
 	u32 sta_aid[AID_WORDS];
 
+	/*
+	 * Change generation for STA-DUMP delta queries. sta_change_gen is
+	 * incremented whenever a station is added, changes state, or is
+	 * removed. Removals are tracked in a small ring buffer; sta_removed_lost
+	 * is the newest generation that has been overwritten in that ring.
+	 * sta_list_seq is incremented for each station added to sta_list so
+	 * that a paged dump can resume after a station that has been removed.
+	 */
+	unsigned int sta_change_gen;
+	unsigned int sta_list_seq;
+#define STA_REMOVED_TRACK 64
+	struct sta_removed_entry {
+		u8 addr[ETH_ALEN];
+		unsigned int gen;
+		unsigned int list_seq;
+	} sta_removed[STA_REMOVED_TRACK];
+	unsigned int sta_removed_next;
+	unsigned int sta_removed_lost;
+
+	/*
+	 * Driver data for all stations from the latest read_all_sta_data()
+	 * call, sorted by address. The array is reused for subsequent calls.
+	 */
+	struct hostap_sta_data_list sta_data;
+	struct os_reltime sta_data_time;
+
 	const struct wpa_driver_ops *driver;
 	void *drv_priv;
 
@@ -189,10 +216,10 @@ struct hostapd_data {
 
 	struct radius_client_data *radius;
 	u64 acct_session_id;
+	struct accounting_sched *acct_sched;
 	struct radius_das_data *radius_das;
 
-	struct hostapd_cached_radius_acl *acl_cache;
-	struct hostapd_acl_query_data *acl_queries;
+	struct hostapd_radius_acl *radius_acl;
 
 	struct wpa_authenticator *wpa_auth;
 	struct eapol_authenticator *eapol_auth;
@@ -312,6 +339,12 @@ struct hostapd_data {
 #ifdef CONFIG_PROXYARP
 	struct l2_packet_data *sock_dhcp;
 	struct l2_packet_data *sock_ndisc;
+	/* Snooped IPv6 addresses of STAs hashed by the last octet, i.e., by
+	 * their solicited-node multicast group */
+#define IP6ADDR_HASH_SIZE 256
+	struct ip6addr *ip6addr_hash[IP6ADDR_HASH_SIZE];
+	unsigned int mcast_to_ucast_converted;
+	unsigned int mcast_to_ucast_suppressed;
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_MESH
 	int num_plinks;
@@ -321,6 +354,9 @@ struct hostapd_data {
 	struct wpabuf *mesh_pending_auth;
 	struct os_reltime mesh_pending_auth_time;
 	u8 mesh_required_peer[ETH_ALEN];
+	/* Bitmap of local link IDs in use (65536 bits), allocated on first
+	 * use */
+	u32 *mesh_llid_map;
 #endif /* CONFIG_MESH */
 
 #ifdef CONFIG_SQLITE
@@ -431,6 +467,10 @@ struct hostapd_data {
 #ifdef CONFIG_CTRL_IFACE_UDP
        unsigned char ctrl_iface_cookie[CTRL_IFACE_COOKIE_LEN];
 #endif /* CONFIG_CTRL_IFACE_UDP */
+
+#ifdef CONFIG_STATS_SHM
+	struct stats_shm *stats_shm;
+#endif /* CONFIG_STATS_SHM */
 };
 
 
@@ -444,6 +484,24 @@ struct hostapd_sta_info {
 #endif /* CONFIG_TAXONOMY */
 };
 
+/**
+ * struct hostapd_reload_status - Result of the last configuration reload
+ */
+struct hostapd_reload_status {
+	unsigned int count; /* number of reloads from the configuration file */
+	enum hostapd_reload_mode {
+		HOSTAPD_RELOAD_NONE,
+		HOSTAPD_RELOAD_UNCHANGED, /* no parameters changed */
+		HOSTAPD_RELOAD_LIVE, /* changes applied without flushing STAs */
+		HOSTAPD_RELOAD_RESTART, /* STAs flushed and BSSs reconfigured */
+		HOSTAPD_RELOAD_FULL, /* interface removed and added again */
+	} mode;
+	struct os_reltime time;
+	char applied[256]; /* space separated names of live-applied params */
+	char restart[256]; /* space separated names of other changed params */
+	unsigned int disconnected; /* STAs disconnected by live changes */
+};
+
 /**
  * struct hostapd_iface - hostapd per-interface data structure
  */
@@ -600,6 +658,8 @@ struct hostapd_iface {
 
 	int (*enable_iface_cb)(struct hostapd_iface *iface);
 	int (*disable_iface_cb)(struct hostapd_iface *iface);
+
+	struct hostapd_reload_status reload;
 };
 
 /* hostapd.c */
@@ -607,6 +667,10 @@ int hostapd_for_each_interface(struct hapd_interfaces *interfaces,
 			       int (*cb)(struct hostapd_iface *iface,
 					 void *ctx), void *ctx);
 int hostapd_reload_config(struct hostapd_iface *iface);
+const char * hostapd_reload_mode_txt(enum hostapd_reload_mode mode);
+int hostapd_disassoc_accept_mac(struct hostapd_data *hapd);
+int hostapd_disassoc_deny_mac(struct hostapd_data *hapd);
+int hostapd_kick_mismatch_psk_sta(struct hostapd_data *hapd);
 void hostapd_reconfig_encryption(struct hostapd_data *hapd);
 struct hostapd_data *
 hostapd_alloc_bss_data(struct hostapd_iface *hapd_iface,
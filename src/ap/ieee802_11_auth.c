@@ -25,28 +25,89 @@
 #include "ieee802_11_auth.h"
 
 #define RADIUS_ACL_TIMEOUT 30
+/* Maximum number of pending queries for which a prefetch is started */
+#define RADIUS_ACL_MAX_PREFETCH 64
 
 
 struct hostapd_cached_radius_acl {
-	struct os_reltime timestamp;
+	struct dl_list list; /* in expiration order */
+	struct hostapd_cached_radius_acl *hnext; /* next entry in hash table */
+	struct os_reltime expires;
 	macaddr addr;
 	int accepted; /* HOSTAPD_ACL_* */
-	struct hostapd_cached_radius_acl *next;
 	struct radius_sta info;
 };
 
 
 struct hostapd_acl_query_data {
+	struct dl_list list; /* oldest first */
+	struct hostapd_acl_query_data *hnext; /* next entry with same address
+						* hash */
+	struct hostapd_acl_query_data *id_next; /* next entry with same RADIUS
+						 * identifier */
 	struct os_reltime timestamp;
 	u8 radius_id;
 	macaddr addr;
-	u8 *auth_msg; /* IEEE 802.11 authentication frame from station */
+	u8 *auth_msg; /* IEEE 802.11 authentication frame from station or
+		       * %NULL for a query started from a Probe Request frame */
 	size_t auth_msg_len;
-	struct hostapd_acl_query_data *next;
 };
 
 
 #ifndef CONFIG_NO_RADIUS
+/*
+ * Cached RADIUS ACL results and pending queries of a BSS. Both are hashed by
+ * the STA address for per-frame lookups and kept on lists ordered by age so
+ * that expiration only needs to look at the entries that have expired.
+ * Accepted and rejected entries use separate lists since their TTLs can
+ * differ.
+ */
+struct hostapd_radius_acl {
+	struct hostapd_cached_radius_acl *cache_hash[STA_HASH_SIZE];
+	struct dl_list cache_accept;
+	struct dl_list cache_reject;
+	unsigned int num_cache;
+
+	struct hostapd_acl_query_data *query_hash[STA_HASH_SIZE];
+	struct hostapd_acl_query_data *query_id[256];
+	struct dl_list queries;
+	unsigned int num_queries;
+
+	/* Counters for MIB */
+	unsigned long hits;
+	unsigned long negative_hits;
+	unsigned long misses;
+	unsigned long queries_sent;
+	unsigned long coalesced;
+	unsigned long prefetches;
+	unsigned long accepts;
+	unsigned long rejects;
+	unsigned long timeouts;
+	unsigned long replies;
+	u64 latency_total_ms;
+	unsigned int latency_max_ms;
+};
+
+
+static struct hostapd_radius_acl * hostapd_radius_acl_get(
+	struct hostapd_data *hapd)
+{
+	struct hostapd_radius_acl *acl = hapd->radius_acl;
+
+	if (acl)
+		return acl;
+
+	acl = os_zalloc(sizeof(*acl));
+	if (!acl)
+		return NULL;
+	dl_list_init(&acl->cache_accept);
+	dl_list_init(&acl->cache_reject);
+	dl_list_init(&acl->queries);
+	hapd->radius_acl = acl;
+	return acl;
+}
+
+
 static void hostapd_acl_cache_free_entry(struct hostapd_cached_radius_acl *e)
 {
 	os_free(e->info.identity);
@@ -56,41 +117,94 @@ static void hostapd_acl_cache_free_entry(struct hostapd_cached_radius_acl *e)
 }
 
 
-static void hostapd_acl_cache_free(struct hostapd_cached_radius_acl *acl_cache)
+static void hostapd_acl_cache_del(struct hostapd_radius_acl *acl,
+				  struct hostapd_cached_radius_acl *entry)
 {
-	struct hostapd_cached_radius_acl *prev;
+	struct hostapd_cached_radius_acl **pos;
 
-	while (acl_cache) {
-		prev = acl_cache;
-		acl_cache = acl_cache->next;
-		hostapd_acl_cache_free_entry(prev);
+	for (pos = &acl->cache_hash[STA_HASH(entry->addr)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == entry) {
+			*pos = entry->hnext;
+			break;
+		}
 	}
+	dl_list_del(&entry->list);
+	acl->num_cache--;
+	hostapd_acl_cache_free_entry(entry);
 }
 
 
-static int hostapd_acl_cache_get(struct hostapd_data *hapd, const u8 *addr,
-				 struct radius_sta *out)
+static struct hostapd_cached_radius_acl *
+hostapd_acl_cache_find(struct hostapd_radius_acl *acl, const u8 *addr)
 {
 	struct hostapd_cached_radius_acl *entry;
-	struct os_reltime now;
 
-	os_get_reltime(&now);
+	for (entry = acl->cache_hash[STA_HASH(addr)]; entry;
+	     entry = entry->hnext) {
+		if (os_memcmp(entry->addr, addr, ETH_ALEN) == 0)
+			return entry;
+	}
 
-	for (entry = hapd->acl_cache; entry; entry = entry->next) {
-		if (os_memcmp(entry->addr, addr, ETH_ALEN) != 0)
-			continue;
+	return NULL;
+}
+
+
+static void hostapd_acl_cache_add(struct hostapd_data *hapd,
+				  struct hostapd_radius_acl *acl,
+				  struct hostapd_cached_radius_acl *entry)
+{
+	struct hostapd_cached_radius_acl *old;
+	int ttl;
+
+	old = hostapd_acl_cache_find(acl, entry->addr);
+	if (old)
+		hostapd_acl_cache_del(acl, old);
+
+	if (entry->accepted == HOSTAPD_ACL_REJECT)
+		ttl = hapd->conf->radius_acl_negative_ttl;
+	else
+		ttl = hapd->conf->radius_acl_cache_ttl;
+	/* The entry needs to be available at least for processing the
+	 * authentication frame that is re-sent after the response */
+	if (ttl < 1)
+		ttl = 1;
+
+	os_get_reltime(&entry->expires);
+	entry->expires.sec += ttl;
+	entry->hnext = acl->cache_hash[STA_HASH(entry->addr)];
+	acl->cache_hash[STA_HASH(entry->addr)] = entry;
+	dl_list_add_tail(entry->accepted == HOSTAPD_ACL_REJECT ?
+			 &acl->cache_reject : &acl->cache_accept,
+			 &entry->list);
+	acl->num_cache++;
+}
 
-		if (os_reltime_expired(&now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT))
-			return -1; /* entry has expired */
-		*out = entry->info;
 
-		return entry->accepted;
+static int hostapd_acl_cache_get(struct hostapd_radius_acl *acl,
+				 const u8 *addr, struct radius_sta *out)
+{
+	struct hostapd_cached_radius_acl *entry;
+	struct os_reltime now;
+
+	entry = hostapd_acl_cache_find(acl, addr);
+	if (entry) {
+		os_get_reltime(&now);
+		if (!os_reltime_before(&now, &entry->expires))
+			entry = NULL; /* entry has expired */
+	}
+	if (!entry) {
+		acl->misses++;
+		return -1;
 	}
 
-	return -1;
+	*out = entry->info;
+	if (entry->accepted == HOSTAPD_ACL_REJECT)
+		acl->negative_hits++;
+	else
+		acl->hits++;
+	return entry->accepted;
 }
-#endif /* CONFIG_NO_RADIUS */
 
 
 static void hostapd_acl_query_free(struct hostapd_acl_query_data *query)
@@ -101,8 +215,58 @@ static void hostapd_acl_query_free(struct hostapd_acl_query_data *query)
 	os_free(query);
 }
 
+static struct hostapd_acl_query_data *
+hostapd_acl_query_find(struct hostapd_radius_acl *acl, const u8 *addr)
+{
+	struct hostapd_acl_query_data *query;
+
+	for (query = acl->query_hash[STA_HASH(addr)]; query;
+	     query = query->hnext) {
+		if (os_memcmp(query->addr, addr, ETH_ALEN) == 0)
+			return query;
+	}
+
+	return NULL;
+}
+
+
+static void hostapd_acl_query_add(struct hostapd_radius_acl *acl,
+				  struct hostapd_acl_query_data *query)
+{
+	query->hnext = acl->query_hash[STA_HASH(query->addr)];
+	acl->query_hash[STA_HASH(query->addr)] = query;
+	query->id_next = acl->query_id[query->radius_id];
+	acl->query_id[query->radius_id] = query;
+	dl_list_add_tail(&acl->queries, &query->list);
+	acl->num_queries++;
+}
+
+
+static void hostapd_acl_query_del(struct hostapd_radius_acl *acl,
+				  struct hostapd_acl_query_data *query)
+{
+	struct hostapd_acl_query_data **pos;
+
+	for (pos = &acl->query_hash[STA_HASH(query->addr)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == query) {
+			*pos = query->hnext;
+			break;
+		}
+	}
+	for (pos = &acl->query_id[query->radius_id]; *pos;
+	     pos = &(*pos)->id_next) {
+		if (*pos == query) {
+			*pos = query->id_next;
+			break;
+		}
+	}
+	dl_list_del(&query->list);
+	acl->num_queries--;
+	hostapd_acl_query_free(query);
+}
+
 
-#ifndef CONFIG_NO_RADIUS
 static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 				    struct hostapd_acl_query_data *query)
 {
@@ -161,6 +325,45 @@ static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 	radius_msg_free(msg);
 	return -1;
 }
+
+
+/*
+ * Start a RADIUS query for a STA that is not yet authenticating so that the
+ * result is already in the cache when the Authentication frame arrives.
+ */
+static void hostapd_acl_prefetch(struct hostapd_data *hapd,
+				 struct hostapd_radius_acl *acl, const u8 *addr)
+{
+	struct hostapd_cached_radius_acl *entry;
+	struct hostapd_acl_query_data *query;
+	struct os_reltime now;
+
+	if (!hapd->conf->radius->auth_server ||
+	    acl->num_queries >= RADIUS_ACL_MAX_PREFETCH ||
+	    hostapd_acl_query_find(acl, addr))
+		return;
+	entry = hostapd_acl_cache_find(acl, addr);
+	if (entry) {
+		os_get_reltime(&now);
+		if (os_reltime_before(&now, &entry->expires))
+			return;
+	}
+
+	query = os_zalloc(sizeof(*query));
+	if (!query)
+		return;
+	os_get_reltime(&query->timestamp);
+	os_memcpy(query->addr, addr, ETH_ALEN);
+	if (hostapd_radius_acl_query(hapd, addr, query)) {
+		hostapd_acl_query_free(query);
+		return;
+	}
+	wpa_printf(MSG_DEBUG, "Prefetching RADIUS ACL result for " MACSTR,
+		   MAC2STR(addr));
+	hostapd_acl_query_add(acl, query);
+	acl->queries_sent++;
+	acl->prefetches++;
+}
 #endif /* CONFIG_NO_RADIUS */
 
 
@@ -174,12 +377,10 @@ static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 int hostapd_check_acl(struct hostapd_data *hapd, const u8 *addr,
 		      struct vlan_description *vlan_id)
 {
-	if (hostapd_maclist_found(hapd->conf->accept_mac,
-				  hapd->conf->num_accept_mac, addr, vlan_id))
+	if (hostapd_maclist_found(&hapd->conf->accept_mac, addr, vlan_id))
 		return HOSTAPD_ACL_ACCEPT;
 
-	if (hostapd_maclist_found(hapd->conf->deny_mac,
-				  hapd->conf->num_deny_mac, addr, vlan_id))
+	if (hostapd_maclist_found(&hapd->conf->deny_mac, addr, vlan_id))
 		return HOSTAPD_ACL_REJECT;
 
 	if (hapd->conf->macaddr_acl == ACCEPT_UNLESS_DENIED)
@@ -226,33 +427,49 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 #ifdef CONFIG_NO_RADIUS
 		return HOSTAPD_ACL_REJECT;
 #else /* CONFIG_NO_RADIUS */
+		struct hostapd_radius_acl *acl;
 		struct hostapd_acl_query_data *query;
 
+		acl = hostapd_radius_acl_get(hapd);
+		if (!acl)
+			return is_probe_req ? HOSTAPD_ACL_ACCEPT :
+				HOSTAPD_ACL_REJECT;
+
 		if (is_probe_req) {
 			/* Skip RADIUS queries for Probe Request frames to avoid
-			 * excessive load on the authentication server. */
+			 * excessive load on the authentication server unless
+			 * prefetching was enabled. */
+			if (hapd->conf->radius_acl_prefetch)
+				hostapd_acl_prefetch(hapd, acl, addr);
 			return HOSTAPD_ACL_ACCEPT;
-		};
+		}
 
 		if (hapd->conf->ssid.dynamic_vlan == DYNAMIC_VLAN_DISABLED)
 			os_memset(&out->vlan_id, 0, sizeof(out->vlan_id));
 
 		/* Check whether ACL cache has an entry for this station */
-		res = hostapd_acl_cache_get(hapd, addr, out);
+		res = hostapd_acl_cache_get(acl, addr, out);
 		if (res == HOSTAPD_ACL_ACCEPT ||
 		    res == HOSTAPD_ACL_ACCEPT_TIMEOUT)
 			return res;
 		if (res == HOSTAPD_ACL_REJECT)
 			return HOSTAPD_ACL_REJECT;
 
-		query = hapd->acl_queries;
-		while (query) {
-			if (os_memcmp(query->addr, addr, ETH_ALEN) == 0) {
-				/* pending query in RADIUS retransmit queue;
-				 * do not generate a new one */
-				return HOSTAPD_ACL_PENDING;
+		query = hostapd_acl_query_find(acl, addr);
+		if (query) {
+			/* Pending query in RADIUS retransmit queue; do not
+			 * generate a new one, but process the latest frame from
+			 * the STA once the response is received. */
+			u8 *auth_msg;
+
+			auth_msg = os_memdup(msg, len);
+			if (auth_msg) {
+				os_free(query->auth_msg);
+				query->auth_msg = auth_msg;
+				query->auth_msg_len = len;
 			}
-			query = query->next;
+			acl->coalesced++;
+			return HOSTAPD_ACL_PENDING;
 		}
 
 		if (!hapd->conf->radius->auth_server)
@@ -266,13 +483,6 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 		}
 		os_get_reltime(&query->timestamp);
 		os_memcpy(query->addr, addr, ETH_ALEN);
-		if (hostapd_radius_acl_query(hapd, addr, query)) {
-			wpa_printf(MSG_DEBUG, "Failed to send Access-Request "
-				   "for ACL query.");
-			hostapd_acl_query_free(query);
-			return HOSTAPD_ACL_REJECT;
-		}
-
 		query->auth_msg = os_memdup(msg, len);
 		if (query->auth_msg == NULL) {
 			wpa_printf(MSG_ERROR, "Failed to allocate memory for "
@@ -281,8 +491,14 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 			return HOSTAPD_ACL_REJECT;
 		}
 		query->auth_msg_len = len;
-		query->next = hapd->acl_queries;
-		hapd->acl_queries = query;
+		if (hostapd_radius_acl_query(hapd, addr, query)) {
+			wpa_printf(MSG_DEBUG, "Failed to send Access-Request "
+				   "for ACL query.");
+			hostapd_acl_query_free(query);
+			return HOSTAPD_ACL_REJECT;
+		}
+		hostapd_acl_query_add(acl, query);
+		acl->queries_sent++;
 
 		/* Queued data will be processed in hostapd_acl_recv_radius()
 		 * when RADIUS server replies to the sent Access-Request. */
@@ -296,31 +512,21 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 
 #ifndef CONFIG_NO_RADIUS
 static void hostapd_acl_expire_cache(struct hostapd_data *hapd,
+				     struct dl_list *list,
 				     struct os_reltime *now)
 {
-	struct hostapd_cached_radius_acl *prev, *entry, *tmp;
-
-	prev = NULL;
-	entry = hapd->acl_cache;
-
-	while (entry) {
-		if (os_reltime_expired(now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT)) {
-			wpa_printf(MSG_DEBUG, "Cached ACL entry for " MACSTR
-				   " has expired.", MAC2STR(entry->addr));
-			if (prev)
-				prev->next = entry->next;
-			else
-				hapd->acl_cache = entry->next;
-			hostapd_drv_set_radius_acl_expire(hapd, entry->addr);
-			tmp = entry;
-			entry = entry->next;
-			hostapd_acl_cache_free_entry(tmp);
-			continue;
-		}
+	struct hostapd_cached_radius_acl *entry;
 
-		prev = entry;
-		entry = entry->next;
+	/* Entries are added to the tail, so the expired ones are at the head
+	 * unless the TTL was reduced during the lifetime of the entries. */
+	while ((entry = dl_list_first(list, struct hostapd_cached_radius_acl,
+				      list))) {
+		if (os_reltime_before(now, &entry->expires))
+			break;
+		wpa_printf(MSG_DEBUG, "Cached ACL entry for " MACSTR
+			   " has expired.", MAC2STR(entry->addr));
+		hostapd_drv_set_radius_acl_expire(hapd, entry->addr);
+		hostapd_acl_cache_del(hapd->radius_acl, entry);
 	}
 }
 
@@ -328,29 +534,18 @@ static void hostapd_acl_expire_cache(struct hostapd_data *hapd,
 static void hostapd_acl_expire_queries(struct hostapd_data *hapd,
 				       struct os_reltime *now)
 {
-	struct hostapd_acl_query_data *prev, *entry, *tmp;
-
-	prev = NULL;
-	entry = hapd->acl_queries;
-
-	while (entry) {
-		if (os_reltime_expired(now, &entry->timestamp,
-				       RADIUS_ACL_TIMEOUT)) {
-			wpa_printf(MSG_DEBUG, "ACL query for " MACSTR
-				   " has expired.", MAC2STR(entry->addr));
-			if (prev)
-				prev->next = entry->next;
-			else
-				hapd->acl_queries = entry->next;
-
-			tmp = entry;
-			entry = entry->next;
-			hostapd_acl_query_free(tmp);
-			continue;
-		}
+	struct hostapd_radius_acl *acl = hapd->radius_acl;
+	struct hostapd_acl_query_data *query;
 
-		prev = entry;
-		entry = entry->next;
+	while ((query = dl_list_first(&acl->queries,
+				      struct hostapd_acl_query_data, list))) {
+		if (!os_reltime_expired(now, &query->timestamp,
+					RADIUS_ACL_TIMEOUT))
+			break;
+		wpa_printf(MSG_DEBUG, "ACL query for " MACSTR
+			   " has expired.", MAC2STR(query->addr));
+		acl->timeouts++;
+		hostapd_acl_query_del(acl, query);
 	}
 }
 
@@ -363,12 +558,59 @@ void hostapd_acl_expire(struct hostapd_data *hapd)
 {
 	struct os_reltime now;
 
+	if (!hapd->radius_acl)
+		return;
+
 	os_get_reltime(&now);
-	hostapd_acl_expire_cache(hapd, &now);
+	hostapd_acl_expire_cache(hapd, &hapd->radius_acl->cache_accept, &now);
+	hostapd_acl_expire_cache(hapd, &hapd->radius_acl->cache_reject, &now);
 	hostapd_acl_expire_queries(hapd, &now);
 }
 
 
+/**
+ * hostapd_acl_get_mib - Get RADIUS ACL cache statistics
+ * @hapd: hostapd BSS data
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written into the buffer
+ */
+int hostapd_acl_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
+{
+	struct hostapd_radius_acl *acl = hapd->radius_acl;
+	int ret;
+
+	if (!acl)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "radiusAclCacheEntries=%u\n"
+			  "radiusAclCacheHits=%lu\n"
+			  "radiusAclCacheNegativeHits=%lu\n"
+			  "radiusAclCacheMisses=%lu\n"
+			  "radiusAclPendingQueries=%u\n"
+			  "radiusAclQueries=%lu\n"
+			  "radiusAclQueriesCoalesced=%lu\n"
+			  "radiusAclPrefetches=%lu\n"
+			  "radiusAclAccepts=%lu\n"
+			  "radiusAclRejects=%lu\n"
+			  "radiusAclQueryTimeouts=%lu\n"
+			  "radiusAclLatencyAvgMs=%u\n"
+			  "radiusAclLatencyMaxMs=%u\n",
+			  acl->num_cache, acl->hits, acl->negative_hits,
+			  acl->misses, acl->num_queries, acl->queries_sent,
+			  acl->coalesced, acl->prefetches, acl->accepts,
+			  acl->rejects, acl->timeouts,
+			  acl->replies ?
+			  (unsigned int) (acl->latency_total_ms /
+					  acl->replies) : 0,
+			  acl->latency_max_ms);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
 static void decode_tunnel_passwords(struct hostapd_data *hapd,
 				    const u8 *shared_secret,
 				    size_t shared_secret_len,
@@ -451,19 +693,17 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 			void *data)
 {
 	struct hostapd_data *hapd = data;
-	struct hostapd_acl_query_data *query, *prev;
+	struct hostapd_radius_acl *acl = hapd->radius_acl;
+	struct hostapd_acl_query_data *query;
 	struct hostapd_cached_radius_acl *cache;
 	struct radius_sta *info;
 	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
+	struct os_reltime now, age;
+	unsigned int latency;
 
-	query = hapd->acl_queries;
-	prev = NULL;
-	while (query) {
-		if (query->radius_id == hdr->identifier)
-			break;
-		prev = query;
-		query = query->next;
-	}
+	if (!acl)
+		return RADIUS_RX_UNKNOWN;
+	query = acl->query_id[hdr->identifier];
 	if (query == NULL)
 		return RADIUS_RX_UNKNOWN;
 
@@ -483,13 +723,20 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 	}
 
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &query->timestamp, &age);
+	latency = age.sec * 1000 + age.usec / 1000;
+	acl->replies++;
+	acl->latency_total_ms += latency;
+	if (latency > acl->latency_max_ms)
+		acl->latency_max_ms = latency;
+
 	/* Insert Accept/Reject info into ACL cache */
 	cache = os_zalloc(sizeof(*cache));
 	if (cache == NULL) {
 		wpa_printf(MSG_DEBUG, "Failed to add ACL cache entry");
 		goto done;
 	}
-	os_get_reltime(&cache->timestamp);
 	os_memcpy(cache->addr, query->addr, sizeof(cache->addr));
 	info = &cache->info;
 	if (hdr->code == RADIUS_CODE_ACCESS_ACCEPT) {
@@ -554,28 +801,40 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 			cache->accepted = HOSTAPD_ACL_REJECT;
 	} else
 		cache->accepted = HOSTAPD_ACL_REJECT;
-	cache->next = hapd->acl_cache;
-	hapd->acl_cache = cache;
+	if (cache->accepted == HOSTAPD_ACL_REJECT)
+		acl->rejects++;
+	else
+		acl->accepts++;
 
 #ifdef CONFIG_DRIVER_RADIUS_ACL
 	hostapd_drv_set_radius_acl_auth(hapd, query->addr, cache->accepted,
 					info->session_timeout);
-#else /* CONFIG_DRIVER_RADIUS_ACL */
+#endif /* CONFIG_DRIVER_RADIUS_ACL */
+	hostapd_acl_cache_add(hapd, acl, cache);
+
+#ifndef CONFIG_DRIVER_RADIUS_ACL
 #ifdef NEED_AP_MLME
 	/* Re-send original authentication frame for 802.11 processing */
-	wpa_printf(MSG_DEBUG, "Re-sending authentication frame after "
-		   "successful RADIUS ACL query");
-	ieee802_11_mgmt(hapd, query->auth_msg, query->auth_msg_len, NULL);
+	if (query->auth_msg) {
+		wpa_printf(MSG_DEBUG, "Re-sending authentication frame after "
+			   "successful RADIUS ACL query");
+		ieee802_11_mgmt(hapd, query->auth_msg, query->auth_msg_len,
+				NULL);
+	}
 #endif /* NEED_AP_MLME */
 #endif /* CONFIG_DRIVER_RADIUS_ACL */
 
- done:
-	if (prev == NULL)
-		hapd->acl_queries = query->next;
-	else
-		prev->next = query->next;
+	if (cache->accepted == HOSTAPD_ACL_REJECT &&
+	    hapd->conf->radius_acl_negative_ttl == 0) {
+		/* Rejects are not cached; the entry was needed only for the
+		 * re-sent authentication frame */
+		cache = hostapd_acl_cache_find(acl, query->addr);
+		if (cache && cache->accepted == HOSTAPD_ACL_REJECT)
+			hostapd_acl_cache_del(acl, cache);
+	}
 
-	hostapd_acl_query_free(query);
+ done:
+	hostapd_acl_query_del(acl, query);
 
 	return RADIUS_RX_PROCESSED;
 }
@@ -605,20 +864,27 @@ int hostapd_acl_init(struct hostapd_data *hapd)
  */
 void hostapd_acl_deinit(struct hostapd_data *hapd)
 {
-	struct hostapd_acl_query_data *query, *prev;
-
 #ifndef CONFIG_NO_RADIUS
-	hostapd_acl_cache_free(hapd->acl_cache);
-	hapd->acl_cache = NULL;
-#endif /* CONFIG_NO_RADIUS */
+	struct hostapd_radius_acl *acl = hapd->radius_acl;
+	struct hostapd_cached_radius_acl *entry;
+	struct hostapd_acl_query_data *query;
 
-	query = hapd->acl_queries;
-	hapd->acl_queries = NULL;
-	while (query) {
-		prev = query;
-		query = query->next;
-		hostapd_acl_query_free(prev);
-	}
+	if (!acl)
+		return;
+
+	while ((entry = dl_list_first(&acl->cache_accept,
+				      struct hostapd_cached_radius_acl, list)))
+		hostapd_acl_cache_del(acl, entry);
+	while ((entry = dl_list_first(&acl->cache_reject,
+				      struct hostapd_cached_radius_acl, list)))
+		hostapd_acl_cache_del(acl, entry);
+	while ((query = dl_list_first(&acl->queries,
+				      struct hostapd_acl_query_data, list)))
+		hostapd_acl_query_del(acl, query);
+
+	os_free(acl);
+	hapd->radius_acl = NULL;
+#endif /* CONFIG_NO_RADIUS */
 }
 
 
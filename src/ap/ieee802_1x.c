@@ -2720,6 +2720,42 @@ int ieee802_1x_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
 }
 
 
+/**
+ * ieee802_1x_sta_mem_usage - Get the amount of memory used for IEEE 802.1X
+ * @sta: Station entry
+ * Returns: Approximate number of octets allocated for the EAPOL and EAP
+ * state machines of the station
+ */
+size_t ieee802_1x_sta_mem_usage(struct sta_info *sta)
+{
+	struct eapol_state_machine *sm = sta->eapol_sm;
+	size_t len = 0;
+#ifndef CONFIG_NO_RADIUS
+	size_t i;
+#endif /* CONFIG_NO_RADIUS */
+
+	if (sta->pending_eapol_rx)
+		len += sizeof(*sta->pending_eapol_rx) +
+			wpabuf_mem_usage(sta->pending_eapol_rx->buf);
+	if (!sm)
+		return len;
+
+	len += sizeof(*sm) + sm->identity_len;
+	len += wpabuf_mem_usage(sm->radius_cui);
+	len += eap_server_sm_mem_usage(sm->eap);
+#ifndef CONFIG_NO_RADIUS
+	if (sm->last_recv_radius)
+		len += wpabuf_mem_usage(
+			radius_msg_get_buf(sm->last_recv_radius));
+	for (i = 0; i < sm->radius_class.count; i++)
+		len += sizeof(sm->radius_class.attr[i]) +
+			sm->radius_class.attr[i].len;
+#endif /* CONFIG_NO_RADIUS */
+
+	return len;
+}
+
+
 int ieee802_1x_get_mib_sta(struct hostapd_data *hapd, struct sta_info *sta,
 			   char *buf, size_t buflen)
 {
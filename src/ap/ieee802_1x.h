@@ -48,6 +48,7 @@ void ieee802_1x_notify_pre_auth(struct eapol_state_machine *sm, bool pre_auth);
 int ieee802_1x_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen);
 int ieee802_1x_get_mib_sta(struct hostapd_data *hapd, struct sta_info *sta,
 			   char *buf, size_t buflen);
+size_t ieee802_1x_sta_mem_usage(struct sta_info *sta);
 void hostapd_get_ntp_timestamp(u8 *buf);
 char *eap_type_text(u8 type);
 
@@ -0,0 +1,253 @@
+/*
+ * hostapd / MAC address access control lists
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "mac_acl.h"
+
+#define MAC_ACL_MIN_HASH_BITS 4
+#define MAC_ACL_MAX_HASH_BITS 20
+
+
+static unsigned int mac_acl_hash(const u8 *addr, unsigned int bits)
+{
+	u32 val;
+
+	/* Most of the variation is in the NIC specific part of the address */
+	val = WPA_GET_BE32(&addr[2]) ^ WPA_GET_BE16(addr);
+	return (val * 0x9e3779b1U) >> (32 - bits);
+}
+
+
+static int mac_acl_resize(struct mac_acl *acl, unsigned int bits)
+{
+	struct mac_acl_entry **hash, *entry, *next;
+	unsigned int i, idx;
+
+	hash = os_calloc((size_t) 1 << bits, sizeof(*hash));
+	if (!hash)
+		return -1;
+
+	for (i = 0; acl->hash && i < (1U << acl->hash_bits); i++) {
+		for (entry = acl->hash[i]; entry; entry = next) {
+			next = entry->next;
+			idx = mac_acl_hash(entry->addr, bits);
+			entry->next = hash[idx];
+			hash[idx] = entry;
+		}
+	}
+
+	os_free(acl->hash);
+	acl->hash = hash;
+	acl->hash_bits = bits;
+	return 0;
+}
+
+
+static struct mac_acl_entry ** mac_acl_find(const struct mac_acl *acl,
+					    const u8 *addr)
+{
+	struct mac_acl_entry **pos;
+
+	if (!acl->hash)
+		return NULL;
+
+	for (pos = &acl->hash[mac_acl_hash(addr, acl->hash_bits)]; *pos;
+	     pos = &(*pos)->next) {
+		if (os_memcmp((*pos)->addr, addr, ETH_ALEN) == 0)
+			return pos;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * mac_acl_add - Add an address into a MAC ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * @vlan_id: Untagged VLAN ID or 0 if not specified
+ * Returns: 0 on success, -1 on failure
+ *
+ * If the address is already in the list, only its VLAN ID is updated.
+ */
+int mac_acl_add(struct mac_acl *acl, const u8 *addr, int vlan_id)
+{
+	struct mac_acl_entry **pos, *entry;
+	unsigned int idx;
+
+	pos = mac_acl_find(acl, addr);
+	if (pos) {
+		(*pos)->vlan_id = vlan_id;
+		return 0;
+	}
+
+	/* Keep the average bucket length at most one */
+	if (!acl->hash ||
+	    (acl->num >= (1U << acl->hash_bits) &&
+	     acl->hash_bits < MAC_ACL_MAX_HASH_BITS)) {
+		if (mac_acl_resize(acl, acl->hash ? acl->hash_bits + 1 :
+				   MAC_ACL_MIN_HASH_BITS) < 0 &&
+		    !acl->hash)
+			return -1;
+	}
+
+	entry = os_malloc(sizeof(*entry));
+	if (!entry)
+		return -1;
+	os_memcpy(entry->addr, addr, ETH_ALEN);
+	entry->vlan_id = vlan_id;
+	idx = mac_acl_hash(addr, acl->hash_bits);
+	entry->next = acl->hash[idx];
+	acl->hash[idx] = entry;
+	acl->num++;
+
+	return 0;
+}
+
+
+/**
+ * mac_acl_del - Remove an address from a MAC ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * Returns: 1 if the address was removed or 0 if it was not in the list
+ */
+int mac_acl_del(struct mac_acl *acl, const u8 *addr)
+{
+	struct mac_acl_entry **pos, *entry;
+
+	pos = mac_acl_find(acl, addr);
+	if (!pos)
+		return 0;
+
+	entry = *pos;
+	*pos = entry->next;
+	os_free(entry);
+	acl->num--;
+
+	return 1;
+}
+
+
+/**
+ * mac_acl_get - Find an address from a MAC ACL
+ * @acl: MAC ACL
+ * @addr: MAC address
+ * Returns: Pointer to the entry or %NULL if the address is not in the list
+ */
+const struct mac_acl_entry * mac_acl_get(const struct mac_acl *acl,
+					 const u8 *addr)
+{
+	struct mac_acl_entry **pos;
+
+	pos = mac_acl_find(acl, addr);
+	return pos ? *pos : NULL;
+}
+
+
+/**
+ * mac_acl_for_each - Iterate over all entries of a MAC ACL
+ * @acl: MAC ACL
+ * @cb: Callback function; a nonzero return value stops the iteration
+ * @ctx: Context data for the callback
+ * Returns: The last return value from the callback
+ *
+ * The entries are not in any particular order.
+ */
+int mac_acl_for_each(const struct mac_acl *acl,
+		     int (*cb)(const struct mac_acl_entry *entry, void *ctx),
+		     void *ctx)
+{
+	struct mac_acl_entry *entry;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; acl->hash && i < (1U << acl->hash_bits); i++) {
+		for (entry = acl->hash[i]; entry; entry = entry->next) {
+			ret = cb(entry, ctx);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return ret;
+}
+
+
+/**
+ * mac_acl_clear - Remove all addresses from a MAC ACL
+ * @acl: MAC ACL
+ *
+ * This frees all memory allocated for the list.
+ */
+void mac_acl_clear(struct mac_acl *acl)
+{
+	struct mac_acl_entry *entry, *next;
+	unsigned int i;
+
+	for (i = 0; acl->hash && i < (1U << acl->hash_bits); i++) {
+		for (entry = acl->hash[i]; entry; entry = next) {
+			next = entry->next;
+			os_free(entry);
+		}
+	}
+
+	os_free(acl->hash);
+	acl->hash = NULL;
+	acl->hash_bits = 0;
+	acl->num = 0;
+}
+
+
+/**
+ * mac_acl_merge - Move all addresses from one MAC ACL into another
+ * @acl: MAC ACL to update
+ * @src: MAC ACL whose entries are moved; this is left empty
+ *
+ * Addresses that are already in @acl get the VLAN ID from @src. The entries
+ * are moved instead of copied, so this cannot fail and a batch of addresses
+ * prepared in a separate list can be applied as a whole.
+ */
+void mac_acl_merge(struct mac_acl *acl, struct mac_acl *src)
+{
+	struct mac_acl_entry **pos, *entry, *next;
+	unsigned int i, idx, bits;
+
+	if (!acl->hash) {
+		*acl = *src;
+		os_memset(src, 0, sizeof(*src));
+		return;
+	}
+
+	/* A failure to grow the table only makes the chains longer */
+	bits = acl->hash_bits;
+	while (acl->num + src->num > (1U << bits) &&
+	       bits < MAC_ACL_MAX_HASH_BITS)
+		bits++;
+	if (bits != acl->hash_bits)
+		mac_acl_resize(acl, bits);
+
+	for (i = 0; src->hash && i < (1U << src->hash_bits); i++) {
+		for (entry = src->hash[i]; entry; entry = next) {
+			next = entry->next;
+			pos = mac_acl_find(acl, entry->addr);
+			if (pos) {
+				(*pos)->vlan_id = entry->vlan_id;
+				os_free(entry);
+				continue;
+			}
+			idx = mac_acl_hash(entry->addr, acl->hash_bits);
+			entry->next = acl->hash[idx];
+			acl->hash[idx] = entry;
+			acl->num++;
+		}
+	}
+
+	os_free(src->hash);
+	os_memset(src, 0, sizeof(*src));
+}
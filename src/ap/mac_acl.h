@@ -0,0 +1,45 @@
+/*
+ * hostapd / MAC address access control lists
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef MAC_ACL_H
+#define MAC_ACL_H
+
+struct mac_acl_entry {
+	struct mac_acl_entry *next; /* next entry in the same hash bucket */
+	u8 addr[ETH_ALEN];
+	int vlan_id; /* untagged VLAN ID or 0 if not specified */
+};
+
+/**
+ * struct mac_acl - Set of MAC addresses
+ *
+ * Addresses are kept in a hash table that is grown as entries are added so
+ * that lookups, additions, and removals take constant time regardless of the
+ * size of the list. An all-zeros structure is a valid empty list.
+ */
+struct mac_acl {
+	struct mac_acl_entry **hash;
+	unsigned int hash_bits;
+	unsigned int num;
+};
+
+int mac_acl_add(struct mac_acl *acl, const u8 *addr, int vlan_id);
+int mac_acl_del(struct mac_acl *acl, const u8 *addr);
+const struct mac_acl_entry * mac_acl_get(const struct mac_acl *acl,
+					 const u8 *addr);
+int mac_acl_for_each(const struct mac_acl *acl,
+		     int (*cb)(const struct mac_acl_entry *entry, void *ctx),
+		     void *ctx);
+void mac_acl_clear(struct mac_acl *acl);
+void mac_acl_merge(struct mac_acl *acl, struct mac_acl *src);
+
+static inline unsigned int mac_acl_count(const struct mac_acl *acl)
+{
+	return acl->num;
+}
+
+#endif /* MAC_ACL_H */
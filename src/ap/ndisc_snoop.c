@@ -22,6 +22,8 @@
 struct ip6addr {
 	struct in6_addr addr;
 	struct dl_list list;
+	struct ip6addr *hnext; /* next entry in hapd->ip6addr_hash */
+	struct sta_info *sta;
 };
 
 struct icmpv6_ndmsg {
@@ -38,22 +40,49 @@ struct icmpv6_ndmsg {
 #define NEIGHBOR_ADVERTISEMENT	136
 #define SOURCE_LL_ADDR		1
 
-static int sta_ip6addr_add(struct sta_info *sta, struct in6_addr *addr)
+/* Maximum number of STAs per batched multicast-to-unicast transmission */
+#define UCAST_BATCH_MAX		32
+
+#define IP6ADDR_HASH(a) ((a)->s6_addr[15] % IP6ADDR_HASH_SIZE)
+
+static int sta_ip6addr_add(struct hostapd_data *hapd, struct sta_info *sta,
+			   struct in6_addr *addr)
 {
 	struct ip6addr *ip6addr;
+	unsigned int idx;
 
 	ip6addr = os_zalloc(sizeof(*ip6addr));
 	if (!ip6addr)
 		return -1;
 
 	os_memcpy(&ip6addr->addr, addr, sizeof(*addr));
+	ip6addr->sta = sta;
 
 	dl_list_add_tail(&sta->ip6addr, &ip6addr->list);
+	idx = IP6ADDR_HASH(addr);
+	ip6addr->hnext = hapd->ip6addr_hash[idx];
+	hapd->ip6addr_hash[idx] = ip6addr;
 
 	return 0;
 }
 
 
+static void ip6addr_hash_del(struct hostapd_data *hapd,
+			     struct ip6addr *ip6addr)
+{
+	struct ip6addr **pos;
+
+	pos = &hapd->ip6addr_hash[IP6ADDR_HASH(&ip6addr->addr)];
+	while (*pos) {
+		if (*pos == ip6addr) {
+			*pos = ip6addr->hnext;
+			return;
+		}
+		pos = &(*pos)->hnext;
+	}
+}
+
+
 void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	struct ip6addr *ip6addr, *prev;
@@ -61,6 +90,8 @@ void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
 	dl_list_for_each_safe(ip6addr, prev, &sta->ip6addr, struct ip6addr,
 			      list) {
 		hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &ip6addr->addr);
+		dl_list_del(&ip6addr->list);
+		ip6addr_hash_del(hapd, ip6addr);
 		os_free(ip6addr);
 	}
 }
@@ -82,15 +113,111 @@ static int sta_has_ip6addr(struct sta_info *sta, struct in6_addr *addr)
 }
 
 
+static int is_solicited_node_mcast(const struct in6_addr *addr)
+{
+	/* ff02::1:ff00:0/104 */
+	static const u8 prefix[13] = {
+		0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0xff
+	};
+
+	return os_memcmp(addr->s6_addr, prefix, sizeof(prefix)) == 0;
+}
+
+
+static int ip6addr_in_group(const struct ip6addr *ip6addr,
+			    const struct in6_addr *group)
+{
+	return os_memcmp(&ip6addr->addr.s6_addr[13], &group->s6_addr[13],
+			 3) == 0;
+}
+
+
+static size_t ucast_to_group_stas(struct hostapd_data *hapd, const u8 *buf,
+				  size_t len)
+{
+	const struct ip6_hdr *ipv6h;
+	struct in6_addr daddr;
+	struct ip6addr *ip6addr, *prev, *head;
+	struct sta_info *sta;
+	u8 addrs[UCAST_BATCH_MAX * ETH_ALEN];
+	size_t num = 0, total = 0, num_auth = 0;
+
+	ipv6h = (const struct ip6_hdr *) &buf[ETH_HLEN];
+	os_memcpy(&daddr, &ipv6h->ip6_dst, sizeof(daddr));
+	if (!is_solicited_node_mcast(&daddr))
+		return 0;
+
+	head = hapd->ip6addr_hash[IP6ADDR_HASH(&daddr)];
+	for (ip6addr = head; ip6addr; ip6addr = ip6addr->hnext) {
+		sta = ip6addr->sta;
+		if (!ip6addr_in_group(ip6addr, &daddr) ||
+		    !(sta->flags & WLAN_STA_AUTHORIZED))
+			continue;
+
+		/* Link-local and global addresses of a STA commonly share the
+		 * group, so send only one copy per STA */
+		for (prev = head; prev != ip6addr; prev = prev->hnext) {
+			if (prev->sta == sta && ip6addr_in_group(prev, &daddr))
+				break;
+		}
+		if (prev != ip6addr)
+			continue;
+
+		os_memcpy(&addrs[num * ETH_ALEN], sta->addr, ETH_ALEN);
+		total++;
+		if (++num == UCAST_BATCH_MAX) {
+			x_snoop_mcast_to_ucast_convert_send_multi(
+				hapd, addrs, num, (u8 *) buf, len);
+			num = 0;
+		}
+	}
+
+	if (total == 0)
+		return 0;
+
+	x_snoop_mcast_to_ucast_convert_send_multi(hapd, addrs, num,
+						  (u8 *) buf, len);
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (sta->flags & WLAN_STA_AUTHORIZED)
+			num_auth++;
+	}
+	if (num_auth > total)
+		hapd->mcast_to_ucast_suppressed += num_auth - total;
+
+	return total;
+}
+
+
 static void ucast_to_stas(struct hostapd_data *hapd, const u8 *buf, size_t len)
 {
 	struct sta_info *sta;
+	u8 addrs[UCAST_BATCH_MAX * ETH_ALEN];
+	size_t num = 0;
+
+	/*
+	 * A frame to a solicited-node multicast address is of interest only
+	 * to the STAs owning an address in that group. The snooped addresses
+	 * may not cover all the addresses of a STA, so this is optional and
+	 * falls back to all STAs if no snooped address matches.
+	 */
+	if (hapd->conf->ndisc_mcast_targeted &&
+	    ucast_to_group_stas(hapd, buf, len) > 0)
+		return;
 
 	for (sta = hapd->sta_list; sta; sta = sta->next) {
 		if (!(sta->flags & WLAN_STA_AUTHORIZED))
 			continue;
-		x_snoop_mcast_to_ucast_convert_send(hapd, sta, (u8 *) buf, len);
+		os_memcpy(&addrs[num * ETH_ALEN], sta->addr, ETH_ALEN);
+		if (++num == UCAST_BATCH_MAX) {
+			x_snoop_mcast_to_ucast_convert_send_multi(
+				hapd, addrs, num, (u8 *) buf, len);
+			num = 0;
+		}
 	}
+
+	x_snoop_mcast_to_ucast_convert_send_multi(hapd, addrs, num,
+						  (u8 *) buf, len);
 }
 
 
@@ -146,7 +273,7 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 				return;
 			}
 
-			if (sta_ip6addr_add(sta, &saddr))
+			if (sta_ip6addr_add(hapd, sta, &saddr))
 				return;
 		}
 		break;
@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/slab.h"
 #include "common/ieee802_11_defs.h"
 #include "common/wpa_ctrl.h"
 #include "common/sae.h"
@@ -48,6 +49,13 @@ static void ap_sta_deauth_cb_timeout(void *eloop_ctx, void *timeout_ctx);
 static void ap_sta_disassoc_cb_timeout(void *eloop_ctx, void *timeout_ctx);
 static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx);
 static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta);
+
+static struct slab_cache sta_info_cache =
+	SLAB_CACHE_INIT("sta_info", sizeof(struct sta_info));
+#ifdef CONFIG_SAE
+static struct slab_cache sta_sae_cache =
+	SLAB_CACHE_INIT("sae_data", sizeof(struct sae_data));
+#endif /* CONFIG_SAE */
 static void ap_sta_delayed_1x_auth_fail_cb(void *eloop_ctx, void *timeout_ctx);
 
 int ap_for_each_sta(struct hostapd_data *hapd,
@@ -187,6 +195,28 @@ void ap_free_sta_pasn(struct hostapd_data *hapd, struct sta_info *sta)
 
 #endif /* CONFIG_PASN */
 
+static void ap_sta_mark_removed(struct hostapd_data *hapd,
+				struct sta_info *sta)
+{
+	struct sta_removed_entry *e;
+
+	e = &hapd->sta_removed[hapd->sta_removed_next];
+	if (e->gen)
+		hapd->sta_removed_lost = e->gen;
+	os_memcpy(e->addr, sta->addr, ETH_ALEN);
+	e->gen = ++hapd->sta_change_gen;
+	e->list_seq = sta->list_seq;
+	hapd->sta_removed_next = (hapd->sta_removed_next + 1) %
+		STA_REMOVED_TRACK;
+}
+
+
+void ap_sta_mark_changed(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	sta->change_gen = ++hapd->sta_change_gen;
+}
+
+
 void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	int set_beacon = 0;
@@ -212,6 +242,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 
 	ap_sta_hash_del(hapd, sta);
 	ap_sta_list_del(hapd, sta);
+	ap_sta_mark_removed(hapd, sta);
 
 	if (sta->aid > 0)
 		hapd->sta_aid[(sta->aid - 1) / 32] &=
@@ -368,7 +399,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 
 #ifdef CONFIG_SAE
 	sae_clear_data(sta->sae);
-	os_free(sta->sae);
+	slab_free(&sta_sae_cache, sta->sae);
 #endif /* CONFIG_SAE */
 
 	mbo_ap_sta_free(sta);
@@ -413,7 +444,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	forced_memzero(sta->last_tk, WPA_TK_MAX_LEN);
 #endif /* CONFIG_TESTING_OPTIONS */
 
-	os_free(sta);
+	slab_free(&sta_info_cache, sta);
 }
 
 
@@ -723,14 +754,14 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	sta = slab_zalloc(&sta_info_cache);
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
 	}
 	sta->acct_interim_interval = hapd->conf->acct_interim_interval;
 	if (accounting_sta_get_id(hapd, sta) < 0) {
-		os_free(sta);
+		slab_free(&sta_info_cache, sta);
 		return NULL;
 	}
 
@@ -756,11 +787,13 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 	os_memcpy(sta->addr, addr, ETH_ALEN);
 	sta->next = hapd->sta_list;
 	hapd->sta_list = sta;
+	sta->list_seq = ++hapd->sta_list_seq;
 	hapd->num_sta++;
 	ap_sta_hash_add(hapd, sta);
 	ap_sta_remove_in_other_bss(hapd, sta);
 	sta->last_seq_ctrl = WLAN_INVALID_MGMT_SEQ;
 	dl_list_init(&sta->ip6addr);
+	ap_sta_mark_changed(hapd, sta);
 
 #ifdef CONFIG_TAXONOMY
 	sta_track_claim_taxonomy_info(hapd->iface, addr,
@@ -1053,6 +1086,8 @@ done:
 	sta->vlan_id = vlan_id;
 	sta->vlan_desc = vlan ? &vlan->vlan_desc : NULL;
 
+	if (vlan_id != old_vlan_id)
+		ap_sta_mark_changed(hapd, sta);
 	if (vlan_id != old_vlan_id && old_vlan_id)
 		vlan_remove_dynamic(hapd, old_vlan_id);
 
@@ -1276,6 +1311,7 @@ void ap_sta_set_authorized(struct hostapd_data *hapd, struct sta_info *sta,
 		sta->flags |= WLAN_STA_AUTHORIZED;
 	else
 		sta->flags &= ~WLAN_STA_AUTHORIZED;
+	ap_sta_mark_changed(hapd, sta);
 
 #ifdef CONFIG_P2P
 	if (hapd->p2p_group == NULL) {
@@ -1546,14 +1582,13 @@ int ap_sta_re_add(struct hostapd_data *hapd, struct sta_info *sta)
 	 * completed association.
 	 */
 	ap_sta_set_authorized(hapd, sta, 0);
-	hostapd_drv_sta_remove(hapd, sta->addr);
 	sta->flags &= ~(WLAN_STA_ASSOC | WLAN_STA_AUTH | WLAN_STA_AUTHORIZED);
 
 	if (hostapd_sta_add(hapd, sta->addr, 0, 0,
 			    sta->supported_rates,
 			    sta->supported_rates_len,
 			    0, NULL, NULL, NULL, 0, NULL,
-			    sta->flags, 0, 0, 0, 0)) {
+			    sta->flags, 0, 0, 0, 0, 1)) {
 		hostapd_logger(hapd, sta->addr,
 			       HOSTAPD_MODULE_IEEE80211,
 			       HOSTAPD_LEVEL_NOTICE,
@@ -1564,3 +1599,92 @@ int ap_sta_re_add(struct hostapd_data *hapd, struct sta_info *sta)
 	sta->added_unassoc = 1;
 	return 0;
 }
+
+
+#ifdef CONFIG_SAE
+/**
+ * ap_sta_alloc_sae - Allocate SAE data for a station
+ * @sta: Station entry
+ * Returns: 0 on success, -1 on failure
+ *
+ * The data is freed in ap_free_sta().
+ */
+int ap_sta_alloc_sae(struct sta_info *sta)
+{
+	sta->sae = slab_zalloc(&sta_sae_cache);
+	return sta->sae ? 0 : -1;
+}
+#endif /* CONFIG_SAE */
+
+
+/**
+ * ap_sta_mem_usage - Get the amount of memory used by a station
+ * @sta: Station entry
+ * Returns: Approximate number of octets allocated for the station entry and
+ * the state machines and buffers attached to it
+ */
+size_t ap_sta_mem_usage(struct sta_info *sta)
+{
+	size_t len = sizeof(*sta);
+	struct hostapd_sta_wpa_psk_short *psk;
+
+	len += wpa_auth_sta_mem_usage(sta->wpa_sm);
+	len += ieee802_1x_sta_mem_usage(sta);
+
+#ifdef CONFIG_SAE
+	if (sta->sae) {
+		len += sizeof(*sta->sae);
+		if (sta->sae->tmp)
+			len += sizeof(*sta->sae->tmp);
+	}
+#endif /* CONFIG_SAE */
+
+	if (sta->challenge)
+		len += WLAN_AUTH_CHALLENGE_LEN;
+	if (sta->sa_query_trans_id)
+		len += sta->sa_query_count * WLAN_SA_QUERY_TR_ID_LEN;
+	if (sta->ht_capabilities)
+		len += sizeof(*sta->ht_capabilities);
+	if (sta->vht_capabilities)
+		len += sizeof(*sta->vht_capabilities);
+	if (sta->vht_operation)
+		len += sizeof(*sta->vht_operation);
+	len += sta->he_capab_len;
+	if (sta->he_6ghz_capab)
+		len += sizeof(*sta->he_6ghz_capab);
+	if (sta->supp_op_classes)
+		len += 1 + sta->supp_op_classes[0];
+	if (sta->ext_capability)
+		len += 1 + sta->ext_capability[0];
+	for (psk = sta->psk; psk; psk = psk->next)
+		len += sizeof(*psk);
+	if (sta->identity)
+		len += os_strlen(sta->identity) + 1;
+	if (sta->radius_cui)
+		len += os_strlen(sta->radius_cui) + 1;
+
+	len += wpabuf_mem_usage(sta->wps_ie);
+	len += wpabuf_mem_usage(sta->p2p_ie);
+	len += wpabuf_mem_usage(sta->hs20_ie);
+	len += wpabuf_mem_usage(sta->roaming_consortium);
+	len += wpabuf_mem_usage(sta->hs20_deauth_req);
+#ifdef CONFIG_FST
+	len += wpabuf_mem_usage(sta->mb_ies);
+#endif /* CONFIG_FST */
+#ifdef CONFIG_TAXONOMY
+	len += wpabuf_mem_usage(sta->probe_ie_taxonomy);
+	len += wpabuf_mem_usage(sta->assoc_ie_taxonomy);
+#endif /* CONFIG_TAXONOMY */
+#ifdef CONFIG_FILS
+	len += sta->fils_pending_assoc_req_len;
+	len += wpabuf_mem_usage(sta->fils_hlp_resp);
+	len += wpabuf_mem_usage(sta->hlp_dhcp_discover);
+	len += wpabuf_mem_usage(sta->fils_dh_ss);
+	len += wpabuf_mem_usage(sta->fils_g_sta);
+#endif /* CONFIG_FILS */
+#ifdef CONFIG_OWE
+	len += sta->owe_pmk_len;
+#endif /* CONFIG_OWE */
+
+	return len;
+}
@@ -117,6 +117,8 @@ struct sta_info {
 	u8 supported_rates[WLAN_SUPP_RATES_MAX];
 	int supported_rates_len;
 	u8 qosinfo; /* Valid when WLAN_STA_WMM is set */
+	unsigned int change_gen; /* hapd->sta_change_gen at last change */
+	unsigned int list_seq; /* hapd->sta_list_seq when added to sta_list */
 
 #ifdef CONFIG_MESH
 	enum mesh_plink_state plink_state;
@@ -185,6 +187,8 @@ struct sta_info {
 	int acct_terminate_cause; /* Acct-Terminate-Cause */
 	int acct_interim_interval; /* Acct-Interim-Interval */
 	unsigned int acct_interim_errors;
+	struct dl_list acct_list; /* entry in the interim update schedule */
+	os_time_t acct_next_update; /* os_reltime seconds */
 
 	/* For extending 32-bit driver counters to 64-bit counters */
 	u32 last_rx_bytes_hi;
@@ -401,6 +405,7 @@ void ap_sta_clear_disconnect_timeouts(struct hostapd_data *hapd,
 				      struct sta_info *sta);
 
 int ap_sta_flags_txt(u32 flags, char *buf, size_t buflen);
+void ap_sta_mark_changed(struct hostapd_data *hapd, struct sta_info *sta);
 void ap_sta_delayed_1x_auth_fail_disconnect(struct hostapd_data *hapd,
 					    struct sta_info *sta);
 int ap_sta_pending_delayed_1x_auth_fail_disconnect(struct hostapd_data *hapd,
@@ -409,4 +414,7 @@ int ap_sta_re_add(struct hostapd_data *hapd, struct sta_info *sta);
 
 void ap_free_sta_pasn(struct hostapd_data *hapd, struct sta_info *sta);
 
+int ap_sta_alloc_sae(struct sta_info *sta);
+size_t ap_sta_mem_usage(struct sta_info *sta);
+
 #endif /* STA_INFO_H */
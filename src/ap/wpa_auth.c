@@ -12,6 +12,7 @@
 #include "utils/eloop.h"
 #include "utils/state_machine.h"
 #include "utils/bitfield.h"
+#include "utils/slab.h"
 #include "common/ieee802_11_defs.h"
 #include "common/ocv.h"
 #include "common/dpp.h"
@@ -78,6 +79,9 @@ static const int dot11RSNAConfigPMKLifetime = 43200;
 static const int dot11RSNAConfigPMKReauthThreshold = 70;
 static const int dot11RSNAConfigSATimeout = 60;
 
+static struct slab_cache wpa_sm_cache =
+	SLAB_CACHE_INIT("wpa_state_machine", sizeof(struct wpa_state_machine));
+
 
 static inline int wpa_auth_mic_failure_report(
 	struct wpa_authenticator *wpa_auth, const u8 *addr)
@@ -653,7 +657,7 @@ wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 	if (wpa_auth->group->wpa_group_state == WPA_GROUP_FATAL_FAILURE)
 		return NULL;
 
-	sm = os_zalloc(sizeof(struct wpa_state_machine));
+	sm = slab_zalloc(&wpa_sm_cache);
 	if (!sm)
 		return NULL;
 	os_memcpy(sm->addr, addr, ETH_ALEN);
@@ -758,7 +762,7 @@ static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 #ifdef CONFIG_DPP2
 	wpabuf_clear_free(sm->dpp_z);
 #endif /* CONFIG_DPP2 */
-	bin_clear_free(sm, sizeof(*sm));
+	slab_clear_free(&wpa_sm_cache, sm);
 }
 
 
@@ -1413,10 +1417,18 @@ continue_processing:
 		wpa_replay_counter_mark_invalid(sm->key_replay, NULL);
 	}
 
-	os_free(sm->last_rx_eapol_key);
-	sm->last_rx_eapol_key = os_memdup(data, data_len);
-	if (!sm->last_rx_eapol_key)
-		return;
+	/* Keep the buffer allocated for the following frames of the handshake;
+	 * the frames from the Supplicant are of similar size. */
+	if (data_len > sm->last_rx_eapol_key_size) {
+		os_free(sm->last_rx_eapol_key);
+		sm->last_rx_eapol_key_len = 0;
+		sm->last_rx_eapol_key_size = 0;
+		sm->last_rx_eapol_key = os_malloc(data_len);
+		if (!sm->last_rx_eapol_key)
+			return;
+		sm->last_rx_eapol_key_size = data_len;
+	}
+	os_memcpy(sm->last_rx_eapol_key, data, data_len);
 	sm->last_rx_eapol_key_len = data_len;
 
 	sm->rx_eapol_key_secure = !!(key_info & WPA_KEY_INFO_SECURE);
@@ -4617,6 +4629,33 @@ int wpa_get_mib(struct wpa_authenticator *wpa_auth, char *buf, size_t buflen)
 }
 
 
+/**
+ * wpa_auth_sta_mem_usage - Get the amount of memory used by a state machine
+ * @sm: Pointer to WPA state machine data from wpa_auth_sta_init() or %NULL
+ * Returns: Approximate number of octets allocated for the state machine
+ */
+size_t wpa_auth_sta_mem_usage(struct wpa_state_machine *sm)
+{
+	size_t len;
+
+	if (!sm)
+		return 0;
+
+	len = sizeof(*sm) + sm->wpa_ie_len + sm->rsnxe_len +
+		sm->last_rx_eapol_key_size;
+#ifdef CONFIG_IEEE80211R_AP
+	if (sm->assoc_resp_ftie)
+		len += 2 + sm->assoc_resp_ftie[1];
+	len += wpabuf_mem_usage(sm->ft_pending_req_ies);
+#endif /* CONFIG_IEEE80211R_AP */
+#ifdef CONFIG_DPP2
+	len += wpabuf_mem_usage(sm->dpp_z);
+#endif /* CONFIG_DPP2 */
+
+	return len;
+}
+
+
 int wpa_get_mib_sta(struct wpa_state_machine *sm, char *buf, size_t buflen)
 {
 	int len = 0, ret;
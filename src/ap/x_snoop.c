@@ -116,6 +116,8 @@ void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
 		wpa_printf(MSG_DEBUG,
 			   "x_snoop: Failed to send mcast to ucast converted packet to "
 			   MACSTR, MAC2STR(sta->addr));
+	} else {
+		hapd->mcast_to_ucast_converted++;
 	}
 
 	/* restore the multicast destination address */
@@ -123,6 +125,54 @@ void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
 }
 
 
+/**
+ * x_snoop_mcast_to_ucast_convert_send_multi - Convert to unicast for STAs
+ * @hapd: Pointer to BSS data
+ * @addrs: STA addresses (num * ETH_ALEN octets)
+ * @num: Number of STAs
+ * @buf: Multicast frame including the Ethernet header
+ * @len: Length of the frame
+ */
+void x_snoop_mcast_to_ucast_convert_send_multi(struct hostapd_data *hapd,
+					       const u8 *addrs, size_t num,
+					       u8 *buf, size_t len)
+{
+	int res;
+	size_t i;
+	u8 addr[ETH_ALEN];
+
+	if (!(buf[0] & 0x01) || num == 0)
+		return;
+
+	wpa_printf(MSG_EXCESSIVE, "x_snoop: Multicast-to-unicast conversion "
+		   MACSTR " -> %u STAs (len %u)", MAC2STR(buf),
+		   (unsigned int) num, (unsigned int) len);
+
+	res = l2_packet_send_multi(hapd->sock_dhcp, buf, len, addrs, num);
+	if (res >= 0) {
+		if ((size_t) res < num)
+			wpa_printf(MSG_DEBUG,
+				   "x_snoop: Sent only %d/%u mcast to ucast converted packets",
+				   res, (unsigned int) num);
+		hapd->mcast_to_ucast_converted += res;
+		return;
+	}
+
+	/* Batched transmission not available; send the copies one by one */
+	os_memcpy(addr, buf, ETH_ALEN);
+	for (i = 0; i < num; i++) {
+		os_memcpy(buf, &addrs[i * ETH_ALEN], ETH_ALEN);
+		if (l2_packet_send(hapd->sock_dhcp, NULL, 0, buf, len) < 0)
+			wpa_printf(MSG_DEBUG,
+				   "x_snoop: Failed to send mcast to ucast converted packet to "
+				   MACSTR, MAC2STR(&addrs[i * ETH_ALEN]));
+		else
+			hapd->mcast_to_ucast_converted++;
+	}
+	os_memcpy(buf, addr, ETH_ALEN);
+}
+
+
 void x_snoop_deinit(struct hostapd_data *hapd)
 {
 	hostapd_drv_br_set_net_param(hapd, DRV_BR_NET_PARAM_GARP_ACCEPT, 0);
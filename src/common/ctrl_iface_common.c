@@ -12,6 +12,7 @@
 #include <sys/un.h>
 
 #include "utils/common.h"
+#include "utils/eloop.h"
 #include "ctrl_iface_common.h"
 
 static int sockaddr_compare(struct sockaddr_storage *a, socklen_t a_len,
@@ -74,8 +75,8 @@ static int sockaddr_compare(struct sockaddr_storage *a, socklen_t a_len,
 }
 
 
-void sockaddr_print(int level, const char *msg, struct sockaddr_storage *sock,
-		    socklen_t socklen)
+static int sockaddr_txt(struct sockaddr_storage *sock, socklen_t socklen,
+			char *buf, size_t buflen)
 {
 	switch (sock->ss_family) {
 #ifdef CONFIG_CTRL_IFACE_UDP
@@ -84,56 +85,97 @@ void sockaddr_print(int level, const char *msg, struct sockaddr_storage *sock,
 	{
 		char host[NI_MAXHOST] = { 0 };
 		char service[NI_MAXSERV] = { 0 };
+		int res;
 
 		getnameinfo((struct sockaddr *) sock, socklen,
 			    host, sizeof(host),
 			    service, sizeof(service),
 			    NI_NUMERICHOST);
 
-		wpa_printf(level, "%s %s:%s", msg, host, service);
-		break;
+		res = os_snprintf(buf, buflen, "%s:%s", host, service);
+		if (os_snprintf_error(buflen, res))
+			return -1;
+		return 0;
 	}
 #endif /* CONFIG_CTRL_IFACE_UDP */
 #ifdef CONFIG_CTRL_IFACE_UNIX
 	case AF_UNIX:
-	{
-		char addr_txt[200];
-
-		printf_encode(addr_txt, sizeof(addr_txt),
+		printf_encode(buf, buflen,
 			      (u8 *) ((struct sockaddr_un *) sock)->sun_path,
 			      socklen - offsetof(struct sockaddr_un, sun_path));
-		wpa_printf(level, "%s %s", msg, addr_txt);
-		break;
-	}
+		return 0;
 #endif /* CONFIG_CTRL_IFACE_UNIX */
 	default:
-		wpa_printf(level, "%s", msg);
-		break;
+		return -1;
 	}
 }
 
 
+void sockaddr_print(int level, const char *msg, struct sockaddr_storage *sock,
+		    socklen_t socklen)
+{
+	char addr_txt[200];
+
+	if (sockaddr_txt(sock, socklen, addr_txt, sizeof(addr_txt)) == 0)
+		wpa_printf(level, "%s %s", msg, addr_txt);
+	else
+		wpa_printf(level, "%s", msg);
+}
+
+
+static void ctrl_free_dst(struct wpa_ctrl_dst *dst)
+{
+	os_free(dst->filter);
+	wpabuf_free(dst->batch_buf);
+	os_free(dst);
+}
+
+
 static int ctrl_set_events(struct wpa_ctrl_dst *dst, const char *input)
 {
-	const char *value;
+	const char *pos, *end, *value;
 	int val;
 
 	if (!input)
 		return 0;
 
-	value = os_strchr(input, '=');
-	if (!value)
-		return -1;
-	value++;
-	val = atoi(value);
-	if (val < 0 || val > 1)
-		return -1;
+	for (pos = input; *pos; pos = end) {
+		while (*pos == ' ')
+			pos++;
+		if (!*pos)
+			break;
+		end = os_strchr(pos, ' ');
+		if (!end)
+			end = pos + os_strlen(pos);
+
+		value = os_strchr(pos, '=');
+		if (!value || value > end)
+			return -1;
+		value++;
+
+		if (str_starts(pos, "filter=")) {
+			os_free(dst->filter);
+			dst->filter = NULL;
+			if (end > value) {
+				dst->filter = dup_binstr(value, end - value);
+				if (!dst->filter)
+					return -1;
+			}
+			continue;
+		}
 
-	if (str_starts(input, "probe_rx_events=")) {
-		if (val)
-			dst->events |= WPA_EVENT_RX_PROBE_REQUEST;
-		else
-			dst->events &= ~WPA_EVENT_RX_PROBE_REQUEST;
+		val = atoi(value);
+		if (val < 0 || val > 1)
+			return -1;
+
+		if (str_starts(pos, "probe_rx_events=")) {
+			if (val)
+				dst->events |= WPA_EVENT_RX_PROBE_REQUEST;
+			else
+				dst->events &= ~WPA_EVENT_RX_PROBE_REQUEST;
+		} else if (str_starts(pos, "batch=")) {
+			dst->batch = val;
+		}
 	}
 
 	return 0;
@@ -178,7 +220,7 @@ int ctrl_iface_detach(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 			sockaddr_print(MSG_DEBUG, "CTRL_IFACE monitor detached",
 				       from, fromlen);
 			dl_list_del(&dst->list);
-			os_free(dst);
+			ctrl_free_dst(dst);
 			return 0;
 		}
 	}
@@ -207,3 +249,244 @@ int ctrl_iface_level(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 
 	return -1;
 }
+
+
+/**
+ * ctrl_iface_event_filter - Check whether an event passes the monitor filter
+ * @dst: Control interface monitor
+ * @buf: Event message without the level prefix
+ * @len: Length of @buf
+ * Returns: 1 if the event is to be sent to the monitor or 0 if not
+ */
+int ctrl_iface_event_filter(struct wpa_ctrl_dst *dst, const char *buf,
+			    size_t len)
+{
+	const char *pos, *end;
+
+	if (!dst->filter)
+		return 1;
+
+	for (pos = dst->filter; *pos; pos = end) {
+		end = os_strchr(pos, ',');
+		if (!end)
+			end = pos + os_strlen(pos);
+		if (end > pos && (size_t) (end - pos) <= len &&
+		    os_memcmp(buf, pos, end - pos) == 0)
+			return 1;
+		if (*end == ',')
+			end++;
+	}
+
+	return 0;
+}
+
+
+/* Returns -1 if the monitor was detached and freed */
+static int ctrl_iface_batch_send(int sock, struct dl_list *ctrl_dst,
+				 struct wpa_ctrl_dst *dst)
+{
+	u8 hdr[WPA_CTRL_BATCH_HDR_LEN];
+	struct msghdr msg;
+	struct iovec io[2];
+	unsigned int count = dst->batch_count;
+	int _errno;
+	char txt[200];
+
+	if (!count)
+		return 0;
+	dst->batch_count = 0;
+
+	os_memcpy(hdr, WPA_CTRL_BATCH_MAGIC, 4);
+	WPA_PUT_LE32(&hdr[4], dst->batch_seq);
+	WPA_PUT_LE32(&hdr[8], dst->lost);
+	WPA_PUT_LE16(&hdr[12], count);
+	io[0].iov_base = hdr;
+	io[0].iov_len = sizeof(hdr);
+	io[1].iov_base = wpabuf_mhead(dst->batch_buf);
+	io[1].iov_len = wpabuf_len(dst->batch_buf);
+	os_memset(&msg, 0, sizeof(msg));
+	msg.msg_name = (void *) &dst->addr;
+	msg.msg_namelen = dst->addrlen;
+	msg.msg_iov = io;
+	msg.msg_iovlen = 2;
+
+	if (sock >= 0 && sendmsg(sock, &msg, MSG_DONTWAIT) >= 0) {
+		dst->batch_buf->used = 0;
+		dst->sent += count;
+		dst->errors = 0;
+		return 0;
+	}
+
+	_errno = sock >= 0 ? errno : EBADF;
+	dst->batch_buf->used = 0;
+	dst->lost += count;
+	dst->errors++;
+	os_snprintf(txt, sizeof(txt),
+		    "CTRL_IFACE monitor: %d (%s) - lost %u batched event(s) for",
+		    _errno, strerror(_errno), count);
+	sockaddr_print(MSG_DEBUG, txt, &dst->addr, dst->addrlen);
+
+	if (dst->errors > 10 || _errno == ENOENT || _errno == EPERM) {
+		sockaddr_print(MSG_INFO,
+			       "CTRL_IFACE: Detach monitor that cannot receive messages:",
+			       &dst->addr, dst->addrlen);
+		dl_list_del(&dst->list);
+		ctrl_free_dst(dst);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+static void ctrl_iface_batch_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	ctrl_iface_flush_batches(timeout_ctx, eloop_ctx);
+}
+
+
+/**
+ * ctrl_iface_batch_event - Add an event to the pending batch of a monitor
+ * @sock: Pointer to the local socket fd
+ * @ctrl_dst: List of attached monitors
+ * @dst: Control interface monitor that has requested batching
+ * @io: Event message parts
+ * @iovlen: Number of entries in @io
+ *
+ * The pending batch is sent out once it becomes full or after
+ * WPA_CTRL_BATCH_DELAY_USEC. @dst may be detached and freed if the batch
+ * cannot be delivered.
+ */
+void ctrl_iface_batch_event(int *sock, struct dl_list *ctrl_dst,
+			    struct wpa_ctrl_dst *dst, const struct iovec *io,
+			    size_t iovlen)
+{
+	size_t i, len = 0;
+
+	for (i = 0; i < iovlen; i++)
+		len += io[i].iov_len;
+
+	if (dst->batch_count &&
+	    WPA_CTRL_BATCH_HDR_LEN + wpabuf_len(dst->batch_buf) + 2 + len >
+	    WPA_CTRL_BATCH_MAX_LEN &&
+	    ctrl_iface_batch_send(*sock, ctrl_dst, dst) < 0)
+		return;
+
+	if (len > 0xffff ||
+	    wpabuf_resize(&dst->batch_buf, 2 + len) < 0) {
+		dst->seq++;
+		dst->lost++;
+		return;
+	}
+
+	if (!dst->batch_count)
+		dst->batch_seq = dst->seq;
+	dst->seq++;
+	wpabuf_put_le16(dst->batch_buf, len);
+	for (i = 0; i < iovlen; i++)
+		wpabuf_put_data(dst->batch_buf, io[i].iov_base,
+				io[i].iov_len);
+	dst->batch_count++;
+
+	if (!eloop_is_timeout_registered(ctrl_iface_batch_timeout, ctrl_dst,
+					 sock))
+		eloop_register_timeout(0, WPA_CTRL_BATCH_DELAY_USEC,
+				       ctrl_iface_batch_timeout, ctrl_dst,
+				       sock);
+}
+
+
+/**
+ * ctrl_iface_event_lost - Record an event that was dropped before sending
+ * @ctrl_dst: List of attached monitors
+ * @level: Priority level of the event
+ * @buf: Event message without the level prefix
+ * @len: Length of @buf
+ *
+ * This is used when an event is dropped before it reached the monitors, e.g.,
+ * from a queue of throttled events, so that the loss is visible in the
+ * sequence numbers and loss counters of the monitors that would have
+ * received it.
+ */
+void ctrl_iface_event_lost(struct dl_list *ctrl_dst, int level,
+			   const char *buf, size_t len)
+{
+	struct wpa_ctrl_dst *dst;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		if (level < dst->debug_level ||
+		    !ctrl_iface_event_filter(dst, buf, len))
+			continue;
+		dst->seq++;
+		dst->lost++;
+	}
+}
+
+
+/**
+ * ctrl_iface_flush_batches - Send out all pending batched events
+ * @sock: Pointer to the local socket fd
+ * @ctrl_dst: List of attached monitors
+ */
+void ctrl_iface_flush_batches(int *sock, struct dl_list *ctrl_dst)
+{
+	struct wpa_ctrl_dst *dst, *next;
+
+	eloop_cancel_timeout(ctrl_iface_batch_timeout, ctrl_dst, sock);
+	dl_list_for_each_safe(dst, next, ctrl_dst, struct wpa_ctrl_dst, list)
+		ctrl_iface_batch_send(*sock, ctrl_dst, dst);
+}
+
+
+/**
+ * ctrl_iface_free_dsts - Free all attached monitors
+ * @ctrl_dst: List of attached monitors
+ *
+ * Any pending batched events are dropped. ctrl_iface_flush_batches() can be
+ * used to send them out before calling this.
+ */
+void ctrl_iface_free_dsts(struct dl_list *ctrl_dst)
+{
+	struct wpa_ctrl_dst *dst, *next;
+
+	eloop_cancel_timeout(ctrl_iface_batch_timeout, ctrl_dst,
+			     ELOOP_ALL_CTX);
+	dl_list_for_each_safe(dst, next, ctrl_dst, struct wpa_ctrl_dst, list) {
+		dl_list_del(&dst->list);
+		ctrl_free_dst(dst);
+	}
+}
+
+
+/**
+ * ctrl_iface_monitor_stats - Write event delivery statistics of monitors
+ * @ctrl_dst: List of attached monitors
+ * @buf: Buffer for the response
+ * @buflen: Length of @buf
+ * Returns: Number of octets written to @buf or -1 on failure
+ */
+int ctrl_iface_monitor_stats(struct dl_list *ctrl_dst, char *buf,
+			     size_t buflen)
+{
+	struct wpa_ctrl_dst *dst;
+	char *pos = buf, *end = buf + buflen;
+	char addr_txt[200];
+	int res;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		if (sockaddr_txt(&dst->addr, dst->addrlen, addr_txt,
+				 sizeof(addr_txt)) < 0)
+			os_strlcpy(addr_txt, "?", sizeof(addr_txt));
+		res = os_snprintf(pos, end - pos,
+				  "%s level=%d batch=%d events=%u sent=%u lost=%u pending=%u errors=%d filter=%s\n",
+				  addr_txt, dst->debug_level, dst->batch,
+				  dst->seq, dst->sent, dst->lost,
+				  dst->batch_count, dst->errors,
+				  dst->filter ? dst->filter : "");
+		if (os_snprintf_error(end - pos, res))
+			return pos - buf;
+		pos += res;
+	}
+
+	return pos - buf;
+}
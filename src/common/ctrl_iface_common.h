@@ -14,6 +14,26 @@
 /* Events enable bits (wpa_ctrl_dst::events) */
 #define WPA_EVENT_RX_PROBE_REQUEST BIT(0)
 
+/*
+ * Batched event messages (ATTACH batch=1)
+ *
+ * Events for a monitor that has requested batching are coalesced into a
+ * single datagram that starts with a header of WPA_CTRL_BATCH_HDR_LEN octets:
+ * WPA_CTRL_BATCH_MAGIC, sequence number of the first event in the batch
+ * (le32), total number of events lost for the monitor (le32), and number of
+ * events in the batch (le16). Each event follows as a le16 length field and
+ * the event message in the same format as it would have been sent without
+ * batching. The sequence number is incremented for each event that passes the
+ * monitor's level and filter, so a gap in sequence numbers between batches
+ * shows how many events were dropped.
+ */
+#define WPA_CTRL_BATCH_MAGIC "EVB1"
+#define WPA_CTRL_BATCH_HDR_LEN 14
+/* Maximum length of a batched message unless a single event is longer */
+#define WPA_CTRL_BATCH_MAX_LEN 4096
+/* Maximum time to hold events in a pending batch */
+#define WPA_CTRL_BATCH_DELAY_USEC 10000
+
 /**
  * struct wpa_ctrl_dst - Data structure of control interface monitors
  *
@@ -27,6 +47,14 @@ struct wpa_ctrl_dst {
 	int debug_level;
 	int errors;
 	u32 events; /* WPA_EVENT_* bitmap */
+	char *filter; /* comma separated event prefixes (ATTACH filter=) */
+	unsigned int seq; /* number of events that passed level and filter */
+	unsigned int sent; /* number of events delivered */
+	unsigned int lost; /* number of events that could not be delivered */
+	int batch; /* coalesce events into batched messages (ATTACH batch=1) */
+	struct wpabuf *batch_buf; /* pending batch without the header */
+	unsigned int batch_seq; /* sequence number of the first pending event */
+	unsigned int batch_count; /* number of events in batch_buf */
 };
 
 void sockaddr_print(int level, const char *msg, struct sockaddr_storage *sock,
@@ -38,5 +66,16 @@ int ctrl_iface_detach(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 		      socklen_t fromlen);
 int ctrl_iface_level(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 		     socklen_t fromlen, const char *level);
+int ctrl_iface_event_filter(struct wpa_ctrl_dst *dst, const char *buf,
+			    size_t len);
+void ctrl_iface_batch_event(int *sock, struct dl_list *ctrl_dst,
+			    struct wpa_ctrl_dst *dst, const struct iovec *io,
+			    size_t iovlen);
+void ctrl_iface_event_lost(struct dl_list *ctrl_dst, int level,
+			   const char *buf, size_t len);
+void ctrl_iface_flush_batches(int *sock, struct dl_list *ctrl_dst);
+void ctrl_iface_free_dsts(struct dl_list *ctrl_dst);
+int ctrl_iface_monitor_stats(struct dl_list *ctrl_dst, char *buf,
+			     size_t buflen);
 
 #endif /* CONTROL_IFACE_COMMON_H */
@@ -1324,7 +1324,7 @@ void dpp_auth_deinit(struct dpp_authentication *auth)
 	wpabuf_free(auth->net_access_key);
 	dpp_bootstrap_info_free(auth->tmp_own_bi);
 	if (auth->tmp_peer_bi) {
-		dl_list_del(&auth->tmp_peer_bi->list);
+		dpp_bootstrap_unlink(auth->global, auth->tmp_peer_bi);
 		dpp_bootstrap_info_free(auth->tmp_peer_bi);
 	}
 	os_free(auth->e_name);
@@ -1731,7 +1731,7 @@ static int dpp_get_peer_bi_id(struct dpp_authentication *auth)
 	if (!bi)
 		return -1;
 	bi->id = dpp_next_id(auth->global);
-	dl_list_add(&auth->global->bootstrap, &bi->list);
+	dpp_bootstrap_add(auth->global, bi);
 	auth->tmp_peer_bi = bi;
 	return bi->id;
 }
@@ -4079,6 +4079,71 @@ unsigned int dpp_next_id(struct dpp_global *dpp)
 }
 
 
+static void dpp_bootstrap_hash_add(struct dpp_global *dpp,
+				   struct dpp_bootstrap_info *bi)
+{
+	unsigned int idx;
+
+	idx = DPP_BOOTSTRAP_HASH(bi->pubkey_hash);
+	bi->hnext = dpp->bootstrap_hash[idx];
+	dpp->bootstrap_hash[idx] = bi;
+
+	idx = DPP_BOOTSTRAP_HASH(bi->pubkey_hash_chirp);
+	bi->chirp_hnext = dpp->bootstrap_chirp_hash[idx];
+	dpp->bootstrap_chirp_hash[idx] = bi;
+}
+
+
+static void dpp_bootstrap_hash_del(struct dpp_global *dpp,
+				   struct dpp_bootstrap_info *bi)
+{
+	struct dpp_bootstrap_info **pos;
+
+	pos = &dpp->bootstrap_hash[DPP_BOOTSTRAP_HASH(bi->pubkey_hash)];
+	while (*pos && *pos != bi)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = bi->hnext;
+
+	pos = &dpp->bootstrap_chirp_hash[
+		DPP_BOOTSTRAP_HASH(bi->pubkey_hash_chirp)];
+	while (*pos && *pos != bi)
+		pos = &(*pos)->chirp_hnext;
+	if (*pos)
+		*pos = bi->chirp_hnext;
+}
+
+
+/**
+ * dpp_bootstrap_add - Add bootstrapping information to the global list
+ * @dpp: DPP global data
+ * @bi: Bootstrapping information with pubkey_hash and pubkey_hash_chirp set
+ *
+ * The entry is added to the beginning of the list and to the hash tables
+ * used by dpp_bootstrap_find_pair() and dpp_bootstrap_find_chirp(). The
+ * public key hashes must not be modified while the entry is in the list.
+ */
+void dpp_bootstrap_add(struct dpp_global *dpp, struct dpp_bootstrap_info *bi)
+{
+	dl_list_add(&dpp->bootstrap, &bi->list);
+	dpp_bootstrap_hash_add(dpp, bi);
+}
+
+
+/**
+ * dpp_bootstrap_unlink - Remove bootstrapping information from the global list
+ * @dpp: DPP global data
+ * @bi: Bootstrapping information added with dpp_bootstrap_add()
+ */
+void dpp_bootstrap_unlink(struct dpp_global *dpp,
+			  struct dpp_bootstrap_info *bi)
+{
+	if (dpp)
+		dpp_bootstrap_hash_del(dpp, bi);
+	dl_list_del(&bi->list);
+}
+
+
 static int dpp_bootstrap_del(struct dpp_global *dpp, unsigned int id)
 {
 	struct dpp_bootstrap_info *bi, *tmp;
@@ -4096,7 +4161,7 @@ static int dpp_bootstrap_del(struct dpp_global *dpp, unsigned int id)
 		if (dpp->remove_bi)
 			dpp->remove_bi(dpp->cb_ctx, bi);
 #endif /* CONFIG_DPP2 */
-		dl_list_del(&bi->list);
+		dpp_bootstrap_unlink(dpp, bi);
 		dpp_bootstrap_info_free(bi);
 	}
 
@@ -4120,7 +4185,7 @@ struct dpp_bootstrap_info * dpp_add_qr_code(struct dpp_global *dpp,
 
 	bi->type = DPP_BOOTSTRAP_QR_CODE;
 	bi->id = dpp_next_id(dpp);
-	dl_list_add(&dpp->bootstrap, &bi->list);
+	dpp_bootstrap_add(dpp, bi);
 	return bi;
 }
 
@@ -4139,7 +4204,7 @@ struct dpp_bootstrap_info * dpp_add_nfc_uri(struct dpp_global *dpp,
 
 	bi->type = DPP_BOOTSTRAP_NFC_URI;
 	bi->id = dpp_next_id(dpp);
-	dl_list_add(&dpp->bootstrap, &bi->list);
+	dpp_bootstrap_add(dpp, bi);
 	return bi;
 }
 
@@ -4191,7 +4256,7 @@ int dpp_bootstrap_gen(struct dpp_global *dpp, const char *cmd)
 		goto fail;
 
 	bi->id = dpp_next_id(dpp);
-	dl_list_add(&dpp->bootstrap, &bi->list);
+	dpp_bootstrap_add(dpp, bi);
 	ret = bi->id;
 	bi = NULL;
 fail:
@@ -4310,25 +4375,28 @@ void dpp_bootstrap_find_pair(struct dpp_global *dpp, const u8 *i_bootstrap,
 	if (!dpp)
 		return;
 
-	dl_list_for_each(bi, &dpp->bootstrap, struct dpp_bootstrap_info, list) {
-		if (!*own_bi && bi->own &&
+	for (bi = dpp->bootstrap_hash[DPP_BOOTSTRAP_HASH(r_bootstrap)]; bi;
+	     bi = bi->hnext) {
+		if (bi->own &&
 		    os_memcmp(bi->pubkey_hash, r_bootstrap,
 			      SHA256_MAC_LEN) == 0) {
 			wpa_printf(MSG_DEBUG,
 				   "DPP: Found matching own bootstrapping information");
 			*own_bi = bi;
+			break;
 		}
+	}
 
-		if (!*peer_bi && !bi->own &&
+	for (bi = dpp->bootstrap_hash[DPP_BOOTSTRAP_HASH(i_bootstrap)]; bi;
+	     bi = bi->hnext) {
+		if (!bi->own &&
 		    os_memcmp(bi->pubkey_hash, i_bootstrap,
 			      SHA256_MAC_LEN) == 0) {
 			wpa_printf(MSG_DEBUG,
 				   "DPP: Found matching peer bootstrapping information");
 			*peer_bi = bi;
-		}
-
-		if (*own_bi && *peer_bi)
 			break;
+		}
 	}
 }
 
@@ -4342,7 +4410,8 @@ struct dpp_bootstrap_info * dpp_bootstrap_find_chirp(struct dpp_global *dpp,
 	if (!dpp)
 		return NULL;
 
-	dl_list_for_each(bi, &dpp->bootstrap, struct dpp_bootstrap_info, list) {
+	for (bi = dpp->bootstrap_chirp_hash[DPP_BOOTSTRAP_HASH(hash)]; bi;
+	     bi = bi->chirp_hnext) {
 		if (!bi->own && os_memcmp(bi->pubkey_hash_chirp, hash,
 					  SHA256_MAC_LEN) == 0)
 			return bi;
@@ -4401,7 +4470,8 @@ static int dpp_nfc_update_bi_channel(struct dpp_bootstrap_info *own_bi,
 }
 
 
-static int dpp_nfc_update_bi_key(struct dpp_bootstrap_info *own_bi,
+static int dpp_nfc_update_bi_key(struct dpp_global *dpp,
+				 struct dpp_bootstrap_info *own_bi,
 				 struct dpp_bootstrap_info *peer_bi)
 {
 	if (peer_bi->curve == own_bi->curve)
@@ -4410,6 +4480,8 @@ static int dpp_nfc_update_bi_key(struct dpp_bootstrap_info *own_bi,
 	wpa_printf(MSG_DEBUG,
 		   "DPP: Update own bootstrapping key to match peer curve from NFC handover");
 
+	/* The public key hashes change, so the entry needs to be rehashed */
+	dpp_bootstrap_hash_del(dpp, own_bi);
 	crypto_ec_key_deinit(own_bi->pubkey);
 	own_bi->pubkey = NULL;
 
@@ -4417,6 +4489,7 @@ static int dpp_nfc_update_bi_key(struct dpp_bootstrap_info *own_bi,
 	    dpp_gen_uri(own_bi) < 0)
 		goto fail;
 
+	dpp_bootstrap_hash_add(dpp, own_bi);
 	return 0;
 fail:
 	dl_list_del(&own_bi->list);
@@ -4425,11 +4498,12 @@ fail:
 }
 
 
-int dpp_nfc_update_bi(struct dpp_bootstrap_info *own_bi,
+int dpp_nfc_update_bi(struct dpp_global *dpp,
+		      struct dpp_bootstrap_info *own_bi,
 		      struct dpp_bootstrap_info *peer_bi)
 {
 	if (dpp_nfc_update_bi_channel(own_bi, peer_bi) < 0 ||
-	    dpp_nfc_update_bi_key(own_bi, peer_bi) < 0)
+	    dpp_nfc_update_bi_key(dpp, own_bi, peer_bi) < 0)
 		return -1;
 	return 0;
 }
@@ -37,6 +37,7 @@ extern int dpp_version_override;
 
 #define DPP_HDR_LEN (4 + 2) /* OUI, OUI Type, Crypto Suite, DPP frame type */
 #define DPP_TCP_PORT 8908
+#define DPP_TCP_BACKLOG 10
 
 enum dpp_public_action_frame_type {
 	DPP_PA_AUTHENTICATION_REQ = 0,
@@ -148,6 +149,8 @@ enum dpp_bootstrap_type {
 
 struct dpp_bootstrap_info {
 	struct dl_list list;
+	struct dpp_bootstrap_info *hnext; /* next entry in bootstrap_hash */
+	struct dpp_bootstrap_info *chirp_hnext; /* next in bootstrap_chirp_hash */
 	unsigned int id;
 	enum dpp_bootstrap_type type;
 	char *uri;
@@ -413,6 +416,7 @@ struct dpp_relay_config {
 struct dpp_controller_config {
 	const char *configurator_params;
 	int tcp_port;
+	int tcp_backlog; /* listen() backlog; 0 = use DPP_TCP_BACKLOG */
 	u8 allowed_roles;
 	int qr_mutual;
 	enum dpp_netrole netrole;
@@ -541,7 +545,8 @@ int dpp_parse_uri_chan_list(struct dpp_bootstrap_info *bi,
 			    const char *chan_list);
 int dpp_parse_uri_mac(struct dpp_bootstrap_info *bi, const char *mac);
 int dpp_parse_uri_info(struct dpp_bootstrap_info *bi, const char *info);
-int dpp_nfc_update_bi(struct dpp_bootstrap_info *own_bi,
+int dpp_nfc_update_bi(struct dpp_global *dpp,
+		      struct dpp_bootstrap_info *own_bi,
 		      struct dpp_bootstrap_info *peer_bi);
 const char * dpp_netrole_str(enum dpp_netrole netrole);
 struct dpp_authentication *
@@ -16,6 +16,13 @@
 struct dpp_global {
 	void *msg_ctx;
 	struct dl_list bootstrap; /* struct dpp_bootstrap_info */
+	/* Bootstrapping information entries hashed by pubkey_hash and
+	 * pubkey_hash_chirp */
+#define DPP_BOOTSTRAP_HASH_SIZE 1024
+#define DPP_BOOTSTRAP_HASH(hash) \
+	(WPA_GET_LE16(hash) & (DPP_BOOTSTRAP_HASH_SIZE - 1))
+	struct dpp_bootstrap_info *bootstrap_hash[DPP_BOOTSTRAP_HASH_SIZE];
+	struct dpp_bootstrap_info *bootstrap_chirp_hash[DPP_BOOTSTRAP_HASH_SIZE];
 	struct dl_list configurator; /* struct dpp_configurator */
 #ifdef CONFIG_DPP2
 	struct dl_list controllers; /* struct dpp_relay_controller */
@@ -33,6 +40,9 @@ struct dpp_global {
 void dpp_build_attr_status(struct wpabuf *msg, enum dpp_status_error status);
 void dpp_build_attr_r_bootstrap_key_hash(struct wpabuf *msg, const u8 *hash);
 unsigned int dpp_next_id(struct dpp_global *dpp);
+void dpp_bootstrap_add(struct dpp_global *dpp, struct dpp_bootstrap_info *bi);
+void dpp_bootstrap_unlink(struct dpp_global *dpp,
+			  struct dpp_bootstrap_info *bi);
 struct wpabuf * dpp_build_conn_status(enum dpp_status_error result,
 				      const u8 *ssid, size_t ssid_len,
 				      const char *channel_list);
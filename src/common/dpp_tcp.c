@@ -20,6 +20,10 @@
 
 #ifdef CONFIG_DPP2
 
+/* Minimum size of the per-connection receive buffer that is reused for all
+ * messages received over the connection */
+#define DPP_TCP_RX_BUF_MIN 2048
+
 struct dpp_connection {
 	struct dl_list list;
 	struct dpp_controller *ctrl;
@@ -72,6 +76,7 @@ struct dpp_controller {
 	u8 allowed_roles;
 	int qr_mutual;
 	int sock;
+	int backlog;
 	struct dl_list conn; /* struct dpp_connection */
 	char *configurator_params;
 	enum dpp_netrole netrole;
@@ -1644,13 +1649,12 @@ static void dpp_controller_rx(int sd, void *eloop_ctx, void *sock_ctx)
 	struct dpp_connection *conn = eloop_ctx;
 	int res;
 	const u8 *pos;
+	u32 msglen;
 
 	wpa_printf(MSG_DEBUG, "DPP: TCP data available for reading (sock %d)",
 		   sd);
 
 	if (conn->msg_len_octets < 4) {
-		u32 msglen;
-
 		res = recv(sd, &conn->msg_len[conn->msg_len_octets],
 			   4 - conn->msg_len_octets, 0);
 		if (res < 0) {
@@ -1685,8 +1689,14 @@ static void dpp_controller_rx(int sd, void *eloop_ctx, void *sock_ctx)
 			return;
 		}
 
-		wpabuf_free(conn->msg);
-		conn->msg = wpabuf_alloc(msglen);
+		/* Reuse the buffer from the previous message, if possible */
+		if (conn->msg && wpabuf_size(conn->msg) >= msglen) {
+			conn->msg->used = 0;
+		} else {
+			wpabuf_free(conn->msg);
+			conn->msg = wpabuf_alloc(msglen > DPP_TCP_RX_BUF_MIN ?
+						 msglen : DPP_TCP_RX_BUF_MIN);
+		}
 	}
 
 	if (!conn->msg) {
@@ -1696,10 +1706,12 @@ static void dpp_controller_rx(int sd, void *eloop_ctx, void *sock_ctx)
 		return;
 	}
 
+	msglen = WPA_GET_BE32(conn->msg_len);
 	wpa_printf(MSG_DEBUG, "DPP: Need %u more octets of message payload",
-		   (unsigned int) wpabuf_tailroom(conn->msg));
+		   (unsigned int) (msglen - wpabuf_len(conn->msg)));
 
-	res = recv(sd, wpabuf_put(conn->msg, 0), wpabuf_tailroom(conn->msg), 0);
+	res = recv(sd, wpabuf_put(conn->msg, 0),
+		   msglen - wpabuf_len(conn->msg), 0);
 	if (res < 0) {
 		wpa_printf(MSG_DEBUG, "DPP: recv failed: %s", strerror(errno));
 		dpp_connection_remove(conn);
@@ -1713,10 +1725,10 @@ static void dpp_controller_rx(int sd, void *eloop_ctx, void *sock_ctx)
 	wpa_printf(MSG_DEBUG, "DPP: Received %d octets", res);
 	wpabuf_put(conn->msg, res);
 
-	if (wpabuf_tailroom(conn->msg) > 0) {
+	if (wpabuf_len(conn->msg) < msglen) {
 		wpa_printf(MSG_DEBUG,
 			   "DPP: Need %u more octets of message payload",
-			   (unsigned int) wpabuf_tailroom(conn->msg));
+			   (unsigned int) (msglen - wpabuf_len(conn->msg)));
 		return;
 	}
 
@@ -1759,26 +1771,10 @@ static void dpp_controller_rx(int sd, void *eloop_ctx, void *sock_ctx)
 }
 
 
-static void dpp_controller_tcp_cb(int sd, void *eloop_ctx, void *sock_ctx)
+static void dpp_controller_add_conn(struct dpp_controller *ctrl, int fd)
 {
-	struct dpp_controller *ctrl = eloop_ctx;
-	struct sockaddr_in addr;
-	socklen_t addr_len = sizeof(addr);
-	int fd;
 	struct dpp_connection *conn;
 
-	wpa_printf(MSG_DEBUG, "DPP: New TCP connection");
-
-	fd = accept(ctrl->sock, (struct sockaddr *) &addr, &addr_len);
-	if (fd < 0) {
-		wpa_printf(MSG_DEBUG,
-			   "DPP: Failed to accept new connection: %s",
-			   strerror(errno));
-		return;
-	}
-	wpa_printf(MSG_DEBUG, "DPP: Connection from %s:%d",
-		   inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
-
 	conn = os_zalloc(sizeof(*conn));
 	if (!conn)
 		goto fail;
@@ -1814,6 +1810,32 @@ fail:
 }
 
 
+static void dpp_controller_tcp_cb(int sd, void *eloop_ctx, void *sock_ctx)
+{
+	struct dpp_controller *ctrl = eloop_ctx;
+	struct sockaddr_in addr;
+	socklen_t addr_len;
+	int fd, i;
+
+	/* Accept all pending connections (up to the listen backlog) instead of
+	 * waiting for another socket event for each one of them. */
+	for (i = 0; i < ctrl->backlog; i++) {
+		addr_len = sizeof(addr);
+		fd = accept(ctrl->sock, (struct sockaddr *) &addr, &addr_len);
+		if (fd < 0) {
+			if (i == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+				wpa_printf(MSG_DEBUG,
+					   "DPP: Failed to accept new connection: %s",
+					   strerror(errno));
+			return;
+		}
+		wpa_printf(MSG_DEBUG, "DPP: New TCP connection from %s:%d",
+			   inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+		dpp_controller_add_conn(ctrl, fd);
+	}
+}
+
+
 int dpp_tcp_pkex_init(struct dpp_global *dpp, struct dpp_pkex *pkex,
 		      const struct hostapd_ip_addr *addr, int port,
 		      void *msg_ctx, void *cb_ctx,
@@ -2038,6 +2060,8 @@ int dpp_controller_start(struct dpp_global *dpp,
 	ctrl->cb_ctx = config->cb_ctx;
 	ctrl->process_conf_obj = config->process_conf_obj;
 	ctrl->tcp_msg_sent = config->tcp_msg_sent;
+	ctrl->backlog = config->tcp_backlog > 0 ? config->tcp_backlog :
+		DPP_TCP_BACKLOG;
 
 	ctrl->sock = socket(AF_INET, SOCK_STREAM, 0);
 	if (ctrl->sock < 0)
@@ -2069,14 +2093,16 @@ int dpp_controller_start(struct dpp_global *dpp,
 			   strerror(errno));
 		goto fail;
 	}
-	if (listen(ctrl->sock, 10 /* max backlog */) < 0 ||
+	if (listen(ctrl->sock, ctrl->backlog) < 0 ||
 	    fcntl(ctrl->sock, F_SETFL, O_NONBLOCK) < 0 ||
 	    eloop_register_sock(ctrl->sock, EVENT_TYPE_READ,
 				dpp_controller_tcp_cb, ctrl, NULL))
 		goto fail;
 
 	dpp->controller = ctrl;
-	wpa_printf(MSG_DEBUG, "DPP: Controller started on TCP port %d", port);
+	wpa_printf(MSG_DEBUG,
+		   "DPP: Controller started on TCP port %d (backlog %d)",
+		   port, ctrl->backlog);
 	return 0;
 fail:
 	dpp_controller_free(ctrl);
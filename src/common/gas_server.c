@@ -35,6 +35,7 @@ struct gas_server_handler {
 
 struct gas_server_response {
 	struct dl_list list;
+	struct gas_server_response *hnext; /* next entry in resp_hash */
 	size_t offset;
 	u8 frag_id;
 	struct wpabuf *resp;
@@ -49,6 +50,11 @@ struct gas_server_response {
 struct gas_server {
 	struct dl_list handlers; /* struct gas_server_handler::list */
 	struct dl_list responses; /* struct gas_server_response::list */
+#define GAS_SERVER_RESP_HASH_SIZE 64
+#define GAS_SERVER_RESP_HASH(addr, dialog_token) \
+	(((addr)[5] ^ (dialog_token)) & (GAS_SERVER_RESP_HASH_SIZE - 1))
+	/* Pending responses hashed by peer address and dialog token */
+	struct gas_server_response *resp_hash[GAS_SERVER_RESP_HASH_SIZE];
 	void (*tx)(void *ctx, int freq, const u8 *da, struct wpabuf *resp,
 		   unsigned int wait_time);
 	void *ctx;
@@ -57,6 +63,51 @@ struct gas_server {
 static void gas_server_free_response(struct gas_server_response *response);
 
 
+static void gas_server_response_add(struct gas_server *gas,
+				    struct gas_server_response *response)
+{
+	unsigned int idx;
+
+	dl_list_add(&gas->responses, &response->list);
+	idx = GAS_SERVER_RESP_HASH(response->dst, response->dialog_token);
+	response->hnext = gas->resp_hash[idx];
+	gas->resp_hash[idx] = response;
+}
+
+
+static void gas_server_response_unlink(struct gas_server_response *response)
+{
+	struct gas_server *gas = response->handler->gas;
+	struct gas_server_response **pos;
+
+	pos = &gas->resp_hash[GAS_SERVER_RESP_HASH(response->dst,
+						   response->dialog_token)];
+	while (*pos && *pos != response)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = response->hnext;
+	dl_list_del(&response->list);
+}
+
+
+static struct gas_server_response *
+gas_server_response_get(struct gas_server *gas, const u8 *addr,
+			u8 dialog_token)
+{
+	struct gas_server_response *response;
+
+	for (response = gas->resp_hash[GAS_SERVER_RESP_HASH(addr,
+							    dialog_token)];
+	     response; response = response->hnext) {
+		if (response->dialog_token == dialog_token &&
+		    os_memcmp(addr, response->dst, ETH_ALEN) == 0)
+			return response;
+	}
+
+	return NULL;
+}
+
+
 static void gas_server_response_timeout(void *eloop_ctx, void *user_ctx)
 {
 	struct gas_server_response *response = eloop_ctx;
@@ -71,7 +122,7 @@ static void gas_server_response_timeout(void *eloop_ctx, void *user_ctx)
 	response->handler->status_cb(response->handler->ctx,
 				     response->resp, 0);
 	response->resp = NULL;
-	dl_list_del(&response->list);
+	gas_server_response_unlink(response);
 	gas_server_free_response(response);
 }
 
@@ -99,7 +150,7 @@ gas_server_send_resp(struct gas_server *gas,
 	struct wpabuf *resp;
 
 	if (comeback_delay == 0 && !query_resp) {
-		dl_list_del(&response->list);
+		gas_server_response_unlink(response);
 		gas_server_free_response(response);
 		return;
 	}
@@ -125,7 +176,7 @@ gas_server_send_resp(struct gas_server *gas,
 				      resp_frag_len);
 	if (!resp) {
 		wpabuf_free(query_resp);
-		dl_list_del(&response->list);
+		gas_server_response_unlink(response);
 		gas_server_free_response(response);
 		return;
 	}
@@ -236,7 +287,7 @@ gas_server_rx_initial_req(struct gas_server *gas, const u8 *da, const u8 *sa,
 		response->handler = handler;
 		os_memcpy(response->dst, sa, ETH_ALEN);
 		response->dialog_token = dialog_token;
-		dl_list_add(&gas->responses, &response->list);
+		gas_server_response_add(gas, response);
 
 		wpa_printf(MSG_DEBUG,
 			   "GAS: Calling handler for the requested Advertisement Protocol ID");
@@ -281,7 +332,7 @@ gas_server_handle_rx_comeback_req(struct gas_server_response *response)
 					       response->comeback_delay,
 					       handler->adv_proto_id_len);
 		if (!resp) {
-			dl_list_del(&response->list);
+			gas_server_response_unlink(response);
 			gas_server_free_response(response);
 			return;
 		}
@@ -315,7 +366,7 @@ gas_server_handle_rx_comeback_req(struct gas_server_response *response)
 				       handler->adv_proto_id_len +
 				       resp_frag_len);
 	if (!resp) {
-		dl_list_del(&response->list);
+		gas_server_response_unlink(response);
 		gas_server_free_response(response);
 		return;
 	}
@@ -349,11 +400,8 @@ gas_server_rx_comeback_req(struct gas_server *gas, const u8 *da, const u8 *sa,
 {
 	struct gas_server_response *response;
 
-	dl_list_for_each(response, &gas->responses, struct gas_server_response,
-			 list) {
-		if (response->dialog_token != dialog_token ||
-		    os_memcmp(sa, response->dst, ETH_ALEN) != 0)
-			continue;
+	response = gas_server_response_get(gas, sa, dialog_token);
+	if (response) {
 		gas_server_handle_rx_comeback_req(response);
 		return 0;
 	}
@@ -440,7 +488,7 @@ static void gas_server_handle_tx_status(struct gas_server_response *response,
 	response->handler->status_cb(response->handler->ctx,
 				     response->resp, ack);
 	response->resp = NULL;
-	dl_list_del(&response->list);
+	gas_server_response_unlink(response);
 	gas_server_free_response(response);
 }
 
@@ -467,11 +515,8 @@ void gas_server_tx_status(struct gas_server *gas, const u8 *dst, const u8 *data,
 		   MAC2STR(dst), ack,
 		   code == WLAN_PA_GAS_INITIAL_RESP ? "initial" : "comeback",
 		   dialog_token);
-	dl_list_for_each(response, &gas->responses, struct gas_server_response,
-			 list) {
-		if (response->dialog_token != dialog_token ||
-		    os_memcmp(dst, response->dst, ETH_ALEN) != 0)
-			continue;
+	response = gas_server_response_get(gas, dst, dialog_token);
+	if (response) {
 		gas_server_handle_tx_status(response, ack);
 		return;
 	}
@@ -574,18 +619,18 @@ void gas_server_deinit(struct gas_server *gas)
 	if (!gas)
 		return;
 
+	dl_list_for_each_safe(response, tmp_r, &gas->responses,
+			      struct gas_server_response, list) {
+		gas_server_response_unlink(response);
+		gas_server_free_response(response);
+	}
+
 	dl_list_for_each_safe(handler, tmp, &gas->handlers,
 			      struct gas_server_handler, list) {
 		dl_list_del(&handler->list);
 		os_free(handler);
 	}
 
-	dl_list_for_each_safe(response, tmp_r, &gas->responses,
-			      struct gas_server_response, list) {
-		dl_list_del(&response->list);
-		gas_server_free_response(response);
-	}
-
 	os_free(gas);
 }
 
@@ -647,6 +647,10 @@ struct wpabuf * ieee802_11_vendor_ie_concat(const u8 *ies, size_t ies_len,
 	if (!found)
 		return NULL; /* No specified vendor IE found */
 
+	/* Elements before the first match were already checked above */
+	ies_len -= (const u8 *) found - ies;
+	ies = (const u8 *) found;
+
 	buf = wpabuf_alloc(ies_len);
 	if (buf == NULL)
 		return NULL;
@@ -0,0 +1,288 @@
+/*
+ * Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "stats_shm.h"
+
+
+struct stats_shm {
+	struct stats_shm_hdr *hdr;
+	size_t len;
+	char *path; /* NULL for read-only mappings */
+};
+
+
+static size_t stats_shm_align(size_t len)
+{
+	return (len + 7) & ~((size_t) 7);
+}
+
+
+/**
+ * stats_shm_create - Create a statistics region
+ * @path: File to create; this is normally on a tmpfs, e.g., in /dev/shm
+ * @type: Type of the region
+ * @data_len: Length of the type-specific data section
+ * @rec_len: Length of each record
+ * @max_rec: Maximum number of records
+ * @interval_ms: Update interval to advertise to readers
+ * Returns: Pointer to the region or %NULL on failure
+ *
+ * The file is initialized under a temporary name and then renamed into place
+ * so that readers never see a partially initialized region and any existing
+ * reader mappings of a previous instance remain valid.
+ */
+struct stats_shm * stats_shm_create(const char *path, enum stats_shm_type type,
+				    size_t data_len, size_t rec_len,
+				    unsigned int max_rec, unsigned int interval_ms)
+{
+	struct stats_shm *shm;
+	struct stats_shm_hdr *hdr;
+	char *tmp;
+	size_t data_off, rec_off, len, tmp_len;
+	void *addr;
+	int fd, res;
+
+	data_off = stats_shm_align(sizeof(*hdr));
+	rec_off = stats_shm_align(data_off + data_len);
+	if (rec_len && max_rec > (0x7fffffff - rec_off) / rec_len)
+		return NULL;
+	len = rec_off + rec_len * max_rec;
+
+	shm = os_zalloc(sizeof(*shm));
+	if (!shm)
+		return NULL;
+	shm->path = os_strdup(path);
+	tmp_len = os_strlen(path) + 5;
+	tmp = os_malloc(tmp_len);
+	if (!shm->path || !tmp)
+		goto fail;
+	res = os_snprintf(tmp, tmp_len, "%s.tmp", path);
+	if (os_snprintf_error(tmp_len, res))
+		goto fail;
+
+	fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP);
+	if (fd < 0) {
+		wpa_printf(MSG_ERROR, "stats_shm: open(%s): %s",
+			   tmp, strerror(errno));
+		goto fail;
+	}
+	if (ftruncate(fd, len) < 0) {
+		wpa_printf(MSG_ERROR, "stats_shm: ftruncate(%s): %s",
+			   tmp, strerror(errno));
+		close(fd);
+		unlink(tmp);
+		goto fail;
+	}
+	addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		wpa_printf(MSG_ERROR, "stats_shm: mmap(%s): %s",
+			   tmp, strerror(errno));
+		unlink(tmp);
+		goto fail;
+	}
+
+	hdr = addr;
+	hdr->version = STATS_SHM_VERSION;
+	hdr->type = type;
+	hdr->pid = getpid();
+	hdr->data_off = data_off;
+	hdr->data_len = data_len;
+	hdr->rec_off = rec_off;
+	hdr->rec_len = rec_len;
+	hdr->max_rec = max_rec;
+	hdr->interval_ms = interval_ms;
+	__sync_synchronize();
+	hdr->magic = STATS_SHM_MAGIC;
+
+	if (rename(tmp, path) < 0) {
+		wpa_printf(MSG_ERROR, "stats_shm: rename(%s): %s",
+			   path, strerror(errno));
+		munmap(addr, len);
+		unlink(tmp);
+		goto fail;
+	}
+	os_free(tmp);
+
+	shm->hdr = hdr;
+	shm->len = len;
+	wpa_printf(MSG_DEBUG,
+		   "stats_shm: Created %s (%zu octets, %u records)",
+		   path, len, max_rec);
+	return shm;
+
+fail:
+	os_free(tmp);
+	os_free(shm->path);
+	os_free(shm);
+	return NULL;
+}
+
+
+/**
+ * stats_shm_destroy - Unmap a statistics region
+ * @shm: Region from stats_shm_create() or stats_shm_open() or %NULL
+ *
+ * The file is removed if the region was created by this process.
+ */
+void stats_shm_destroy(struct stats_shm *shm)
+{
+	if (!shm)
+		return;
+	if (shm->path) {
+		unlink(shm->path);
+		os_free(shm->path);
+	}
+	munmap(shm->hdr, shm->len);
+	os_free(shm);
+}
+
+
+void * stats_shm_data(struct stats_shm *shm)
+{
+	return ((u8 *) shm->hdr) + shm->hdr->data_off;
+}
+
+
+void * stats_shm_rec(struct stats_shm *shm, unsigned int idx)
+{
+	if (idx >= shm->hdr->max_rec)
+		return NULL;
+	return ((u8 *) shm->hdr) + shm->hdr->rec_off + idx * shm->hdr->rec_len;
+}
+
+
+/**
+ * stats_shm_write_begin - Start an update of a statistics region
+ * @shm: Region from stats_shm_create()
+ *
+ * The data section and records can be modified until the matching
+ * stats_shm_write_end() call.
+ */
+void stats_shm_write_begin(struct stats_shm *shm)
+{
+	volatile u32 *seq = &shm->hdr->seq;
+
+	*seq = *seq + 1;
+	__sync_synchronize();
+}
+
+
+/**
+ * stats_shm_write_end - Complete an update of a statistics region
+ * @shm: Region from stats_shm_create()
+ * @num_rec: Number of valid records
+ */
+void stats_shm_write_end(struct stats_shm *shm, unsigned int num_rec)
+{
+	volatile u32 *seq = &shm->hdr->seq;
+	struct os_time now;
+
+	os_get_time(&now);
+	shm->hdr->pid = getpid(); /* may have changed with daemonize */
+	shm->hdr->num_rec = num_rec;
+	shm->hdr->update_count++;
+	shm->hdr->update_time_usec = now.sec * 1000000ULL + now.usec;
+	__sync_synchronize();
+	*seq = *seq + 1;
+}
+
+
+/**
+ * stats_shm_open - Map an existing statistics region for reading
+ * @path: File that was created with stats_shm_create()
+ * Returns: Pointer to the region or %NULL on failure
+ */
+struct stats_shm * stats_shm_open(const char *path)
+{
+	struct stats_shm *shm;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 ||
+	    (size_t) st.st_size < sizeof(struct stats_shm_hdr)) {
+		close(fd);
+		return NULL;
+	}
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	shm = os_zalloc(sizeof(*shm));
+	if (!shm) {
+		munmap(addr, st.st_size);
+		return NULL;
+	}
+	shm->hdr = addr;
+	shm->len = st.st_size;
+	if (shm->hdr->magic != STATS_SHM_MAGIC ||
+	    shm->hdr->version != STATS_SHM_VERSION ||
+	    shm->hdr->data_off > shm->len ||
+	    shm->hdr->data_len > shm->len - shm->hdr->data_off ||
+	    shm->hdr->rec_off > shm->len ||
+	    (shm->hdr->rec_len &&
+	     shm->hdr->max_rec > (shm->len - shm->hdr->rec_off) /
+	     shm->hdr->rec_len)) {
+		stats_shm_destroy(shm);
+		return NULL;
+	}
+	return shm;
+}
+
+
+size_t stats_shm_len(struct stats_shm *shm)
+{
+	return shm->len;
+}
+
+
+/**
+ * stats_shm_read - Copy a consistent snapshot of a statistics region
+ * @shm: Region from stats_shm_open()
+ * @buf: Buffer for the snapshot; at least stats_shm_len() octets
+ * @buflen: Length of buf
+ * @max_tries: Maximum number of attempts before giving up
+ * Returns: 0 on success, -1 on failure
+ */
+int stats_shm_read(struct stats_shm *shm, void *buf, size_t buflen,
+		   unsigned int max_tries)
+{
+	volatile u32 *seq = &shm->hdr->seq;
+	unsigned int i;
+	u32 start;
+
+	if (buflen < shm->len)
+		return -1;
+
+	for (i = 0; i < max_tries; i++) {
+		start = *seq;
+		__sync_synchronize();
+		if (start & 1) {
+			os_sleep(0, 100);
+			continue;
+		}
+		os_memcpy(buf, shm->hdr, shm->len);
+		__sync_synchronize();
+		if (*seq == start) {
+			((struct stats_shm_hdr *) buf)->seq = start;
+			return 0;
+		}
+	}
+
+	return -1;
+}
@@ -0,0 +1,155 @@
+/*
+ * Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef STATS_SHM_H
+#define STATS_SHM_H
+
+/*
+ * The statistics region is a file mapped with MAP_SHARED so that monitoring
+ * tools can read the counters without going through the control interface.
+ * The region starts with struct stats_shm_hdr. It is followed by a
+ * type-specific data section (struct stats_shm_ap or struct stats_shm_iface)
+ * at hdr.data_off and, for the AP type, an array of struct stats_shm_sta
+ * records at hdr.rec_off.
+ *
+ * All updates are done within a single writer that uses a sequence lock:
+ * hdr.seq is odd while an update is in progress. Readers need to copy the
+ * region and retry if hdr.seq was odd or changed during the copy; see
+ * stats_shm_read().
+ */
+
+#define STATS_SHM_MAGIC 0x53544857 /* "WHTS" in little endian */
+#define STATS_SHM_VERSION 1
+
+enum stats_shm_type {
+	STATS_SHM_TYPE_AP = 1,
+	STATS_SHM_TYPE_STA = 2,
+};
+
+struct stats_shm_hdr {
+	u32 magic;
+	u16 version;
+	u8 type; /* enum stats_shm_type */
+	u8 reserved;
+	u32 seq; /* odd while an update is in progress */
+	u32 pid;
+	u32 data_off;
+	u32 data_len;
+	u32 rec_off;
+	u32 rec_len;
+	u32 max_rec;
+	u32 num_rec;
+	u32 update_count;
+	u32 interval_ms;
+	u64 update_time_usec; /* wall clock time of the latest update */
+};
+
+/* RADIUS client MIB for the currently used server */
+struct stats_shm_radius {
+	u32 requests;
+	u32 retransmissions;
+	u32 access_accepts;
+	u32 access_rejects;
+	u32 access_challenges;
+	u32 responses;
+	u32 malformed_responses;
+	u32 bad_authenticators;
+	u32 timeouts;
+	u32 unknown_types;
+	u32 packets_dropped;
+	s32 round_trip_time; /* in hundredths of a second */
+	u16 port;
+	u8 valid;
+	u8 af; /* 4 = IPv4, 6 = IPv6 */
+	u8 addr[16];
+};
+
+/* Per-BSS data section for STATS_SHM_TYPE_AP */
+struct stats_shm_ap {
+	/* Sums over the stations for which driver data was available */
+	u64 rx_bytes;
+	u64 tx_bytes;
+	u64 rx_packets;
+	u64 tx_packets;
+	char ifname[32];
+	u8 bssid[6];
+	u8 ssid_len;
+	u8 state; /* enum hostapd_iface_state */
+	u8 ssid[32];
+	u32 freq;
+	u32 channel;
+	u32 num_sta;
+	u32 num_sta_authorized;
+	u32 max_num_sta;
+	/* Age of the station driver data snapshot when the region was updated
+	 * or STATS_SHM_AGE_UNKNOWN if the driver did not provide one */
+	u32 drv_data_age_ms;
+	struct stats_shm_radius radius_auth;
+	struct stats_shm_radius radius_acct;
+};
+
+#define STATS_SHM_AGE_UNKNOWN 0xffffffff
+
+#define STATS_SHM_STA_DRV_DATA BIT(0)
+
+/* Per-station record for STATS_SHM_TYPE_AP */
+struct stats_shm_sta {
+	u64 rx_bytes;
+	u64 tx_bytes;
+	u64 rx_packets;
+	u64 tx_packets;
+	u8 addr[6];
+	u16 aid;
+	u32 flags; /* WLAN_STA_* */
+	u32 connected_sec;
+	u32 inactive_msec;
+	u32 tx_rate; /* in 100 kbps */
+	u32 rx_rate; /* in 100 kbps */
+	u32 tx_retry_failed;
+	s8 signal;
+	u8 info; /* STATS_SHM_STA_* */
+	u8 reserved[2];
+};
+
+/* Per-interface data section for STATS_SHM_TYPE_STA */
+struct stats_shm_iface {
+	u64 rx_packets;
+	u64 tx_packets;
+	u64 rx_bytes;
+	u64 tx_bytes;
+	char ifname[32];
+	u8 bssid[6];
+	u8 ssid_len;
+	u8 wpa_state; /* enum wpa_states */
+	u8 ssid[32];
+	u32 freq;
+	s32 signal;
+	s32 avg_signal;
+	s32 noise;
+	s32 txrate; /* in kbps */
+	u32 connected_sec;
+	u32 tx_retry_failed;
+	u32 reserved;
+};
+
+struct stats_shm;
+
+struct stats_shm * stats_shm_create(const char *path, enum stats_shm_type type,
+				    size_t data_len, size_t rec_len,
+				    unsigned int max_rec, unsigned int interval_ms);
+void stats_shm_destroy(struct stats_shm *shm);
+void * stats_shm_data(struct stats_shm *shm);
+void * stats_shm_rec(struct stats_shm *shm, unsigned int idx);
+void stats_shm_write_begin(struct stats_shm *shm);
+void stats_shm_write_end(struct stats_shm *shm, unsigned int num_rec);
+
+struct stats_shm * stats_shm_open(const char *path);
+int stats_shm_read(struct stats_shm *shm, void *buf, size_t buflen,
+		   unsigned int max_tries);
+size_t stats_shm_len(struct stats_shm *shm);
+
+#endif /* STATS_SHM_H */
@@ -86,6 +86,7 @@ struct tls_config {
 	int cert_in_cb;
 	const char *openssl_ciphers;
 	unsigned int tls_session_lifetime;
+	const char *session_cache_file;
 	unsigned int crl_reload_interval;
 	unsigned int tls_flags;
 
@@ -640,6 +641,28 @@ void tls_connection_set_test_flags(struct tls_connection *conn, u32 flags);
 
 int tls_get_library_version(char *buf, size_t buf_len);
 
+/**
+ * tls_get_stats - Get TLS handshake and certificate store statistics
+ * @tls_ctx: TLS context data from tls_init()
+ * @buf: Buffer for returning the statistics as name=value lines
+ * @buflen: Maximum length of the buffer in bytes
+ * Returns: Number of bytes written to buf or -1 on error
+ */
+int tls_get_stats(void *tls_ctx, char *buf, size_t buflen);
+
+/**
+ * tls_global_crl_reload - Reload CA certificates and CRLs
+ * @tls_ctx: TLS context data from tls_init()
+ * Returns: 0 on success, -1 on failure
+ *
+ * This function rebuilds the certificate store from the ca_cert file that was
+ * configured with tls_global_set_params() and replaces the store used for new
+ * handshakes once the new one has been fully loaded. The caller is expected to
+ * call this periodically (e.g., based on crl_reload_interval) from the event
+ * loop instead of having the reload delay tls_connection_init().
+ */
+int tls_global_crl_reload(void *tls_ctx);
+
 void tls_connection_set_success_data(struct tls_connection *conn,
 				     struct wpabuf *data);
 
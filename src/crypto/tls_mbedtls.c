@@ -868,6 +868,18 @@ int tls_get_library_version(char *buf, size_t buf_len)
 	return os_snprintf(buf, buf_len, "MbedTLS build=test run=test");
 }
 
+
+int tls_get_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	return -1;
+}
+
+
+int tls_global_crl_reload(void *tls_ctx)
+{
+	return -1;
+}
+
 // Lifted from https://stackoverflow.com/a/47117431
 char *strremove(char *str, const char *sub)
 {
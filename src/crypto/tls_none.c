@@ -209,6 +209,18 @@ int tls_get_library_version(char *buf, size_t buf_len)
 }
 
 
+int tls_get_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	return -1;
+}
+
+
+int tls_global_crl_reload(void *tls_ctx)
+{
+	return -1;
+}
+
+
 void tls_connection_set_success_data(struct tls_connection *conn,
 				     struct wpabuf *data)
 {
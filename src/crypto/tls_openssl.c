@@ -7,6 +7,8 @@
  */
 
 #include "includes.h"
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #ifndef CONFIG_SMARTCARD
 #ifndef OPENSSL_NO_ENGINE
@@ -32,6 +34,7 @@
 #endif
 
 #include "common.h"
+#include "utils/list.h"
 #include "crypto.h"
 #include "sha1.h"
 #include "sha256.h"
@@ -126,6 +129,13 @@ static const unsigned char * ASN1_STRING_get0_data(const ASN1_STRING *x)
 {
 	return ASN1_STRING_data((ASN1_STRING *) x);
 }
+
+
+static int SSL_SESSION_up_ref(SSL_SESSION *sess)
+{
+	CRYPTO_add(&sess->references, 1, CRYPTO_LOCK_SSL_SESSION);
+	return 1;
+}
 #endif
 
 #ifdef ANDROID
@@ -206,6 +216,7 @@ static int tls_add_ca_from_keystore_encoded(X509_STORE *ctx,
 
 static int tls_openssl_ref_count = 0;
 static int tls_ex_idx_session = -1;
+static int tls_ex_idx_cache = -1;
 
 struct tls_context {
 	void (*event_cb)(void *ctx, enum tls_event ev,
@@ -213,6 +224,16 @@ struct tls_context {
 	void *cb_ctx;
 	int cert_in_cb;
 	char *ocsp_stapling_response;
+	/* Cached contents of the ocsp_stapling_response file and the cache
+	 * statistics; like ocsp_stapling_response, these are used only in
+	 * tls_global */
+	struct wpabuf *ocsp_resp;
+	time_t ocsp_resp_mtime;
+	off_t ocsp_resp_size;
+	ino_t ocsp_resp_ino;
+	struct os_reltime ocsp_last_check;
+	unsigned int ocsp_cache_hits;
+	unsigned int ocsp_cache_reloads;
 };
 
 static struct tls_context *tls_global = NULL;
@@ -227,6 +248,25 @@ struct tls_data {
 	unsigned int crl_reload_interval;
 	struct os_reltime crl_last_reload;
 	char *check_cert_subject;
+
+	/* Sessions with success data, persisted to session_cache_file */
+	char *session_cache_file;
+	struct dl_list session_cache; /* struct tls_cached_session */
+	unsigned int session_cache_loaded;
+
+	/* Statistics for tls_get_stats() */
+	unsigned int hs_count;
+	unsigned int hs_resumed;
+	unsigned int hs_usec_max;
+	unsigned long long hs_usec_total;
+	unsigned int crl_reloads;
+	unsigned int crl_reload_failures;
+	unsigned int crl_reload_usec;
+};
+
+struct tls_cached_session {
+	struct dl_list list;
+	SSL_SESSION *sess;
 };
 
 struct tls_connection {
@@ -257,6 +297,7 @@ struct tls_connection {
 	unsigned int success_data:1;
 	unsigned int client_hello_generated:1;
 	unsigned int server:1;
+	unsigned int hs_counted:1;
 
 	u8 srv_cert_hash[32];
 
@@ -272,6 +313,8 @@ struct tls_connection {
 
 	u16 cipher_suite;
 	int server_dh_prime_len;
+
+	unsigned int hs_usec; /* time spent processing handshake messages */
 };
 
 
@@ -931,12 +974,198 @@ static int tls_engine_load_dynamic_opensc(const char *opensc_so_path)
 #endif /* OPENSSL_NO_ENGINE */
 
 
+static void tls_session_cache_del(SSL_SESSION *sess)
+{
+	struct tls_cached_session *entry;
+
+	if (tls_ex_idx_cache < 0)
+		return;
+	entry = SSL_SESSION_get_ex_data(sess, tls_ex_idx_cache);
+	if (!entry)
+		return;
+	SSL_SESSION_set_ex_data(sess, tls_ex_idx_cache, NULL);
+	dl_list_del(&entry->list);
+	os_free(entry);
+	SSL_SESSION_free(sess);
+}
+
+
+static void tls_session_cache_add(struct tls_data *data, SSL_SESSION *sess)
+{
+	struct tls_cached_session *entry;
+
+	if (!data->session_cache_file || tls_ex_idx_cache < 0 ||
+	    SSL_SESSION_get_ex_data(sess, tls_ex_idx_cache))
+		return;
+
+	entry = os_zalloc(sizeof(*entry));
+	if (!entry)
+		return;
+	if (SSL_SESSION_set_ex_data(sess, tls_ex_idx_cache, entry) != 1) {
+		os_free(entry);
+		return;
+	}
+	SSL_SESSION_up_ref(sess);
+	entry->sess = sess;
+	dl_list_add(&data->session_cache, &entry->list);
+}
+
+
+static int tls_session_expired(SSL_SESSION *sess, long now)
+{
+	return SSL_SESSION_get_time(sess) + SSL_SESSION_get_timeout(sess) <=
+		now;
+}
+
+
+static void tls_session_cache_load(struct tls_data *data)
+{
+	char *buf;
+	const u8 *pos, *end, *p;
+	size_t len;
+	u16 slen, dlen;
+	SSL_SESSION *sess;
+	struct wpabuf *success;
+	long now = time(NULL);
+
+	buf = os_readfile(data->session_cache_file, &len);
+	if (!buf)
+		return;
+	pos = (const u8 *) buf;
+	end = pos + len;
+	if (len < 4 || os_memcmp(pos, "HTS1", 4) != 0) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Ignore invalid TLS session cache file %s",
+			   data->session_cache_file);
+		os_free(buf);
+		return;
+	}
+	pos += 4;
+
+	while (end - pos >= 2) {
+		slen = WPA_GET_BE16(pos);
+		pos += 2;
+		if (end - pos < slen + 2)
+			break;
+		p = pos;
+		sess = d2i_SSL_SESSION(NULL, &p, slen);
+		pos += slen;
+		dlen = WPA_GET_BE16(pos);
+		pos += 2;
+		if (end - pos < dlen) {
+			SSL_SESSION_free(sess);
+			break;
+		}
+		success = sess && !tls_session_expired(sess, now) ?
+			wpabuf_alloc_copy(pos, dlen) : NULL;
+		pos += dlen;
+		if (!success) {
+			SSL_SESSION_free(sess);
+			continue;
+		}
+
+		if (SSL_SESSION_set_ex_data(sess, tls_ex_idx_session,
+					    success) != 1 ||
+		    SSL_CTX_add_session(data->ssl, sess) != 1) {
+			SSL_SESSION_set_ex_data(sess, tls_ex_idx_session, NULL);
+			wpabuf_free(success);
+			SSL_SESSION_free(sess);
+			continue;
+		}
+		tls_session_cache_add(data, sess);
+		SSL_SESSION_free(sess);
+		data->session_cache_loaded++;
+	}
+	os_free(buf);
+
+	wpa_printf(MSG_DEBUG,
+		   "OpenSSL: Loaded %u cached TLS session(s) from %s",
+		   data->session_cache_loaded, data->session_cache_file);
+}
+
+
+static void tls_session_cache_save(struct tls_data *data)
+{
+	struct tls_cached_session *entry;
+	struct wpabuf *success;
+	char *tmp;
+	size_t tmp_len;
+	FILE *f;
+	unsigned char *der, *p;
+	int fd, slen;
+	unsigned int count = 0;
+	long now = time(NULL);
+
+	tmp_len = os_strlen(data->session_cache_file) + 5;
+	tmp = os_malloc(tmp_len);
+	if (!tmp)
+		return;
+	os_snprintf(tmp, tmp_len, "%s.tmp", data->session_cache_file);
+	/* The file contains session master secrets */
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	f = fd >= 0 ? fdopen(fd, "wb") : NULL;
+	if (!f) {
+		wpa_printf(MSG_INFO, "OpenSSL: Could not write %s: %s",
+			   tmp, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		os_free(tmp);
+		return;
+	}
+	fwrite("HTS1", 4, 1, f);
+
+	dl_list_for_each(entry, &data->session_cache,
+			 struct tls_cached_session, list) {
+		u8 hdr[2];
+
+		success = SSL_SESSION_get_ex_data(entry->sess,
+						  tls_ex_idx_session);
+		if (!success || wpabuf_len(success) > 0xffff ||
+		    tls_session_expired(entry->sess, now))
+			continue;
+		slen = i2d_SSL_SESSION(entry->sess, NULL);
+		if (slen <= 0 || slen > 0xffff)
+			continue;
+		der = os_malloc(slen);
+		if (!der)
+			continue;
+		p = der;
+		slen = i2d_SSL_SESSION(entry->sess, &p);
+		if (slen <= 0) {
+			os_free(der);
+			continue;
+		}
+		WPA_PUT_BE16(hdr, slen);
+		fwrite(hdr, 2, 1, f);
+		fwrite(der, slen, 1, f);
+		bin_clear_free(der, slen);
+		WPA_PUT_BE16(hdr, wpabuf_len(success));
+		fwrite(hdr, 2, 1, f);
+		fwrite(wpabuf_head(success), wpabuf_len(success), 1, f);
+		count++;
+	}
+
+	if (fclose(f) != 0 || rename(tmp, data->session_cache_file) < 0) {
+		wpa_printf(MSG_INFO,
+			   "OpenSSL: Could not update TLS session cache file %s: %s",
+			   data->session_cache_file, strerror(errno));
+		unlink(tmp);
+	} else {
+		wpa_printf(MSG_DEBUG,
+			   "OpenSSL: Saved %u TLS session(s) to %s",
+			   count, data->session_cache_file);
+	}
+	os_free(tmp);
+}
+
+
 static void remove_session_cb(SSL_CTX *ctx, SSL_SESSION *sess)
 {
 	struct wpabuf *buf;
 
 	if (tls_ex_idx_session < 0)
 		return;
+	tls_session_cache_del(sess);
 	buf = SSL_SESSION_get_ex_data(sess, tls_ex_idx_session);
 	if (!buf)
 		return;
@@ -1041,9 +1270,19 @@ void * tls_init(const struct tls_config *conf)
 		return NULL;
 	}
 	data->ssl = ssl;
+	dl_list_init(&data->session_cache);
 	if (conf) {
 		data->tls_session_lifetime = conf->tls_session_lifetime;
 		data->crl_reload_interval = conf->crl_reload_interval;
+		if (conf->tls_session_lifetime > 0 &&
+		    conf->session_cache_file) {
+			data->session_cache_file =
+				os_strdup(conf->session_cache_file);
+			if (!data->session_cache_file) {
+				tls_deinit(data);
+				return NULL;
+			}
+		}
 	}
 
 	SSL_CTX_set_options(ssl, SSL_OP_NO_SSLv2);
@@ -1084,6 +1323,17 @@ void * tls_init(const struct tls_config *conf)
 		}
 	}
 
+	if (data->session_cache_file && tls_ex_idx_cache < 0) {
+		tls_ex_idx_cache = SSL_SESSION_get_ex_new_index(
+			0, NULL, NULL, NULL, NULL);
+		if (tls_ex_idx_cache < 0) {
+			tls_deinit(data);
+			return NULL;
+		}
+	}
+	if (data->session_cache_file)
+		tls_session_cache_load(data);
+
 #ifndef OPENSSL_NO_ENGINE
 	wpa_printf(MSG_DEBUG, "ENGINE: Loading builtin engines");
 	ENGINE_load_builtin_engines();
@@ -1121,8 +1371,18 @@ void tls_deinit(void *ssl_ctx)
 	struct tls_data *data = ssl_ctx;
 	SSL_CTX *ssl = data->ssl;
 	struct tls_context *context = SSL_CTX_get_app_data(ssl);
+	struct tls_cached_session *entry;
+
 	if (context != tls_global)
 		os_free(context);
+	if (data->session_cache_file) {
+		tls_session_cache_save(data);
+		while ((entry = dl_list_first(&data->session_cache,
+					      struct tls_cached_session,
+					      list)))
+			tls_session_cache_del(entry->sess);
+		os_free(data->session_cache_file);
+	}
 	if (data->tls_session_lifetime > 0)
 		SSL_CTX_flush_sessions(ssl, 0);
 	os_free(data->ca_cert);
@@ -1143,6 +1403,7 @@ void tls_deinit(void *ssl_ctx)
 #endif /* < 1.1.0 */
 		os_free(tls_global->ocsp_stapling_response);
 		tls_global->ocsp_stapling_response = NULL;
+		wpabuf_free(tls_global->ocsp_resp);
 		os_free(tls_global);
 		tls_global = NULL;
 	}
@@ -1534,34 +1795,50 @@ static void tls_msg_cb(int write_p, int version, int content_type,
 }
 
 
+int tls_global_crl_reload(void *ssl_ctx)
+{
+	struct tls_data *data = ssl_ctx;
+	X509_STORE *new_cert_store;
+	struct os_reltime start, end, diff;
+
+	if (!data->check_crl)
+		return 0;
+
+	wpa_printf(MSG_INFO, "OpenSSL: Flushing X509 store with ca_cert file");
+	os_get_reltime(&start);
+	new_cert_store = tls_crl_cert_reload(data->ca_cert, data->check_crl);
+	if (!new_cert_store) {
+		wpa_printf(MSG_ERROR,
+			   "OpenSSL: Error replacing X509 store with ca_cert file");
+		data->crl_reload_failures++;
+		return -1;
+	}
+
+	/*
+	 * The new store is fully built before it is installed, so handshakes
+	 * never see a partially loaded set of CA certificates and CRLs.
+	 */
+	SSL_CTX_set_cert_store(data->ssl, new_cert_store);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	data->crl_last_reload = end;
+	data->crl_reloads++;
+	data->crl_reload_usec = diff.sec * 1000000 + diff.usec;
+	wpa_printf(MSG_DEBUG, "OpenSSL: X509 store reloaded in %u usec",
+		   data->crl_reload_usec);
+
+	return 0;
+}
+
+
 struct tls_connection * tls_connection_init(void *ssl_ctx)
 {
 	struct tls_data *data = ssl_ctx;
 	SSL_CTX *ssl = data->ssl;
 	struct tls_connection *conn;
 	long options;
-	X509_STORE *new_cert_store;
-	struct os_reltime now;
 	struct tls_context *context = SSL_CTX_get_app_data(ssl);
 
-	/* Replace X509 store if it is time to update CRL. */
-	if (data->crl_reload_interval > 0 && os_get_reltime(&now) == 0 &&
-	    os_reltime_expired(&now, &data->crl_last_reload,
-			       data->crl_reload_interval)) {
-		wpa_printf(MSG_INFO,
-			   "OpenSSL: Flushing X509 store with ca_cert file");
-		new_cert_store = tls_crl_cert_reload(data->ca_cert,
-						     data->check_crl);
-		if (!new_cert_store) {
-			wpa_printf(MSG_ERROR,
-				   "OpenSSL: Error replacing X509 store with ca_cert file");
-		} else {
-			/* Replace old store */
-			SSL_CTX_set_cert_store(ssl, new_cert_store);
-			data->crl_last_reload = now;
-		}
-	}
-
 	conn = os_zalloc(sizeof(*conn));
 	if (conn == NULL)
 		return NULL;
@@ -4439,11 +4716,16 @@ openssl_connection_handshake(struct tls_connection *conn,
 			     struct wpabuf **appl_data)
 {
 	struct wpabuf *out_data;
+	struct os_reltime start, end, diff;
 
 	if (appl_data)
 		*appl_data = NULL;
 
+	os_get_reltime(&start);
 	out_data = openssl_handshake(conn, in_data);
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	conn->hs_usec += diff.sec * 1000000 + diff.usec;
 	if (out_data == NULL)
 		return NULL;
 	if (conn->invalid_hb_used) {
@@ -4456,6 +4738,20 @@ openssl_connection_handshake(struct tls_connection *conn,
 		wpa_printf(MSG_DEBUG,
 			   "OpenSSL: Handshake finished - resumed=%d",
 			   tls_connection_resumed(conn->ssl_ctx, conn));
+		if (!conn->hs_counted) {
+			struct tls_data *data = conn->data;
+
+			conn->hs_counted = 1;
+			data->hs_count++;
+			if (tls_connection_resumed(conn->ssl_ctx, conn))
+				data->hs_resumed++;
+			data->hs_usec_total += conn->hs_usec;
+			if (conn->hs_usec > data->hs_usec_max)
+				data->hs_usec_max = conn->hs_usec;
+			wpa_printf(MSG_DEBUG,
+				   "OpenSSL: Handshake processing time %u usec",
+				   conn->hs_usec);
+		}
 		if (conn->server) {
 			char *buf;
 			size_t buflen = 2000;
@@ -4979,18 +5275,81 @@ static int ocsp_resp_cb(SSL *s, void *arg)
 }
 
 
-static int ocsp_status_cb(SSL *s, void *arg)
+/* Minimum interval in seconds between checks for OCSP response file updates */
+#define OCSP_RESP_CHECK_INTERVAL 1
+
+static void ocsp_resp_cache_flush(struct tls_context *context)
 {
-	char *tmp;
+	wpabuf_free(context->ocsp_resp);
+	context->ocsp_resp = NULL;
+	context->ocsp_last_check.sec = 0;
+	context->ocsp_last_check.usec = 0;
+}
+
+
+static const struct wpabuf * ocsp_resp_cached(struct tls_context *context)
+{
+	struct os_reltime now;
+	struct stat st;
 	char *resp;
 	size_t len;
 
+	os_get_reltime(&now);
+	if (context->ocsp_resp &&
+	    !os_reltime_expired(&now, &context->ocsp_last_check,
+				OCSP_RESP_CHECK_INTERVAL)) {
+		context->ocsp_cache_hits++;
+		return context->ocsp_resp;
+	}
+	context->ocsp_last_check = now;
+
+	if (stat(context->ocsp_stapling_response, &st) < 0) {
+		ocsp_resp_cache_flush(context);
+		return NULL;
+	}
+
+	/* The response file is commonly replaced with rename(), so check the
+	 * inode in addition to the modification time and size. */
+	if (context->ocsp_resp && st.st_mtime == context->ocsp_resp_mtime &&
+	    st.st_size == context->ocsp_resp_size &&
+	    st.st_ino == context->ocsp_resp_ino) {
+		context->ocsp_cache_hits++;
+		return context->ocsp_resp;
+	}
+
+	resp = os_readfile(context->ocsp_stapling_response, &len);
+	if (!resp) {
+		ocsp_resp_cache_flush(context);
+		return NULL;
+	}
+	wpabuf_free(context->ocsp_resp);
+	context->ocsp_resp = wpabuf_alloc_ext_data((u8 *) resp, len);
+	if (!context->ocsp_resp) {
+		os_free(resp);
+		return NULL;
+	}
+	context->ocsp_resp_mtime = st.st_mtime;
+	context->ocsp_resp_size = st.st_size;
+	context->ocsp_resp_ino = st.st_ino;
+	context->ocsp_cache_reloads++;
+	wpa_printf(MSG_DEBUG, "OpenSSL: Loaded OCSP response (%u bytes) from %s",
+		   (unsigned int) len, context->ocsp_stapling_response);
+
+	return context->ocsp_resp;
+}
+
+
+static int ocsp_status_cb(SSL *s, void *arg)
+{
+	const struct wpabuf *resp;
+	char *tmp;
+
 	if (tls_global->ocsp_stapling_response == NULL) {
 		wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - no response configured");
 		return SSL_TLSEXT_ERR_OK;
 	}
 
-	resp = os_readfile(tls_global->ocsp_stapling_response, &len);
+	resp = ocsp_resp_cached(tls_global);
 	if (resp == NULL) {
 		wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - could not read response file");
 		/* TODO: Build OCSPResponse with responseStatus = internalError
@@ -4998,15 +5357,12 @@ static int ocsp_status_cb(SSL *s, void *arg)
 		return SSL_TLSEXT_ERR_OK;
 	}
 	wpa_printf(MSG_DEBUG, "OpenSSL: OCSP status callback - send cached response");
-	tmp = OPENSSL_malloc(len);
-	if (tmp == NULL) {
-		os_free(resp);
+	tmp = OPENSSL_malloc(wpabuf_len(resp));
+	if (tmp == NULL)
 		return SSL_TLSEXT_ERR_ALERT_FATAL;
-	}
 
-	os_memcpy(tmp, resp, len);
-	os_free(resp);
-	SSL_set_tlsext_status_ocsp_resp(s, tmp, len);
+	os_memcpy(tmp, wpabuf_head(resp), wpabuf_len(resp));
+	SSL_set_tlsext_status_ocsp_resp(s, tmp, wpabuf_len(resp));
 
 	return SSL_TLSEXT_ERR_OK;
 }
@@ -5519,6 +5875,7 @@ int tls_global_set_params(void *tls_ctx,
 #ifdef HAVE_OCSP
 	SSL_CTX_set_tlsext_status_cb(ssl_ctx, ocsp_status_cb);
 	SSL_CTX_set_tlsext_status_arg(ssl_ctx, ssl_ctx);
+	ocsp_resp_cache_flush(tls_global);
 	os_free(tls_global->ocsp_stapling_response);
 	if (params->ocsp_stapling_response)
 		tls_global->ocsp_stapling_response =
@@ -5659,6 +6016,39 @@ int tls_get_library_version(char *buf, size_t buf_len)
 }
 
 
+int tls_get_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	struct tls_data *data = tls_ctx;
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "tls_handshakes=%u\n"
+			  "tls_handshakes_resumed=%u\n"
+			  "tls_handshake_usec_avg=%llu\n"
+			  "tls_handshake_usec_max=%u\n"
+			  "tls_crl_reloads=%u\n"
+			  "tls_crl_reload_failures=%u\n"
+			  "tls_crl_reload_usec=%u\n"
+			  "tls_ocsp_cache_hits=%u\n"
+			  "tls_ocsp_cache_reloads=%u\n"
+			  "tls_session_cache_entries=%u\n"
+			  "tls_session_cache_loaded=%u\n",
+			  data->hs_count, data->hs_resumed,
+			  data->hs_count ?
+			  data->hs_usec_total / data->hs_count : 0,
+			  data->hs_usec_max,
+			  data->crl_reloads, data->crl_reload_failures,
+			  data->crl_reload_usec,
+			  tls_global ? tls_global->ocsp_cache_hits : 0,
+			  tls_global ? tls_global->ocsp_cache_reloads : 0,
+			  dl_list_len(&data->session_cache),
+			  data->session_cache_loaded);
+	if (os_snprintf_error(buflen, ret))
+		return -1;
+	return ret;
+}
+
+
 void tls_connection_set_success_data(struct tls_connection *conn,
 				     struct wpabuf *data)
 {
@@ -5681,6 +6071,11 @@ void tls_connection_set_success_data(struct tls_connection *conn,
 
 	wpa_printf(MSG_DEBUG, "OpenSSL: Stored success data %p", data);
 	conn->success_data = 1;
+	if (conn->data->session_cache_file) {
+		/* Make sure the session stays resumable after a restart */
+		SSL_CTX_add_session(conn->ssl_ctx, sess);
+		tls_session_cache_add(conn->data, sess);
+	}
 	return;
 
 fail:
@@ -1953,6 +1953,18 @@ int tls_get_library_version(char *buf, size_t buf_len)
 			   WOLFSSL_VERSION, wolfSSL_lib_version());
 }
 
+
+int tls_get_stats(void *tls_ctx, char *buf, size_t buflen)
+{
+	return -1;
+}
+
+
+int tls_global_crl_reload(void *tls_ctx)
+{
+	return -1;
+}
+
 int tls_get_version(void *ssl_ctx, struct tls_connection *conn,
 		    char *buf, size_t buflen)
 {
@@ -2031,6 +2031,8 @@ struct wpa_driver_capa {
 #define WPA_DRIVER_FLAGS2_SA_QUERY_OFFLOAD_AP	0x0000000000000200ULL
 /** Driver supports background radar/CAC detection */
 #define WPA_DRIVER_RADAR_BACKGROUND		0x0000000000000400ULL
+/** Driver can replace an existing STA entry in sta_add() (remove_old) */
+#define WPA_DRIVER_FLAGS2_STA_ADD_REMOVE_OLD	0x0000000000000800ULL
 	u64 flags2;
 
 #define FULL_AP_CLIENT_STATE_SUPP(drv_flags) \
@@ -2184,6 +2186,22 @@ struct hostap_sta_driver_data {
 	u8 tx_vht_nss;
 };
 
+/**
+ * struct hostap_sta_data_list - Driver data for all stations
+ * @entries: Per-station data; the array is grown by the driver wrapper as
+ *	needed and kept allocated by the caller for reuse between calls
+ * @num: Number of valid entries
+ * @size: Number of allocated entries
+ */
+struct hostap_sta_data_list {
+	struct hostap_sta_data_entry {
+		u8 addr[ETH_ALEN];
+		struct hostap_sta_driver_data data;
+	} *entries;
+	size_t num;
+	size_t size;
+};
+
 struct hostapd_sta_add_params {
 	const u8 *addr;
 	u16 aid;
@@ -2213,6 +2231,9 @@ struct hostapd_sta_add_params {
 	const u8 *supp_oper_classes;
 	size_t supp_oper_classes_len;
 	int support_p2p_ps;
+	/* Remove any existing STA entry before adding the new one; only used
+	 * with drivers indicating WPA_DRIVER_FLAGS2_STA_ADD_REMOVE_OLD */
+	int remove_old;
 };
 
 struct mac_address {
@@ -3121,6 +3142,20 @@ struct wpa_driver_ops {
 	int (*read_sta_data)(void *priv, struct hostap_sta_driver_data *data,
 			     const u8 *addr);
 
+	/**
+	 * read_all_sta_data - Fetch station data for all stations
+	 * @priv: Private driver interface data
+	 * @list: Buffer for returning station information; entries are
+	 *	appended after list->num and list->entries is reallocated as
+	 *	needed
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * This is an optional alternative to calling read_sta_data() for each
+	 * station when the data is needed for all stations at the same time.
+	 */
+	int (*read_all_sta_data)(void *priv,
+				 struct hostap_sta_data_list *list);
+
 	/**
 	 * tx_control_port - Send a frame over the 802.1X controlled port
 	 * @priv: Private driver interface data
@@ -3307,6 +3342,27 @@ struct wpa_driver_ops {
 			     unsigned int total_flags, unsigned int flags_or,
 			     unsigned int flags_and);
 
+	/**
+	 * sta_batch_start - Start queuing station configuration (AP only)
+	 * @priv: Private driver interface data
+	 * @addr: Station address
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * After this, sta_set_flags() and set_sta_vlan() calls for the station
+	 * are queued and return 0 instead of waiting for the driver. The queued
+	 * commands are submitted together with sta_batch_commit(), which must
+	 * be called before returning to the event loop.
+	 */
+	int (*sta_batch_start)(void *priv, const u8 *addr);
+
+	/**
+	 * sta_batch_commit - Submit queued station configuration (AP only)
+	 * @priv: Private driver interface data
+	 * Returns: 0 if all queued commands succeeded, the first error of the
+	 * queued commands (negative errno), or -1 if no batch was started
+	 */
+	int (*sta_batch_commit)(void *priv);
+
 	/**
 	 * sta_set_airtime_weight - Set station airtime weight (AP only)
 	 * @priv: Private driver interface data
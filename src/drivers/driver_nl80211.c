@@ -197,6 +197,7 @@ static int nl80211_put_mesh_config(struct nl_msg *msg,
 #endif /* CONFIG_MESH */
 static int i802_sta_disassoc(void *priv, const u8 *own_addr, const u8 *addr,
 			     u16 reason);
+static void rtnl_neigh_delete_fdb_entry(struct i802_bss *bss, const u8 *addr);
 
 
 /* Converts nl80211_chan_width to a common format */
@@ -387,6 +388,22 @@ static void nl80211_nlmsg_clear(struct nl_msg *msg)
 }
 
 
+static void nl80211_set_ext_ack(struct nl_sock *nl_handle)
+{
+	int opt;
+
+	/* try to set NETLINK_EXT_ACK to 1, ignoring errors */
+	opt = 1;
+	setsockopt(nl_socket_get_fd(nl_handle), SOL_NETLINK,
+		   NETLINK_EXT_ACK, &opt, sizeof(opt));
+
+	/* try to set NETLINK_CAP_ACK to 1, ignoring errors */
+	opt = 1;
+	setsockopt(nl_socket_get_fd(nl_handle), SOL_NETLINK,
+		   NETLINK_CAP_ACK, &opt, sizeof(opt));
+}
+
+
 static int send_and_recv(struct nl80211_global *global,
 			 struct nl_sock *nl_handle, struct nl_msg *msg,
 			 int (*valid_handler)(struct nl_msg *, void *),
@@ -395,7 +412,7 @@ static int send_and_recv(struct nl80211_global *global,
 			 void *ack_data)
 {
 	struct nl_cb *cb;
-	int err = -ENOMEM, opt;
+	int err = -ENOMEM;
 
 	if (!msg)
 		return -ENOMEM;
@@ -404,15 +421,7 @@ static int send_and_recv(struct nl80211_global *global,
 	if (!cb)
 		goto out;
 
-	/* try to set NETLINK_EXT_ACK to 1, ignoring errors */
-	opt = 1;
-	setsockopt(nl_socket_get_fd(nl_handle), SOL_NETLINK,
-		   NETLINK_EXT_ACK, &opt, sizeof(opt));
-
-	/* try to set NETLINK_CAP_ACK to 1, ignoring errors */
-	opt = 1;
-	setsockopt(nl_socket_get_fd(nl_handle), SOL_NETLINK,
-		   NETLINK_CAP_ACK, &opt, sizeof(opt));
+	nl80211_set_ext_ack(nl_handle);
 
 	err = nl_send_auto_complete(nl_handle, msg);
 	if (err < 0) {
@@ -475,6 +484,230 @@ static int send_and_recv(struct nl80211_global *global,
 }
 
 
+struct nl80211_batch_cmd {
+	struct dl_list list;
+	struct nl_msg *msg;
+	u32 seq;
+	int err;
+	bool wait; /* sent and waiting for the response */
+	void (*done)(void *ctx, int err);
+	void *ctx;
+};
+
+
+static void nl80211_batch_cmd_free(struct nl80211_batch_cmd *cmd)
+{
+	if (cmd->msg) {
+		/* Always clear the message as it can potentially contain keys
+		 */
+		nl80211_nlmsg_clear(cmd->msg);
+		nlmsg_free(cmd->msg);
+	}
+	os_free(cmd);
+}
+
+
+static struct nl80211_batch_cmd *
+nl80211_batch_find(struct nl80211_batch *batch, u32 seq)
+{
+	struct nl80211_batch_cmd *cmd;
+
+	dl_list_for_each(cmd, &batch->cmds, struct nl80211_batch_cmd, list) {
+		if (cmd->wait && cmd->seq == seq)
+			return cmd;
+	}
+	return NULL;
+}
+
+
+static void nl80211_batch_result(struct nl80211_batch *batch,
+				 struct nl80211_batch_cmd *cmd, int err)
+{
+	cmd->wait = false;
+	cmd->err = err;
+	batch->waiting--;
+}
+
+
+static int batch_ack_handler(struct nl_msg *msg, void *arg)
+{
+	struct nl80211_batch *batch = arg;
+	struct nl80211_batch_cmd *cmd;
+
+	cmd = nl80211_batch_find(batch, nlmsg_hdr(msg)->nlmsg_seq);
+	if (cmd && TEST_FAIL()) {
+		wpa_printf(MSG_INFO,
+			   "nl80211: TESTING - drop ACK for batched command");
+		return NL_SKIP;
+	}
+	if (cmd)
+		nl80211_batch_result(batch, cmd, 0);
+	return NL_SKIP;
+}
+
+
+static int batch_error_handler(struct sockaddr_nl *nla, struct nlmsgerr *err,
+			       void *arg)
+{
+	struct nl80211_batch *batch = arg;
+	struct nl80211_batch_cmd *cmd;
+	int res = 0;
+
+	error_handler(nla, err, &res);
+	cmd = nl80211_batch_find(batch, err->msg.nlmsg_seq);
+	if (cmd)
+		nl80211_batch_result(batch, cmd, res);
+	return NL_SKIP;
+}
+
+
+/**
+ * nl80211_batch_init - Initialize an nl80211 command batch
+ * @batch: Batch to initialize
+ * @bss: BSS the commands are for
+ */
+void nl80211_batch_init(struct nl80211_batch *batch, struct i802_bss *bss)
+{
+	batch->bss = bss;
+	dl_list_init(&batch->cmds);
+	batch->waiting = 0;
+}
+
+
+/**
+ * nl80211_batch_add - Queue an nl80211 command to a batch
+ * @batch: Batch from nl80211_batch_init()
+ * @msg: nl80211 command; the batch takes ownership of the message
+ * @done: Optional callback for the command result
+ * @ctx: Context for the done callback
+ * Returns: 0 on success or -ENOMEM on failure
+ */
+int nl80211_batch_add(struct nl80211_batch *batch, struct nl_msg *msg,
+		      void (*done)(void *ctx, int err), void *ctx)
+{
+	struct nl80211_batch_cmd *cmd;
+
+	if (!msg)
+		return -ENOMEM;
+
+	cmd = os_zalloc(sizeof(*cmd));
+	if (!cmd) {
+		nlmsg_free(msg);
+		return -ENOMEM;
+	}
+	cmd->msg = msg;
+	cmd->done = done;
+	cmd->ctx = ctx;
+	dl_list_add_tail(&batch->cmds, &cmd->list);
+
+	return 0;
+}
+
+
+/* Done callback for nl80211_batch_add() that stores the result in an int */
+void nl80211_batch_store_result(void *ctx, int err)
+{
+	int *res = ctx;
+
+	*res = err;
+}
+
+
+/**
+ * nl80211_batch_send - Send all queued commands of a batch
+ * @batch: Batch from nl80211_batch_init(); empty when this returns
+ *
+ * All queued commands are sent without reading the response to the previous
+ * one in between. nl80211 processes a command while it is being sent and
+ * queues the ACK or error to the socket before the send returns, so the
+ * responses are then read without waiting. Each done callback is called in
+ * the order the commands were queued before this returns, with 0, the error
+ * reported by the kernel, -EBADF if the command could not be sent, or -EIO if
+ * no response was found (e.g., the socket receive buffer overflowed).
+ */
+void nl80211_batch_send(struct nl80211_batch *batch)
+{
+	struct nl80211_global *global = batch->bss->drv->global;
+	struct nl80211_batch_cmd *cmd;
+	struct nl_cb *cb;
+	int res;
+
+	if (dl_list_empty(&batch->cmds))
+		return;
+
+	dl_list_for_each(cmd, &batch->cmds, struct nl80211_batch_cmd, list) {
+		res = TEST_FAIL() ? -NLE_FAILURE :
+			nl_send_auto_complete(global->nl_batch, cmd->msg);
+		if (res < 0) {
+			wpa_printf(MSG_INFO,
+				   "nl80211: nl_send_auto_complete() failed: %s",
+				   nl_geterror(res));
+			cmd->err = -EBADF;
+		} else {
+			cmd->seq = nlmsg_hdr(cmd->msg)->nlmsg_seq;
+			cmd->wait = true;
+			batch->waiting++;
+		}
+	}
+
+	cb = nl_cb_alloc(NL_CB_DEFAULT);
+	if (cb) {
+		nl_cb_set(cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, no_seq_check,
+			  NULL);
+		nl_cb_err(cb, NL_CB_CUSTOM, batch_error_handler, batch);
+		nl_cb_set(cb, NL_CB_ACK, NL_CB_CUSTOM, batch_ack_handler,
+			  batch);
+	}
+	while (cb && batch->waiting) {
+		/* The socket is non-blocking, so this stops with -NLE_AGAIN
+		 * once all queued responses have been read */
+		res = nl_recvmsgs(global->nl_batch, cb);
+		if (res < 0) {
+			wpa_printf(MSG_INFO,
+				   "nl80211: %s->nl_recvmsgs failed: %d (%s)",
+				   __func__, res, nl_geterror(res));
+			break;
+		}
+	}
+	nl_cb_put(cb);
+
+	while ((cmd = dl_list_first(&batch->cmds, struct nl80211_batch_cmd,
+				    list))) {
+		dl_list_del(&cmd->list);
+		if (cmd->wait) {
+			wpa_printf(MSG_INFO,
+				   "nl80211: No response to batched command (seq=%u)",
+				   cmd->seq);
+			cmd->err = -EIO;
+		}
+		if (cmd->err)
+			wpa_printf(MSG_DEBUG,
+				   "nl80211: Batched command (seq=%u) failed: %d (%s)",
+				   cmd->seq, cmd->err, strerror(-cmd->err));
+		if (cmd->done)
+			cmd->done(cmd->ctx, cmd->err);
+		nl80211_batch_cmd_free(cmd);
+	}
+	batch->waiting = 0;
+}
+
+
+/**
+ * nl80211_batch_flush - Drop the queued commands of a batch without sending
+ * @batch: Batch from nl80211_batch_init()
+ */
+void nl80211_batch_flush(struct nl80211_batch *batch)
+{
+	struct nl80211_batch_cmd *cmd;
+
+	while ((cmd = dl_list_first(&batch->cmds, struct nl80211_batch_cmd,
+				    list))) {
+		dl_list_del(&cmd->list);
+		nl80211_batch_cmd_free(cmd);
+	}
+}
+
+
 int send_and_recv_msgs(struct wpa_driver_nl80211_data *drv,
 		       struct nl_msg *msg,
 		       int (*valid_handler)(struct nl_msg *, void *),
@@ -1934,6 +2167,18 @@ static int wpa_driver_nl80211_init_nl_global(struct nl80211_global *global)
 		/* Continue without vendor events */
 	}
 
+	/*
+	 * Separate socket for batched commands. global->nl does not check
+	 * sequence numbers, so a response to a batched command that was not
+	 * read there (e.g., after a failed send or a receive error) would be
+	 * taken as the result of the next synchronous command. The batch
+	 * handlers match responses by sequence number and ignore stale ones.
+	 */
+	global->nl_batch = nl_create_handle(global->nl_cb, "batch");
+	if (!global->nl_batch)
+		goto err;
+	nl_socket_set_nonblocking(global->nl_batch);
+
 	nl_cb_set(global->nl_cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM,
 		  no_seq_check, NULL);
 	nl_cb_set(global->nl_cb, NL_CB_VALID, NL_CB_CUSTOM,
@@ -1942,10 +2187,12 @@ static int wpa_driver_nl80211_init_nl_global(struct nl80211_global *global)
 	nl80211_register_eloop_read(&global->nl_event,
 				    wpa_driver_nl80211_event_receive,
 				    global->nl_cb, 0);
+	nl80211_set_ext_ack(global->nl_batch);
 
 	return 0;
 
 err:
+	nl_destroy_handles(&global->nl_batch);
 	nl_destroy_handles(&global->nl_event);
 	nl_destroy_handles(&global->nl);
 	nl_cb_put(global->nl_cb);
@@ -2115,6 +2362,11 @@ static int nl80211_init_bss(struct i802_bss *bss)
 
 static void nl80211_destroy_bss(struct i802_bss *bss)
 {
+	if (bss->sta_batch_active) {
+		nl80211_batch_flush(&bss->sta_batch);
+		bss->sta_batch_active = false;
+	}
+
 	nl_cb_put(bss->nl_cb);
 	bss->nl_cb = NULL;
 
@@ -5073,6 +5325,30 @@ static u32 sta_plink_state_nl80211(enum mesh_plink_state state)
 #endif /* CONFIG_MESH */
 
 
+static struct nl_msg * nl80211_sta_remove_msg(struct i802_bss *bss,
+					      const u8 *addr, int deauth,
+					      u16 reason_code)
+{
+	struct nl_msg *msg;
+
+	if (!(msg = nl80211_bss_msg(bss, 0, NL80211_CMD_DEL_STATION)) ||
+	    nla_put(msg, NL80211_ATTR_MAC, ETH_ALEN, addr) ||
+	    (deauth == 0 &&
+	     nla_put_u8(msg, NL80211_ATTR_MGMT_SUBTYPE,
+			WLAN_FC_STYPE_DISASSOC)) ||
+	    (deauth == 1 &&
+	     nla_put_u8(msg, NL80211_ATTR_MGMT_SUBTYPE,
+			WLAN_FC_STYPE_DEAUTH)) ||
+	    (reason_code &&
+	     nla_put_u16(msg, NL80211_ATTR_REASON_CODE, reason_code))) {
+		nlmsg_free(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+
 static int wpa_driver_nl80211_sta_add(void *priv,
 				      struct hostapd_sta_add_params *params)
 {
@@ -5300,8 +5576,35 @@ static int wpa_driver_nl80211_sta_add(void *priv,
 		nla_nest_end(msg, wme);
 	}
 
-	ret = send_and_recv_msgs(drv, msg, NULL, NULL, NULL, NULL);
-	msg = NULL;
+	if (params->remove_old && !params->set) {
+		struct nl80211_batch batch;
+
+		/*
+		 * Remove the old STA entry and add the new one back-to-back.
+		 * The result of DEL_STATION (typically -ENOENT if there was no
+		 * entry) is only logged. ret stays -ENOBUFS if NEW_STATION
+		 * could not be queued.
+		 */
+		ret = -ENOBUFS;
+		nl80211_batch_init(&batch, bss);
+		if (nl80211_batch_add(&batch,
+				      nl80211_sta_remove_msg(bss, params->addr,
+							     -1, 0),
+				      NULL, NULL) < 0)
+			goto fail;
+		nl80211_batch_add(&batch, msg, nl80211_batch_store_result,
+				  &ret);
+		msg = NULL;
+		nl80211_batch_send(&batch);
+		wpa_printf(MSG_DEBUG, "nl80211: sta_add -> DEL_STATION %s "
+			   MACSTR " (batched)",
+			   bss->ifname, MAC2STR(params->addr));
+		if (drv->rtnl_sk)
+			rtnl_neigh_delete_fdb_entry(bss, params->addr);
+	} else {
+		ret = send_and_recv_msgs(drv, msg, NULL, NULL, NULL, NULL);
+		msg = NULL;
+	}
 	if (ret)
 		wpa_printf(MSG_DEBUG, "nl80211: NL80211_CMD_%s_STATION "
 			   "result: %d (%s)", params->set ? "SET" : "NEW", ret,
@@ -5358,19 +5661,9 @@ static int wpa_driver_nl80211_sta_remove(struct i802_bss *bss, const u8 *addr,
 	struct nl_msg *msg;
 	int ret;
 
-	if (!(msg = nl80211_bss_msg(bss, 0, NL80211_CMD_DEL_STATION)) ||
-	    nla_put(msg, NL80211_ATTR_MAC, ETH_ALEN, addr) ||
-	    (deauth == 0 &&
-	     nla_put_u8(msg, NL80211_ATTR_MGMT_SUBTYPE,
-			WLAN_FC_STYPE_DISASSOC)) ||
-	    (deauth == 1 &&
-	     nla_put_u8(msg, NL80211_ATTR_MGMT_SUBTYPE,
-			WLAN_FC_STYPE_DEAUTH)) ||
-	    (reason_code &&
-	     nla_put_u16(msg, NL80211_ATTR_REASON_CODE, reason_code))) {
-		nlmsg_free(msg);
+	msg = nl80211_sta_remove_msg(bss, addr, deauth, reason_code);
+	if (!msg)
 		return -ENOBUFS;
-	}
 
 	ret = send_and_recv_msgs(drv, msg, NULL, NULL, NULL, NULL);
 	wpa_printf(MSG_DEBUG, "nl80211: sta_remove -> DEL_STATION %s " MACSTR
@@ -5786,6 +6079,61 @@ static int wpa_driver_nl80211_hapd_send_eapol(
 }
 
 
+static void nl80211_sta_batch_done(void *ctx, int err)
+{
+	struct i802_bss *bss = ctx;
+
+	if (err && !bss->sta_batch_err)
+		bss->sta_batch_err = err;
+}
+
+
+/* Send a STA configuration command or queue it if a batch for the STA has
+ * been started with nl80211_sta_batch_start() */
+static int nl80211_sta_cmd(struct i802_bss *bss, const u8 *addr,
+			   struct nl_msg *msg)
+{
+	if (!bss->sta_batch_active ||
+	    os_memcmp(addr, bss->sta_batch_addr, ETH_ALEN) != 0)
+		return send_and_recv_msgs(bss->drv, msg, NULL, NULL, NULL,
+					  NULL);
+
+	return nl80211_batch_add(&bss->sta_batch, msg, nl80211_sta_batch_done,
+				 bss);
+}
+
+
+static int nl80211_sta_batch_start(void *priv, const u8 *addr)
+{
+	struct i802_bss *bss = priv;
+
+	if (bss->sta_batch_active)
+		return -1;
+	os_memcpy(bss->sta_batch_addr, addr, ETH_ALEN);
+	bss->sta_batch_err = 0;
+	nl80211_batch_init(&bss->sta_batch, bss);
+	bss->sta_batch_active = true;
+	return 0;
+}
+
+
+static int nl80211_sta_batch_commit(void *priv)
+{
+	struct i802_bss *bss = priv;
+
+	if (!bss->sta_batch_active)
+		return -1;
+	if (!dl_list_empty(&bss->sta_batch.cmds))
+		wpa_printf(MSG_DEBUG,
+			   "nl80211: Send %u batched command(s) for STA "
+			   MACSTR, dl_list_len(&bss->sta_batch.cmds),
+			   MAC2STR(bss->sta_batch_addr));
+	nl80211_batch_send(&bss->sta_batch);
+	bss->sta_batch_active = false;
+	return bss->sta_batch_err;
+}
+
+
 static int wpa_driver_nl80211_sta_set_flags(void *priv, const u8 *addr,
 					    unsigned int total_flags,
 					    unsigned int flags_or,
@@ -5831,7 +6179,7 @@ static int wpa_driver_nl80211_sta_set_flags(void *priv, const u8 *addr,
 	if (nla_put(msg, NL80211_ATTR_STA_FLAGS2, sizeof(upd), &upd))
 		goto fail;
 
-	return send_and_recv_msgs(bss->drv, msg, NULL, NULL, NULL, NULL);
+	return nl80211_sta_cmd(bss, addr, msg);
 fail:
 	nlmsg_free(msg);
 	return -ENOBUFS;
@@ -7219,6 +7567,78 @@ static int i802_read_sta_data(struct i802_bss *bss,
 }
 
 
+struct get_all_sta_ctx {
+	struct hostap_sta_data_list *list;
+	int ifindex;
+	int err;
+};
+
+static int get_all_sta_handler(struct nl_msg *msg, void *arg)
+{
+	struct get_all_sta_ctx *ctx = arg;
+	struct hostap_sta_data_list *list = ctx->list;
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct hostap_sta_data_entry *entry;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+	if (!tb[NL80211_ATTR_MAC] ||
+	    nla_len(tb[NL80211_ATTR_MAC]) != ETH_ALEN ||
+	    (tb[NL80211_ATTR_IFINDEX] &&
+	     (int) nla_get_u32(tb[NL80211_ATTR_IFINDEX]) != ctx->ifindex))
+		return NL_SKIP;
+
+	if (list->num == list->size) {
+		size_t size = list->size ? list->size * 2 : 16;
+
+		entry = os_realloc_array(list->entries, size, sizeof(*entry));
+		if (!entry) {
+			ctx->err = -ENOMEM;
+			return NL_SKIP;
+		}
+		list->entries = entry;
+		list->size = size;
+	}
+
+	entry = &list->entries[list->num];
+	os_memset(entry, 0, sizeof(*entry));
+	os_memcpy(entry->addr, nla_data(tb[NL80211_ATTR_MAC]), ETH_ALEN);
+	get_sta_handler(msg, &entry->data);
+	list->num++;
+
+	return NL_SKIP;
+}
+
+
+static int i802_read_all_sta_data(void *priv,
+				  struct hostap_sta_data_list *list)
+{
+	struct i802_bss *bss = priv;
+	struct get_all_sta_ctx ctx;
+	struct nl_msg *msg;
+	int ret;
+
+	msg = nl80211_bss_msg(bss, NLM_F_DUMP, NL80211_CMD_GET_STATION);
+	if (!msg)
+		return -1;
+
+	ctx.list = list;
+	ctx.ifindex = bss->ifindex;
+	ctx.err = 0;
+	ret = send_and_recv_msgs(bss->drv, msg, get_all_sta_handler, &ctx,
+				 NULL, NULL);
+	if (ret || ctx.err) {
+		wpa_printf(MSG_DEBUG,
+			   "nl80211: Station data dump failed: ret=%d err=%d",
+			   ret, ctx.err);
+		return -1;
+	}
+
+	return 0;
+}
+
+
 static int i802_set_tx_queue_params(void *priv, int queue, int aifs,
 				    int cw_min, int cw_max, int burst_time)
 {
@@ -7305,7 +7725,7 @@ static int i802_set_sta_vlan(struct i802_bss *bss, const u8 *addr,
 		return -ENOBUFS;
 	}
 
-	ret = send_and_recv_msgs(drv, msg, NULL, NULL, NULL, NULL);
+	ret = nl80211_sta_cmd(bss, addr, msg);
 	if (ret < 0) {
 		wpa_printf(MSG_ERROR, "nl80211: NL80211_ATTR_STA_VLAN (addr="
 			   MACSTR " ifname=%s vlan_id=%d) failed: %d (%s)",
@@ -8039,6 +8459,10 @@ static int wpa_driver_nl80211_if_remove(struct i802_bss *bss,
 
 	wpa_printf(MSG_DEBUG, "nl80211: %s(type=%d ifname=%s) ifindex=%d added_if=%d",
 		   __func__, type, ifname, ifindex, bss->added_if);
+	/* A queued STA VLAN change has to move the STA away from the interface
+	 * before it is removed */
+	if (bss->sta_batch_active)
+		nl80211_batch_send(&bss->sta_batch);
 	if (ifindex > 0 && (bss->added_if || bss->ifindex != ifindex))
 		nl80211_remove_iface(drv, ifindex);
 	else if (ifindex > 0 && !bss->added_if) {
@@ -8763,6 +9187,8 @@ static void nl80211_global_deinit(void *priv)
 	if (global->nl_event)
 		nl80211_destroy_eloop_handle(&global->nl_event, 0);
 
+	nl_destroy_handles(&global->nl_batch);
+
 	nl_cb_put(global->nl_cb);
 
 	if (global->ioctl_sock >= 0)
@@ -12194,6 +12620,8 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.tx_control_port = nl80211_tx_control_port,
 	.hapd_send_eapol = wpa_driver_nl80211_hapd_send_eapol,
 	.sta_set_flags = wpa_driver_nl80211_sta_set_flags,
+	.sta_batch_start = nl80211_sta_batch_start,
+	.sta_batch_commit = nl80211_sta_batch_commit,
 	.sta_set_airtime_weight = driver_nl80211_sta_set_airtime_weight,
 	.hapd_init = i802_init,
 	.hapd_deinit = i802_deinit,
@@ -12209,6 +12637,7 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.sta_deauth = i802_sta_deauth,
 	.sta_disassoc = i802_sta_disassoc,
 	.read_sta_data = driver_nl80211_read_sta_data,
+	.read_all_sta_data = i802_read_all_sta_data,
 	.set_freq = i802_set_freq,
 	.send_action = driver_nl80211_send_action,
 	.send_action_cancel_wait = wpa_driver_nl80211_send_action_cancel_wait,
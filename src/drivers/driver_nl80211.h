@@ -22,6 +22,17 @@
 	nla_nest_start(msg, NLA_F_NESTED | (attrtype))
 #endif
 
+/*
+ * Batch of nl80211 commands that are sent back-to-back on the global batch
+ * socket before reading the responses. Only commands that are acknowledged
+ * with a single ACK/error message (i.e., no dumps or replies) can be batched.
+ */
+struct nl80211_batch {
+	struct i802_bss *bss;
+	struct dl_list cmds; /* struct nl80211_batch_cmd */
+	unsigned int waiting; /* sent commands without a response */
+};
+
 struct nl80211_global {
 	void *ctx;
 	struct dl_list interfaces;
@@ -36,6 +47,8 @@ struct nl80211_global {
 	int ioctl_sock; /* socket for ioctl() use */
 
 	struct nl_sock *nl_event;
+
+	struct nl_sock *nl_batch;
 };
 
 struct nl80211_wiphy_data {
@@ -80,6 +93,13 @@ struct i802_bss {
 	struct nl80211_wiphy_data *wiphy_data;
 	struct dl_list wiphy_list;
 	u8 rand_addr[ETH_ALEN];
+
+	/* STA configuration commands queued between sta_batch_start() and
+	 * sta_batch_commit() */
+	struct nl80211_batch sta_batch;
+	bool sta_batch_active;
+	u8 sta_batch_addr[ETH_ALEN];
+	int sta_batch_err; /* first error of the queued commands */
 };
 
 struct drv_nl80211_if_info {
@@ -250,6 +270,13 @@ int send_and_recv_msgs(struct wpa_driver_nl80211_data *drv, struct nl_msg *msg,
 		       int (*ack_handler_custom)(struct nl_msg *, void *),
 		       void *ack_data);
 struct nl_sock * get_connect_handle(struct i802_bss *bss);
+
+void nl80211_batch_init(struct nl80211_batch *batch, struct i802_bss *bss);
+int nl80211_batch_add(struct nl80211_batch *batch, struct nl_msg *msg,
+		      void (*done)(void *ctx, int err), void *ctx);
+void nl80211_batch_store_result(void *ctx, int err);
+void nl80211_batch_send(struct nl80211_batch *batch);
+void nl80211_batch_flush(struct nl80211_batch *batch);
 int nl80211_create_iface(struct wpa_driver_nl80211_data *drv,
 			 const char *ifname, enum nl80211_iftype iftype,
 			 const u8 *addr, int wds,
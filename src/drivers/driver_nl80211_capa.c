@@ -1403,6 +1403,7 @@ int wpa_driver_nl80211_capa(struct wpa_driver_nl80211_data *drv)
 	drv->capa.flags |= WPA_DRIVER_FLAGS_VALID_ERROR_CODES;
 	drv->capa.flags |= WPA_DRIVER_FLAGS_SET_KEYS_AFTER_ASSOC_DONE;
 	drv->capa.flags |= WPA_DRIVER_FLAGS_EAPOL_TX_STATUS;
+	drv->capa.flags2 |= WPA_DRIVER_FLAGS2_STA_ADD_REMOVE_OLD;
 
 	/*
 	 * As all cfg80211 drivers must support cases where the AP interface is
@@ -275,6 +275,7 @@ struct eap_sm * eap_server_sm_init(void *eapol_ctx,
 				   const struct eap_config *conf,
 				   const struct eap_session_data *sess);
 void eap_server_sm_deinit(struct eap_sm *sm);
+size_t eap_server_sm_mem_usage(struct eap_sm *sm);
 int eap_server_sm_step(struct eap_sm *sm);
 void eap_sm_notify_cached(struct eap_sm *sm);
 void eap_sm_pending_cb(struct eap_sm *sm);
@@ -18,11 +18,15 @@
 #include "crypto/sha256.h"
 #include "eap_i.h"
 #include "state_machine.h"
+#include "slab.h"
 #include "common/wpa_ctrl.h"
 
 #define STATE_MACHINE_DATA struct eap_sm
 #define STATE_MACHINE_DEBUG_PREFIX "EAP"
 
+static struct slab_cache eap_sm_cache =
+	SLAB_CACHE_INIT("eap_sm", sizeof(struct eap_sm));
+
 /* EAP state machines are described in RFC 4137 */
 
 static int eap_sm_calculateTimeout(struct eap_sm *sm, int retransCount,
@@ -1857,7 +1861,7 @@ struct eap_sm * eap_server_sm_init(void *eapol_ctx,
 {
 	struct eap_sm *sm;
 
-	sm = os_zalloc(sizeof(*sm));
+	sm = slab_zalloc(&eap_sm_cache);
 	if (sm == NULL)
 		return NULL;
 	sm->eapol_ctx = eapol_ctx;
@@ -1907,7 +1911,37 @@ void eap_server_sm_deinit(struct eap_sm *sm)
 	eap_user_free(sm->user);
 	wpabuf_free(sm->assoc_wps_ie);
 	wpabuf_free(sm->assoc_p2p_ie);
-	os_free(sm);
+	slab_free(&eap_sm_cache, sm);
+}
+
+
+/**
+ * eap_server_sm_mem_usage - Get the amount of memory used by a state machine
+ * @sm: Pointer to EAP state machine allocated with eap_server_sm_init()
+ * Returns: Approximate number of octets allocated for the state machine and
+ * its buffers; memory used by the EAP method is not included
+ */
+size_t eap_server_sm_mem_usage(struct eap_sm *sm)
+{
+	size_t len;
+
+	if (!sm)
+		return 0;
+
+	len = sizeof(*sm) + sm->identity_len;
+	len += wpabuf_mem_usage(sm->eap_if.eapReqData);
+	len += wpabuf_mem_usage(sm->eap_if.eapRespData);
+	len += wpabuf_mem_usage(sm->lastReqData);
+	len += wpabuf_mem_usage(sm->eap_if.aaaEapReqData);
+	len += wpabuf_mem_usage(sm->eap_if.aaaEapRespData);
+	len += wpabuf_mem_usage(sm->assoc_wps_ie);
+	len += wpabuf_mem_usage(sm->assoc_p2p_ie);
+	if (sm->eap_if.eapKeyData)
+		len += sm->eap_if.eapKeyDataLen;
+	if (sm->eap_if.aaaEapKeyData)
+		len += sm->eap_if.aaaEapKeyDataLen;
+
+	return len;
 }
 
 
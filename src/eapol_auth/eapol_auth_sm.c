@@ -11,6 +11,7 @@
 #include "common.h"
 #include "eloop.h"
 #include "state_machine.h"
+#include "slab.h"
 #include "common/eapol_common.h"
 #include "eap_common/eap_defs.h"
 #include "eap_common/eap_common.h"
@@ -24,6 +25,10 @@
 
 static const struct eapol_callbacks eapol_cb;
 
+static struct slab_cache eapol_sm_cache =
+	SLAB_CACHE_INIT("eapol_state_machine",
+			sizeof(struct eapol_state_machine));
+
 /* EAPOL state machines are described in IEEE Std 802.1X-2004, Chap. 8.2 */
 
 #define setPortAuthorized() \
@@ -785,7 +790,7 @@ eapol_auth_alloc(struct eapol_authenticator *eapol, const u8 *addr,
 	if (eapol == NULL)
 		return NULL;
 
-	sm = os_zalloc(sizeof(*sm));
+	sm = slab_zalloc(&eapol_sm_cache);
 	if (sm == NULL) {
 		wpa_printf(MSG_DEBUG, "IEEE 802.1X state machine allocation "
 			   "failed");
@@ -877,7 +882,7 @@ void eapol_auth_free(struct eapol_state_machine *sm)
 
 	wpabuf_free(sm->radius_cui);
 	os_free(sm->identity);
-	os_free(sm);
+	slab_free(&eapol_sm_cache, sm);
 }
 
 
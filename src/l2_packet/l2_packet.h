@@ -114,6 +114,23 @@ int l2_packet_get_own_addr(struct l2_packet_data *l2, u8 *addr);
 int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 		   const u8 *buf, size_t len);
 
+/**
+ * l2_packet_send_multi - Send a copy of a packet to each of the destinations
+ * @l2: Pointer to internal l2_packet data from l2_packet_init()
+ * @buf: Packet contents including the layer 2 header; only supported if l2_hdr
+ * was set to 1 in l2_packet_init() call
+ * @len: Length of the buffer
+ * @dst: Destination addresses (num_dst * ETH_ALEN octets) that replace the
+ * destination address of the packet in the transmitted copies
+ * @num_dst: Number of destination addresses
+ * Returns: Number of copies sent or -1 if not supported
+ *
+ * The buffer is not modified and the copies are sent with as few system calls
+ * as the platform allows.
+ */
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *buf, size_t len,
+			 const u8 *dst, size_t num_dst);
+
 /**
  * l2_packet_get_ip_addr - Get the current IP address from the interface
  * @l2: Pointer to internal l2_packet data from l2_packet_init()
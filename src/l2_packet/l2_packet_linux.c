@@ -6,6 +6,7 @@
  * See README for more details.
  */
 
+#define _GNU_SOURCE /* sendmmsg(), recvmmsg() */
 #include "includes.h"
 #include <sys/ioctl.h>
 #include <netpacket/packet.h>
@@ -19,8 +20,22 @@
 #include "l2_packet.h"
 
 
+/* Maximum number of frames read from the packet socket per read event */
+#define L2_PACKET_RX_BATCH 8
+#define L2_PACKET_RX_BUF_LEN 2300
+
+struct l2_packet_rx_batch {
+	u8 buf[L2_PACKET_RX_BATCH][L2_PACKET_RX_BUF_LEN];
+	struct sockaddr_ll ll[L2_PACKET_RX_BATCH];
+	struct iovec iov[L2_PACKET_RX_BATCH];
+	struct mmsghdr msgs[L2_PACKET_RX_BATCH];
+};
+
 struct l2_packet_data {
 	int fd; /* packet socket for EAPOL frames */
+	struct l2_packet_rx_batch *rx; /* receive buffers for fd */
+	int in_rx; /* rx_callback is being called for a received batch */
+	int deinit_pending; /* l2_packet_deinit() called from rx_callback */
 	char ifname[IFNAMSIZ + 1];
 	int ifindex;
 	u8 own_addr[ETH_ALEN];
@@ -145,26 +160,62 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
-static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
+#define L2_PACKET_SEND_MULTI_BATCH 32
+
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *buf, size_t len,
+			 const u8 *dst, size_t num_dst)
 {
-	struct l2_packet_data *l2 = eloop_ctx;
-	u8 buf[2300];
+	struct mmsghdr msgs[L2_PACKET_SEND_MULTI_BATCH];
+	struct iovec iov[L2_PACKET_SEND_MULTI_BATCH][2];
+	size_t i, n, sent = 0;
 	int res;
-	struct sockaddr_ll ll;
-	socklen_t fromlen;
 
-	os_memset(&ll, 0, sizeof(ll));
-	fromlen = sizeof(ll);
-	res = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *) &ll,
-		       &fromlen);
-	if (res < 0) {
-		wpa_printf(MSG_DEBUG, "l2_packet_receive - recvfrom: %s",
-			   strerror(errno));
-		return;
+	if (TEST_FAIL())
+		return -1;
+	if (!l2 || !l2->l2_hdr || len < ETH_ALEN)
+		return -1;
+
+	/* Use a separate header iovec per copy instead of copying the frame */
+	while (sent < num_dst) {
+		n = num_dst - sent;
+		if (n > L2_PACKET_SEND_MULTI_BATCH)
+			n = L2_PACKET_SEND_MULTI_BATCH;
+		os_memset(msgs, 0, n * sizeof(msgs[0]));
+		for (i = 0; i < n; i++) {
+			iov[i][0].iov_base = (void *) &dst[(sent + i) * ETH_ALEN];
+			iov[i][0].iov_len = ETH_ALEN;
+			iov[i][1].iov_base = (void *) (buf + ETH_ALEN);
+			iov[i][1].iov_len = len - ETH_ALEN;
+			msgs[i].msg_hdr.msg_iov = iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 2;
+		}
+		res = sendmmsg(l2->fd, msgs, n, 0);
+		if (res <= 0) {
+			wpa_printf(MSG_ERROR, "l2_packet_send_multi - sendmmsg: %s",
+				   strerror(errno));
+			if (sent == 0)
+				return -1;
+			break;
+		}
+		sent += res;
 	}
 
-	wpa_printf(MSG_DEBUG, "%s: src=" MACSTR " len=%d",
-		   __func__, MAC2STR(ll.sll_addr), (int) res);
+	return sent;
+}
+
+
+static void l2_packet_free(struct l2_packet_data *l2)
+{
+	os_free(l2->rx);
+	os_free(l2);
+}
+
+
+static void l2_packet_rx(struct l2_packet_data *l2, const u8 *src_addr,
+			 const u8 *buf, int res)
+{
+	wpa_printf(MSG_DEBUG, "l2_packet_receive: src=" MACSTR " len=%d",
+		   MAC2STR(src_addr), (int) res);
 
 #ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
 	if (l2->fd_br_rx >= 0) {
@@ -194,14 +245,14 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		sha1_vector(1, addr, len, hash);
 		if (l2->last_from_br &&
 		    os_memcmp(hash, l2->last_hash, SHA1_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG, "%s: Drop duplicate RX",
-				   __func__);
+			wpa_printf(MSG_DEBUG,
+				   "l2_packet_receive: Drop duplicate RX");
 			return;
 		}
 		if (l2->last_from_br_prev &&
 		    os_memcmp(hash, l2->last_hash_prev, SHA1_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG, "%s: Drop duplicate RX(prev)",
-				   __func__);
+			wpa_printf(MSG_DEBUG,
+				   "l2_packet_receive: Drop duplicate RX(prev)");
 			return;
 		}
 		os_memcpy(l2->last_hash_prev, l2->last_hash, SHA1_MAC_LEN);
@@ -211,7 +262,51 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 
 	l2->last_from_br = 0;
 #endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
-	l2->rx_callback(l2->rx_callback_ctx, ll.sll_addr, buf, res);
+	l2->rx_callback(l2->rx_callback_ctx, src_addr, buf, res);
+}
+
+
+static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct l2_packet_data *l2 = eloop_ctx;
+	struct l2_packet_rx_batch *rx = l2->rx;
+	unsigned int vlen = L2_PACKET_RX_BATCH;
+	int i, res;
+
+#ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
+	/*
+	 * The duplicate filter for the bridge workaround socket remembers only
+	 * the two most recently delivered frames, so frames from the two
+	 * sockets need to be interleaved one at a time while the workaround
+	 * socket is in use.
+	 */
+	if (l2->fd_br_rx >= 0)
+		vlen = 1;
+#endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
+
+	/*
+	 * Read all frames that are already queued, up to the batch size, with
+	 * a single call and pass them to the callback directly from the
+	 * receive buffers. The socket is known to be readable, so do not wait
+	 * for the batch to fill up.
+	 */
+	for (i = 0; i < (int) vlen; i++)
+		rx->msgs[i].msg_hdr.msg_namelen = sizeof(rx->ll[i]);
+	res = recvmmsg(sock, rx->msgs, vlen, MSG_DONTWAIT, NULL);
+	if (res < 0) {
+		wpa_printf(MSG_DEBUG, "l2_packet_receive - recvmmsg: %s",
+			   strerror(errno));
+		return;
+	}
+
+	/* The callback may deinitialize this l2_packet instance */
+	l2->in_rx = 1;
+	for (i = 0; i < res && !l2->deinit_pending; i++)
+		l2_packet_rx(l2, rx->ll[i].sll_addr, rx->buf[i],
+			     rx->msgs[i].msg_len);
+	l2->in_rx = 0;
+	if (l2->deinit_pending)
+		l2_packet_free(l2);
 }
 
 
@@ -330,8 +425,24 @@ struct l2_packet_data * l2_packet_init(
 	}
 	os_memcpy(l2->own_addr, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
 
-	if (rx_callback)
+	if (rx_callback) {
+		int i;
+
+		l2->rx = os_zalloc(sizeof(*l2->rx));
+		if (!l2->rx) {
+			close(l2->fd);
+			os_free(l2);
+			return NULL;
+		}
+		for (i = 0; i < L2_PACKET_RX_BATCH; i++) {
+			l2->rx->iov[i].iov_base = l2->rx->buf[i];
+			l2->rx->iov[i].iov_len = L2_PACKET_RX_BUF_LEN;
+			l2->rx->msgs[i].msg_hdr.msg_name = &l2->rx->ll[i];
+			l2->rx->msgs[i].msg_hdr.msg_iov = &l2->rx->iov[i];
+			l2->rx->msgs[i].msg_hdr.msg_iovlen = 1;
+		}
 		eloop_register_read_sock(l2->fd, l2_packet_receive, l2, NULL);
+	}
 
 	return l2;
 }
@@ -430,16 +541,22 @@ void l2_packet_deinit(struct l2_packet_data *l2)
 	if (l2->fd >= 0) {
 		eloop_unregister_read_sock(l2->fd);
 		close(l2->fd);
+		l2->fd = -1;
 	}
 
 #ifndef CONFIG_NO_LINUX_PACKET_SOCKET_WAR
 	if (l2->fd_br_rx >= 0) {
 		eloop_unregister_read_sock(l2->fd_br_rx);
 		close(l2->fd_br_rx);
+		l2->fd_br_rx = -1;
 	}
 #endif /* CONFIG_NO_LINUX_PACKET_SOCKET_WAR */
 
-	os_free(l2);
+	/* Free once the remaining frames of the batch have been dropped */
+	if (l2->in_rx)
+		l2->deinit_pending = 1;
+	else
+		l2_packet_free(l2);
 }
 
 
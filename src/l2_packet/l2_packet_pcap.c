@@ -393,6 +393,13 @@ void l2_packet_notify_auth_start(struct l2_packet_data *l2)
 }
 
 
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *buf, size_t len,
+			 const u8 *dst, size_t num_dst)
+{
+	return -1;
+}
+
+
 int l2_packet_set_packet_filter(struct l2_packet_data *l2,
 				enum l2_packet_filter_type type)
 {
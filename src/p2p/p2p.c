@@ -57,9 +57,12 @@ void p2p_expire_peers(struct p2p_data *p2p)
 	size_t i;
 
 	os_get_reltime(&now);
-	dl_list_for_each_safe(dev, n, &p2p->devices, struct p2p_device, list) {
+	dl_list_for_each_safe(dev, n, &p2p->devices_lru, struct p2p_device,
+			      lru) {
+		/* The list is sorted by last_seen, so all the remaining
+		 * entries are newer */
 		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
-			continue;
+			break;
 
 		if (dev == p2p->go_neg_peer) {
 			/*
@@ -77,7 +80,7 @@ void p2p_expire_peers(struct p2p_data *p2p)
 			 * We are connected as a client to a group in which the
 			 * peer is the GO, so do not expire the peer entry.
 			 */
-			os_get_reltime(&dev->last_seen);
+			p2p_device_set_last_seen(p2p, dev, NULL);
 			continue;
 		}
 
@@ -91,13 +94,12 @@ void p2p_expire_peers(struct p2p_data *p2p)
 			 * The peer is connected as a client in a group where
 			 * we are the GO, so do not expire the peer entry.
 			 */
-			os_get_reltime(&dev->last_seen);
+			p2p_device_set_last_seen(p2p, dev, NULL);
 			continue;
 		}
 
 		p2p_dbg(p2p, "Expiring old peer entry " MACSTR,
 			MAC2STR(dev->info.p2p_device_addr));
-		dl_list_del(&dev->list);
 		p2p_device_free(p2p, dev);
 	}
 }
@@ -376,7 +378,8 @@ static void p2p_device_clear_reported(struct p2p_data *p2p)
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_hash[P2P_DEV_HASH(addr)]; dev; dev = dev->hnext) {
 		if (os_memcmp(dev->info.p2p_device_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -394,7 +397,9 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_iface_hash[P2P_DEV_HASH(addr)]; dev;
+	     dev = dev->iface_hnext) {
 		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -402,6 +407,83 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 }
 
 
+static void p2p_dev_iface_hash_del(struct p2p_data *p2p,
+				   struct p2p_device *dev)
+{
+	struct p2p_device **pos;
+
+	if (is_zero_ether_addr(dev->interface_addr))
+		return;
+
+	pos = &p2p->dev_iface_hash[P2P_DEV_HASH(dev->interface_addr)];
+	while (*pos) {
+		if (*pos == dev) {
+			*pos = dev->iface_hnext;
+			return;
+		}
+		pos = &(*pos)->iface_hnext;
+	}
+}
+
+
+/**
+ * p2p_device_set_interface_addr - Update P2P Interface Address of a peer
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @addr: P2P Interface Address of the peer
+ *
+ * dev->interface_addr must not be modified directly since the entry is
+ * indexed based on it.
+ */
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr)
+{
+	unsigned int idx;
+
+	if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
+		return;
+
+	p2p_dev_iface_hash_del(p2p, dev);
+	os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+	if (is_zero_ether_addr(addr))
+		return;
+	idx = P2P_DEV_HASH(addr);
+	dev->iface_hnext = p2p->dev_iface_hash[idx];
+	p2p->dev_iface_hash[idx] = dev;
+}
+
+
+/**
+ * p2p_device_set_last_seen - Update the time a peer was last seen
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @seen: Time the peer was seen or %NULL to use the current time
+ *
+ * dev->last_seen must not be modified directly since the LRU list used for
+ * expiration and eviction is sorted based on it.
+ */
+void p2p_device_set_last_seen(struct p2p_data *p2p, struct p2p_device *dev,
+			      const struct os_reltime *seen)
+{
+	struct p2p_device *pos;
+
+	if (seen)
+		os_memcpy(&dev->last_seen, seen, sizeof(*seen));
+	else
+		os_get_reltime(&dev->last_seen);
+
+	/* The new time is normally the latest one, so search the position
+	 * starting from the newest entry */
+	dl_list_del(&dev->lru);
+	dl_list_for_each_reverse(pos, &p2p->devices_lru, struct p2p_device,
+				 lru) {
+		if (!os_reltime_before(&dev->last_seen, &pos->last_seen))
+			break;
+	}
+	dl_list_add(&pos->lru, &dev->lru);
+}
+
+
 /**
  * p2p_create_device - Create a peer entry
  * @p2p: P2P module context from p2p_init()
@@ -414,24 +496,18 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev, *oldest = NULL;
-	size_t count = 0;
+	struct p2p_device *dev, *oldest;
+	unsigned int idx;
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev)
 		return dev;
 
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		count++;
-		if (oldest == NULL ||
-		    os_reltime_before(&dev->last_seen, &oldest->last_seen))
-			oldest = dev;
-	}
-	if (count + 1 > p2p->cfg->max_peers && oldest) {
+	oldest = dl_list_first(&p2p->devices_lru, struct p2p_device, lru);
+	if (p2p->num_devices + 1 > p2p->cfg->max_peers && oldest) {
 		p2p_dbg(p2p,
 			"Remove oldest peer entry to make room for a new peer "
 			MACSTR, MAC2STR(oldest->info.p2p_device_addr));
-		dl_list_del(&oldest->list);
 		p2p_device_free(p2p, oldest);
 	}
 
@@ -439,7 +515,13 @@ static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 	if (dev == NULL)
 		return NULL;
 	dl_list_add(&p2p->devices, &dev->list);
+	/* last_seen is not yet set, so this is the oldest entry */
+	dl_list_add(&p2p->devices_lru, &dev->lru);
 	os_memcpy(dev->info.p2p_device_addr, addr, ETH_ALEN);
+	idx = P2P_DEV_HASH(addr);
+	dev->hnext = p2p->dev_hash[idx];
+	p2p->dev_hash[idx] = dev;
+	p2p->num_devices++;
 
 	return dev;
 }
@@ -531,9 +613,9 @@ static int p2p_add_group_clients(struct p2p_data *p2p, const u8 *go_dev_addr,
 			dev->flags |= P2P_DEV_REPORTED | P2P_DEV_REPORTED_ONCE;
 		}
 
-		os_memcpy(dev->interface_addr, cli->p2p_interface_addr,
-			  ETH_ALEN);
-		os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+		p2p_device_set_interface_addr(p2p, dev,
+					      cli->p2p_interface_addr);
+		p2p_device_set_last_seen(p2p, dev, rx_time);
 		os_memcpy(dev->member_in_go_dev, go_dev_addr, ETH_ALEN);
 		os_memcpy(dev->member_in_go_iface, go_interface_addr,
 			  ETH_ALEN);
@@ -779,13 +861,13 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 		return -1;
 	}
 
-	os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+	p2p_device_set_last_seen(p2p, dev, rx_time);
 
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY |
 			P2P_DEV_LAST_SEEN_AS_GROUP_CLIENT);
 
 	if (os_memcmp(addr, p2p_dev_addr, ETH_ALEN) != 0)
-		os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, addr);
 	if (msg.ssid &&
 	    msg.ssid[1] <= sizeof(dev->oper_ssid) &&
 	    (msg.ssid[1] != P2P_WILDCARD_SSID_LEN ||
@@ -915,8 +997,22 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 
 static void p2p_device_free(struct p2p_data *p2p, struct p2p_device *dev)
 {
+	struct p2p_device **pos;
 	int i;
 
+	dl_list_del(&dev->list);
+	dl_list_del(&dev->lru);
+	pos = &p2p->dev_hash[P2P_DEV_HASH(dev->info.p2p_device_addr)];
+	while (*pos) {
+		if (*pos == dev) {
+			*pos = dev->hnext;
+			break;
+		}
+		pos = &(*pos)->hnext;
+	}
+	p2p_dev_iface_hash_del(p2p, dev);
+	p2p->num_devices--;
+
 	if (p2p->go_neg_peer == dev) {
 		/*
 		 * If GO Negotiation is in progress, report that it has failed.
@@ -1721,7 +1817,7 @@ int p2p_authorize(struct p2p_data *p2p, const u8 *peer_addr,
 void p2p_add_dev_info(struct p2p_data *p2p, const u8 *addr,
 		      struct p2p_device *dev, struct p2p_message *msg)
 {
-	os_get_reltime(&dev->last_seen);
+	p2p_device_set_last_seen(p2p, dev, NULL);
 
 	p2p_copy_wps_info(p2p, dev, 0, msg);
 
@@ -2075,7 +2171,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 			}
 		}
 
-		os_get_reltime(&dev->last_seen);
+		p2p_device_set_last_seen(p2p, dev, NULL);
 		p2p_parse_free(&msg);
 		return; /* already known */
 	}
@@ -2086,7 +2182,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 		return;
 	}
 
-	os_get_reltime(&dev->last_seen);
+	p2p_device_set_last_seen(p2p, dev, NULL);
 	dev->flags |= P2P_DEV_PROBE_REQ_ONLY;
 
 	if (msg.listen_channel) {
@@ -2120,7 +2216,7 @@ struct p2p_device * p2p_add_dev_from_go_neg_req(struct p2p_data *p2p,
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev) {
-		os_get_reltime(&dev->last_seen);
+		p2p_device_set_last_seen(p2p, dev, NULL);
 		return dev; /* already known */
 	}
 
@@ -2988,6 +3084,7 @@ struct p2p_data * p2p_init(const struct p2p_config *cfg)
 	p2p->dev_capab |= P2P_DEV_CAPAB_CLIENT_DISCOVERABILITY;
 
 	dl_list_init(&p2p->devices);
+	dl_list_init(&p2p->devices_lru);
 
 	p2p->go_timeout = 100;
 	p2p->client_timeout = 20;
@@ -3047,10 +3144,8 @@ void p2p_flush(struct p2p_data *p2p)
 	p2p_ext_listen(p2p, 0, 0);
 	p2p_stop_find(p2p);
 	dl_list_for_each_safe(dev, prev, &p2p->devices, struct p2p_device,
-			      list) {
-		dl_list_del(&dev->list);
+			      list)
 		p2p_device_free(p2p, dev);
-	}
 	p2p_free_sd_queries(p2p);
 	p2p->ssid_set = 0;
 	p2ps_prov_free(p2p);
@@ -5401,7 +5496,7 @@ int p2p_process_nfc_connection_handover(struct p2p_data *p2p,
 
 	params->peer = &dev->info;
 
-	os_get_reltime(&dev->last_seen);
+	p2p_device_set_last_seen(p2p, dev, NULL);
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY);
 	p2p_copy_wps_info(p2p, dev, 0, &msg);
 
@@ -40,6 +40,9 @@ enum p2p_go_state {
  */
 struct p2p_device {
 	struct dl_list list;
+	struct dl_list lru; /* p2p->devices_lru, ordered by last_seen */
+	struct p2p_device *hnext; /* next entry in p2p->dev_hash */
+	struct p2p_device *iface_hnext; /* next entry in p2p->dev_iface_hash */
 	struct os_reltime last_seen;
 	int listen_freq;
 	int oob_go_neg_freq;
@@ -260,6 +263,30 @@ struct p2p_data {
 	 */
 	struct dl_list devices;
 
+	/**
+	 * num_devices - Number of entries in the devices list
+	 */
+	size_t num_devices;
+
+	/**
+	 * devices_lru - Peers ordered by last_seen, oldest first
+	 */
+	struct dl_list devices_lru;
+
+#define P2P_DEV_HASH_SIZE 256
+#define P2P_DEV_HASH(addr) ((addr)[5])
+	/**
+	 * dev_hash - Peers hashed by P2P Device Address
+	 */
+	struct p2p_device *dev_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * dev_iface_hash - Peers hashed by P2P Interface Address
+	 *
+	 * Only peers with a known (nonzero) interface_addr are included.
+	 */
+	struct p2p_device *dev_iface_hash[P2P_DEV_HASH_SIZE];
+
 	/**
 	 * go_neg_peer - Pointer to GO Negotiation peer
 	 */
@@ -872,6 +899,10 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr);
 struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr);
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr);
+void p2p_device_set_last_seen(struct p2p_data *p2p, struct p2p_device *dev,
+			      const struct os_reltime *seen);
 void p2p_go_neg_failed(struct p2p_data *p2p, int status);
 void p2p_go_complete(struct p2p_data *p2p, struct p2p_device *peer);
 int p2p_match_dev_type(struct p2p_data *p2p, struct wpabuf *wps);
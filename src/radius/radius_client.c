@@ -1010,6 +1010,33 @@ u8 radius_client_get_id(struct radius_client_data *radius)
 }
 
 
+/**
+ * radius_client_num_pending - Get the number of pending RADIUS messages
+ * @radius: RADIUS client context from radius_client_init()
+ * @msg_type: Message type (RADIUS_AUTH, RADIUS_ACCT, RADIUS_ACCT_INTERIM)
+ * Returns: Number of messages of the given type waiting for a response
+ *
+ * This can be used to limit the number of requests that are sent to the
+ * server without waiting for responses to earlier ones.
+ */
+size_t radius_client_num_pending(struct radius_client_data *radius,
+				 RadiusType msg_type)
+{
+	struct radius_msg_list *entry;
+	size_t num = 0;
+
+	if (!radius)
+		return 0;
+
+	for (entry = radius->msgs; entry; entry = entry->next) {
+		if (entry->msg_type == msg_type)
+			num++;
+	}
+
+	return num;
+}
+
+
 /**
  * radius_client_flush - Flush all pending RADIUS client messages
  * @radius: RADIUS client context from radius_client_init()
@@ -1720,9 +1747,37 @@ int radius_client_get_mib(struct radius_client_data *radius, char *buf,
 }
 
 
+/**
+ * radius_client_reconfig - Update RADIUS client configuration
+ * @radius: RADIUS client context from radius_client_init()
+ * @conf: New RADIUS client configuration (RADIUS servers)
+ *
+ * If the configuration data is replaced, the sockets are set up again since
+ * the server addresses may have changed. Pending authentication messages are
+ * dropped while pending accounting messages are kept and sent to the current
+ * accounting server of the new configuration.
+ */
 void radius_client_reconfig(struct radius_client_data *radius,
 			    struct hostapd_radius_servers *conf)
 {
-	if (radius)
-		radius->conf = conf;
+	if (!radius || radius->conf == conf)
+		return;
+
+	radius->conf = conf;
+
+	radius_client_flush(radius, 1);
+	if (conf->auth_server)
+		radius_client_init_auth(radius);
+	else
+		radius_close_auth_sockets(radius);
+
+	if (conf->acct_server) {
+		radius_client_update_acct_msgs(
+			radius, conf->acct_server->shared_secret,
+			conf->acct_server->shared_secret_len);
+		radius_client_init_acct(radius);
+	} else {
+		radius_client_flush(radius, 0);
+		radius_close_acct_sockets(radius);
+	}
 }
@@ -6,6 +6,11 @@
  * See README for more details.
  */
 
+#ifdef CONFIG_ELOOP_PROFILE
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#endif /* CONFIG_ELOOP_PROFILE */
+
 #include "includes.h"
 #include <assert.h>
 
@@ -39,11 +44,43 @@
 #include <sys/event.h>
 #endif /* CONFIG_ELOOP_KQUEUE */
 
+#ifdef CONFIG_ELOOP_PROFILE
+
+/* Delay histogram buckets: <100 us, <1 ms, <10 ms, <100 ms, <1 s, >= 1 s */
+#define ELOOP_PROF_HIST_LEN 6
+#define ELOOP_PROF_HASH_SIZE 64
+
+enum eloop_prof_type {
+	ELOOP_PROF_READ,
+	ELOOP_PROF_WRITE,
+	ELOOP_PROF_EXCEPTION,
+	ELOOP_PROF_TIMEOUT,
+	ELOOP_PROF_SIGNAL,
+};
+
+struct eloop_prof {
+	struct eloop_prof *hnext;
+	void *handler;
+	enum eloop_prof_type type;
+	unsigned long calls;
+	unsigned long long total_usec;
+	unsigned long long max_usec;
+	/* Timer lateness or socket readiness-to-dispatch delay */
+	unsigned long long delay_usec;
+	unsigned long long max_delay_usec;
+	unsigned long hist[ELOOP_PROF_HIST_LEN];
+};
+
+#endif /* CONFIG_ELOOP_PROFILE */
+
 struct eloop_sock {
 	int sock;
 	void *eloop_data;
 	void *user_data;
 	eloop_sock_handler handler;
+#ifdef CONFIG_ELOOP_PROFILE
+	struct eloop_prof *prof;
+#endif /* CONFIG_ELOOP_PROFILE */
 	WPA_TRACE_REF(eloop);
 	WPA_TRACE_REF(user);
 	WPA_TRACE_INFO
@@ -55,6 +92,9 @@ struct eloop_timeout {
 	void *eloop_data;
 	void *user_data;
 	eloop_timeout_handler handler;
+#ifdef CONFIG_ELOOP_PROFILE
+	struct eloop_prof *prof;
+#endif /* CONFIG_ELOOP_PROFILE */
 	WPA_TRACE_REF(eloop);
 	WPA_TRACE_REF(user);
 	WPA_TRACE_INFO
@@ -65,6 +105,9 @@ struct eloop_signal {
 	void *user_data;
 	eloop_signal_handler handler;
 	int signaled;
+#ifdef CONFIG_ELOOP_PROFILE
+	struct eloop_prof *prof;
+#endif /* CONFIG_ELOOP_PROFILE */
 };
 
 struct eloop_sock_table {
@@ -110,11 +153,327 @@ struct eloop_data {
 	int pending_terminate;
 
 	int terminate;
+
+#ifdef CONFIG_ELOOP_PROFILE
+	struct eloop_prof *prof_hash[ELOOP_PROF_HASH_SIZE];
+	unsigned int prof_count;
+	struct os_reltime prof_start; /* start of the measurement period */
+	struct os_reltime prof_ready; /* when the latest wait returned */
+	unsigned long prof_iterations;
+	unsigned long long prof_busy_usec;
+#endif /* CONFIG_ELOOP_PROFILE */
 };
 
 static struct eloop_data eloop;
 
 
+#ifdef CONFIG_ELOOP_PROFILE
+
+static struct eloop_prof * eloop_prof_get(void *handler,
+					  enum eloop_prof_type type)
+{
+	struct eloop_prof *prof;
+	unsigned int idx;
+
+	idx = (((uintptr_t) handler) >> 4) % ELOOP_PROF_HASH_SIZE;
+	for (prof = eloop.prof_hash[idx]; prof; prof = prof->hnext) {
+		if (prof->handler == handler && prof->type == type)
+			return prof;
+	}
+
+	prof = os_zalloc(sizeof(*prof));
+	if (!prof)
+		return NULL;
+	prof->handler = handler;
+	prof->type = type;
+	prof->hnext = eloop.prof_hash[idx];
+	eloop.prof_hash[idx] = prof;
+	eloop.prof_count++;
+	return prof;
+}
+
+
+static struct eloop_prof *
+eloop_prof_get_sock(struct eloop_sock_table *table, eloop_sock_handler handler)
+{
+	enum eloop_prof_type type = ELOOP_PROF_READ;
+
+	if (table == &eloop.writers)
+		type = ELOOP_PROF_WRITE;
+	else if (table == &eloop.exceptions)
+		type = ELOOP_PROF_EXCEPTION;
+	return eloop_prof_get((void *) handler, type);
+}
+
+
+static unsigned long long eloop_prof_usec(const struct os_reltime *a,
+					  const struct os_reltime *b)
+{
+	struct os_reltime diff;
+
+	if (os_reltime_before((struct os_reltime *) a, (struct os_reltime *) b))
+		return 0;
+	os_reltime_sub((struct os_reltime *) a, (struct os_reltime *) b,
+		       &diff);
+	return diff.sec * 1000000ULL + diff.usec;
+}
+
+
+/**
+ * eloop_prof_done - Record a completed handler call
+ * @prof: Profiling entry for the handler or %NULL
+ * @due: Time when the handler became runnable or %NULL if not known
+ * @start: Time when the handler was called
+ */
+static void eloop_prof_done(struct eloop_prof *prof,
+			    const struct os_reltime *due,
+			    const struct os_reltime *start)
+{
+	struct os_reltime now;
+	unsigned long long usec, delay, limit;
+	unsigned int i;
+
+	if (!prof)
+		return;
+
+	os_get_reltime(&now);
+	usec = eloop_prof_usec(&now, start);
+	prof->calls++;
+	prof->total_usec += usec;
+	if (usec > prof->max_usec)
+		prof->max_usec = usec;
+	eloop.prof_busy_usec += usec;
+
+	if (!due)
+		return;
+	delay = eloop_prof_usec(start, due);
+	prof->delay_usec += delay;
+	if (delay > prof->max_delay_usec)
+		prof->max_delay_usec = delay;
+	for (i = 0, limit = 100; i < ELOOP_PROF_HIST_LEN - 1; i++, limit *= 10)
+		if (delay < limit)
+			break;
+	prof->hist[i]++;
+}
+
+
+static void eloop_sock_call(struct eloop_sock *sock)
+{
+	struct eloop_prof *prof = sock->prof;
+	struct os_reltime start;
+
+	os_get_reltime(&start);
+	sock->handler(sock->sock, sock->eloop_data, sock->user_data);
+	eloop_prof_done(prof, &eloop.prof_ready, &start);
+}
+
+
+static const char * eloop_prof_type_txt(enum eloop_prof_type type)
+{
+	switch (type) {
+	case ELOOP_PROF_READ:
+		return "read";
+	case ELOOP_PROF_WRITE:
+		return "write";
+	case ELOOP_PROF_EXCEPTION:
+		return "exception";
+	case ELOOP_PROF_TIMEOUT:
+		return "timeout";
+	case ELOOP_PROF_SIGNAL:
+		return "signal";
+	}
+	return "?";
+}
+
+
+static void eloop_prof_func_name(void *addr, char *buf, size_t buflen)
+{
+	Dl_info info;
+	const char *name;
+	int res;
+
+#ifdef WPA_TRACE_BFD
+	name = wpa_trace_func_name(addr);
+	if (name) {
+		os_strlcpy(buf, name, buflen);
+		return;
+	}
+#endif /* WPA_TRACE_BFD */
+
+	os_memset(&info, 0, sizeof(info));
+	if (dladdr(addr, &info) && info.dli_sname &&
+	    info.dli_saddr == addr) {
+		os_strlcpy(buf, info.dli_sname, buflen);
+		return;
+	}
+	if (info.dli_fname && info.dli_fbase) {
+		/* Static functions are not in the dynamic symbol table; report
+		 * the offset for addr2line instead. */
+		name = os_strrchr(info.dli_fname, '/');
+		res = os_snprintf(buf, buflen, "%s+0x%lx",
+				  name ? name + 1 : info.dli_fname,
+				  (unsigned long) ((u8 *) addr -
+						   (u8 *) info.dli_fbase));
+	} else {
+		res = os_snprintf(buf, buflen, "%p", addr);
+	}
+	if (os_snprintf_error(buflen, res))
+		buf[0] = '\0';
+}
+
+
+static int eloop_prof_cmp(const void *a, const void *b)
+{
+	const struct eloop_prof *pa = *(const struct eloop_prof **) a;
+	const struct eloop_prof *pb = *(const struct eloop_prof **) b;
+
+	if (pa->total_usec > pb->total_usec)
+		return -1;
+	if (pa->total_usec < pb->total_usec)
+		return 1;
+	return 0;
+}
+
+
+static int eloop_prof_entry_txt(struct eloop_prof *prof, char *buf,
+				size_t buflen)
+{
+	char name[128];
+	int res;
+
+	eloop_prof_func_name(prof->handler, name, sizeof(name));
+	res = os_snprintf(buf, buflen,
+			  "%s %s calls=%lu total_usec=%llu max_usec=%llu avg_usec=%llu delay_usec=%llu max_delay_usec=%llu delay_hist=%lu,%lu,%lu,%lu,%lu,%lu\n",
+			  eloop_prof_type_txt(prof->type), name, prof->calls,
+			  prof->total_usec, prof->max_usec,
+			  prof->calls ? prof->total_usec / prof->calls : 0,
+			  prof->delay_usec, prof->max_delay_usec,
+			  prof->hist[0], prof->hist[1], prof->hist[2],
+			  prof->hist[3], prof->hist[4], prof->hist[5]);
+	if (os_snprintf_error(buflen, res))
+		return -1;
+	return res;
+}
+
+
+/* Return the profiling entries sorted by cumulative run time */
+static struct eloop_prof ** eloop_prof_sorted(unsigned int *num)
+{
+	struct eloop_prof **list, *prof;
+	unsigned int i, n = 0;
+
+	list = os_calloc(eloop.prof_count + 1, sizeof(*list));
+	if (!list)
+		return NULL;
+	for (i = 0; i < ELOOP_PROF_HASH_SIZE; i++) {
+		for (prof = eloop.prof_hash[i]; prof && n < eloop.prof_count;
+		     prof = prof->hnext) {
+			if (prof->calls)
+				list[n++] = prof;
+		}
+	}
+	qsort(list, n, sizeof(*list), eloop_prof_cmp);
+	*num = n;
+	return list;
+}
+
+
+int eloop_profile_dump(char *buf, size_t buflen)
+{
+	struct eloop_prof **list;
+	struct os_reltime now;
+	char *pos = buf, *end = buf + buflen;
+	unsigned int i, num;
+	int res;
+
+	os_get_reltime(&now);
+	res = os_snprintf(pos, end - pos,
+			  "elapsed_usec=%llu\n"
+			  "iterations=%lu\n"
+			  "busy_usec=%llu\n"
+			  "handlers=%u\n",
+			  eloop_prof_usec(&now, &eloop.prof_start),
+			  eloop.prof_iterations, eloop.prof_busy_usec,
+			  eloop.prof_count);
+	if (os_snprintf_error(end - pos, res))
+		return pos - buf;
+	pos += res;
+
+	list = eloop_prof_sorted(&num);
+	if (!list)
+		return pos - buf;
+	for (i = 0; i < num; i++) {
+		res = eloop_prof_entry_txt(list[i], pos, end - pos);
+		if (res < 0)
+			break;
+		pos += res;
+	}
+	os_free(list);
+
+	return pos - buf;
+}
+
+
+void eloop_profile_reset(void)
+{
+	struct eloop_prof *prof;
+	unsigned int i;
+
+	for (i = 0; i < ELOOP_PROF_HASH_SIZE; i++) {
+		for (prof = eloop.prof_hash[i]; prof; prof = prof->hnext) {
+			prof->calls = 0;
+			prof->total_usec = prof->max_usec = 0;
+			prof->delay_usec = prof->max_delay_usec = 0;
+			os_memset(prof->hist, 0, sizeof(prof->hist));
+		}
+	}
+	eloop.prof_iterations = 0;
+	eloop.prof_busy_usec = 0;
+	os_get_reltime(&eloop.prof_start);
+}
+
+
+static void eloop_prof_deinit(void)
+{
+	struct eloop_prof **list, *prof, *next;
+	struct os_reltime now;
+	unsigned int i, num;
+	char buf[512];
+
+	os_get_reltime(&now);
+	wpa_printf(MSG_DEBUG,
+		   "ELOOP: profile: elapsed_usec=%llu iterations=%lu busy_usec=%llu",
+		   eloop_prof_usec(&now, &eloop.prof_start),
+		   eloop.prof_iterations, eloop.prof_busy_usec);
+	list = eloop_prof_sorted(&num);
+	for (i = 0; list && i < num; i++) {
+		if (eloop_prof_entry_txt(list[i], buf, sizeof(buf)) > 0) {
+			buf[os_strlen(buf) - 1] = '\0';
+			wpa_printf(MSG_DEBUG, "ELOOP: profile: %s", buf);
+		}
+	}
+	os_free(list);
+
+	for (i = 0; i < ELOOP_PROF_HASH_SIZE; i++) {
+		for (prof = eloop.prof_hash[i]; prof; prof = next) {
+			next = prof->hnext;
+			os_free(prof);
+		}
+		eloop.prof_hash[i] = NULL;
+	}
+	eloop.prof_count = 0;
+}
+
+#else /* CONFIG_ELOOP_PROFILE */
+
+static inline void eloop_sock_call(struct eloop_sock *sock)
+{
+	sock->handler(sock->sock, sock->eloop_data, sock->user_data);
+}
+
+#endif /* CONFIG_ELOOP_PROFILE */
+
+
 #ifdef WPA_TRACE
 
 static void eloop_sigsegv_handler(int sig)
@@ -164,6 +523,9 @@ int eloop_init(void)
 {
 	os_memset(&eloop, 0, sizeof(eloop));
 	dl_list_init(&eloop.timeout);
+#ifdef CONFIG_ELOOP_PROFILE
+	os_get_reltime(&eloop.prof_start);
+#endif /* CONFIG_ELOOP_PROFILE */
 #ifdef CONFIG_ELOOP_EPOLL
 	eloop.epollfd = epoll_create1(0);
 	if (eloop.epollfd < 0) {
@@ -364,6 +726,9 @@ static int eloop_sock_table_add_sock(struct eloop_sock_table *table,
 	tmp[table->count].eloop_data = eloop_data;
 	tmp[table->count].user_data = user_data;
 	tmp[table->count].handler = handler;
+#ifdef CONFIG_ELOOP_PROFILE
+	tmp[table->count].prof = eloop_prof_get_sock(table, handler);
+#endif /* CONFIG_ELOOP_PROFILE */
 	wpa_trace_record(&tmp[table->count]);
 	table->count++;
 	table->table = tmp;
@@ -538,9 +903,7 @@ static int eloop_sock_table_dispatch_table(struct eloop_sock_table *table,
 		if (!(pfd->revents & revents))
 			continue;
 
-		table->table[i].handler(table->table[i].sock,
-					table->table[i].eloop_data,
-					table->table[i].user_data);
+		eloop_sock_call(&table->table[i]);
 		if (table->changed)
 			return 1;
 	}
@@ -600,9 +963,7 @@ static void eloop_sock_table_dispatch(struct eloop_sock_table *table,
 	table->changed = 0;
 	for (i = 0; i < table->count; i++) {
 		if (FD_ISSET(table->table[i].sock, fds)) {
-			table->table[i].handler(table->table[i].sock,
-						table->table[i].eloop_data,
-						table->table[i].user_data);
+			eloop_sock_call(&table->table[i]);
 			if (table->changed)
 				break;
 		}
@@ -622,8 +983,7 @@ static void eloop_sock_table_dispatch(struct epoll_event *events, int nfds)
 		table = &eloop.fd_table[events[i].data.fd];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_sock_call(table);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -644,8 +1004,7 @@ static void eloop_sock_table_dispatch(struct kevent *events, int nfds)
 		table = &eloop.fd_table[events[i].ident];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_sock_call(table);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -797,6 +1156,9 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	timeout->eloop_data = eloop_data;
 	timeout->user_data = user_data;
 	timeout->handler = handler;
+#ifdef CONFIG_ELOOP_PROFILE
+	timeout->prof = eloop_prof_get((void *) handler, ELOOP_PROF_TIMEOUT);
+#endif /* CONFIG_ELOOP_PROFILE */
 	wpa_trace_add_ref(timeout, eloop, eloop_data);
 	wpa_trace_add_ref(timeout, user, user_data);
 	wpa_trace_record(timeout);
@@ -1017,9 +1379,18 @@ static void eloop_process_pending_signals(void)
 
 	for (i = 0; i < eloop.signal_count; i++) {
 		if (eloop.signals[i].signaled) {
+#ifdef CONFIG_ELOOP_PROFILE
+			struct eloop_prof *prof = eloop.signals[i].prof;
+			struct os_reltime start;
+
+			os_get_reltime(&start);
+#endif /* CONFIG_ELOOP_PROFILE */
 			eloop.signals[i].signaled = 0;
 			eloop.signals[i].handler(eloop.signals[i].sig,
 						 eloop.signals[i].user_data);
+#ifdef CONFIG_ELOOP_PROFILE
+			eloop_prof_done(prof, NULL, &start);
+#endif /* CONFIG_ELOOP_PROFILE */
 		}
 	}
 }
@@ -1039,6 +1410,10 @@ int eloop_register_signal(int sig, eloop_signal_handler handler,
 	tmp[eloop.signal_count].user_data = user_data;
 	tmp[eloop.signal_count].handler = handler;
 	tmp[eloop.signal_count].signaled = 0;
+#ifdef CONFIG_ELOOP_PROFILE
+	tmp[eloop.signal_count].prof = eloop_prof_get((void *) handler,
+						      ELOOP_PROF_SIGNAL);
+#endif /* CONFIG_ELOOP_PROFILE */
 	eloop.signal_count++;
 	eloop.signals = tmp;
 	signal(sig, eloop_handle_signal);
@@ -1122,7 +1497,9 @@ void eloop_run(void)
 			else
 				tv.sec = tv.usec = 0;
 #if defined(CONFIG_ELOOP_POLL) || defined(CONFIG_ELOOP_EPOLL)
-			timeout_ms = tv.sec * 1000 + tv.usec / 1000;
+			/* Round up to avoid busy looping for the last
+			 * fraction of a millisecond before the timeout */
+			timeout_ms = tv.sec * 1000 + (tv.usec + 999) / 1000;
 #endif /* defined(CONFIG_ELOOP_POLL) || defined(CONFIG_ELOOP_EPOLL) */
 #ifdef CONFIG_ELOOP_SELECT
 			_tv.tv_sec = tv.sec;
@@ -1189,6 +1566,11 @@ void eloop_run(void)
 		eloop.writers.changed = 0;
 		eloop.exceptions.changed = 0;
 
+#ifdef CONFIG_ELOOP_PROFILE
+		os_get_reltime(&eloop.prof_ready);
+		eloop.prof_iterations++;
+#endif /* CONFIG_ELOOP_PROFILE */
+
 		eloop_process_pending_signals();
 
 
@@ -1202,8 +1584,18 @@ void eloop_run(void)
 				void *user_data = timeout->user_data;
 				eloop_timeout_handler handler =
 					timeout->handler;
+#ifdef CONFIG_ELOOP_PROFILE
+				struct eloop_prof *prof = timeout->prof;
+				struct os_reltime due = timeout->time, start;
+
+				eloop_remove_timeout(timeout);
+				os_get_reltime(&start);
+				handler(eloop_data, user_data);
+				eloop_prof_done(prof, &due, &start);
+#else /* CONFIG_ELOOP_PROFILE */
 				eloop_remove_timeout(timeout);
 				handler(eloop_data, user_data);
+#endif /* CONFIG_ELOOP_PROFILE */
 			}
 
 		}
@@ -1287,6 +1679,9 @@ void eloop_destroy(void)
 	eloop_sock_table_destroy(&eloop.writers);
 	eloop_sock_table_destroy(&eloop.exceptions);
 	os_free(eloop.signals);
+#ifdef CONFIG_ELOOP_PROFILE
+	eloop_prof_deinit();
+#endif /* CONFIG_ELOOP_PROFILE */
 
 #ifdef CONFIG_ELOOP_POLL
 	os_free(eloop.pollfds);
@@ -356,6 +356,31 @@ void eloop_destroy(void);
  */
 int eloop_terminated(void);
 
+#ifdef CONFIG_ELOOP_PROFILE
+
+/**
+ * eloop_profile_dump - Write event loop profiling data into a buffer
+ * @buf: Buffer for the text output
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written into the buffer
+ *
+ * The output starts with summary lines (elapsed time, number of loop
+ * iterations, and total time spent in handlers) and is followed by one line
+ * per handler sorted by cumulative run time. Each handler line contains the
+ * handler type and symbol, call count, total/max/average run time, and the
+ * total/max delay and a delay histogram (<100 us, <1 ms, <10 ms, <100 ms,
+ * <1 s, >=1 s). The delay is the lateness of a timeout or the time from a
+ * socket becoming ready to its handler being called.
+ */
+int eloop_profile_dump(char *buf, size_t buflen);
+
+/**
+ * eloop_profile_reset - Clear event loop profiling data
+ */
+void eloop_profile_reset(void);
+
+#endif /* CONFIG_ELOOP_PROFILE */
+
 /**
  * eloop_wait_for_read_sock - Wait for a single reader
  * @sock: File descriptor number for the socket
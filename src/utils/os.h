@@ -55,11 +55,13 @@ static inline int os_time_before(struct os_time *a, struct os_time *b)
 static inline void os_time_sub(struct os_time *a, struct os_time *b,
 			       struct os_time *res)
 {
+	/* os_time_t is unsigned, so borrow before subtracting usec */
 	res->sec = a->sec - b->sec;
-	res->usec = a->usec - b->usec;
-	if (res->usec < 0) {
+	if (a->usec < b->usec) {
 		res->sec--;
-		res->usec += 1000000;
+		res->usec = a->usec + 1000000 - b->usec;
+	} else {
+		res->usec = a->usec - b->usec;
 	}
 }
 
@@ -77,11 +79,13 @@ static inline int os_reltime_before(struct os_reltime *a,
 static inline void os_reltime_sub(struct os_reltime *a, struct os_reltime *b,
 				  struct os_reltime *res)
 {
+	/* os_time_t is unsigned, so borrow before subtracting usec */
 	res->sec = a->sec - b->sec;
-	res->usec = a->usec - b->usec;
-	if (res->usec < 0) {
+	if (a->usec < b->usec) {
 		res->sec--;
-		res->usec += 1000000;
+		res->usec = a->usec + 1000000 - b->usec;
+	} else {
+		res->usec = a->usec - b->usec;
 	}
 }
 
@@ -0,0 +1,244 @@
+/*
+ * Fixed-size object caches
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "slab.h"
+
+/* Target size for a slab; caches of large objects use at least
+ * SLAB_MIN_OBJS objects per slab */
+#define SLAB_SIZE 16384
+#define SLAB_MIN_OBJS 4
+#define SLAB_ALIGN 16
+
+/*
+ * With WPA_TRACE, each object is allocated separately with os_zalloc() so
+ * that allocation tracking (leak reports) and the allocation failure testing
+ * (alloc_fail/fail_test) keep working for the callers. Only the counters are
+ * maintained in that case.
+ */
+
+struct slab {
+	struct dl_list list;
+	struct slab_cache *cache;
+	struct slab_slot *free;
+	unsigned int in_use;
+} __attribute__((aligned(SLAB_ALIGN)));
+
+/* Each object is preceded by a slot header that points to its slab */
+struct slab_slot {
+	struct slab *slab;
+	struct slab_slot *next; /* next free slot */
+} __attribute__((aligned(SLAB_ALIGN)));
+
+static struct slab_cache *slab_caches;
+
+
+static void slab_cache_setup(struct slab_cache *cache)
+{
+	cache->slot_size = (sizeof(struct slab_slot) + cache->obj_size +
+			    SLAB_ALIGN - 1) & ~((size_t) SLAB_ALIGN - 1);
+	cache->per_slab = (SLAB_SIZE - sizeof(struct slab)) / cache->slot_size;
+	if (cache->per_slab < SLAB_MIN_OBJS)
+		cache->per_slab = SLAB_MIN_OBJS;
+	dl_list_init(&cache->partial);
+	dl_list_init(&cache->full);
+	cache->next = slab_caches;
+	slab_caches = cache;
+}
+
+
+static struct slab * slab_new(struct slab_cache *cache)
+{
+	struct slab *slab;
+	struct slab_slot *slot;
+	u8 *pos;
+	unsigned int i;
+
+	slab = os_malloc(sizeof(*slab) + cache->per_slab * cache->slot_size);
+	if (!slab)
+		return NULL;
+	slab->cache = cache;
+	slab->in_use = 0;
+	slab->free = NULL;
+	pos = (u8 *) (slab + 1) + (cache->per_slab - 1) * cache->slot_size;
+	for (i = 0; i < cache->per_slab; i++, pos -= cache->slot_size) {
+		slot = (struct slab_slot *) pos;
+		slot->slab = slab;
+		slot->next = slab->free;
+		slab->free = slot;
+	}
+	cache->slabs++;
+	return slab;
+}
+
+
+/**
+ * slab_zalloc - Allocate and clear an object from a cache
+ * @cache: Object cache
+ * Returns: Pointer to the object or %NULL on failure
+ */
+void * slab_zalloc(struct slab_cache *cache)
+{
+	struct slab *slab;
+	struct slab_slot *slot;
+
+	if (!cache->slot_size)
+		slab_cache_setup(cache);
+
+#ifdef WPA_TRACE
+	slot = os_zalloc(cache->obj_size);
+	if (!slot)
+		return NULL;
+	cache->in_use++;
+	cache->allocs++;
+	return slot;
+#endif /* WPA_TRACE */
+
+	slab = dl_list_first(&cache->partial, struct slab, list);
+	if (!slab) {
+		slab = cache->empty;
+		cache->empty = NULL;
+		if (!slab)
+			slab = slab_new(cache);
+		if (!slab)
+			return NULL;
+		dl_list_add(&cache->partial, &slab->list);
+	}
+
+	slot = slab->free;
+	slab->free = slot->next;
+	slab->in_use++;
+	if (!slab->free) {
+		dl_list_del(&slab->list);
+		dl_list_add(&cache->full, &slab->list);
+	}
+	cache->in_use++;
+	cache->allocs++;
+
+	os_memset(slot + 1, 0, cache->obj_size);
+	return slot + 1;
+}
+
+
+/**
+ * slab_free - Return an object to its cache
+ * @cache: Object cache that was used to allocate the object
+ * @obj: Object from slab_zalloc() or %NULL
+ */
+void slab_free(struct slab_cache *cache, void *obj)
+{
+	struct slab_slot *slot;
+	struct slab *slab;
+
+	if (!obj)
+		return;
+#ifdef WPA_TRACE
+	os_free(obj);
+	cache->in_use--;
+	cache->frees++;
+	return;
+#endif /* WPA_TRACE */
+	slot = ((struct slab_slot *) obj) - 1;
+	slab = slot->slab;
+	if (slab->cache != cache) {
+		wpa_printf(MSG_ERROR, "slab: %p freed to wrong cache %s",
+			   obj, cache->name);
+		return;
+	}
+
+	if (!slab->free) {
+		dl_list_del(&slab->list);
+		dl_list_add(&cache->partial, &slab->list);
+	}
+	slot->next = slab->free;
+	slab->free = slot;
+	slab->in_use--;
+	cache->in_use--;
+	cache->frees++;
+
+	if (slab->in_use)
+		return;
+	dl_list_del(&slab->list);
+	if (!cache->empty) {
+		cache->empty = slab;
+	} else {
+		os_free(slab);
+		cache->slabs--;
+	}
+}
+
+
+/**
+ * slab_clear_free - Clear an object and return it to its cache
+ * @cache: Object cache that was used to allocate the object
+ * @obj: Object from slab_zalloc() or %NULL
+ *
+ * This is used for objects that may contain keys.
+ */
+void slab_clear_free(struct slab_cache *cache, void *obj)
+{
+	if (obj) {
+		forced_memzero(obj, cache->obj_size);
+		slab_free(cache, obj);
+	}
+}
+
+
+/**
+ * slab_stats - Write object cache statistics into a text buffer
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written into the buffer
+ *
+ * One line is written per initialized cache with the object size, number of
+ * objects in use, number of slabs and memory used by them, and total number
+ * of allocations and frees.
+ */
+int slab_stats(char *buf, size_t buflen)
+{
+	struct slab_cache *cache;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	for (cache = slab_caches; cache; cache = cache->next) {
+		ret = os_snprintf(pos, end - pos,
+				  "%s obj_size=%zu in_use=%u slabs=%u slab_bytes=%zu allocs=%lu frees=%lu\n",
+				  cache->name, cache->obj_size, cache->in_use,
+				  cache->slabs,
+				  cache->slabs * (sizeof(struct slab) +
+						  cache->per_slab *
+						  cache->slot_size),
+				  cache->allocs, cache->frees);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
+/**
+ * slab_flush - Free unused slabs of all caches
+ *
+ * This is called on process termination to release the slabs that are kept
+ * for reuse.
+ */
+void slab_flush(void)
+{
+	struct slab_cache *cache;
+
+	for (cache = slab_caches; cache; cache = cache->next) {
+		if (cache->empty) {
+			os_free(cache->empty);
+			cache->empty = NULL;
+			cache->slabs--;
+		}
+	}
+}
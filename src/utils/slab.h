@@ -0,0 +1,79 @@
+/*
+ * Fixed-size object caches
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "list.h"
+
+/**
+ * struct slab_cache - Cache of objects of a single size
+ *
+ * Objects are carved out of larger blocks (slabs) so that frequently
+ * allocated and freed objects (e.g., per-station state) do not fragment the
+ * heap. A cache is defined statically with SLAB_CACHE_INIT() and it is set
+ * up on the first allocation. Without CONFIG_STA_SLAB, the functions map
+ * directly to os_zalloc() and os_free(). With WPA_TRACE, objects are allocated
+ * individually as well so that allocation failure testing and leak tracking
+ * cover them.
+ */
+struct slab_cache {
+	const char *name;
+	size_t obj_size;
+#ifdef CONFIG_STA_SLAB
+	size_t slot_size;
+	unsigned int per_slab;
+	struct dl_list partial; /* slabs with both used and free objects */
+	struct dl_list full; /* slabs with no free objects */
+	struct slab *empty; /* an unused slab that is kept for reuse */
+	struct slab_cache *next; /* list of initialized caches */
+	unsigned int in_use;
+	unsigned int slabs;
+	unsigned long allocs;
+	unsigned long frees;
+#endif /* CONFIG_STA_SLAB */
+};
+
+#define SLAB_CACHE_INIT(_name, _size) { .name = (_name), .obj_size = (_size) }
+
+#ifdef CONFIG_STA_SLAB
+
+void * slab_zalloc(struct slab_cache *cache);
+void slab_free(struct slab_cache *cache, void *obj);
+void slab_clear_free(struct slab_cache *cache, void *obj);
+int slab_stats(char *buf, size_t buflen);
+void slab_flush(void);
+
+#else /* CONFIG_STA_SLAB */
+
+static inline void * slab_zalloc(struct slab_cache *cache)
+{
+	return os_zalloc(cache->obj_size);
+}
+
+static inline void slab_free(struct slab_cache *cache, void *obj)
+{
+	os_free(obj);
+}
+
+static inline void slab_clear_free(struct slab_cache *cache, void *obj)
+{
+	bin_clear_free(obj, cache->obj_size);
+}
+
+static inline int slab_stats(char *buf, size_t buflen)
+{
+	return 0;
+}
+
+static inline void slab_flush(void)
+{
+}
+
+#endif /* CONFIG_STA_SLAB */
+
+#endif /* SLAB_H */
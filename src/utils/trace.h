@@ -59,6 +59,7 @@ size_t wpa_trace_calling_func(const char *buf[], size_t len);
 #ifdef WPA_TRACE_BFD
 
 void wpa_trace_dump_funcname(const char *title, void *pc);
+const char * wpa_trace_func_name(void *pc);
 
 #else /* WPA_TRACE_BFD */
 
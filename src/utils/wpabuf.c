@@ -27,6 +27,36 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 #endif /* WPA_TRACE */
 
 
+/*
+ * Data areas of up to WPABUF_POOL_MAX_LEN octets are allocated in power of two
+ * size classes starting from WPABUF_POOL_MIN_LEN. Freed buffers of these
+ * sizes are kept in per-class free lists to be reused for the common short
+ * lived frames (management frames, EAPOL-Key frames, RADIUS messages). The
+ * pool is not used with WPA_TRACE to keep allocation tracking and the
+ * allocation failure testing working for each buffer. The free lists are not
+ * locked, so the pool is not used on Zephyr either where the supplicant API
+ * can be called from other threads.
+ */
+#define WPABUF_POOL_MIN_LEN 64
+#define WPABUF_POOL_MAX_LEN (WPABUF_POOL_MIN_LEN << (WPABUF_POOL_CLASSES - 1))
+#define WPABUF_POOL_MAX_FREE 8
+
+#if !defined(WPA_TRACE) && !defined(CONFIG_ZEPHYR)
+#define WPABUF_POOL
+#endif /* !WPA_TRACE && !CONFIG_ZEPHYR */
+
+#ifdef WPA_TRACE
+#define WPABUF_HDR_LEN (sizeof(struct wpabuf_trace) + sizeof(struct wpabuf))
+#else /* WPA_TRACE */
+#define WPABUF_HDR_LEN sizeof(struct wpabuf)
+#endif /* WPA_TRACE */
+
+static struct wpabuf_stats wpabuf_stats;
+#ifdef WPABUF_POOL
+static struct wpabuf *wpabuf_pool[WPABUF_POOL_CLASSES];
+#endif /* WPABUF_POOL */
+
+
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
 #ifdef WPA_TRACE
@@ -44,9 +74,92 @@ static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 }
 
 
+/* Return the size class index for a data area length or -1 if not pooled */
+static int wpabuf_pool_class(size_t len)
+{
+	size_t class_len = WPABUF_POOL_MIN_LEN;
+	int i;
+
+	for (i = 0; i < WPABUF_POOL_CLASSES; i++, class_len <<= 1) {
+		if (len <= class_len)
+			return i;
+	}
+	return -1;
+}
+
+
+static size_t wpabuf_alloc_len(size_t len)
+{
+	int idx = wpabuf_pool_class(len);
+
+	return idx < 0 ? len : (size_t) WPABUF_POOL_MIN_LEN << idx;
+}
+
+
+/* Allocate the header and a data area of alloc_len octets; the data area is
+ * not cleared. */
+static void * wpabuf_alloc_raw(size_t alloc_len)
+{
+	void *ptr;
+#ifdef WPABUF_POOL
+	int idx = wpabuf_pool_class(alloc_len);
+	struct wpabuf *buf;
+
+	if (idx >= 0) {
+		buf = wpabuf_pool[idx];
+		if (buf) {
+			wpabuf_pool[idx] = (struct wpabuf *) buf->buf;
+			wpabuf_stats.pool[idx].cached--;
+			wpabuf_stats.pool[idx].hits++;
+			return buf;
+		}
+		wpabuf_stats.pool[idx].misses++;
+	}
+#endif /* WPABUF_POOL */
+
+	ptr = os_malloc(WPABUF_HDR_LEN + alloc_len);
+	if (ptr)
+		wpabuf_stats.allocs++;
+	return ptr;
+}
+
+
+static void wpabuf_free_raw(void *ptr, size_t alloc_len)
+{
+#ifdef WPABUF_POOL
+	int idx = wpabuf_pool_class(alloc_len);
+	struct wpabuf *buf = ptr;
+
+	if (idx >= 0 && alloc_len == (size_t) WPABUF_POOL_MIN_LEN << idx &&
+	    wpabuf_stats.pool[idx].cached < WPABUF_POOL_MAX_FREE) {
+		buf->buf = (u8 *) wpabuf_pool[idx];
+		wpabuf_pool[idx] = buf;
+		wpabuf_stats.pool[idx].cached++;
+		return;
+	}
+#endif /* WPABUF_POOL */
+
+	wpabuf_stats.frees++;
+	os_free(ptr);
+}
+
+
+/* Geometric growth keeps the number of reallocations logarithmic when a
+ * buffer is built with a sequence of small wpabuf_resize() calls. */
+static size_t wpabuf_grow_len(size_t alloc_len, size_t needed)
+{
+	size_t len = needed;
+
+	if (alloc_len < ((size_t) -1) / 3 && alloc_len + alloc_len / 2 > len)
+		len = alloc_len + alloc_len / 2;
+	return wpabuf_alloc_len(len);
+}
+
+
 int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 {
 	struct wpabuf *buf = *_buf;
+	size_t needed, alloc_len;
 #ifdef WPA_TRACE
 	struct wpabuf_trace *trace;
 #endif /* WPA_TRACE */
@@ -66,41 +179,64 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 	}
 #endif /* WPA_TRACE */
 
-	if (buf->used + add_len > buf->size) {
+	if (add_len > ((size_t) -1) - buf->used)
+		return -1;
+	needed = buf->used + add_len;
+	if (needed <= buf->size)
+		return 0;
+
+	wpabuf_stats.grows++;
+	if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 		unsigned char *nbuf;
-		if (buf->flags & WPABUF_FLAG_EXT_DATA) {
-			nbuf = os_realloc(buf->buf, buf->used + add_len);
-			if (nbuf == NULL)
-				return -1;
-			os_memset(nbuf + buf->used, 0, add_len);
-			buf->buf = nbuf;
-		} else {
+
+		nbuf = os_realloc(buf->buf, needed);
+		if (nbuf == NULL)
+			return -1;
+		wpabuf_stats.reallocs++;
+		buf->buf = nbuf;
+		buf->alloc = needed;
+	} else if (needed > buf->alloc) {
+		unsigned char *nbuf;
+
+		alloc_len = wpabuf_grow_len(buf->alloc, needed);
 #ifdef WPA_TRACE
-			nbuf = os_realloc(trace, sizeof(struct wpabuf_trace) +
-					  sizeof(struct wpabuf) +
-					  buf->used + add_len);
+		nbuf = os_realloc(trace, WPABUF_HDR_LEN + alloc_len);
+		if (nbuf == NULL)
+			return -1;
+		wpabuf_stats.reallocs++;
+		trace = (struct wpabuf_trace *) nbuf;
+		buf = (struct wpabuf *) (trace + 1);
+#else /* WPA_TRACE */
+#ifdef WPABUF_POOL
+		if (wpabuf_pool_class(buf->alloc) >= 0) {
+			/* Do not reallocate pooled areas in place so that the
+			 * old area can be returned to its pool */
+			nbuf = wpabuf_alloc_raw(alloc_len);
 			if (nbuf == NULL)
 				return -1;
-			trace = (struct wpabuf_trace *) nbuf;
-			buf = (struct wpabuf *) (trace + 1);
-			os_memset(nbuf + sizeof(struct wpabuf_trace) +
-				  sizeof(struct wpabuf) + buf->used, 0,
-				  add_len);
-#else /* WPA_TRACE */
-			nbuf = os_realloc(buf, sizeof(struct wpabuf) +
-					  buf->used + add_len);
+			os_memcpy(nbuf, buf, WPABUF_HDR_LEN + buf->size);
+			wpabuf_free_raw(buf, buf->alloc);
+		} else
+#endif /* WPABUF_POOL */
+		{
+			nbuf = os_realloc(buf, WPABUF_HDR_LEN + alloc_len);
 			if (nbuf == NULL)
 				return -1;
-			buf = (struct wpabuf *) nbuf;
-			os_memset(nbuf + sizeof(struct wpabuf) + buf->used, 0,
-				  add_len);
-#endif /* WPA_TRACE */
-			buf->buf = (u8 *) (buf + 1);
-			*_buf = buf;
+			wpabuf_stats.reallocs++;
 		}
-		buf->size = buf->used + add_len;
+		buf = (struct wpabuf *) nbuf;
+#endif /* WPA_TRACE */
+		buf->buf = (u8 *) (buf + 1);
+		buf->alloc = alloc_len;
+		*_buf = buf;
+	} else {
+		wpabuf_stats.grows_in_place++;
 	}
 
+	/* Everything up to the size has been either written or cleared */
+	os_memset(buf->buf + buf->size, 0, needed - buf->size);
+	buf->size = needed;
+
 	return 0;
 }
 
@@ -112,21 +248,24 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
  */
 struct wpabuf * wpabuf_alloc(size_t len)
 {
+	size_t alloc_len = wpabuf_alloc_len(len);
 #ifdef WPA_TRACE
-	struct wpabuf_trace *trace = os_zalloc(sizeof(struct wpabuf_trace) +
-					       sizeof(struct wpabuf) + len);
+	struct wpabuf_trace *trace = wpabuf_alloc_raw(alloc_len);
 	struct wpabuf *buf;
 	if (trace == NULL)
 		return NULL;
+	os_memset(trace, 0, WPABUF_HDR_LEN + len);
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
-	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf) + len);
+	struct wpabuf *buf = wpabuf_alloc_raw(alloc_len);
 	if (buf == NULL)
 		return NULL;
+	os_memset(buf, 0, WPABUF_HDR_LEN + len);
 #endif /* WPA_TRACE */
 
 	buf->size = len;
+	buf->alloc = alloc_len;
 	buf->buf = (u8 *) (buf + 1);
 	return buf;
 }
@@ -149,6 +288,7 @@ struct wpabuf * wpabuf_alloc_ext_data(u8 *data, size_t len)
 #endif /* WPA_TRACE */
 
 	buf->size = len;
+	buf->alloc = len;
 	buf->used = len;
 	buf->buf = data;
 	buf->flags |= WPABUF_FLAG_EXT_DATA;
@@ -192,15 +332,21 @@ void wpabuf_free(struct wpabuf *buf)
 		wpa_trace_show("wpabuf_free magic mismatch");
 		abort();
 	}
-	if (buf->flags & WPABUF_FLAG_EXT_DATA)
+	if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 		os_free(buf->buf);
-	os_free(trace);
+		os_free(trace);
+		return;
+	}
+	wpabuf_free_raw(trace, buf->alloc);
 #else /* WPA_TRACE */
 	if (buf == NULL)
 		return;
-	if (buf->flags & WPABUF_FLAG_EXT_DATA)
+	if (buf->flags & WPABUF_FLAG_EXT_DATA) {
 		os_free(buf->buf);
-	os_free(buf);
+		os_free(buf);
+		return;
+	}
+	wpabuf_free_raw(buf, buf->alloc);
 #endif /* WPA_TRACE */
 }
 
@@ -338,3 +484,41 @@ struct wpabuf * wpabuf_parse_bin(const char *buf)
 
 	return ret;
 }
+
+
+/**
+ * wpabuf_get_stats - Get wpabuf allocation statistics
+ * @stats: Buffer for the statistics
+ */
+void wpabuf_get_stats(struct wpabuf_stats *stats)
+{
+	int i;
+
+	os_memcpy(stats, &wpabuf_stats, sizeof(*stats));
+	for (i = 0; i < WPABUF_POOL_CLASSES; i++)
+		stats->pool[i].len = (size_t) WPABUF_POOL_MIN_LEN << i;
+}
+
+
+/**
+ * wpabuf_pool_flush - Free all buffers cached in the wpabuf pool
+ *
+ * This can be used before process termination to make memory leak checkers
+ * ignore the cached buffers. Allocation statistics are cleared.
+ */
+void wpabuf_pool_flush(void)
+{
+#ifdef WPABUF_POOL
+	struct wpabuf *buf, *next;
+	int i;
+
+	for (i = 0; i < WPABUF_POOL_CLASSES; i++) {
+		for (buf = wpabuf_pool[i]; buf; buf = next) {
+			next = (struct wpabuf *) buf->buf;
+			os_free(buf);
+		}
+		wpabuf_pool[i] = NULL;
+	}
+#endif /* WPABUF_POOL */
+	os_memset(&wpabuf_stats, 0, sizeof(wpabuf_stats));
+}
@@ -22,9 +22,26 @@ struct wpabuf {
 	size_t used; /* length of data in the buffer */
 	u8 *buf; /* pointer to the head of the buffer */
 	unsigned int flags;
+	size_t alloc; /* allocated length of the data area (>= size) */
 	/* optionally followed by the allocated buffer */
 };
 
+#define WPABUF_POOL_CLASSES 7
+
+struct wpabuf_stats {
+	unsigned long allocs; /* heap allocations */
+	unsigned long reallocs; /* heap reallocations */
+	unsigned long frees; /* heap frees */
+	unsigned long grows; /* wpabuf_resize() calls that needed more room */
+	unsigned long grows_in_place; /* ... and were served from spare space */
+	struct {
+		size_t len; /* data area length of the size class */
+		unsigned long hits; /* allocations served from the pool */
+		unsigned long misses; /* allocations that needed the heap */
+		unsigned int cached; /* currently cached free buffers */
+	} pool[WPABUF_POOL_CLASSES];
+};
+
 
 int wpabuf_resize(struct wpabuf **buf, size_t add_len);
 struct wpabuf * wpabuf_alloc(size_t len);
@@ -38,6 +55,8 @@ struct wpabuf * wpabuf_concat(struct wpabuf *a, struct wpabuf *b);
 struct wpabuf * wpabuf_zeropad(struct wpabuf *buf, size_t len);
 void wpabuf_printf(struct wpabuf *buf, char *fmt, ...) PRINTF_FORMAT(2, 3);
 struct wpabuf * wpabuf_parse_bin(const char *buf);
+void wpabuf_get_stats(struct wpabuf_stats *stats);
+void wpabuf_pool_flush(void);
 
 
 /**
@@ -70,6 +89,16 @@ static inline size_t wpabuf_tailroom(const struct wpabuf *buf)
 	return buf->size - buf->used;
 }
 
+/**
+ * wpabuf_mem_usage - Get the amount of heap memory used by a wpabuf
+ * @buf: wpabuf buffer or %NULL
+ * Returns: Allocated length including the wpabuf header
+ */
+static inline size_t wpabuf_mem_usage(const struct wpabuf *buf)
+{
+	return buf ? sizeof(*buf) + buf->alloc : 0;
+}
+
 /**
  * wpabuf_cmp - Check if two buffers contain the same data
  * @a: wpabuf buffer
@@ -180,7 +209,7 @@ static inline void wpabuf_set(struct wpabuf *buf, const void *data, size_t len)
 {
 	buf->buf = (u8 *) data;
 	buf->flags = WPABUF_FLAG_EXT_DATA;
-	buf->size = buf->used = len;
+	buf->size = buf->used = buf->alloc = len;
 }
 
 static inline void wpabuf_put_str(struct wpabuf *dst, const char *str)
@@ -27,6 +27,7 @@ const struct wpa_driver_ops *const wpa_drivers[] =
 struct arg_ctx {
 	const u8 *data;
 	size_t data_len;
+	unsigned int iterations;
 	struct hostapd_iface iface;
 	struct hostapd_data hapd;
 	struct wpa_driver_ops driver;
@@ -40,22 +41,38 @@ static void test_send_mgmt(void *eloop_data, void *user_ctx)
 	struct arg_ctx *ctx = eloop_data;
 	struct hostapd_frame_info fi;
 	const u8 *pos, *end;
+	unsigned int i, frames = 0;
+	struct os_reltime start, now, diff;
 
 	os_memset(&fi, 0, sizeof(fi));
 
-	pos = ctx->data;
-	end = pos + ctx->data_len;
+	os_get_reltime(&start);
+	for (i = 0; i < ctx->iterations; i++) {
+		pos = ctx->data;
+		end = pos + ctx->data_len;
+
+		while (end - pos > 2) {
+			u16 flen;
+
+			flen = WPA_GET_BE16(pos);
+			pos += 2;
+			if (end - pos < flen)
+				break;
+			wpa_hexdump(MSG_MSGDUMP, "fuzzer - frame", pos, flen);
+			ieee802_11_mgmt(&ctx->hapd, pos, flen, &fi);
+			pos += flen;
+			frames++;
+		}
+	}
 
-	while (end - pos > 2) {
-		u16 flen;
+	if (ctx->iterations > 1) {
+		unsigned long long usec;
 
-		flen = WPA_GET_BE16(pos);
-		pos += 2;
-		if (end - pos < flen)
-			break;
-		wpa_hexdump(MSG_MSGDUMP, "fuzzer - frame", pos, flen);
-		ieee802_11_mgmt(&ctx->hapd, pos, flen, &fi);
-		pos += flen;
+		os_get_reltime(&now);
+		os_reltime_sub(&now, &start, &diff);
+		usec = diff.sec * 1000000ULL + diff.usec;
+		printf("%u frames in %llu usec (%.0f frames/sec)\n",
+		       frames, usec, usec ? frames * 1000000.0 / usec : 0.0);
 	}
 
 	eloop_terminate();
@@ -104,6 +121,7 @@ static int init_hapd(struct arg_ctx *ctx)
 	hapd->driver = &ctx->driver;
 	os_memcpy(hapd->own_addr, "\x02\x00\x00\x00\x03\x00", ETH_ALEN);
 	hapd->iface = &ctx->iface;
+	hapd->iface->state = HAPD_IFACE_ENABLED;
 	hapd->iface->conf = hostapd_config_defaults();
 	if (!hapd->iface->conf)
 		return -1;
@@ -130,6 +148,9 @@ static int init_hapd(struct arg_ctx *ctx)
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
 	struct arg_ctx ctx;
+#ifndef TEST_LIBFUZZER
+	char *env;
+#endif /* TEST_LIBFUZZER */
 
 	wpa_fuzzer_set_debug_level();
 
@@ -144,6 +165,13 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 	os_memset(&ctx, 0, sizeof(ctx));
 	ctx.data = data;
 	ctx.data_len = size;
+	ctx.iterations = 1;
+#ifndef TEST_LIBFUZZER
+	/* Benchmark mode: AP_MGMT_BENCH=<iterations> replays the input */
+	env = getenv("AP_MGMT_BENCH");
+	if (env && atoi(env) > 1)
+		ctx.iterations = atoi(env);
+#endif /* TEST_LIBFUZZER */
 
 	if (init_hapd(&ctx))
 		goto fail;
@@ -0,0 +1,288 @@
+/*
+ * GAS server fuzzer
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "common/ieee802_11_defs.h"
+#include "common/gas.h"
+#include "common/gas_server.h"
+#include "../fuzzer-common.h"
+
+/* Default Query Response length in benchmark mode */
+#define GAS_BENCH_RESP_LEN 16384
+/* Number of peers with a concurrently pending exchange in benchmark mode */
+#define GAS_BENCH_PEERS 64
+/* Upper bound on the number of Comeback Requests per exchange */
+#define GAS_MAX_COMEBACK 300
+
+
+struct arg_ctx {
+	const u8 *data;
+	size_t data_len;
+	struct gas_server *gas;
+	size_t resp_len;
+	unsigned int bench;
+
+	/* Last transmitted frame with a dummy IEEE 802.11 header */
+	struct wpabuf *tx;
+	u8 tx_dst[ETH_ALEN];
+	int tx_more; /* more fragments remaining after the last frame */
+	size_t tx_octets; /* Query Response octets in the last frame */
+};
+
+
+static const u8 src_addr[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 };
+static const u8 own_addr[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+
+static struct wpabuf * anqp_req_cb(void *ctx, void *resp_ctx, const u8 *sa,
+				   const u8 *query, size_t query_len,
+				   int *comeback_delay)
+{
+	struct arg_ctx *actx = ctx;
+	struct wpabuf *buf;
+
+	buf = wpabuf_alloc(actx->resp_len);
+	if (buf)
+		os_memset(wpabuf_put(buf, actx->resp_len), 0xab,
+			  actx->resp_len);
+	return buf;
+}
+
+
+static void anqp_status_cb(void *ctx, struct wpabuf *resp, int ok)
+{
+	wpabuf_free(resp);
+}
+
+
+static void gas_tx(void *ctx, int freq, const u8 *da, struct wpabuf *buf,
+		   unsigned int wait_time)
+{
+	struct arg_ctx *actx = ctx;
+	const u8 *pos, *end;
+	u8 action;
+
+	actx->tx_more = 0;
+	actx->tx_octets = 0;
+	wpabuf_free(actx->tx);
+	actx->tx = wpabuf_alloc(IEEE80211_HDRLEN + wpabuf_len(buf));
+	if (!actx->tx)
+		return;
+	os_memset(wpabuf_put(actx->tx, IEEE80211_HDRLEN), 0, IEEE80211_HDRLEN);
+	wpabuf_put_buf(actx->tx, buf);
+	os_memcpy(actx->tx_dst, da, ETH_ALEN);
+
+	/* Category, Action, Dialog Token, Status Code */
+	pos = wpabuf_head(buf);
+	end = pos + wpabuf_len(buf);
+	if (end - pos < 5)
+		return;
+	action = pos[1];
+	pos += 5;
+	if (action == WLAN_PA_GAS_COMEBACK_RESP) {
+		if (end - pos < 1)
+			return;
+		actx->tx_more = !!(*pos & 0x80);
+		pos++;
+	}
+	if (end - pos < 2)
+		return;
+	if (action == WLAN_PA_GAS_INITIAL_RESP && WPA_GET_LE16(pos))
+		actx->tx_more = 1; /* Comeback Delay */
+	pos += 2;
+	if (end - pos < 2 || end - pos - 2 < pos[1])
+		return;
+	pos += 2 + pos[1]; /* Advertisement Protocol element */
+	if (end - pos < 2)
+		return;
+	actx->tx_octets = WPA_GET_LE16(pos);
+}
+
+
+static void tx_ack(struct arg_ctx *ctx)
+{
+	if (!ctx->tx)
+		return;
+	gas_server_tx_status(ctx->gas, ctx->tx_dst, wpabuf_head(ctx->tx),
+			     wpabuf_len(ctx->tx), 1);
+	wpabuf_free(ctx->tx);
+	ctx->tx = NULL;
+}
+
+
+/* Fetch the remaining fragments with Comeback Request frames and return the
+ * number of Query Response octets received */
+static size_t fetch_comeback(struct arg_ctx *ctx, const u8 *sa, u8 dialog_token)
+{
+	struct wpabuf *req;
+	size_t octets = 0;
+	int i;
+
+	req = gas_build_comeback_req(dialog_token);
+	if (!req)
+		return 0;
+	for (i = 0; ctx->tx_more && i < GAS_MAX_COMEBACK; i++) {
+		ctx->tx_more = 0;
+		if (gas_server_rx(ctx->gas, own_addr, sa, own_addr,
+				  WLAN_ACTION_PUBLIC,
+				  wpabuf_head_u8(req) + 1, wpabuf_len(req) - 1,
+				  2412) < 0)
+			break;
+		octets += ctx->tx_octets;
+		tx_ack(ctx);
+	}
+	wpabuf_free(req);
+	return octets;
+}
+
+
+static unsigned long long usec_since(struct os_reltime *start)
+{
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	return now.sec * 1000000ULL + now.usec -
+		(start->sec * 1000000ULL + start->usec);
+}
+
+
+/* Run the input GAS Initial Request through complete exchanges with a number
+ * of peers that have a pending response at the same time */
+static void bench_exchanges(struct arg_ctx *ctx)
+{
+	struct os_reltime start;
+	unsigned long long usec;
+	u8 sa[GAS_BENCH_PEERS][ETH_ALEN];
+	int more[GAS_BENCH_PEERS];
+	unsigned int i, p, done = 0;
+	size_t octets = 0;
+	u8 dialog_token;
+
+	if (ctx->data_len < 2 || ctx->data[0] != WLAN_PA_GAS_INITIAL_REQ) {
+		printf("Input is not a GAS Initial Request frame\n");
+		return;
+	}
+	dialog_token = ctx->data[1];
+
+	os_get_reltime(&start);
+	for (i = 0; i < ctx->bench; i++) {
+		for (p = 0; p < GAS_BENCH_PEERS; p++) {
+			os_memcpy(sa[p], src_addr, ETH_ALEN);
+			sa[p][4] = i;
+			sa[p][5] = p;
+			ctx->tx_more = 0;
+			if (gas_server_rx(ctx->gas, own_addr, sa[p], own_addr,
+					  WLAN_ACTION_PUBLIC, ctx->data,
+					  ctx->data_len, 2412) < 0)
+				return;
+			more[p] = ctx->tx_more;
+			octets += ctx->tx_octets;
+			tx_ack(ctx);
+		}
+		for (p = 0; p < GAS_BENCH_PEERS; p++) {
+			ctx->tx_more = more[p];
+			octets += fetch_comeback(ctx, sa[p], dialog_token);
+			done++;
+		}
+	}
+	usec = usec_since(&start);
+	printf("%u GAS exchanges (%zu octets) in %llu usec (%.0f exchanges/sec, %.1f MB/s)\n",
+	       done, octets, usec, usec ? done * 1000000.0 / usec : 0.0,
+	       usec ? octets / (double) usec : 0.0);
+}
+
+
+static void test_send(void *eloop_data, void *user_ctx)
+{
+	struct arg_ctx *ctx = eloop_data;
+
+	wpa_hexdump(MSG_MSGDUMP, "fuzzer - GAS request", ctx->data,
+		    ctx->data_len);
+
+	if (ctx->bench) {
+		bench_exchanges(ctx);
+		eloop_terminate();
+		return;
+	}
+
+	if (ctx->data_len >= 2) {
+		gas_server_rx(ctx->gas, own_addr, src_addr, own_addr,
+			      WLAN_ACTION_PUBLIC, ctx->data, ctx->data_len,
+			      2412);
+		tx_ack(ctx);
+		fetch_comeback(ctx, src_addr, ctx->data[1]);
+	}
+
+	eloop_terminate();
+}
+
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct arg_ctx ctx;
+	static const u8 anqp_adv_proto_id[] = { ACCESS_NETWORK_QUERY_PROTOCOL };
+#ifndef TEST_LIBFUZZER
+	char *env;
+#endif /* TEST_LIBFUZZER */
+
+	wpa_fuzzer_set_debug_level();
+
+	if (os_program_init())
+		return -1;
+
+	if (eloop_init()) {
+		wpa_printf(MSG_ERROR, "Failed to initialize event loop");
+		return 0;
+	}
+
+	os_memset(&ctx, 0, sizeof(ctx));
+	ctx.data = data;
+	ctx.data_len = size;
+	ctx.resp_len = 4000;
+
+#ifndef TEST_LIBFUZZER
+	/* Benchmark mode: GAS_BENCH=<count> runs count rounds of complete
+	 * exchanges based on the input GAS Initial Request and
+	 * GAS_BENCH_LEN=<octets> sets the Query Response length */
+	env = getenv("GAS_BENCH");
+	if (env && atoi(env) > 0) {
+		ctx.bench = atoi(env);
+		ctx.resp_len = GAS_BENCH_RESP_LEN;
+		env = getenv("GAS_BENCH_LEN");
+		if (env && atoi(env) > 0)
+			ctx.resp_len = atoi(env);
+	}
+#endif /* TEST_LIBFUZZER */
+
+	ctx.gas = gas_server_init(&ctx, gas_tx);
+	if (!ctx.gas ||
+	    gas_server_register(ctx.gas, anqp_adv_proto_id,
+				sizeof(anqp_adv_proto_id), anqp_req_cb,
+				anqp_status_cb, &ctx) < 0) {
+		wpa_printf(MSG_ERROR, "GAS server init failed");
+		gas_server_deinit(ctx.gas);
+		eloop_destroy();
+		os_program_deinit();
+		return 0;
+	}
+
+	eloop_register_timeout(0, 0, test_send, &ctx, NULL);
+
+	wpa_printf(MSG_DEBUG, "Starting eloop");
+	eloop_run();
+	wpa_printf(MSG_DEBUG, "eloop done");
+
+	wpabuf_free(ctx.tx);
+	gas_server_deinit(ctx.gas);
+	eloop_destroy();
+	os_program_deinit();
+
+	return 0;
+}
@@ -12,8 +12,12 @@
 #include "utils/eloop.h"
 #include "common/ieee802_11_defs.h"
 #include "p2p/p2p.h"
+#include "p2p/p2p_i.h"
 #include "../fuzzer-common.h"
 
+/* Size of the peer table in benchmark mode */
+#define P2P_BENCH_MAX_PEERS 1000
+
 
 static void debug_print(void *ctx, int level, const char *msg)
 {
@@ -71,12 +75,12 @@ static void go_neg_req_rx(void *ctx, const u8 *src, u16 dev_passwd_id,
 }
 
 
-static struct p2p_data * init_p2p(void)
+static struct p2p_data * init_p2p(size_t max_peers)
 {
 	struct p2p_config p2p;
 
 	os_memset(&p2p, 0, sizeof(p2p));
-	p2p.max_peers = 100;
+	p2p.max_peers = max_peers;
 	p2p.passphrase_len = 8;
 	p2p.channels.reg_classes = 1;
 	p2p.channels.reg_class[0].reg_class = 81;
@@ -102,9 +106,92 @@ struct arg_ctx {
 	size_t data_len;
 	struct p2p_data *p2p;
 	int count;
+	unsigned int bench_peers;
 };
 
 
+static unsigned long long usec_since(struct os_reltime *start)
+{
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	return now.sec * 1000000ULL + now.usec -
+		(start->sec * 1000000ULL + start->usec);
+}
+
+
+static void bench_peer_addr(u8 *addr, unsigned int i)
+{
+	addr[3] = i >> 16;
+	addr[4] = i >> 8;
+	addr[5] = i;
+}
+
+
+/* Add synthetic peers with unique P2P Device and Interface Addresses using the
+ * input as the Probe Response template and then look all of them up. */
+static void bench_peers(struct arg_ctx *ctx)
+{
+	struct p2p_message msg;
+	struct os_reltime start, rx_time;
+	unsigned long long usec;
+	u8 *ies, *dev_addr = NULL, addr[ETH_ALEN] = { 0x02, 0x01, 0, 0, 0, 0 };
+	unsigned int i, found = 0;
+	size_t pos;
+
+	ies = os_memdup(ctx->data, ctx->data_len);
+	if (!ies)
+		return;
+	os_memset(&msg, 0, sizeof(msg));
+	/* The parsed attributes point to a reassembled copy of the P2P IE, so
+	 * locate the P2P Device Address within the input */
+	if (p2p_parse_ies(ies, ctx->data_len, &msg) == 0 &&
+	    msg.p2p_device_addr) {
+		for (pos = 0; pos + ETH_ALEN <= ctx->data_len; pos++) {
+			if (os_memcmp(ies + pos, msg.p2p_device_addr,
+				      ETH_ALEN) == 0) {
+				dev_addr = ies + pos;
+				break;
+			}
+		}
+	}
+	p2p_parse_free(&msg);
+	if (!dev_addr) {
+		printf("No P2P Device Info in the input\n");
+		os_free(ies);
+		return;
+	}
+
+	os_get_reltime(&start);
+	for (i = 0; i < ctx->bench_peers; i++) {
+		bench_peer_addr(dev_addr, i);
+		bench_peer_addr(addr, i);
+		os_get_reltime(&rx_time);
+		p2p_add_device(ctx->p2p, addr, 2412, &rx_time, 0, ies,
+			       ctx->data_len, 1);
+	}
+	usec = usec_since(&start);
+	printf("%u peers added in %llu usec (%.0f peers/sec)\n",
+	       ctx->bench_peers, usec,
+	       usec ? ctx->bench_peers * 1000000.0 / usec : 0.0);
+
+	os_get_reltime(&start);
+	for (i = 0; i < ctx->bench_peers; i++) {
+		bench_peer_addr(dev_addr, i);
+		bench_peer_addr(addr, i);
+		if (p2p_get_device(ctx->p2p, dev_addr) &&
+		    p2p_get_device_interface(ctx->p2p, addr))
+			found++;
+	}
+	usec = usec_since(&start);
+	printf("%u peer lookups (%u found) in %llu usec (%.0f lookups/sec)\n",
+	       ctx->bench_peers, found, usec,
+	       usec ? ctx->bench_peers * 1000000.0 / usec : 0.0);
+
+	os_free(ies);
+}
+
+
 static void test_send(void *eloop_data, void *user_ctx)
 {
 	struct arg_ctx *ctx = eloop_data;
@@ -112,6 +199,12 @@ static void test_send(void *eloop_data, void *user_ctx)
 
 	wpa_hexdump(MSG_MSGDUMP, "fuzzer - IEs", ctx->data, ctx->data_len);
 
+	if (ctx->bench_peers) {
+		bench_peers(ctx);
+		eloop_terminate();
+		return;
+	}
+
 	os_memset(&rx_time, 0, sizeof(rx_time));
 	p2p_scan_res_handler(ctx->p2p, (u8 *) "\x02\x00\x00\x00\x01\x00", 2412,
 			     &rx_time, 0, ctx->data, ctx->data_len);
@@ -142,6 +235,10 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
 	struct p2p_data *p2p;
 	struct arg_ctx ctx;
+	unsigned int bench = 0;
+#ifndef TEST_LIBFUZZER
+	char *env;
+#endif /* TEST_LIBFUZZER */
 
 	wpa_fuzzer_set_debug_level();
 
@@ -153,7 +250,15 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 		return 0;
 	}
 
-	p2p = init_p2p();
+#ifndef TEST_LIBFUZZER
+	/* Benchmark mode: P2P_BENCH=<count> adds count peers based on the
+	 * input Probe Response */
+	env = getenv("P2P_BENCH");
+	if (env && atoi(env) > 0)
+		bench = atoi(env);
+#endif /* TEST_LIBFUZZER */
+
+	p2p = init_p2p(bench ? P2P_BENCH_MAX_PEERS : 100);
 	if (!p2p) {
 		wpa_printf(MSG_ERROR, "P2P init failed");
 		return 0;
@@ -163,6 +268,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 	ctx.p2p = p2p;
 	ctx.data = data;
 	ctx.data_len = size;
+	ctx.bench_peers = bench;
 
 	eloop_register_timeout(0, 0, test_send, &ctx, NULL);
 
@@ -13,7 +13,8 @@ import subprocess
 
 from remotehost import remote_compatible
 import hostapd
-from utils import alloc_fail, fail_test
+import hwsim_utils
+from utils import alloc_fail, fail_test, check_sae_capab
 
 @remote_compatible
 def test_ap_config_errors(dev, apdev):
@@ -271,6 +272,133 @@ def test_ap_config_reload_before_enable(dev, apdev, params):
     os.kill(pid, signal.SIGHUP)
     hapd.ping()
 
+def get_reload_status(hapd):
+    res = {}
+    for line in hapd.request("RELOAD_STATUS").splitlines():
+        [name, value] = line.split('=', 1)
+        res[name] = value
+    return res
+
+def test_ap_config_reload_live(dev, apdev, params):
+    """hostapd configuration reload without disconnecting stations"""
+    check_sae_capab(dev[2])
+    conffile = params['prefix'] + ".hostapd.conf"
+    denyfile = params['prefix'] + ".hostapd.deny"
+    ifname = apdev[0]['ifname']
+
+    def write_conf(ssid, extra=[]):
+        with open(conffile, "w") as f:
+            f.write("driver=nl80211\n")
+            f.write("ctrl_interface=/var/run/hostapd\n")
+            f.write("hw_mode=g\n")
+            f.write("channel=1\n")
+            f.write("interface=" + ifname + "\n")
+            f.write("ssid=" + ssid + "\n")
+            f.write("wpa=2\n")
+            f.write("wpa_key_mgmt=WPA-PSK SAE\n")
+            f.write("rsn_pairwise=CCMP\n")
+            f.write("ieee80211w=1\n")
+            f.write("sae_pwe=2\n")
+            f.write("wpa_passphrase=12345678\n")
+            for line in extra:
+                f.write(line + "\n")
+
+    with open(denyfile, "w") as f:
+        f.write(dev[1].own_addr() + "\n")
+    write_conf("reload-live")
+    hapd = hostapd.add_bss(apdev[0], ifname, conffile)
+    with open(os.path.join(params['logdir'], 'hostapd-test.pid'), "r") as f:
+        pid = int(f.read())
+
+    try:
+        dev[2].set("sae_pwe", "1")
+        run_ap_config_reload_live(dev, hapd, pid, write_conf, denyfile)
+    finally:
+        dev[2].set("sae_pwe", "0")
+
+def run_ap_config_reload_live(dev, hapd, pid, write_conf, denyfile):
+    dev[0].connect("reload-live", psk="12345678", key_mgmt="WPA-PSK",
+                   scan_freq="2412")
+    dev[1].connect("reload-live", psk="12345678", key_mgmt="WPA-PSK",
+                   scan_freq="2412")
+    dev[2].connect("reload-live", psk="12345678", key_mgmt="SAE",
+                   ieee80211w="2", scan_freq="2412")
+
+    # ACL, station limit, and vendor element changes are applied live
+    extra = ["deny_mac_file=" + denyfile,
+             "max_listen_interval=100",
+             "vendor_elements=dd0411223301"]
+    write_conf("reload-live", extra)
+    os.kill(pid, signal.SIGHUP)
+    dev[1].wait_disconnected()
+    dev[1].request("REMOVE_NETWORK all")
+    for i in [0, 2]:
+        ev = dev[i].wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=1)
+        if ev is not None:
+            raise Exception("Station disconnected on live reload")
+        hwsim_utils.test_connectivity(dev[i], hapd)
+    status = get_reload_status(hapd)
+    logger.info("RELOAD_STATUS: " + str(status))
+    if status['mode'] != "LIVE" or status['restart'] != "":
+        raise Exception("Reload not applied live")
+    applied = status['applied'].split(' ')
+    for name in ["deny_mac_file", "max_listen_interval", "vendor_elements"]:
+        if name not in applied:
+            raise Exception("Parameter %s not reported as applied" % name)
+    if status['disconnected'] != "1":
+        raise Exception("Unexpected number of disconnected stations")
+
+    # Reload with no changes
+    os.kill(pid, signal.SIGHUP)
+    ev = dev[0].wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=1)
+    if ev is not None:
+        raise Exception("Station disconnected on unchanged reload")
+    status = get_reload_status(hapd)
+    if status['mode'] != "UNCHANGED" or status['reloads'] != "2":
+        raise Exception("Unexpected reload status: " + str(status))
+
+    # A new SAE password disconnects only the SAE station
+    extra.append("sae_password=another password")
+    write_conf("reload-live", extra)
+    os.kill(pid, signal.SIGHUP)
+    dev[2].wait_disconnected()
+    dev[2].request("REMOVE_NETWORK all")
+    ev = dev[0].wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=0.1)
+    if ev is not None:
+        raise Exception("PSK station disconnected on SAE password change")
+    status = get_reload_status(hapd)
+    if status['mode'] != "LIVE" or status['disconnected'] != "1" or \
+       "sae_password" not in status['applied'].split(' '):
+        raise Exception("Unexpected reload status: " + str(status))
+    dev[2].connect("reload-live", sae_password="another password",
+                   key_mgmt="SAE", ieee80211w="2", scan_freq="2412")
+    hwsim_utils.test_connectivity(dev[2], hapd)
+
+    # A parameter set back to the value from the file is not a change
+    for val in ["reload-live-2", "reload-live-3", "reload-live"]:
+        if "OK" not in hapd.request("SET ssid " + val):
+            raise Exception("SET ssid failed")
+    os.kill(pid, signal.SIGHUP)
+    ev = dev[0].wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=1)
+    if ev is not None:
+        raise Exception("Station disconnected on unchanged reload")
+    status = get_reload_status(hapd)
+    if status['mode'] != "UNCHANGED":
+        raise Exception("Unexpected reload status: " + str(status))
+
+    # Runtime changes through the control interface are reverted
+    if "OK" not in hapd.request("SET ssid reload-live-2"):
+        raise Exception("SET ssid failed")
+    os.kill(pid, signal.SIGHUP)
+    dev[0].wait_disconnected()
+    status = get_reload_status(hapd)
+    if status['mode'] != "RESTART" or status['restart'] != "ssid":
+        raise Exception("Unexpected reload status: " + str(status))
+    dev[0].wait_connected()
+    for i in [0, 2]:
+        dev[i].request("REMOVE_NETWORK all")
+        dev[i].wait_disconnected()
+
 def test_ap_config_sigusr1(dev, apdev, params):
     """hostapd SIGUSR1"""
     hapd = hostapd.add_ap(apdev[0], {"ssid": "foobar"})
@@ -5671,6 +5671,77 @@ def _test_ap_wpa2_eap_in_bridge(dev, apdev):
     wpas.wait_connected()
     wpas.dump_monitor()
 
+def test_ap_wpa2_eap_in_bridge_burst(dev, apdev):
+    """WPA2-EAP and wpas interface in a bridge receiving a burst of frames"""
+    br_ifname = 'sta-br0'
+    ifname = 'wlan5'
+    try:
+        _test_ap_wpa2_eap_in_bridge_burst(dev, apdev)
+    finally:
+        subprocess.call(['ip', 'link', 'set', 'dev', br_ifname, 'down'])
+        subprocess.call(['brctl', 'delif', br_ifname, ifname])
+        subprocess.call(['brctl', 'delbr', br_ifname])
+        subprocess.call(['iw', ifname, 'set', '4addr', 'off'])
+
+def _test_ap_wpa2_eap_in_bridge_burst(dev, apdev):
+    params = hostapd.wpa2_eap_params(ssid="test-wpa2-eap")
+    hapd = hostapd.add_ap(apdev[0], params)
+
+    br_ifname = 'sta-br0'
+    ifname = 'wlan5'
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+    subprocess.call(['brctl', 'addbr', br_ifname])
+    subprocess.call(['brctl', 'setfd', br_ifname, '0'])
+    subprocess.call(['ip', 'link', 'set', 'dev', br_ifname, 'up'])
+    subprocess.call(['iw', ifname, 'set', '4addr', 'on'])
+    subprocess.check_call(['brctl', 'addif', br_ifname, ifname])
+    wpas.interface_add(ifname, br_ifname=br_ifname)
+    wpas.dump_monitor()
+
+    eap_connect(wpas, hapd, "PAX", "pax.user@example.com",
+                password_hex="0123456789abcdef0123456789abcdef")
+    wpas.dump_monitor()
+    addr = wpas.own_addr()
+
+    pid = 0
+    err, data = wpas.cmd_execute(['ps', 'ax'])
+    for l in data.splitlines():
+        if "wpa_supplicant" in l and "/tmp/wpas-wlan5" in l:
+            pid = int(l.strip().split(' ')[0])
+    if pid == 0:
+        raise HwsimSkip("Could not find wpa_supplicant process")
+
+    mib = wpas.get_mib()
+    prev = int(mib['dot1xSuppEapolFramesRx'])
+
+    # Queue a burst of distinct EAPOL frames on both the main packet socket
+    # and the bridge workaround socket before wpa_supplicant gets to read
+    # either of them. Each frame needs to be delivered exactly once.
+    count = 6
+    try:
+        os.kill(pid, signal.SIGSTOP)
+        for i in range(count):
+            # Unexpected WEP EAPOL-Key with a distinct replay counter; these
+            # are counted and then dropped
+            frame = "0203002c010000%016x" % i + 33 * "00"
+            if "OK" not in hapd.request("EAPOL_TX " + addr + " " + frame):
+                raise Exception("EAPOL_TX failed")
+        time.sleep(0.2)
+    finally:
+        os.kill(pid, signal.SIGCONT)
+
+    for i in range(20):
+        mib = wpas.get_mib()
+        rx = int(mib['dot1xSuppEapolFramesRx']) - prev
+        if rx >= count:
+            break
+        time.sleep(0.1)
+    time.sleep(0.2)
+    mib = wpas.get_mib()
+    rx = int(mib['dot1xSuppEapolFramesRx']) - prev
+    if rx != count:
+        raise Exception("Unexpected number of EAPOL frames delivered: %d (expected %d)" % (rx, count))
+
 def test_ap_wpa2_eap_session_ticket(dev, apdev):
     """WPA2-Enterprise connection using EAP-TTLS and TLS session ticket enabled"""
     params = hostapd.wpa2_eap_params(ssid="test-wpa2-eap")
@@ -5752,6 +5823,25 @@ def test_ap_wpa2_eap_tls_check_crl_not_strict(dev, apdev):
                 private_key="auth_serv/user.key")
     dev[0].request("REMOVE_NETWORK all")
 
+def tls_stats(hapd):
+    res = hapd.request("MIB tls")
+    if "FAIL" in res:
+        return None
+    return dict(l.split('=') for l in res.splitlines())
+
+def wait_tls_crl_reload(hapd):
+    stats = tls_stats(hapd)
+    if stats is None:
+        # No TLS statistics available; wait for one reload interval
+        time.sleep(1)
+        return
+    prev = int(stats['tls_crl_reloads'])
+    for i in range(50):
+        time.sleep(0.1)
+        if int(tls_stats(hapd)['tls_crl_reloads']) > prev:
+            return
+    raise Exception("CRL not reloaded")
+
 def test_ap_wpa2_eap_tls_crl_reload(dev, apdev, params):
     """EAP-TLS and server reloading CRL from ca_cert"""
     ca_cert = os.path.join(params['logdir'],
@@ -5777,7 +5867,7 @@ def test_ap_wpa2_eap_tls_crl_reload(dev, apdev, params):
 
     with open(ca_cert, 'w') as f:
         f.write(cert_and_crl)
-    time.sleep(1)
+    wait_tls_crl_reload(hapd)
 
     # check_crl=1 and valid CRL --> accept
     eap_connect(dev[0], hapd, "TLS", "tls user", ca_cert="auth_serv/ca.pem",
@@ -5786,6 +5876,20 @@ def test_ap_wpa2_eap_tls_crl_reload(dev, apdev, params):
     dev[0].request("REMOVE_NETWORK all")
     dev[0].wait_disconnected()
 
+    tls = hapd.request("GET tls_library")
+    res = hapd.request("MIB tls")
+    if not tls.startswith("OpenSSL"):
+        if "FAIL" not in res:
+            raise Exception("Unexpected MIB tls response: " + res)
+        return
+    if "FAIL" in res:
+        raise Exception("MIB tls failed")
+    stats = dict(l.split('=') for l in res.splitlines())
+    if int(stats['tls_crl_reloads']) < 1:
+        raise Exception("CRL reload not reported: " + res)
+    if int(stats['tls_handshakes']) < 1:
+        raise Exception("TLS handshake not reported: " + res)
+
 def test_ap_wpa2_eap_tls_check_cert_subject(dev, apdev):
     """EAP-TLS and server checking client subject name"""
     params = int_eap_server_params()
@@ -6400,6 +6504,32 @@ def test_eap_tls_session_resumption(dev, apdev):
     if dev[0].get_status_field("tls_session_reused") != '1':
         raise Exception("Session resumption not used on the third connection")
 
+def test_eap_tls_session_resumption_cache_file(dev, apdev, params):
+    """EAP-TLS session resumption across hostapd restart"""
+    cache = os.path.join(params['logdir'], 'tls_sessions')
+    ap_params = int_eap_server_params()
+    ap_params['tls_session_lifetime'] = '60'
+    ap_params['tls_session_cache_file'] = cache
+    hapd = hostapd.add_ap(apdev[0], ap_params)
+    check_tls_session_resumption_capa(dev[0], hapd)
+    eap_connect(dev[0], hapd, "TLS", "tls user", ca_cert="auth_serv/ca.pem",
+                client_cert="auth_serv/user.pem",
+                private_key="auth_serv/user.key")
+    if dev[0].get_status_field("tls_session_reused") != '0':
+        raise Exception("Unexpected session resumption on the first connection")
+
+    dev[0].request("DISCONNECT")
+    dev[0].wait_disconnected()
+    hapd.disable()
+    if not os.path.exists(cache):
+        raise Exception("TLS session cache file not written")
+    hapd.enable()
+
+    dev[0].request("RECONNECT")
+    dev[0].wait_connected(timeout=10)
+    if dev[0].get_status_field("tls_session_reused") != '1':
+        raise Exception("Session resumption not used after hostapd restart")
+
 def test_eap_tls_session_resumption_expiration(dev, apdev):
     """EAP-TLS session resumption"""
     params = int_eap_server_params()
@@ -327,6 +327,110 @@ def test_ap_anqp_sharing_oom(dev, apdev):
         if ev is None:
             raise Exception("ANQP operation timed out")
 
+def get_anqp_stats(dev):
+    return dict(x.split('=') for x in dev.request("ANQP_STATS").splitlines())
+
+def test_ap_anqp_parallel_fetch_cache(dev, apdev):
+    """Parallel ANQP fetch with ANQP Domain ID sharing and ANQP cache"""
+    dev[0].flush_scan_cache()
+
+    bssid = apdev[0]['bssid']
+    params = hs20_ap_params()
+    params['hessid'] = bssid
+    params['anqp_domain_id'] = '1234'
+    hostapd.add_ap(apdev[0], params)
+
+    bssid2 = apdev[1]['bssid']
+    params = hs20_ap_params()
+    params['hessid'] = bssid
+    params['anqp_domain_id'] = '1234'
+    hostapd.add_ap(apdev[1], params)
+
+    bssid3 = apdev[2]['bssid']
+    params = hs20_ap_params(ssid="test-hs20-another")
+    params['hessid'] = bssid3
+    params['nai_realm'] = ["0,example.org,13[5:6],21[2:4][5:7]"]
+    hostapd.add_ap(apdev[2], params)
+
+    dev[0].hs20_enable()
+    try:
+        dev[0].set("anqp_cache_ttl", "60")
+        for b in [bssid, bssid2, bssid3]:
+            dev[0].scan_for_bss(b, freq="2412")
+        dev[0].request("FETCH_ANQP")
+        ev = dev[0].wait_event(["ANQP fetch completed"], timeout=30)
+        if ev is None:
+            raise Exception("ANQP fetch timed out")
+        stats = get_anqp_stats(dev[0])
+        logger.info("ANQP stats: " + str(stats))
+        if stats['queries'] != "2" or stats['shared'] != "1":
+            raise Exception("Unexpected ANQP query count: " + str(stats))
+        if stats['max_pending'] != "2":
+            raise Exception("ANQP queries were not parallel: " + str(stats))
+        if int(stats['last_fetch_usec']) == 0:
+            raise Exception("No ANQP fetch time recorded")
+        res1 = dev[0].get_bss(bssid)
+        res2 = dev[0].get_bss(bssid2)
+        res3 = dev[0].get_bss(bssid3)
+        if res1['anqp_nai_realm'] != res2['anqp_nai_realm']:
+            raise Exception("ANQP results were not shared between BSSes")
+        if res1['anqp_nai_realm'] == res3['anqp_nai_realm']:
+            raise Exception("ANQP results were shared between ESSs")
+
+        dev[0].dump_monitor()
+        dev[0].request("FETCH_ANQP")
+        ev = dev[0].wait_event(["ANQP fetch completed", "RX-ANQP"],
+                               timeout=10)
+        if ev is None:
+            raise Exception("ANQP fetch timed out")
+        if "RX-ANQP" in ev:
+            raise Exception("ANQP query sent for cached data")
+        stats = get_anqp_stats(dev[0])
+        if stats['queries'] != "2" or stats['cache_hits'] != "3":
+            raise Exception("ANQP cache not used: " + str(stats))
+        if dev[0].get_bss(bssid3)['anqp_nai_realm'] != res3['anqp_nai_realm']:
+            raise Exception("ANQP data lost with cache")
+    finally:
+        dev[0].set("anqp_cache_ttl", "0")
+        dev[0].request("FLUSH")
+
+def test_ap_anqp_parallel_fetch_restart(dev, apdev):
+    """Parallel ANQP fetch restarted while queries are in progress"""
+    dev[0].flush_scan_cache()
+
+    bssid = apdev[0]['bssid']
+    params = hs20_ap_params()
+    params['hessid'] = bssid
+    hostapd.add_ap(apdev[0], params)
+
+    bssid2 = apdev[1]['bssid']
+    params = hs20_ap_params(ssid="test-hs20-another")
+    params['hessid'] = bssid2
+    hostapd.add_ap(apdev[1], params)
+
+    dev[0].hs20_enable()
+    try:
+        for b in [bssid, bssid2]:
+            dev[0].scan_for_bss(b, freq="2412")
+        dev[0].request("FETCH_ANQP")
+        dev[0].request("STOP_FETCH_ANQP")
+        dev[0].request("FETCH_ANQP")
+        ev = dev[0].wait_event(["ANQP fetch completed"], timeout=30)
+        if ev is None:
+            raise Exception("ANQP fetch timed out")
+        stats = get_anqp_stats(dev[0])
+        logger.info("ANQP stats: " + str(stats))
+        if stats['pending'] != "0":
+            raise Exception("ANQP queries left pending: " + str(stats))
+        if stats['queries'] != "2":
+            raise Exception("In-progress ANQP queries were repeated: " +
+                            str(stats))
+        for b in [bssid, bssid2]:
+            if 'anqp_nai_realm' not in dev[0].get_bss(b):
+                raise Exception("ANQP data missing for " + b)
+    finally:
+        dev[0].request("FLUSH")
+
 def test_ap_nai_home_realm_query(dev, apdev):
     """NAI Home Realm Query"""
     check_eap_capa(dev[0], "MSCHAPV2")
@@ -4335,13 +4439,26 @@ def test_ap_hs20_proxyarp(dev, apdev):
         subprocess.call(['brctl', 'delbr', 'ap-br0'],
                         stderr=open('/dev/null', 'w'))
 
-def _test_ap_hs20_proxyarp_dgaf(dev, apdev, disabled):
+def wait_mcast_to_ucast_converted(hapd, prev, count):
+    for i in range(10):
+        time.sleep(0.1)
+        val = int(hapd.get_status_field("mcast_to_ucast_converted"))
+        if val - prev >= count and count > 0:
+            break
+    logger.info("mcast_to_ucast_converted: %d -> %d" % (prev, val))
+    if val - prev != count:
+        raise Exception("Unexpected number of converted frames: %d (expected %d)" % (val - prev, count))
+    return val
+
+def _test_ap_hs20_proxyarp_dgaf(dev, apdev, disabled, targeted=False):
     bssid = apdev[0]['bssid']
     params = hs20_ap_params()
     params['hessid'] = bssid
     params['disable_dgaf'] = '1' if disabled else '0'
     params['proxy_arp'] = '1'
     params['na_mcast_to_ucast'] = '1'
+    if targeted:
+        params['ndisc_mcast_targeted'] = '1'
     params['ap_isolate'] = '1'
     params['bridge'] = 'ap-br0'
     hapd = hostapd.add_ap(apdev[0], params, no_enable=True)
@@ -4383,15 +4500,43 @@ def _test_ap_hs20_proxyarp_dgaf(dev, apdev, disabled):
     if "OK" not in dev[0].request("DATA_TEST_FRAME " + binascii.hexlify(pkt).decode()):
         raise Exception("DATA_TEST_FRAME failed")
 
+    converted = int(hapd.get_status_field("mcast_to_ucast_converted"))
     pkt = build_ra(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::33",
                    ip_dst="ff01::1")
     if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
         raise Exception("DATA_TEST_FRAME failed")
+    # RA is converted for both STAs only when DGAF is disabled
+    converted = wait_mcast_to_ucast_converted(hapd, converted,
+                                              2 if disabled else 0)
 
     pkt = build_na(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::44",
                    ip_dst="ff01::1", target="aaaa:bbbb:cccc::55")
     if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
         raise Exception("DATA_TEST_FRAME failed")
+    # NA is converted for both STAs with na_mcast_to_ucast=1
+    converted = wait_mcast_to_ucast_converted(hapd, converted, 2)
+
+    if targeted:
+        suppressed = int(hapd.get_status_field("mcast_to_ucast_suppressed"))
+        pkt = build_na(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::44",
+                       ip_dst="ff02::1:ff00:2", target="aaaa:bbbb:cccc::55")
+        if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
+            raise Exception("DATA_TEST_FRAME failed")
+        # Only dev[0] owns a snooped address in the solicited-node group
+        converted = wait_mcast_to_ucast_converted(hapd, converted, 1)
+        val = int(hapd.get_status_field("mcast_to_ucast_suppressed"))
+        if val != suppressed + 1:
+            raise Exception("Unexpected mcast_to_ucast_suppressed: %d (expected %d)" % (val, suppressed + 1))
+
+        pkt = build_na(src_ll=apdev[0]['bssid'], ip_src="aaaa:bbbb:cccc::44",
+                       ip_dst="ff02::1:ff00:99", target="aaaa:bbbb:cccc::55")
+        if "OK" not in hapd.request("DATA_TEST_FRAME ifname=ap-br0 " + binascii.hexlify(pkt).decode()):
+            raise Exception("DATA_TEST_FRAME failed")
+        # No snooped address in the group, so fall back to all STAs
+        converted = wait_mcast_to_ucast_converted(hapd, converted, 2)
+        val = int(hapd.get_status_field("mcast_to_ucast_suppressed"))
+        if val != suppressed + 1:
+            raise Exception("Unexpected mcast_to_ucast_suppressed after fallback: %d" % val)
 
     pkt = build_dhcp_ack(dst_ll="ff:ff:ff:ff:ff:ff", src_ll=bssid,
                          ip_src="192.168.1.1", ip_dst="255.255.255.255",
@@ -4443,6 +4588,17 @@ def test_ap_hs20_proxyarp_enable_dgaf(dev, apdev):
         subprocess.call(['brctl', 'delbr', 'ap-br0'],
                         stderr=open('/dev/null', 'w'))
 
+def test_ap_hs20_proxyarp_ndisc_targeted(dev, apdev):
+    """Hotspot 2.0 and ProxyARP with targeted solicited-node conversion"""
+    check_eap_capa(dev[0], "MSCHAPV2")
+    try:
+        _test_ap_hs20_proxyarp_dgaf(dev, apdev, True, targeted=True)
+    finally:
+        subprocess.call(['ip', 'link', 'set', 'dev', 'ap-br0', 'down'],
+                        stderr=open('/dev/null', 'w'))
+        subprocess.call(['brctl', 'delbr', 'ap-br0'],
+                        stderr=open('/dev/null', 'w'))
+
 def ip_checksum(buf):
     sum = 0
     if len(buf) & 0x01:
@@ -5214,6 +5370,12 @@ def _test_proxyarp_open_ipv6(dev, apdev, params, ebtables=False):
     hwsim_utils.test_connectivity_iface(dev[1], hapd, "ap-br0")
     hwsim_utils.test_connectivity(dev[0], dev[1])
 
+    # na_mcast_to_ucast is not enabled, so the unsolicited NAs above must not
+    # have been converted to unicast
+    val = hapd.get_status_field("mcast_to_ucast_converted")
+    if val != "0":
+        raise Exception("Unexpected mcast_to_ucast_converted=%s" % val)
+
     dev[0].request("DISCONNECT")
     dev[1].request("DISCONNECT")
     time.sleep(0.5)
@@ -771,6 +771,29 @@ def test_ap_open_drv_fail(dev, apdev):
         wait_fail_trigger(dev[0], "GET_FAIL")
         dev[0].request("REMOVE_NETWORK all")
 
+def test_ap_open_sta_batch_fail(dev, apdev):
+    """AP with open mode and batched STA configuration failing"""
+    hapd = hostapd.add_ap(apdev[0], {"ssid": "open"})
+
+    # A failure of the batched STA flag update is only logged, like it was
+    # for the individual commands, and the STA remains associated
+    for func in ["nl80211_batch_send", "batch_ack_handler"]:
+        with fail_test(hapd, 1, func):
+            dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+            hapd.wait_sta()
+        ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=1)
+        if ev is not None:
+            raise Exception("STA disconnected on batch failure (%s)" % func)
+        if hapd.get_sta(dev[0].own_addr())['flags'].find('[ASSOC]') < 0:
+            raise Exception("STA not associated after batch failure")
+        dev[0].request("REMOVE_NETWORK all")
+        dev[0].wait_disconnected()
+        hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+
+    dev[0].connect("open", key_mgmt="NONE", scan_freq="2412")
+    hapd.wait_sta()
+    hwsim_utils.test_connectivity(dev[0], hapd)
+
 def run_multicast_to_unicast(dev, apdev, convert):
     params = {"ssid": "open"}
     params["multicast_to_unicast"] = "1" if convert else "0"
@@ -260,6 +260,72 @@ def test_ap_acl_mgmt(dev, apdev):
     if filename.startswith('/tmp/'):
         os.unlink(filename)
 
+def test_ap_acl_mgmt_batch(dev, apdev):
+    """MAC ACL batched accept/deny list updates"""
+    ssid = "acl"
+    params = {}
+    params['ssid'] = ssid
+    params['macaddr_acl'] = "1"
+    hapd = hostapd.add_ap(apdev[0], params)
+
+    addrs = ["02:00:00:01:%02x:%02x" % (i // 256, i % 256)
+             for i in range(100)]
+    res = hapd.request("ACCEPT_ACL ADD_MACS " + dev[0].own_addr() + "/3 " +
+                       " ".join(addrs))
+    if "FAIL" in res or int(res) != 101:
+        raise Exception("ADD_MACS failed: " + res)
+    accept = hapd.request("ACCEPT_ACL SHOW").splitlines()
+    if len(accept) != 101:
+        raise Exception("Unexpected number of accept entries")
+    if dev[0].own_addr() + " VLAN_ID=3" not in accept:
+        raise Exception("Missing accept entry with VLAN ID")
+
+    if "FAIL" not in hapd.request("ACCEPT_ACL DEL_MACS " + addrs[0] +
+                                  " 02:00:00:02:00"):
+        raise Exception("DEL_MACS with invalid MAC address accepted")
+    if "FAIL" not in hapd.request("ACCEPT_ACL ADD_MACS " + addrs[0] + "/x"):
+        raise Exception("ADD_MACS with invalid VLAN ID accepted")
+    accept = hapd.request("ACCEPT_ACL SHOW").splitlines()
+    if len(accept) != 101:
+        raise Exception("Invalid batch modified the list")
+
+    new_addrs = ["02:00:00:03:00:%02x" % i for i in range(10)]
+    with alloc_fail(hapd, 3, "mac_acl_add;hostapd_ctrl_iface_acl_update"):
+        if "FAIL" not in hapd.request("ACCEPT_ACL ADD_MACS " +
+                                      " ".join(new_addrs)):
+            raise Exception("ADD_MACS accepted with allocation failure")
+    accept = hapd.request("ACCEPT_ACL SHOW").splitlines()
+    if len(accept) != 101:
+        raise Exception("Failed batch modified the list")
+
+    res = hapd.request("ACCEPT_ACL DEL_MACS " + " ".join(addrs[0:50]))
+    if "FAIL" in res or int(res) != 50:
+        raise Exception("DEL_MACS failed: " + res)
+    accept = hapd.request("ACCEPT_ACL SHOW").splitlines()
+    if len(accept) != 51:
+        raise Exception("Unexpected number of accept entries (2)")
+
+    hapd.request("ACCEPT_ACL ADD_MACS " + dev[0].own_addr())
+    dev[0].scan_for_bss(apdev[0]['bssid'], freq="2412")
+    dev[0].connect(ssid, key_mgmt="NONE", scan_freq="2412")
+    dev[0].dump_monitor()
+    hapd.request("ACCEPT_ACL DEL_MACS " + " ".join(addrs[50:]) + " " +
+                 dev[0].own_addr())
+    dev[0].wait_disconnected()
+    dev[0].request("DISCONNECT")
+    if len(hapd.request("ACCEPT_ACL SHOW").splitlines()) != 0:
+        raise Exception("Unexpected accept entries left")
+
+    hapd.request("SET macaddr_acl 0")
+    res = hapd.request("DENY_ACL ADD_MACS " + " ".join(addrs[0:10]))
+    if "FAIL" in res or int(res) != 10:
+        raise Exception("DENY_ACL ADD_MACS failed: " + res)
+    res = hapd.request("DENY_ACL DEL_MACS " + " ".join(addrs[0:10]))
+    if "FAIL" in res or int(res) != 10:
+        raise Exception("DENY_ACL DEL_MACS failed: " + res)
+    if len(hapd.request("DENY_ACL SHOW").splitlines()) != 0:
+        raise Exception("Unexpected deny entries left")
+
 def test_ap_acl_accept_changes(dev, apdev):
     """MAC ACL accept list changes"""
     ssid = "acl"
@@ -971,3 +1037,87 @@ def test_ap_airtime_policy_per_bss_limit_invalid(dev, apdev):
     dev[0].connect(ssid, psk=passphrase, scan_freq="2412")
     dev[1].connect(ssid, psk=passphrase, scan_freq="2412")
     time.sleep(1)
+
+def read_stats_shm(fname):
+    prg = '../../hostapd/stats_shm_reader'
+    if not os.path.exists(prg):
+        raise HwsimSkip("No stats_shm_reader available")
+    res = subprocess.check_output([prg, fname]).decode()
+    vals = {}
+    stas = []
+    for line in res.splitlines():
+        if line.startswith("sta="):
+            stas.append(dict(p.split('=', 1) for p in line.split(' ')))
+        elif '=' in line:
+            name, val = line.split('=', 1)
+            vals[name] = val
+    return vals, stas
+
+def test_ap_stats_shm(dev, apdev, params):
+    """Shared memory statistics export"""
+    fname = params['prefix'] + '.stats_shm'
+    sta_prefix = params['prefix'] + '.stats_shm_sta'
+    sta_fname = sta_prefix + '-' + dev[0].ifname
+    ssid = "test-wpa2-psk"
+    passphrase = 'qwertyuiop'
+    apparams = hostapd.wpa2_params(ssid=ssid, passphrase=passphrase)
+    apparams['stats_shm'] = fname
+    apparams['stats_shm_interval'] = "100"
+    try:
+        hapd = hostapd.add_ap(apdev[0], apparams)
+    except Exception as e:
+        if "Failed to enable hostapd interface" in str(e):
+            raise HwsimSkip("stats_shm not supported in the build")
+        raise
+    if "OK" not in dev[0].request("SET stats_shm " + sta_prefix):
+        raise HwsimSkip("stats_shm not supported in the build")
+    try:
+        dev[0].connect(ssid, psk=passphrase, scan_freq="2412")
+        hapd.wait_sta()
+        hwsim_utils.test_connectivity(dev[0], hapd)
+        time.sleep(0.3)
+
+        vals, stas = read_stats_shm(fname)
+        if vals['type'] != "ap" or vals['ssid'] != ssid:
+            raise Exception("Unexpected AP statistics: " + str(vals))
+        if vals['bssid'] != hapd.own_addr() or vals['freq'] != "2412":
+            raise Exception("Unexpected AP statistics: " + str(vals))
+        if vals['num_sta'] != "1" or vals['num_sta_authorized'] != "1":
+            raise Exception("Unexpected station count: " + str(vals))
+        if len(stas) != 1 or stas[0]['sta'] != dev[0].own_addr():
+            raise Exception("Unexpected station records: " + str(stas))
+        if 'rx_packets' not in stas[0] or int(stas[0]['rx_packets']) == 0:
+            raise Exception("No driver counters for the station")
+        if 'drv_data_age_ms' not in vals or \
+           int(vals['drv_data_age_ms']) > 100:
+            raise Exception("Unexpected driver data age: " + str(vals))
+
+        vals, stas = read_stats_shm(sta_fname)
+        if vals['type'] != "sta" or vals['ssid'] != ssid:
+            raise Exception("Unexpected station statistics: " + str(vals))
+        if vals['bssid'] != hapd.own_addr() or vals['freq'] != "2412":
+            raise Exception("Unexpected station statistics: " + str(vals))
+        if int(vals['signal']) == 0 or int(vals['rx_packets']) == 0:
+            raise Exception("No driver counters for the interface")
+
+        count = int(vals['update_count'])
+        time.sleep(0.3)
+        vals, stas = read_stats_shm(sta_fname)
+        if int(vals['update_count']) <= count:
+            raise Exception("Statistics not updated")
+
+        dev[0].request("DISCONNECT")
+        dev[0].wait_disconnected()
+        hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+        time.sleep(0.3)
+        vals, stas = read_stats_shm(fname)
+        if vals['num_sta'] != "0" or len(stas) != 0:
+            raise Exception("Station not removed: " + str(vals))
+    finally:
+        dev[0].request("SET stats_shm ")
+
+    if os.path.exists(sta_fname):
+        raise Exception("Station statistics file not removed")
+    hapd.disable()
+    if os.path.exists(fname):
+        raise Exception("AP statistics file not removed")
@@ -5795,6 +5795,69 @@ def run_dpp_controller_rx_errors(dev, apdev):
             pass
         sock.close()
 
+def test_dpp_controller_many_connections(dev, apdev):
+    """DPP Controller with many concurrent TCP connections"""
+    check_dpp_capab(dev[0], min_ver=2)
+    check_dpp_capab(dev[1])
+    try:
+        run_dpp_controller_many_connections(dev, apdev)
+    finally:
+        dev[0].request("DPP_CONTROLLER_STOP")
+
+def run_dpp_controller_many_connections(dev, apdev):
+    # Peer bootstrapping information for a number of Enrollees
+    uris = []
+    for i in range(50):
+        id = dev[1].dpp_bootstrap_gen(chan="81/1")
+        uris.append(dev[1].request("DPP_BOOTSTRAP_GET_URI %d" % id))
+        dev[1].request("DPP_BOOTSTRAP_REMOVE %d" % id)
+    for uri in uris:
+        dev[0].dpp_qr_code(uri)
+    der = base64.b64decode(uris[-1].split(';K:')[1].split(';')[0])
+    chirp_hash = hashlib.sha256(b"chirp" + der).digest()
+
+    if "OK" not in dev[0].request("DPP_CONTROLLER_START tcp_backlog=256"):
+        raise Exception("Could not start Controller")
+
+    addr = ("127.0.0.1", 8908)
+    num_conn = 200
+    socks = []
+    for i in range(num_conn):
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM,
+                             socket.IPPROTO_TCP)
+        sock.settimeout(5)
+        sock.connect(addr)
+        socks.append(sock)
+
+    # Presence Announcement with an unknown hash on all but the last
+    # connection and with a known hash on the last one. Send the messages
+    # in fragments interleaved between the connections.
+    msgs = []
+    for i in range(num_conn):
+        if i == num_conn - 1:
+            hash = chirp_hash
+        else:
+            hash = struct.pack('>L', i) + 28*b'\xff'
+        frame = b'\x09\x50\x6f\x9a\x1a\x01\x0d'
+        frame += struct.pack('<HH', 0x1002, len(hash)) + hash
+        msgs.append(struct.pack('>L', len(frame)) + frame)
+    for start, end in [(0, 2), (2, 6), (6, 20), (20, None)]:
+        for i in range(num_conn):
+            socks[i].send(msgs[i][start:end])
+
+    res = socks[-1].recv(1000)
+    if len(res) < 5:
+        raise Exception("No Authentication Request received")
+    logger.info("Response: " + binascii.hexlify(res).decode())
+    # Length, Public Action, DPP OUI/type, crypto suite, Authentication Request
+    if res[4:11] != b'\x09\x50\x6f\x9a\x1a\x01\x00':
+        raise Exception("Unexpected response to Presence Announcement")
+    for sock in socks:
+        sock.close()
+
+    if "PONG" not in dev[0].request("PING"):
+        raise Exception("No response from the Controller")
+
 def test_dpp_conn_status_success(dev, apdev):
     """DPP connection status - success"""
     try:
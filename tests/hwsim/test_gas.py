@@ -927,6 +927,85 @@ def test_gas_malformed_comeback_resp(dev, apdev):
         send_gas_resp(hapd, resp)
     expect_gas_result(dev[0], "PEER_ERROR")
 
+def gas_comeback_frag(hapd, dialog_token, id, more, data):
+    query = gas_rx(hapd)
+    gas = parse_gas(query['payload'])
+    if gas['action'] != GAS_COMEBACK_REQUEST:
+        raise Exception("Unexpected request action")
+    if gas['dialog_token'] != dialog_token:
+        raise Exception("Unexpected dialog token change")
+    resp = action_response(query)
+    resp['payload'] = anqp_comeback_resp(dialog_token, id=id, more=more) + \
+        struct.pack('<H', len(data)) + data
+    send_gas_resp(hapd, resp)
+
+def check_nai_realm(dev, bssid, payload):
+    bss = dev.get_bss(bssid)
+    if 'anqp_nai_realm' not in bss:
+        raise Exception("NAI Realm not reported")
+    if bss['anqp_nai_realm'] != binascii.hexlify(payload).decode():
+        raise Exception("Unexpected reassembled NAI Realm: " +
+                        bss['anqp_nai_realm'])
+
+def test_gas_comeback_resp_reassembly(dev, apdev):
+    """GAS comeback response fragment reassembly"""
+    hapd = start_ap(apdev[0])
+    bssid = apdev[0]['bssid']
+
+    dev[0].scan_for_bss(bssid, freq="2412", force_scan=True)
+    hapd.set("ext_mgmt_frame_handling", "1")
+
+    payload = bytes(range(0, 100))
+    elem = struct.pack('<HH', 263, len(payload)) + payload
+
+    logger.debug("In-order fragments")
+    query, dialog_token = init_gas(hapd, bssid, dev[0])
+    resp = action_response(query)
+    resp['payload'] = anqp_comeback_resp(dialog_token, more=True) + \
+        struct.pack('<H', 30) + elem[0:30]
+    send_gas_resp(hapd, resp)
+    gas_comeback_frag(hapd, dialog_token, 1, True, elem[30:31])
+    gas_comeback_frag(hapd, dialog_token, 2, True, b'')
+    gas_comeback_frag(hapd, dialog_token, 3, False, elem[31:])
+    expect_gas_result(dev[0], "SUCCESS")
+    check_nai_realm(dev[0], bssid, payload)
+
+    logger.debug("Out-of-order fragment")
+    query, dialog_token = init_gas(hapd, bssid, dev[0])
+    resp = action_response(query)
+    resp['payload'] = anqp_comeback_resp(dialog_token, more=True) + \
+        struct.pack('<H', 30) + elem[0:30]
+    send_gas_resp(hapd, resp)
+    gas_comeback_frag(hapd, dialog_token, 2, False, elem[30:])
+    expect_gas_result(dev[0], "PEER_ERROR")
+
+    logger.debug("Truncated fragment sequence followed by retry")
+    query, dialog_token = init_gas(hapd, bssid, dev[0])
+    resp = action_response(query)
+    resp['payload'] = anqp_comeback_resp(dialog_token, more=True) + \
+        struct.pack('<H', 30) + elem[0:30]
+    send_gas_resp(hapd, resp)
+    query = gas_rx(hapd)
+    gas = parse_gas(query['payload'])
+    if gas['action'] != GAS_COMEBACK_REQUEST:
+        raise Exception("Unexpected request action")
+    # No response to the comeback request; the query is restarted with a new
+    # dialog token and the partially received fragments must be discarded.
+    query = gas_rx(hapd)
+    gas = parse_gas(query['payload'])
+    if gas['action'] != GAS_INITIAL_REQUEST:
+        raise Exception("GAS query not retried")
+    if gas['dialog_token'] == dialog_token:
+        raise Exception("Dialog token not changed on retry")
+    payload2 = b'retry'
+    elem2 = struct.pack('<HH', 263, len(payload2)) + payload2
+    resp = action_response(query)
+    resp['payload'] = anqp_initial_resp(gas['dialog_token'], 0) + \
+        struct.pack('<H', len(elem2)) + elem2
+    send_gas_resp(hapd, resp)
+    expect_gas_result(dev[0], "SUCCESS")
+    check_nai_realm(dev[0], bssid, payload2)
+
 def test_gas_comeback_resp_additional_delay(dev, apdev):
     """GAS comeback response requesting additional delay"""
     hapd = start_ap(apdev[0])
@@ -10,6 +10,7 @@ import os
 from remotehost import remote_compatible
 import hostapd
 import hwsim_utils
+import wpaspy
 from utils import *
 
 @remote_compatible
@@ -125,6 +126,143 @@ def run_hapd_ctrl_sta(dev, apdev):
     if sta['max_txpower'] != '2':
         raise Exception("Unxpected max_txpower value: " + sta['max_txpower'])
 
+@remote_compatible
+def test_hapd_ctrl_sta_dump(dev, apdev):
+    """hostapd STA-DUMP ctrl_iface command"""
+    ssid = "hapd-ctrl-sta-dump"
+    passphrase = "12345678"
+    params = hostapd.wpa2_params(ssid=ssid, passphrase=passphrase)
+    hapd = hostapd.add_ap(apdev[0], params)
+
+    res = hapd.request("STA-DUMP")
+    hdr = dict(x.split('=') for x in res.splitlines()[0].split(' '))
+    if hdr['count'] != "0" or hdr['more'] != "0":
+        raise Exception("Unexpected empty STA-DUMP: " + res)
+    gen0 = hdr['gen']
+
+    dev[0].connect(ssid, psk=passphrase, scan_freq="2412")
+    dev[1].connect(ssid, psk=passphrase, scan_freq="2412")
+    hapd.wait_sta()
+    hapd.wait_sta()
+    addrs = [dev[0].own_addr(), dev[1].own_addr()]
+
+    res = hapd.request("STA-DUMP fields=flags,aid,packets")
+    lines = res.splitlines()
+    hdr = dict(x.split('=') for x in lines[0].split(' '))
+    if hdr['count'] != "2" or len(lines) != 3:
+        raise Exception("Unexpected STA-DUMP: " + res)
+    for l in lines[1:]:
+        sta = dict(x.split('=') for x in l.split(' '))
+        if sta['addr'] not in addrs:
+            raise Exception("Unexpected station: " + l)
+        if "[AUTHORIZED]" not in sta['flags'] or 'rx_packets' not in sta:
+            raise Exception("Missing station fields: " + l)
+
+    # Driver data from the bulk fetch must match the per-station data
+    res = hapd.request("STA-DUMP fields=packets,bytes")
+    for l in res.splitlines()[1:]:
+        dump = dict(x.split('=') for x in l.split(' '))
+        sta = hapd.get_sta(dump['addr'])
+        for field in ['rx_packets', 'tx_packets', 'rx_bytes', 'tx_bytes']:
+            if int(dump[field]) > int(sta[field]):
+                raise Exception("Unexpected %s for %s: %s > %s" %
+                                (field, dump['addr'], dump[field], sta[field]))
+
+    res = hapd.request("STA-DUMP max=1")
+    hdr = dict(x.split('=') for x in res.splitlines()[0].split(' '))
+    if hdr['more'] != "1" or 'next' not in hdr:
+        raise Exception("STA-DUMP did not indicate more stations: " + res)
+    res = hapd.request("STA-DUMP max=1 after=" + hdr['next'])
+    hdr2 = dict(x.split('=') for x in res.splitlines()[0].split(' '))
+    if hdr2['count'] != "1" or hdr2['more'] != "0" or hdr['next'] in res:
+        raise Exception("Unexpected second STA-DUMP page: " + res)
+
+    res = hapd.request("STA-DUMP format=json fields=aid")
+    if not res.startswith('{"gen":') or '"stations":[{"addr":' not in res:
+        raise Exception("Unexpected JSON STA-DUMP: " + res)
+
+    gen = hapd.request("STA-DUMP").splitlines()[0].split(' ')[0].split('=')[1]
+    dev[1].request("DISCONNECT")
+    ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+    if ev is None:
+        raise Exception("No disconnection event")
+    res = hapd.request("STA-DUMP since=" + gen)
+    if "addr=%s removed=1" % addrs[1] not in res:
+        raise Exception("Unexpected delta STA-DUMP: " + res)
+    res = hapd.request("STA-DUMP since=" + gen0)
+    if addrs[0] not in res:
+        raise Exception("Station missing from delta STA-DUMP: " + res)
+
+    # A dump continues after a station that was removed between the pages
+    res = hapd.request("STA-DUMP after=" + addrs[1])
+    hdr = dict(x.split('=') for x in res.splitlines()[0].split(' '))
+    if hdr['count'] != "1" or hdr['resync'] != "0" or addrs[0] not in res:
+        raise Exception("Unexpected STA-DUMP after removed station: " + res)
+    res = hapd.request("STA-DUMP after=00:11:22:33:44:55")
+    hdr = dict(x.split('=') for x in res.splitlines()[0].split(' '))
+    if hdr['count'] != "1" or hdr['resync'] != "1" or addrs[0] not in res:
+        raise Exception("Unexpected STA-DUMP after unknown station: " + res)
+
+    hglobal = hostapd.HostapdGlobal(apdev[0])
+    res = hglobal.request("IFNAME=%s STA-DUMP bufsize=8192" % apdev[0]['ifname'])
+    if not res.startswith("gen=") or addrs[0] not in res:
+        raise Exception("Unexpected STA-DUMP through global ctrl_iface: " + res)
+
+    for cmd in ["STA-DUMP max=0", "STA-DUMP fields=foo",
+                "STA-DUMP format=xml", "STA-DUMP format=kvX",
+                "STA-DUMP format=jsonX", "STA-DUMP xformat=json",
+                "STA-DUMP max=1x", "STA-DUMP maxcount=1",
+                "STA-DUMP since=-1", "STA-DUMP after=00:11:22:33:44",
+                "STA-DUMP after=00:11:22:33:44:55:66", "STA-DUMP foo"]:
+        if "FAIL" not in hapd.request(cmd):
+            raise Exception("Unexpected success: " + cmd)
+
+def test_hapd_ctrl_sta_mem_usage(dev, apdev):
+    """hostapd per-station memory use reporting"""
+    ssid = "hapd-ctrl-sta-mem"
+    passphrase = "12345678"
+    params = hostapd.wpa2_params(ssid=ssid, passphrase=passphrase)
+    hapd = hostapd.add_ap(apdev[0], params)
+    dev[0].connect(ssid, psk=passphrase, scan_freq="2412")
+    hapd.wait_sta()
+    addr = dev[0].own_addr()
+
+    sta = hapd.get_sta(addr)
+    if 'mem_usage' not in sta or int(sta['mem_usage']) < 1000:
+        raise Exception("Unexpected mem_usage in STA output: " + str(sta))
+    res = hapd.request("STA-DUMP fields=mem_usage")
+    dump = dict(x.split('=') for x in res.splitlines()[1].split(' '))
+    if dump['addr'] != addr or dump['mem_usage'] != sta['mem_usage']:
+        raise Exception("Unexpected STA-DUMP mem_usage: " + res)
+
+    before = get_slab_stats(hapd)
+    if before is None:
+        raise HwsimSkip("SLAB_STATS not supported in the build")
+    for name in ['sta_info', 'wpa_state_machine']:
+        if name not in before or int(before[name]['in_use']) < 1:
+            raise Exception("Missing %s in SLAB_STATS: %s" % (name,
+                                                               str(before)))
+    dev[0].request("DISCONNECT")
+    ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+    if ev is None:
+        raise Exception("No disconnection event")
+    after = get_slab_stats(hapd)
+    if int(after['sta_info']['in_use']) != \
+       int(before['sta_info']['in_use']) - 1:
+        raise Exception("sta_info not freed: " + str(after))
+    if int(after['sta_info']['frees']) <= int(before['sta_info']['frees']):
+        raise Exception("sta_info free not counted: " + str(after))
+
+def get_slab_stats(hapd):
+    res = hapd.request("SLAB_STATS")
+    if "UNKNOWN COMMAND" in res:
+        return None
+    caches = {}
+    for l in res.splitlines():
+        vals = l.split(' ')
+        caches[vals[0]] = dict(x.split('=') for x in vals[1:])
+    return caches
+
 @remote_compatible
 def test_hapd_ctrl_disconnect(dev, apdev):
     """hostapd and disconnection ctrl_iface commands"""
@@ -175,6 +313,43 @@ def test_hapd_ctrl_level(dev, apdev):
     if "FAIL" not in hapd.request("LEVEL 0"):
         raise Exception("Unexpected LEVEL success on non-monitor interface")
 
+def test_hapd_ctrl_event_batch(dev, apdev):
+    """hostapd and batched event messages with a filter"""
+    ssid = "hapd-ctrl"
+    params = {"ssid": ssid}
+    hapd = hostapd.add_ap(apdev[0], params)
+    mon = wpaspy.Ctrl(os.path.join(hostapd.hapd_ctrl, apdev[0]['ifname']))
+    try:
+        mon.attach("batch=1 filter=AP-STA-CONNECTED,AP-STA-DISCONNECTED")
+        dev[0].connect(ssid, key_mgmt="NONE", scan_freq="2412")
+        hapd.wait_sta()
+        dev[0].request("DISCONNECT")
+        dev[0].wait_disconnected()
+        ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=2)
+        if ev is None:
+            raise Exception("Disconnection not reported")
+
+        events = []
+        while len(events) < 2:
+            if not mon.pending(timeout=1):
+                raise Exception("Batched events not received")
+            seq, lost, ev = mon.recv_batch()
+            if seq != len(events) or lost != 0:
+                raise Exception("Unexpected seq=%d lost=%d" % (seq, lost))
+            events += ev
+        if len(events) != 2 or \
+           not events[0].startswith("<3>AP-STA-CONNECTED " + dev[0].own_addr()) or \
+           not events[1].startswith("<3>AP-STA-DISCONNECTED " + dev[0].own_addr()):
+            raise Exception("Unexpected events: " + str(events))
+
+        stats = hapd.request("MONITOR_STATS")
+        logger.info("MONITOR_STATS:\n" + stats)
+        if "batch=1 events=2 sent=2 lost=0" not in stats:
+            raise Exception("Unexpected MONITOR_STATS: " + stats)
+    finally:
+        mon.detach()
+        mon.close()
+
 @remote_compatible
 def test_hapd_ctrl_new_sta(dev, apdev):
     """hostapd and NEW_STA ctrl_iface command"""
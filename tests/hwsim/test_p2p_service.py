@@ -119,13 +119,29 @@ def test_p2p_service_discovery2(dev):
         if "496e7465726e6574" not in ev:
             raise Exception("Unexpected service discovery response contents (UPnP)")
 
+def get_sd_stats(dev):
+    stats = {}
+    for line in dev.global_request("P2P_SERVICE_STATS").splitlines():
+        [name, value] = line.split('=', 1)
+        stats[name] = int(value)
+    return stats
+
 def test_p2p_service_discovery3(dev):
     """P2P service discovery for Bonjour with one peer having no services"""
     dev[2].p2p_listen()
+    before = get_sd_stats(dev[0])
     for dst in ["00:00:00:00:00:00", dev[0].p2p_dev_addr()]:
         ev = run_sd(dev, dst, "02000101")
         if "0b5f6166706f766572746370c00c000c01" not in ev:
             raise Exception("Unexpected service discovery response contents (Bonjour)")
+    after = get_sd_stats(dev[0])
+    logger.info("SD stats: " + str(after))
+    if after['responses'] < before['responses'] + 2:
+        raise Exception("SD responses not counted")
+    if after['resp_bytes'] <= before['resp_bytes']:
+        raise Exception("SD response bytes not counted")
+    if after['cache_hits'] < before['cache_hits'] + 2:
+        raise Exception("Cached Bonjour response not used")
 
 def test_p2p_service_discovery4(dev):
     """P2P service discovery for UPnP with one peer having no services"""
@@ -21,6 +21,7 @@ import hostapd
 from utils import *
 from test_ap_hs20 import build_dhcp_ack
 from test_ap_ft import ft_params1
+from wpasupplicant import WpaSupplicant
 
 def connect(dev, ssid, wait_connect=True):
     dev.connect(ssid, key_mgmt="WPA-EAP", scan_freq="2412",
@@ -366,6 +367,37 @@ def test_radius_acct_interim_unreachable2(dev, apdev):
     if req_e < req_s + 2:
         raise Exception("Unexpected RADIUS server acct MIB value")
 
+def test_radius_acct_interim_window(dev, apdev):
+    """RADIUS Accounting interim updates limited by in-flight window"""
+    params = hostapd.wpa2_eap_params(ssid="radius-acct")
+    params['acct_server_addr'] = "127.0.0.1"
+    params['acct_server_port'] = "18139"
+    params['acct_server_shared_secret'] = "radius"
+    params['radius_acct_interim_interval'] = "1"
+    params['radius_acct_interim_window'] = "1"
+    hapd = hostapd.add_ap(apdev[0], params)
+    for i in range(3):
+        connect(dev[i], "radius-acct")
+    time.sleep(3.1)
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib['radiusAcctScheduledStations']) != 3:
+        raise Exception("Unexpected number of scheduled stations")
+    if int(mib['radiusAcctInterimPending']) > 1:
+        raise Exception("In-flight window exceeded")
+    if int(mib['radiusAcctInterimWindowFull']) == 0:
+        raise Exception("Interim updates were not delayed")
+    sent = int(mib['radiusAcctInterimSent'])
+    if sent == 0:
+        raise Exception("No interim updates sent")
+
+    dev[0].request("DISCONNECT")
+    dev[0].wait_disconnected()
+    time.sleep(0.1)
+    mib = hapd.get_mib()
+    if int(mib['radiusAcctScheduledStations']) != 2:
+        raise Exception("Station not removed from schedule")
+
 def test_radius_acct_ipaddr(dev, apdev):
     """RADIUS Accounting and Framed-IP-Address"""
     try:
@@ -936,6 +968,116 @@ def test_radius_macacl_acct(dev, apdev):
     dev[1].wait_disconnected()
     dev[1].request("RECONNECT")
 
+def test_radius_macacl_cache(dev, apdev):
+    """RADIUS MAC ACL cache and prefetch"""
+    params = hostapd.radius_params()
+    params["ssid"] = "radius"
+    params["macaddr_acl"] = "2"
+    params["radius_acl_cache_ttl"] = "60"
+    params["radius_acl_negative_ttl"] = "2"
+    hapd = hostapd.add_ap(apdev[0], params)
+    bssid = hapd.own_addr()
+
+    dev[0].connect("radius", key_mgmt="NONE", scan_freq="2412")
+    dev[0].request("DISCONNECT")
+    dev[0].wait_disconnected()
+    dev[0].request("RECONNECT")
+    dev[0].wait_connected()
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if mib["radiusAclQueries"] != "1" or mib["radiusAclAccepts"] != "1":
+        raise Exception("Unexpected number of RADIUS ACL queries")
+    if int(mib["radiusAclCacheHits"]) < 1:
+        raise Exception("Cached RADIUS ACL result not used")
+    if mib["radiusAclCacheEntries"] != "1":
+        raise Exception("Unexpected number of cache entries")
+
+    hapd.set("radius_acl_prefetch", "1")
+    dev[1].scan_for_bss(bssid, freq="2412")
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclPrefetches"]) < 1:
+        raise Exception("RADIUS ACL result not prefetched")
+    time.sleep(0.1)
+    dev[1].connect("radius", key_mgmt="NONE", scan_freq="2412")
+    mib2 = hapd.get_mib()
+    logger.info("MIB: " + str(mib2))
+    if mib2["radiusAclQueries"] != mib["radiusAclQueries"]:
+        raise Exception("RADIUS ACL query sent after prefetch")
+
+    # The MAC address of wlan5 is not known to the RADIUS server
+    wpas = WpaSupplicant(global_iface='/tmp/wpas-wlan5')
+    wpas.interface_add("wlan5")
+    wpas.scan_for_bss(bssid, freq="2412")
+    wpas.connect("radius", key_mgmt="NONE", scan_freq="2412",
+                 wait_connect=False)
+    macacl_wait_reject(wpas)
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclRejects"]) != 1:
+        raise Exception("RADIUS ACL reject not reported")
+    queries = int(mib["radiusAclQueries"])
+
+    logger.info("Cached reject")
+    wpas.request("RECONNECT")
+    macacl_wait_reject(wpas)
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclQueries"]) != queries:
+        raise Exception("RADIUS ACL query sent for cached reject")
+    if int(mib["radiusAclCacheNegativeHits"]) < 1:
+        raise Exception("Cached RADIUS ACL reject not used")
+
+    logger.info("Expired reject")
+    time.sleep(2.1)
+    wpas.request("RECONNECT")
+    macacl_wait_reject(wpas)
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclQueries"]) != queries + 1:
+        raise Exception("RADIUS ACL query not sent after negative TTL")
+    queries += 1
+
+    logger.info("Reject caching disabled")
+    time.sleep(2.1)
+    hapd.set("radius_acl_negative_ttl", "0")
+    for i in range(2):
+        wpas.request("RECONNECT")
+        macacl_wait_reject(wpas)
+    mib = hapd.get_mib()
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclQueries"]) < queries + 2:
+        raise Exception("RADIUS ACL reject cached with radius_acl_negative_ttl=0")
+    wpas.request("REMOVE_NETWORK all")
+
+    logger.info("Coalesced queries")
+    params = hostapd.radius_params()
+    params['auth_server_port'] = "18139"
+    params["ssid"] = "radius2"
+    params["macaddr_acl"] = "2"
+    hapd2 = hostapd.add_ap(apdev[1], params)
+    dev[2].scan_for_bss(hapd2.own_addr(), freq="2412")
+    dev[2].connect("radius2", key_mgmt="NONE", scan_freq="2412",
+                   wait_connect=False)
+    for i in range(100):
+        mib = hapd2.get_mib()
+        if int(mib["radiusAclQueriesCoalesced"]) > 0:
+            break
+        time.sleep(0.1)
+    dev[2].request("DISCONNECT")
+    logger.info("MIB: " + str(mib))
+    if int(mib["radiusAclQueriesCoalesced"]) < 1:
+        raise Exception("Authentication frame retry not coalesced")
+    if mib["radiusAclQueries"] != "1" or mib["radiusAclPendingQueries"] != "1":
+        raise Exception("Unexpected number of RADIUS ACL queries")
+
+def macacl_wait_reject(wpas):
+    ev = wpas.wait_event(["CTRL-EVENT-AUTH-REJECT"], timeout=10)
+    if ev is None:
+        raise Exception("No CTRL-EVENT-AUTH-REJECT event")
+    wpas.request("DISCONNECT")
+    wpas.wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=0.5)
+
 def test_radius_macacl_oom(dev, apdev):
     """RADIUS MAC ACL and OOM"""
     params = hostapd.radius_params()
@@ -12,6 +12,7 @@ import socket
 import subprocess
 import time
 import binascii
+import wpaspy
 
 import hostapd
 import hwsim_utils
@@ -1977,6 +1978,59 @@ def test_wpas_ctrl_event_burst(dev, apdev):
     if not dev[0].ping():
         raise Exception("Could not ping wpa_supplicant at the end of the test")
 
+def test_wpas_ctrl_event_batch(dev, apdev):
+    """wpa_supplicant control socket and batched event messages"""
+    mon = wpaspy.Ctrl("/var/run/wpa_supplicant/" + dev[0].ifname)
+    try:
+        mon.attach("batch=1 filter=TEST-EVENT-MESSAGE,CTRL-EVENT-FOO")
+        if "OK" not in dev[0].request("EVENT_TEST 1000"):
+            raise Exception("Could not request event messages")
+
+        events = []
+        next_seq = 0
+        batches = 0
+        for i in range(100):
+            if len(events) >= 1000:
+                break
+            # Other attached monitors need to be served as well to avoid
+            # throttling of event messages
+            dev[0].dump_monitor()
+            if not mon.pending(timeout=0.05):
+                continue
+            seq, lost, ev = mon.recv_batch()
+            batches += 1
+            if seq != next_seq or lost != 0:
+                raise Exception("Unexpected seq=%d lost=%d (expected seq=%d)" % (seq, lost, next_seq))
+            next_seq += len(ev)
+            events += ev
+        if len(events) < 1000:
+            raise Exception("Timeout on batched events (%d received)" % len(events))
+        logger.info("Received %d events in %d batches" % (len(events),
+                                                           batches))
+        if batches >= 1000:
+            raise Exception("Events were not batched")
+        for i in range(1000):
+            exp = "<3>TEST-EVENT-MESSAGE %d/1000" % (i + 1)
+            if events[i] != exp:
+                raise Exception("Unexpected event %d: %s" % (i, events[i]))
+
+        stats = dev[0].request("MONITOR_STATS")
+        logger.info("MONITOR_STATS:\n" + stats)
+        if "batch=1 events=1000 sent=1000 lost=0 pending=0" not in stats:
+            raise Exception("Unexpected MONITOR_STATS: " + stats)
+
+        # Events that do not match the filter are not delivered
+        dev[0].request("EVENT_TEST 1")
+        dev[0].scan(freq=2412)
+        seq, lost, ev = mon.recv_batch()
+        if seq != 1000 or ev != ["<3>TEST-EVENT-MESSAGE 1/1"]:
+            raise Exception("Unexpected batch: seq=%d %s" % (seq, str(ev)))
+        if mon.pending(timeout=0.1):
+            raise Exception("Unexpected event delivered")
+    finally:
+        mon.detach()
+        mon.close()
+
 @remote_compatible
 def test_wpas_ctrl_sched_scan_plans(dev, apdev):
     """wpa_supplicant sched_scan_plans parsing"""
@@ -2171,3 +2225,46 @@ def test_wpas_ctrl_interface_add_driver_init_failure(dev, apdev):
         if "FAIL" not in res:
             raise Exception("Unexpected result: " + res)
     dev[0].dump_monitor()
+
+def test_wpas_ctrl_eloop_profile(dev):
+    """wpa_supplicant ELOOP_PROFILE"""
+    res = dev[0].request("ELOOP_PROFILE")
+    if "UNKNOWN COMMAND" in res:
+        raise HwsimSkip("ELOOP_PROFILE not supported")
+    if "OK" not in dev[0].request("ELOOP_PROFILE RESET"):
+        raise Exception("ELOOP_PROFILE RESET failed")
+    dev[0].scan(freq="2412")
+    res = dev[0].request("ELOOP_PROFILE")
+    logger.info("ELOOP_PROFILE:\n" + res)
+    lines = res.splitlines()
+    vals = {}
+    for line in lines[0:4]:
+        name, val = line.split('=')
+        vals[name] = int(val)
+    for name in ["elapsed_usec", "iterations", "busy_usec", "handlers"]:
+        if name not in vals:
+            raise Exception("Missing %s in ELOOP_PROFILE output" % name)
+    if vals['iterations'] == 0 or vals['busy_usec'] > vals['elapsed_usec']:
+        raise Exception("Unexpected ELOOP_PROFILE summary: " + str(vals))
+    handlers = lines[4:]
+    if len(handlers) == 0:
+        raise Exception("No handlers reported")
+    prev = None
+    for line in handlers:
+        fields = line.split(' ')
+        if fields[0] not in ["read", "write", "exception", "timeout",
+                             "signal"]:
+            raise Exception("Unexpected handler type: " + line)
+        vals = dict(f.split('=') for f in fields[2:])
+        if int(vals['calls']) == 0:
+            raise Exception("Handler without calls listed: " + line)
+        hist = [int(x) for x in vals['delay_hist'].split(',')]
+        if len(hist) != 6 or sum(hist) > int(vals['calls']):
+            raise Exception("Unexpected delay histogram: " + line)
+        total = int(vals['total_usec'])
+        if prev is not None and total > prev:
+            raise Exception("Handlers not sorted by total run time")
+        prev = total
+    # At least the control interface socket handler has been called
+    if not any(l.startswith("read ") for l in handlers):
+        raise Exception("No socket read handlers reported")
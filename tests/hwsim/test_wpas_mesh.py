@@ -2277,6 +2277,49 @@ def test_mesh_mpm_init_proto(dev, apdev):
     if "FAIL" not in dev[1].request("MESH_PEER_ADD 02:00:00:00:01:02"):
         raise Exception("Unexpected MESH_PEER_ADD success")
 
+def test_mesh_mpm_many_peers(dev, apdev):
+    """Mesh peering management with hundreds of peers"""
+    check_mesh_support(dev[0])
+    add_open_mesh_network(dev[0])
+    check_mesh_group_added(dev[0])
+    dev[0].dump_monitor()
+
+    dev[0].request("SET ext_mgmt_frame_handling 1")
+
+    fixed = "0f010000"
+    supp_rates = "010802040b168c129824"
+    ext_supp_rates = "3204b048606c"
+    mesh_id = "720e777061732d6d6573682d6f70656e"
+    mesh_conf = "710701010001000009"
+    ht_capab = "2d1a7c001bffff000000000000000000000100000000000000000000"
+    ht_oper = "3d160b000000000000000000000000000000000000000000"
+
+    num_peers = 300
+    for i in range(num_peers):
+        addr = "0200000a%04x" % i
+        hdr = "d000ac00020000000000" + addr + addr + "1000"
+        mpm = "75040000%04x" % (0x1000 + i)
+        frame = hdr + fixed + supp_rates + ext_supp_rates + mesh_id + mesh_conf + mpm + ht_capab + ht_oper
+        if "OK" not in dev[0].request("MGMT_RX_PROCESS freq=2412 datarate=0 ssi_signal=-30 frame=%s" % frame):
+            raise Exception("MGMT_RX_PROCESS failed")
+
+    llids = set()
+    sta = dev[0].get_sta(None)
+    while "addr" in sta:
+        if "my_lid" not in sta:
+            raise Exception("No local link ID for " + sta['addr'])
+        llid = int(sta['my_lid'], 16)
+        if llid == 0 or llid in llids:
+            raise Exception("Duplicate or invalid local link ID: " + sta['my_lid'])
+        llids.add(llid)
+        sta = dev[0].get_sta(sta['addr'], next=True)
+    if len(llids) != num_peers:
+        raise Exception("Unexpected number of peers: %d" % len(llids))
+
+    dev[0].request("SET ext_mgmt_frame_handling 0")
+    dev[0].mesh_group_remove()
+    check_mesh_group_removed(dev[0])
+
 def test_mesh_holding(dev, apdev):
     """Mesh MPM FSM and HOLDING state event OPN_ACPT"""
     check_mesh_support(dev[0])
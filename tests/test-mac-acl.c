@@ -0,0 +1,382 @@
+/*
+ * MAC ACL - test program and load benchmark
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "ap/mac_acl.h"
+
+
+/* Sorted array as used for accept_mac/deny_mac before the hash table */
+struct sorted_entry {
+	u8 addr[ETH_ALEN];
+	int vlan_id;
+};
+
+
+static int sorted_comp(const void *a, const void *b)
+{
+	const struct sorted_entry *aa = a;
+	const struct sorted_entry *bb = b;
+
+	return os_memcmp(aa->addr, bb->addr, ETH_ALEN);
+}
+
+
+static int sorted_add(struct sorted_entry **list, unsigned int *num,
+		      const u8 *addr, int vlan_id)
+{
+	struct sorted_entry *n;
+
+	n = os_realloc_array(*list, *num + 1, sizeof(**list));
+	if (!n)
+		return -1;
+	*list = n;
+	os_memcpy(n[*num].addr, addr, ETH_ALEN);
+	n[*num].vlan_id = vlan_id;
+	(*num)++;
+	return 0;
+}
+
+
+static int sorted_found(struct sorted_entry *list, unsigned int num,
+			const u8 *addr)
+{
+	int start = 0, end = (int) num - 1, middle, res;
+
+	while (start <= end) {
+		middle = (start + end) / 2;
+		res = os_memcmp(list[middle].addr, addr, ETH_ALEN);
+		if (res == 0)
+			return 1;
+		if (res < 0)
+			start = middle + 1;
+		else
+			end = middle - 1;
+	}
+	return 0;
+}
+
+
+static void sorted_del(struct sorted_entry *list, unsigned int *num,
+		       const u8 *addr)
+{
+	unsigned int i = 0;
+
+	while (i < *num) {
+		if (os_memcmp(list[i].addr, addr, ETH_ALEN) == 0) {
+			os_remove_in_array(list, *num, sizeof(*list), i);
+			(*num)--;
+		} else {
+			i++;
+		}
+	}
+}
+
+
+static void gen_addr(u8 *addr, unsigned int i)
+{
+	/* Sequential NIC specific part under a few OUIs, as is common for
+	 * provisioned device lists */
+	addr[0] = 0x02;
+	addr[1] = 0x00;
+	addr[2] = i % 3;
+	WPA_PUT_BE24(&addr[3], i * 7 + 1);
+}
+
+
+static double usec_since(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec * 1000000.0 + diff.usec;
+}
+
+
+static int count_cb(const struct mac_acl_entry *entry, void *ctx)
+{
+	unsigned int *count = ctx;
+
+	(*count)++;
+	return 0;
+}
+
+
+static int test_basic(void)
+{
+	struct mac_acl acl;
+	const struct mac_acl_entry *e;
+	u8 addr[ETH_ALEN];
+	unsigned int i, count = 0;
+	int ret = -1;
+
+	os_memset(&acl, 0, sizeof(acl));
+	gen_addr(addr, 0);
+	if (mac_acl_get(&acl, addr) || mac_acl_del(&acl, addr) ||
+	    mac_acl_count(&acl) != 0) {
+		printf("empty list not handled\n");
+		return -1;
+	}
+
+	for (i = 0; i < 1000; i++) {
+		gen_addr(addr, i);
+		if (mac_acl_add(&acl, addr, i % 5) < 0)
+			goto fail;
+	}
+	gen_addr(addr, 10);
+	if (mac_acl_add(&acl, addr, 42) < 0 || mac_acl_count(&acl) != 1000) {
+		printf("duplicate address added\n");
+		goto fail;
+	}
+	e = mac_acl_get(&acl, addr);
+	if (!e || e->vlan_id != 42) {
+		printf("VLAN ID not updated\n");
+		goto fail;
+	}
+
+	for (i = 0; i < 1000; i += 2) {
+		gen_addr(addr, i);
+		if (mac_acl_del(&acl, addr) != 1) {
+			printf("entry %u not removed\n", i);
+			goto fail;
+		}
+	}
+	for (i = 0; i < 1000; i++) {
+		gen_addr(addr, i);
+		e = mac_acl_get(&acl, addr);
+		if (!!e != (i & 1) ||
+		    (e && e->vlan_id != (int) (i % 5))) {
+			printf("unexpected lookup result for entry %u\n", i);
+			goto fail;
+		}
+	}
+	mac_acl_for_each(&acl, count_cb, &count);
+	if (count != 500 || mac_acl_count(&acl) != 500) {
+		printf("unexpected number of entries %u\n", count);
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	mac_acl_clear(&acl);
+	if (acl.hash || mac_acl_count(&acl)) {
+		printf("list not cleared\n");
+		ret = -1;
+	}
+	return ret;
+}
+
+
+static int test_merge(void)
+{
+	struct mac_acl acl, tmp;
+	const struct mac_acl_entry *e;
+	u8 addr[ETH_ALEN];
+	unsigned int i;
+	int ret = -1;
+
+	os_memset(&acl, 0, sizeof(acl));
+	os_memset(&tmp, 0, sizeof(tmp));
+
+	/* Merge into an empty list */
+	for (i = 0; i < 10; i++) {
+		gen_addr(addr, i);
+		if (mac_acl_add(&tmp, addr, 1) < 0)
+			goto fail;
+	}
+	mac_acl_merge(&acl, &tmp);
+	if (mac_acl_count(&acl) != 10 || tmp.hash || mac_acl_count(&tmp)) {
+		printf("merge into empty list failed\n");
+		goto fail;
+	}
+
+	/* Overlapping batch large enough to grow the table */
+	for (i = 5; i < 200; i++) {
+		gen_addr(addr, i);
+		if (mac_acl_add(&tmp, addr, 2) < 0)
+			goto fail;
+	}
+	mac_acl_merge(&acl, &tmp);
+	if (mac_acl_count(&acl) != 200 || tmp.hash || mac_acl_count(&tmp) ||
+	    acl.num > (1U << acl.hash_bits)) {
+		printf("unexpected list after merge\n");
+		goto fail;
+	}
+	for (i = 0; i < 200; i++) {
+		gen_addr(addr, i);
+		e = mac_acl_get(&acl, addr);
+		if (!e || e->vlan_id != (i < 5 ? 1 : 2)) {
+			printf("unexpected merged entry %u\n", i);
+			goto fail;
+		}
+	}
+
+	/* Merging an empty list is a no-op */
+	mac_acl_merge(&acl, &tmp);
+	if (mac_acl_count(&acl) != 200) {
+		printf("empty merge modified the list\n");
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	mac_acl_clear(&acl);
+	mac_acl_clear(&tmp);
+	return ret;
+}
+
+
+/* Load the list as hostapd_config_read_maclist() does and look up each
+ * entry once; for the sorted array this is one realloc per entry and a final
+ * qsort. */
+static int bench_load(unsigned int num)
+{
+	struct mac_acl acl;
+	struct sorted_entry *list = NULL;
+	unsigned int i, slist = 0;
+	struct os_reltime start;
+	double load_old, load_new, lookup_old, lookup_new, del_old, del_new;
+	u8 addr[ETH_ALEN];
+	int ret = -1;
+
+	os_memset(&acl, 0, sizeof(acl));
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (sorted_add(&list, &slist, addr, 0) < 0)
+			goto fail;
+	}
+	qsort(list, slist, sizeof(*list), sorted_comp);
+	load_old = usec_since(&start);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (mac_acl_add(&acl, addr, 0) < 0)
+			goto fail;
+	}
+	load_new = usec_since(&start);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (!sorted_found(list, slist, addr))
+			goto fail;
+	}
+	lookup_old = usec_since(&start);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (!mac_acl_get(&acl, addr))
+			goto fail;
+	}
+	lookup_new = usec_since(&start);
+
+	/* Removal of a small batch, e.g., DENY_ACL DEL_MAC for a few
+	 * addresses, from the full list */
+	os_get_reltime(&start);
+	for (i = 0; i < 100; i++) {
+		gen_addr(addr, i * (num / 100));
+		sorted_del(list, &slist, addr);
+	}
+	del_old = usec_since(&start);
+
+	os_get_reltime(&start);
+	for (i = 0; i < 100; i++) {
+		gen_addr(addr, i * (num / 100));
+		mac_acl_del(&acl, addr);
+	}
+	del_new = usec_since(&start);
+
+	if (slist != mac_acl_count(&acl)) {
+		printf("load: list sizes differ (%u vs. %u)\n",
+		       slist, mac_acl_count(&acl));
+		goto fail;
+	}
+
+	printf("load: entries=%u load_usec old=%.0f new=%.0f lookup_nsec old=%.1f new=%.1f del100_usec old=%.0f new=%.0f hash_bits=%u\n",
+	       num, load_old, load_new,
+	       lookup_old * 1000 / num, lookup_new * 1000 / num,
+	       del_old, del_new, acl.hash_bits);
+	ret = 0;
+fail:
+	if (ret)
+		printf("load: failed\n");
+	os_free(list);
+	mac_acl_clear(&acl);
+	return ret;
+}
+
+
+/* Add entries one at a time as ACCEPT_ACL ADD_MAC does; the sorted array was
+ * resorted after each addition. */
+static int bench_incremental(unsigned int num)
+{
+	struct mac_acl acl;
+	struct sorted_entry *list = NULL;
+	unsigned int i, slist = 0;
+	struct os_reltime start;
+	double t_old, t_new;
+	u8 addr[ETH_ALEN];
+	int ret = -1;
+
+	os_memset(&acl, 0, sizeof(acl));
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (sorted_found(list, slist, addr))
+			continue;
+		if (sorted_add(&list, &slist, addr, 0) < 0)
+			goto fail;
+		qsort(list, slist, sizeof(*list), sorted_comp);
+	}
+	t_old = usec_since(&start);
+
+	os_get_reltime(&start);
+	for (i = 0; i < num; i++) {
+		gen_addr(addr, i);
+		if (mac_acl_add(&acl, addr, 0) < 0)
+			goto fail;
+	}
+	t_new = usec_since(&start);
+
+	printf("incremental: entries=%u usec/add old=%.2f new=%.3f\n",
+	       num, t_old / num, t_new / num);
+	ret = 0;
+fail:
+	os_free(list);
+	mac_acl_clear(&acl);
+	return ret;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int num = 100000;
+	int ret = 0;
+
+	if (argc > 1)
+		num = atoi(argv[1]);
+	if (num < 100)
+		num = 100;
+
+	if (test_basic() < 0 || test_merge() < 0) {
+		printf("MAC ACL tests failed\n");
+		ret = -1;
+	}
+
+	if (bench_load(num) < 0 ||
+	    bench_incremental(num / 20) < 0)
+		ret = -1;
+
+	return ret;
+}
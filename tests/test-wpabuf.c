@@ -0,0 +1,278 @@
+/*
+ * wpabuf - test program and allocation benchmark
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/wpabuf.h"
+
+
+static unsigned long alloc_calls;
+
+
+static struct wpabuf * bench_alloc(size_t len)
+{
+	alloc_calls++;
+	return wpabuf_alloc(len);
+}
+
+
+static int bench_put(struct wpabuf **buf, size_t len, u8 val)
+{
+	if (wpabuf_resize(buf, len) < 0)
+		return -1;
+	os_memset(wpabuf_put(*buf, len), val, len);
+	return 0;
+}
+
+
+static int bench_frame(size_t len)
+{
+	struct wpabuf *buf;
+
+	buf = bench_alloc(len);
+	if (!buf)
+		return -1;
+	os_memset(wpabuf_put(buf, len), 0x11, len);
+	wpabuf_free(buf);
+	return 0;
+}
+
+
+/* Extra IEs are built one element at a time, e.g., as done in
+ * hostapd_build_ap_extra_ies() and the WPS attribute builders. */
+static int bench_ies(unsigned int count)
+{
+	struct wpabuf *buf = NULL;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (bench_put(&buf, 2 + 8 + (i * 7) % 32, i) < 0) {
+			wpabuf_free(buf);
+			return -1;
+		}
+	}
+	wpabuf_free(buf);
+	return 0;
+}
+
+
+/* RADIUS messages start at RADIUS_DEFAULT_MSG_SIZE and are grown with
+ * wpabuf_resize() when attributes do not fit. */
+static int bench_radius(size_t eap_len)
+{
+	struct wpabuf *buf;
+	unsigned int i;
+	size_t left;
+
+	buf = bench_alloc(1024);
+	if (!buf)
+		return -1;
+	os_memset(wpabuf_put(buf, 20), 0, 20);
+	for (i = 0; i < 12; i++) {
+		if (bench_put(&buf, 2 + 16, i) < 0)
+			goto fail;
+	}
+	for (left = eap_len; left > 0; left -= left > 253 ? 253 : left) {
+		if (bench_put(&buf, 2 + (left > 253 ? 253 : left), 0x79) < 0)
+			goto fail;
+	}
+	if (bench_put(&buf, 2 + 16, 0x50) < 0)
+		goto fail;
+	wpabuf_free(buf);
+	return 0;
+fail:
+	wpabuf_free(buf);
+	return -1;
+}
+
+
+/* EAP-TLS messages without the total length are reassembled by appending
+ * each fragment. */
+static int bench_tls_reassembly(size_t total, size_t frag)
+{
+	struct wpabuf *buf = NULL;
+	size_t left, len;
+
+	for (left = total; left > 0; left -= len) {
+		len = left > frag ? frag : left;
+		if (bench_put(&buf, len, 0x16) < 0) {
+			wpabuf_free(buf);
+			return -1;
+		}
+	}
+	wpabuf_free(buf);
+	return 0;
+}
+
+
+static int bench_assoc_psk(void)
+{
+	return bench_frame(30) || /* Authentication */
+		bench_frame(34) || /* Authentication response */
+		bench_frame(180) || /* (Re)Association Request */
+		bench_ies(6) || /* extra IEs for the response */
+		bench_frame(190) || /* (Re)Association Response */
+		bench_frame(99) || /* EAPOL-Key msg 1/4 */
+		bench_frame(121) || /* EAPOL-Key msg 2/4 */
+		bench_frame(179) || /* EAPOL-Key msg 3/4 */
+		bench_frame(99) || /* EAPOL-Key msg 4/4 */
+		bench_radius(0); /* Accounting-Request */
+}
+
+
+static int bench_assoc_eap_tls(void)
+{
+	unsigned int i;
+
+	if (bench_assoc_psk())
+		return -1;
+	for (i = 0; i < 8; i++) {
+		if (bench_frame(40 + i * 4) || /* EAPOL */
+		    bench_radius(i == 2 || i == 3 ? 1024 : 80) ||
+		    bench_frame(1024))
+			return -1;
+	}
+	return bench_tls_reassembly(3500, 1398) ||
+		bench_tls_reassembly(1100, 1024);
+}
+
+
+static int bench(const char *name, int (*assoc)(void), unsigned int count)
+{
+	struct wpabuf_stats stats;
+	struct os_reltime start, end, diff;
+	unsigned long before, after, hits = 0, misses = 0;
+	unsigned int i;
+	int j;
+
+	wpabuf_pool_flush();
+	alloc_calls = 0;
+	os_get_reltime(&start);
+	for (i = 0; i < count; i++) {
+		if (assoc() < 0) {
+			printf("%s: allocation failed\n", name);
+			return -1;
+		}
+	}
+	os_get_reltime(&end);
+	wpabuf_get_stats(&stats);
+
+	for (j = 0; j < WPABUF_POOL_CLASSES; j++) {
+		hits += stats.pool[j].hits;
+		misses += stats.pool[j].misses;
+	}
+	/* Exact size reallocation used to call malloc for each wpabuf_alloc()
+	 * and realloc for each wpabuf_resize() that needed more room. */
+	before = alloc_calls + stats.grows;
+	after = stats.allocs + stats.reallocs;
+	os_reltime_sub(&end, &start, &diff);
+
+	printf("%s: associations=%u alloc_calls/assoc=%.1f heap_ops/assoc before=%.1f after=%.2f grows=%lu in_place=%lu pool_hits=%lu pool_misses=%lu usec/assoc=%.2f\n",
+	       name, count, (double) alloc_calls / count,
+	       (double) before / count, (double) after / count,
+	       stats.grows, stats.grows_in_place, hits, misses,
+	       (diff.sec * 1000000.0 + diff.usec) / count);
+	for (j = 0; j < WPABUF_POOL_CLASSES; j++)
+		printf("  pool %5zu: hits=%lu misses=%lu cached=%u\n",
+		       stats.pool[j].len, stats.pool[j].hits,
+		       stats.pool[j].misses, stats.pool[j].cached);
+
+	if (after > before) {
+		printf("%s: more heap operations than with exact growth\n",
+		       name);
+		return -1;
+	}
+	return 0;
+}
+
+
+static int test_resize(void)
+{
+	struct wpabuf *buf = NULL;
+	size_t i;
+	u8 *pos;
+
+	/* Data is preserved and new space is cleared across growth */
+	for (i = 0; i < 5000; i++) {
+		if (wpabuf_resize(&buf, 1) < 0)
+			return -1;
+		if (wpabuf_tailroom(buf) != 1 || wpabuf_size(buf) != i + 1) {
+			printf("resize: unexpected size %zu/%zu\n",
+			       wpabuf_size(buf), wpabuf_tailroom(buf));
+			goto fail;
+		}
+		if (*(wpabuf_mhead_u8(buf) + i) != 0) {
+			printf("resize: new space not cleared at %zu\n", i);
+			goto fail;
+		}
+		wpabuf_put_u8(buf, i & 0xff);
+	}
+	pos = wpabuf_mhead_u8(buf);
+	for (i = 0; i < 5000; i++) {
+		if (pos[i] != (i & 0xff)) {
+			printf("resize: data corrupted at %zu\n", i);
+			goto fail;
+		}
+	}
+	wpabuf_free(buf);
+
+	/* Reused pool entries are cleared */
+	buf = wpabuf_alloc(100);
+	if (!buf)
+		return -1;
+	os_memset(wpabuf_put(buf, 100), 0xff, 100);
+	wpabuf_free(buf);
+	buf = wpabuf_alloc(120);
+	if (!buf)
+		return -1;
+	for (i = 0; i < 120; i++) {
+		if (wpabuf_head_u8(buf)[i]) {
+			printf("alloc: reused buffer not cleared\n");
+			goto fail;
+		}
+	}
+	wpabuf_put(buf, 100);
+	if (wpabuf_resize(&buf, 27) < 0 || wpabuf_tailroom(buf) != 27)
+		goto fail;
+	for (i = 100; i < 127; i++) {
+		if (wpabuf_head_u8(buf)[i]) {
+			printf("resize: spare space not cleared\n");
+			goto fail;
+		}
+	}
+	wpabuf_free(buf);
+
+	return 0;
+fail:
+	wpabuf_free(buf);
+	return -1;
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int count = 20000;
+	int ret = 0;
+
+	if (argc > 1)
+		count = atoi(argv[1]);
+	if (count == 0)
+		count = 1;
+
+	if (test_resize() < 0) {
+		printf("wpabuf resize tests failed\n");
+		ret = -1;
+	}
+
+	if (bench("psk", bench_assoc_psk, count) < 0 ||
+	    bench("eap-tls", bench_assoc_eap_tls, count / 10 + 1) < 0)
+		ret = -1;
+
+	wpabuf_pool_flush();
+	return ret;
+}
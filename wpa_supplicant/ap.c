@@ -1666,12 +1666,8 @@ int wpa_supplicant_ap_mac_addr_filter(struct wpa_supplicant *wpa_s,
 	hapd = wpa_s->ap_iface->bss[0];
 	conf = hapd->conf;
 
-	os_free(conf->accept_mac);
-	conf->accept_mac = NULL;
-	conf->num_accept_mac = 0;
-	os_free(conf->deny_mac);
-	conf->deny_mac = NULL;
-	conf->num_deny_mac = 0;
+	mac_acl_clear(&conf->accept_mac);
+	mac_acl_clear(&conf->deny_mac);
 
 	if (addr == NULL) {
 		conf->macaddr_acl = ACCEPT_UNLESS_DENIED;
@@ -1679,13 +1675,7 @@ int wpa_supplicant_ap_mac_addr_filter(struct wpa_supplicant *wpa_s,
 	}
 
 	conf->macaddr_acl = DENY_UNLESS_ACCEPTED;
-	conf->accept_mac = os_zalloc(sizeof(struct mac_acl_entry));
-	if (conf->accept_mac == NULL)
-		return -1;
-	os_memcpy(conf->accept_mac[0].addr, addr, ETH_ALEN);
-	conf->num_accept_mac = 1;
-
-	return 0;
+	return mac_acl_add(&conf->accept_mac, addr, 0);
 }
 
 
@@ -134,8 +134,11 @@ int wpa_bss_anqp_unshare_alloc(struct wpa_bss *bss)
 /**
  * wpa_bss_anqp_free - Free an ANQP data structure
  * @anqp: ANQP data structure from wpa_bss_anqp_alloc() or wpa_bss_anqp_clone()
+ *
+ * This releases one reference to the data. The data is freed once there are
+ * no remaining users.
  */
-static void wpa_bss_anqp_free(struct wpa_bss_anqp *anqp)
+void wpa_bss_anqp_free(struct wpa_bss_anqp *anqp)
 {
 #ifdef CONFIG_INTERWORKING
 	struct wpa_bss_anqp_elem *elem;
@@ -38,6 +38,7 @@
 #define DEFAULT_SCAN_CUR_FREQ 0
 #define DEFAULT_P2P_SEARCH_DELAY 500
 #define DEFAULT_RAND_ADDR_LIFETIME 60
+#define DEFAULT_ANQP_MAX_PARALLEL 4
 #define DEFAULT_KEY_MGMT_OFFLOAD 1
 #define DEFAULT_CERT_IN_CB 1
 #define DEFAULT_P2P_GO_CTWINDOW 0
@@ -47,6 +48,7 @@
 #define DEFAULT_OCE_SUPPORT OCE_STA
 #define DEFAULT_EXTENDED_KEY_ID 0
 #define DEFAULT_SCAN_RES_VALID_FOR_CONNECT 5
+#define DEFAULT_STATS_SHM_INTERVAL 1000
 
 #include "config_ssid.h"
 #include "wps/wps.h"
@@ -404,6 +406,7 @@ struct wpa_cred {
 #define CFG_CHANGED_WOWLAN_TRIGGERS BIT(18)
 #define CFG_CHANGED_DISABLE_BTM BIT(19)
 #define CFG_CHANGED_BGSCAN BIT(20)
+#define CFG_CHANGED_STATS_SHM BIT(21)
 
 /**
  * struct wpa_config - wpa_supplicant configuration data
@@ -1563,6 +1566,25 @@ struct wpa_config {
 	 */
 	unsigned int gas_rand_addr_lifetime;
 
+	/**
+	 * anqp_max_parallel - Maximum number of parallel ANQP queries
+	 *
+	 * This limits the number of ANQP queries that are queued at the same
+	 * time during Interworking ANQP fetch. The queries are still
+	 * transmitted one at a time through the radio work queue, but there is
+	 * no idle time between the BSSes.
+	 */
+	int anqp_max_parallel;
+
+	/**
+	 * anqp_cache_ttl - Lifetime of cached ANQP responses in seconds
+	 *
+	 * ANQP responses received during Interworking ANQP fetch are cached
+	 * for this many seconds and reused for BSSes that are seen again or
+	 * that share the HESSID, SSID, and ANQP Domain ID. 0 = disabled.
+	 */
+	unsigned int anqp_cache_ttl;
+
 	/**
 	 * gas_rand_mac_addr - GAS MAC address policy
 	 *
@@ -1686,6 +1708,20 @@ struct wpa_config {
 	 */
 	int wowlan_disconnect_on_deinit;
 
+	/**
+	 * stats_shm - File name prefix for the shared memory statistics regions
+	 *
+	 * If set, the interface state and link counters of each interface are
+	 * exported into a memory mapped file named <stats_shm>-<ifname>. This
+	 * requires CONFIG_STATS_SHM=y build option.
+	 */
+	char *stats_shm;
+
+	/**
+	 * stats_shm_interval - Statistics update interval in milliseconds
+	 */
+	unsigned int stats_shm_interval;
+
 #ifdef CONFIG_PASN
 #ifdef CONFIG_TESTING_OPTIONS
 	/*
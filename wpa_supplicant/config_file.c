@@ -1536,6 +1536,10 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 			config->gas_rand_addr_lifetime);
 	if (config->gas_rand_mac_addr)
 		fprintf(f, "gas_rand_mac_addr=%d\n", config->gas_rand_mac_addr);
+	if (config->anqp_max_parallel != DEFAULT_ANQP_MAX_PARALLEL)
+		fprintf(f, "anqp_max_parallel=%d\n", config->anqp_max_parallel);
+	if (config->anqp_cache_ttl)
+		fprintf(f, "anqp_cache_ttl=%u\n", config->anqp_cache_ttl);
 	if (config->dpp_config_processing)
 		fprintf(f, "dpp_config_processing=%d\n",
 			config->dpp_config_processing);
@@ -1559,6 +1563,11 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	if (config->wowlan_disconnect_on_deinit)
 		fprintf(f, "wowlan_disconnect_on_deinit=%d\n",
 			config->wowlan_disconnect_on_deinit);
+	if (config->stats_shm)
+		fprintf(f, "stats_shm=%s\n", config->stats_shm);
+	if (config->stats_shm_interval != DEFAULT_STATS_SHM_INTERVAL)
+		fprintf(f, "stats_shm_interval=%u\n",
+			config->stats_shm_interval);
 }
 
 #endif /* CONFIG_NO_CONFIG_WRITE */
@@ -8498,6 +8498,7 @@ static void wpa_supplicant_ctrl_iface_flush(struct wpa_supplicant *wpa_s)
 	hs20_cancel_fetch_osu(wpa_s);
 	hs20_del_icon(wpa_s, NULL, NULL);
 #endif /* CONFIG_HS20 */
+	interworking_flush(wpa_s);
 #endif /* CONFIG_INTERWORKING */
 
 	wpa_s->ext_mgmt_frame_handling = 0;
@@ -11497,6 +11498,12 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+#ifdef CONFIG_ELOOP_PROFILE
+	} else if (os_strcmp(buf, "ELOOP_PROFILE") == 0) {
+		reply_len = eloop_profile_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_PROFILE RESET") == 0) {
+		eloop_profile_reset();
+#endif /* CONFIG_ELOOP_PROFILE */
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = wpa_sm_get_mib(wpa_s->wpa, reply, reply_size);
 		if (reply_len >= 0) {
@@ -11761,6 +11768,8 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strcmp(buf, "P2P_SERVICE_FLUSH") == 0) {
 		wpas_p2p_service_flush(wpa_s);
+	} else if (os_strcmp(buf, "P2P_SERVICE_STATS") == 0) {
+		reply_len = wpas_p2p_sd_stats(wpa_s, reply, reply_size);
 	} else if (os_strncmp(buf, "P2P_SERVICE_ADD ", 16) == 0) {
 		if (p2p_ctrl_service_add(wpa_s, buf + 16) < 0)
 			reply_len = -1;
@@ -11826,6 +11835,8 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strcmp(buf, "STOP_FETCH_ANQP") == 0) {
 		interworking_stop_fetch_anqp(wpa_s);
+	} else if (os_strcmp(buf, "ANQP_STATS") == 0) {
+		reply_len = interworking_anqp_stats(wpa_s, reply, reply_size);
 	} else if (os_strcmp(buf, "INTERWORKING_SELECT") == 0) {
 		if (ctrl_interworking_select(wpa_s, NULL) < 0)
 			reply_len = -1;
@@ -12694,6 +12705,7 @@ static char * wpas_global_ctrl_iface_redir_p2p(struct wpa_global *global,
 		"P2P_GET_PASSPHRASE",
 		"P2P_SERVICE_UPDATE",
 		"P2P_SERVICE_FLUSH",
+		"P2P_SERVICE_STATS",
 		"P2P_FLUSH",
 		"P2P_CANCEL",
 		"P2P_PRESENCE_REQ",
@@ -13097,6 +13109,12 @@ char * wpa_supplicant_global_ctrl_iface_process(struct wpa_global *global,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_PROFILE
+	} else if (os_strcmp(buf, "ELOOP_PROFILE") == 0) {
+		reply_len = eloop_profile_dump(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_PROFILE RESET") == 0) {
+		eloop_profile_reset();
+#endif /* CONFIG_ELOOP_PROFILE */
 	} else {
 		os_memcpy(reply, "UNKNOWN COMMAND\n", 16);
 		reply_len = 16;
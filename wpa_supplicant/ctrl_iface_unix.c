@@ -101,9 +101,33 @@ static void wpas_ctrl_sock_debug(const char *title, int sock, const char *buf,
 
 static int wpa_supplicant_ctrl_iface_attach(struct dl_list *ctrl_dst,
 					    struct sockaddr_storage *from,
-					    socklen_t fromlen, int global)
+					    socklen_t fromlen, int global,
+					    const char *input)
 {
-	return ctrl_iface_attach(ctrl_dst, from, fromlen, NULL);
+	return ctrl_iface_attach(ctrl_dst, from, fromlen, input);
+}
+
+
+static char * wpa_supplicant_ctrl_iface_monitor_stats(struct dl_list *ctrl_dst,
+						      size_t *resp_len)
+{
+	const size_t buflen = 4096;
+	char *buf;
+	int res;
+
+	buf = os_malloc(buflen);
+	if (!buf) {
+		*resp_len = 1;
+		return NULL;
+	}
+	res = ctrl_iface_monitor_stats(ctrl_dst, buf, buflen);
+	if (res < 0) {
+		os_free(buf);
+		*resp_len = 1;
+		return NULL;
+	}
+	*resp_len = res;
+	return buf;
 }
 
 
@@ -157,14 +181,20 @@ static void wpa_supplicant_ctrl_iface_receive(int sock, void *eloop_ctx,
 	}
 	buf[res] = '\0';
 
-	if (os_strcmp(buf, "ATTACH") == 0) {
+	if (os_strcmp(buf, "ATTACH") == 0 ||
+	    os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst, &from,
-						     fromlen, 0))
+						     fromlen, 0,
+						     buf[6] ? buf + 7 : NULL))
 			reply_len = 1;
 		else {
 			new_attached = 1;
 			reply_len = 2;
 		}
+	} else if (os_strcmp(buf, "MONITOR_STATS") == 0) {
+		reply_buf = wpa_supplicant_ctrl_iface_monitor_stats(
+			&priv->ctrl_dst, &reply_len);
+		reply = reply_buf;
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (wpa_supplicant_ctrl_iface_detach(&priv->ctrl_dst, &from,
 						     fromlen))
@@ -406,7 +436,8 @@ static void wpas_ctrl_msg_queue(struct dl_list *queue,
 
 
 static void wpas_ctrl_msg_queue_limit(unsigned int throttle_count,
-				      struct dl_list *queue)
+				      struct dl_list *queue,
+				      struct dl_list *ctrl_dst)
 {
 	struct ctrl_iface_msg *msg;
 
@@ -416,6 +447,8 @@ static void wpas_ctrl_msg_queue_limit(unsigned int throttle_count,
 	msg = dl_list_first(queue, struct ctrl_iface_msg, list);
 	if (msg) {
 		wpa_printf(MSG_DEBUG, "CTRL: Dropped oldest pending message");
+		ctrl_iface_event_lost(ctrl_dst, msg->level, msg->txt,
+				      msg->len);
 		dl_list_del(&msg->list);
 		os_free(msg);
 	}
@@ -446,7 +479,8 @@ static void wpa_supplicant_ctrl_iface_msg_cb(void *ctx, int level,
 			}
 			gpriv->throttle_count++;
 			wpas_ctrl_msg_queue_limit(gpriv->throttle_count,
-						  &gpriv->msg_queue);
+						  &gpriv->msg_queue,
+						  &gpriv->ctrl_dst);
 			wpas_ctrl_msg_queue(&gpriv->msg_queue, wpa_s, level,
 					    type, txt, len);
 		} else {
@@ -477,7 +511,8 @@ static void wpa_supplicant_ctrl_iface_msg_cb(void *ctx, int level,
 			}
 			priv->throttle_count++;
 			wpas_ctrl_msg_queue_limit(priv->throttle_count,
-						  &priv->msg_queue);
+						  &priv->msg_queue,
+						  &priv->ctrl_dst);
 			wpas_ctrl_msg_queue(&priv->msg_queue, wpa_s, level,
 					    type, txt, len);
 		} else {
@@ -832,7 +867,6 @@ wpas_global_ctrl_iface_flush_queued_msg(struct wpa_global *global,
 void wpa_supplicant_ctrl_iface_deinit(struct wpa_supplicant *wpa_s,
 				      struct ctrl_iface_priv *priv)
 {
-	struct wpa_ctrl_dst *dst, *prev;
 	struct ctrl_iface_msg *msg, *prev_msg;
 	struct ctrl_iface_global_priv *gpriv;
 
@@ -850,6 +884,7 @@ void wpa_supplicant_ctrl_iface_deinit(struct wpa_supplicant *wpa_s,
 		char *fname;
 		char *buf, *dir = NULL;
 		eloop_unregister_read_sock(priv->sock);
+		ctrl_iface_flush_batches(&priv->sock, &priv->ctrl_dst);
 		if (!dl_list_empty(&priv->ctrl_dst)) {
 			/*
 			 * Wait before closing the control socket if
@@ -897,11 +932,7 @@ void wpa_supplicant_ctrl_iface_deinit(struct wpa_supplicant *wpa_s,
 	}
 
 free_dst:
-	dl_list_for_each_safe(dst, prev, &priv->ctrl_dst, struct wpa_ctrl_dst,
-			      list) {
-		dl_list_del(&dst->list);
-		os_free(dst);
-	}
+	ctrl_iface_free_dsts(&priv->ctrl_dst);
 	dl_list_for_each_safe(msg, prev_msg, &priv->msg_queue,
 			      struct ctrl_iface_msg, list) {
 		dl_list_del(&msg->list);
@@ -947,6 +978,7 @@ static void wpa_supplicant_ctrl_iface_send(struct wpa_supplicant *wpa_s,
 	int idx, res;
 	struct msghdr msg;
 	struct iovec io[5];
+	int *sockp = priv ? &priv->sock : (gp ? &gp->sock : NULL);
 
 	if (sock < 0 || dl_list_empty(ctrl_dst))
 		return;
@@ -980,9 +1012,16 @@ static void wpa_supplicant_ctrl_iface_send(struct wpa_supplicant *wpa_s,
 		int _errno;
 		char txt[200];
 
-		if (level < dst->debug_level)
+		if (level < dst->debug_level ||
+		    !ctrl_iface_event_filter(dst, buf, len))
 			continue;
 
+		if (dst->batch && sockp) {
+			ctrl_iface_batch_event(sockp, ctrl_dst, dst, io, idx);
+			continue;
+		}
+
+		dst->seq++;
 		msg.msg_name = (void *) &dst->addr;
 		msg.msg_namelen = dst->addrlen;
 		wpas_ctrl_sock_debug("ctrl_sock-sendmsg", sock, buf, len);
@@ -990,11 +1029,13 @@ static void wpa_supplicant_ctrl_iface_send(struct wpa_supplicant *wpa_s,
 			sockaddr_print(MSG_MSGDUMP,
 				       "CTRL_IFACE monitor sent successfully to",
 				       &dst->addr, dst->addrlen);
+			dst->sent++;
 			dst->errors = 0;
 			continue;
 		}
 
 		_errno = errno;
+		dst->lost++;
 		os_snprintf(txt, sizeof(txt), "CTRL_IFACE monitor: %d (%s) for",
 			    _errno, strerror(_errno));
 		sockaddr_print(MSG_DEBUG, txt, &dst->addr, dst->addrlen);
@@ -1060,7 +1101,7 @@ void wpa_supplicant_ctrl_iface_wait(struct ctrl_iface_priv *priv)
 			/* handle ATTACH signal of first monitor interface */
 			if (!wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst,
 							      &from, fromlen,
-							      0)) {
+							      0, NULL)) {
 				if (sendto(priv->sock, "OK\n", 3, 0,
 					   (struct sockaddr *) &from, fromlen) <
 				    0) {
@@ -1122,12 +1163,18 @@ static void wpa_supplicant_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	}
 	buf[res] = '\0';
 
-	if (os_strcmp(buf, "ATTACH") == 0) {
+	if (os_strcmp(buf, "ATTACH") == 0 ||
+	    os_strncmp(buf, "ATTACH ", 7) == 0) {
 		if (wpa_supplicant_ctrl_iface_attach(&priv->ctrl_dst, &from,
-						     fromlen, 1))
+						     fromlen, 1,
+						     buf[6] ? buf + 7 : NULL))
 			reply_len = 1;
 		else
 			reply_len = 2;
+	} else if (os_strcmp(buf, "MONITOR_STATS") == 0) {
+		reply_buf = wpa_supplicant_ctrl_iface_monitor_stats(
+			&priv->ctrl_dst, &reply_len);
+		reply = reply_buf;
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (wpa_supplicant_ctrl_iface_detach(&priv->ctrl_dst, &from,
 						     fromlen))
@@ -1408,20 +1455,16 @@ static int wpas_ctrl_iface_global_reinit(struct wpa_global *global,
 void
 wpa_supplicant_global_ctrl_iface_deinit(struct ctrl_iface_global_priv *priv)
 {
-	struct wpa_ctrl_dst *dst, *prev;
 	struct ctrl_iface_msg *msg, *prev_msg;
 
 	if (priv->sock >= 0) {
 		eloop_unregister_read_sock(priv->sock);
+		ctrl_iface_flush_batches(&priv->sock, &priv->ctrl_dst);
 		close(priv->sock);
 	}
 	if (priv->global->params.ctrl_interface)
 		unlink(priv->global->params.ctrl_interface);
-	dl_list_for_each_safe(dst, prev, &priv->ctrl_dst, struct wpa_ctrl_dst,
-			      list) {
-		dl_list_del(&dst->list);
-		os_free(dst);
-	}
+	ctrl_iface_free_dsts(&priv->ctrl_dst);
 	dl_list_for_each_safe(msg, prev_msg, &priv->msg_queue,
 			      struct ctrl_iface_msg, list) {
 		dl_list_del(&msg->list);
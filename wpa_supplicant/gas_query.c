@@ -30,11 +30,22 @@
 #define GAS_QUERY_WAIT_TIME_INITIAL 1000
 #define GAS_QUERY_WAIT_TIME_COMEBACK 150
 
+/**
+ * struct gas_query_frag - Received Query Response fragment
+ *
+ * The fragment data follows this structure in the same allocation.
+ */
+struct gas_query_frag {
+	struct gas_query_frag *next;
+	size_t len;
+};
+
 /**
  * struct gas_query_pending - Pending GAS query
  */
 struct gas_query_pending {
 	struct dl_list list;
+	struct gas_query_pending *hnext; /* next entry in gas->pending_hash */
 	struct gas_query *gas;
 	u8 addr[ETH_ALEN];
 	u8 dialog_token;
@@ -49,6 +60,11 @@ struct gas_query_pending {
 	struct wpabuf *req;
 	struct wpabuf *adv_proto;
 	struct wpabuf *resp;
+	/* Query Response fragments received so far; these are combined into
+	 * resp only once the query has been completed */
+	struct gas_query_frag *frags;
+	struct gas_query_frag **frags_tail;
+	size_t frags_len;
 	struct os_reltime last_oper;
 	void (*cb)(void *ctx, const u8 *dst, u8 dialog_token,
 		   enum gas_query_result result,
@@ -64,6 +80,11 @@ struct gas_query_pending {
 struct gas_query {
 	struct wpa_supplicant *wpa_s;
 	struct dl_list pending; /* struct gas_query_pending */
+#define GAS_QUERY_HASH_SIZE 64
+#define GAS_QUERY_HASH(addr, dialog_token) \
+	(((addr)[5] ^ (dialog_token)) & (GAS_QUERY_HASH_SIZE - 1))
+	/* Pending queries hashed by peer address and dialog token */
+	struct gas_query_pending *pending_hash[GAS_QUERY_HASH_SIZE];
 	struct gas_query_pending *current;
 	struct wpa_radio_work *work;
 	struct os_reltime last_mac_addr_rand;
@@ -133,12 +154,58 @@ static const char * gas_result_txt(enum gas_query_result result)
 }
 
 
+static void gas_query_hash_add(struct gas_query *gas,
+			       struct gas_query_pending *query)
+{
+	unsigned int idx = GAS_QUERY_HASH(query->addr, query->dialog_token);
+
+	query->hnext = gas->pending_hash[idx];
+	gas->pending_hash[idx] = query;
+}
+
+
+static void gas_query_hash_del(struct gas_query *gas,
+			       struct gas_query_pending *query)
+{
+	struct gas_query_pending **pos;
+
+	pos = &gas->pending_hash[GAS_QUERY_HASH(query->addr,
+						query->dialog_token)];
+	while (*pos && *pos != query)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = query->hnext;
+}
+
+
+static void gas_query_unlink(struct gas_query *gas,
+			     struct gas_query_pending *query)
+{
+	gas_query_hash_del(gas, query);
+	dl_list_del(&query->list);
+}
+
+
+static void gas_query_free_frags(struct gas_query_pending *query)
+{
+	struct gas_query_frag *frag, *next;
+
+	for (frag = query->frags; frag; frag = next) {
+		next = frag->next;
+		os_free(frag);
+	}
+	query->frags = NULL;
+	query->frags_tail = &query->frags;
+	query->frags_len = 0;
+}
+
+
 static void gas_query_free(struct gas_query_pending *query, int del_list)
 {
 	struct gas_query *gas = query->gas;
 
 	if (del_list)
-		dl_list_del(&query->list);
+		gas_query_unlink(gas, query);
 
 	if (gas->work && gas->work->ctx == query) {
 		radio_work_done(gas->work);
@@ -148,10 +215,32 @@ static void gas_query_free(struct gas_query_pending *query, int del_list)
 	wpabuf_free(query->req);
 	wpabuf_free(query->adv_proto);
 	wpabuf_free(query->resp);
+	gas_query_free_frags(query);
 	os_free(query);
 }
 
 
+/* Combine the received fragments into a single Query Response buffer */
+static int gas_query_linearize(struct gas_query_pending *query)
+{
+	struct gas_query_frag *frag;
+
+	if (!query->frags)
+		return 0;
+
+	query->resp = wpabuf_alloc(query->frags_len);
+	if (!query->resp) {
+		wpa_printf(MSG_DEBUG, "GAS: No memory to store the response");
+		gas_query_free_frags(query);
+		return -1;
+	}
+	for (frag = query->frags; frag; frag = frag->next)
+		wpabuf_put_data(query->resp, frag + 1, frag->len);
+	gas_query_free_frags(query);
+	return 0;
+}
+
+
 static void gas_query_done(struct gas_query *gas,
 			   struct gas_query_pending *query,
 			   enum gas_query_result result)
@@ -167,7 +256,9 @@ static void gas_query_done(struct gas_query *gas,
 	eloop_cancel_timeout(gas_query_tx_comeback_timeout, gas, query);
 	eloop_cancel_timeout(gas_query_timeout, gas, query);
 	eloop_cancel_timeout(gas_query_rx_comeback_timeout, gas, query);
-	dl_list_del(&query->list);
+	gas_query_unlink(gas, query);
+	if (gas_query_linearize(query) < 0 && result == GAS_QUERY_SUCCESS)
+		result = GAS_QUERY_INTERNAL_ERROR;
 	query->cb(query->ctx, query->addr, query->dialog_token, result,
 		  query->adv_proto, query->resp, query->status_code);
 	gas_query_free(query, 0);
@@ -197,7 +288,9 @@ static struct gas_query_pending *
 gas_query_get_pending(struct gas_query *gas, const u8 *addr, u8 dialog_token)
 {
 	struct gas_query_pending *q;
-	dl_list_for_each(q, &gas->pending, struct gas_query_pending, list) {
+
+	for (q = gas->pending_hash[GAS_QUERY_HASH(addr, dialog_token)]; q;
+	     q = q->hnext) {
 		if (os_memcmp(q->addr, addr, ETH_ALEN) == 0 &&
 		    q->dialog_token == dialog_token)
 			return q;
@@ -209,11 +302,24 @@ gas_query_get_pending(struct gas_query *gas, const u8 *addr, u8 dialog_token)
 static int gas_query_append(struct gas_query_pending *query, const u8 *data,
 			    size_t len)
 {
-	if (wpabuf_resize(&query->resp, len) < 0) {
+	struct gas_query_frag *frag;
+
+	/* Store each fragment as-is and combine them only once the last one
+	 * has been received instead of reallocating the response buffer for
+	 * every Comeback Response. An empty fragment is kept as well so that
+	 * an empty Query Response is reported as an empty buffer. */
+	frag = os_malloc(sizeof(*frag) + len);
+	if (!frag) {
 		wpa_printf(MSG_DEBUG, "GAS: No memory to store the response");
 		return -1;
 	}
-	wpabuf_put_data(query->resp, data, len);
+	frag->next = NULL;
+	frag->len = len;
+	if (len)
+		os_memcpy(frag + 1, data, len);
+	*query->frags_tail = frag;
+	query->frags_tail = &frag->next;
+	query->frags_len += len;
 	return 0;
 }
 
@@ -356,10 +462,13 @@ static void gas_query_rx_comeback_timeout(void *eloop_data, void *user_ctx)
 	wpa_printf(MSG_DEBUG,
 		   "GAS: Retry GAS query due to comeback response timeout");
 	query->retry = 1;
+	gas_query_hash_del(gas, query);
 	query->dialog_token = dialog_token;
+	gas_query_hash_add(gas, query);
 	*(wpabuf_mhead_u8(query->req) + 2) = dialog_token;
 	query->wait_comeback = 0;
 	query->next_frag_id = 0;
+	gas_query_free_frags(query);
 	wpabuf_free(query->adv_proto);
 	query->adv_proto = NULL;
 	eloop_cancel_timeout(gas_query_tx_comeback_timeout, gas, query);
@@ -656,14 +765,7 @@ static void gas_query_timeout(void *eloop_data, void *user_ctx)
 static int gas_query_dialog_token_available(struct gas_query *gas,
 					    const u8 *dst, u8 dialog_token)
 {
-	struct gas_query_pending *q;
-	dl_list_for_each(q, &gas->pending, struct gas_query_pending, list) {
-		if (os_memcmp(dst, q->addr, ETH_ALEN) == 0 &&
-		    dialog_token == q->dialog_token)
-			return 0;
-	}
-
-	return 1;
+	return gas_query_get_pending(gas, dst, dialog_token) == NULL;
 }
 
 
@@ -854,7 +956,9 @@ int gas_query_req(struct gas_query *gas, const u8 *dst, int freq,
 	query->cb = cb;
 	query->ctx = ctx;
 	query->req = req;
+	query->frags_tail = &query->frags;
 	dl_list_add(&gas->pending, &query->list);
+	gas_query_hash_add(gas, query);
 
 	*(wpabuf_mhead_u8(req) + 2) = dialog_token;
 
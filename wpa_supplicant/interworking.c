@@ -46,6 +46,8 @@
 #endif
 
 static void interworking_next_anqp_fetch(struct wpa_supplicant *wpa_s);
+static void interworking_anqp_cache_add(struct wpa_supplicant *wpa_s,
+					struct wpa_bss *bss);
 static struct wpa_cred * interworking_credentials_available_realm(
 	struct wpa_supplicant *wpa_s, struct wpa_bss *bss, int ignore_bw,
 	int *excluded);
@@ -129,12 +131,28 @@ static void interworking_anqp_resp_cb(void *ctx, const u8 *dst,
 				      u16 status_code)
 {
 	struct wpa_supplicant *wpa_s = ctx;
+	struct wpa_bss *bss;
 
 	wpa_printf(MSG_DEBUG, "ANQP: Response callback dst=" MACSTR
 		   " dialog_token=%u result=%d status_code=%u",
 		   MAC2STR(dst), dialog_token, result, status_code);
 	anqp_resp_cb(wpa_s, dst, dialog_token, result, adv_proto, resp,
 		     status_code);
+
+	if (wpa_s->anqp_fetch_pending)
+		wpa_s->anqp_fetch_pending--;
+	if (result != GAS_QUERY_SUCCESS)
+		wpa_s->anqp_stats.failures++;
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		if ((bss->flags & WPA_BSS_ANQP_FETCH_PENDING) &&
+		    os_memcmp(bss->bssid, dst, ETH_ALEN) == 0) {
+			bss->flags &= ~WPA_BSS_ANQP_FETCH_PENDING;
+			if (result == GAS_QUERY_SUCCESS)
+				interworking_anqp_cache_add(wpa_s, bss);
+			break;
+		}
+	}
+
 	interworking_next_anqp_fetch(wpa_s);
 }
 
@@ -1692,6 +1710,8 @@ int interworking_connect(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	wpa_printf(MSG_DEBUG, "Interworking: Considering BSS " MACSTR
 		   " for connection",
 		   MAC2STR(bss->bssid));
+	if (!only_add)
+		wpa_s->interworking_connect_timing = 1;
 
 	if (!wpa_bss_get_ie(bss, WLAN_EID_RSN)) {
 		/*
@@ -2613,6 +2633,157 @@ static void interworking_select_network(struct wpa_supplicant *wpa_s)
 }
 
 
+#define ANQP_CACHE_MAX_ENTRIES 64
+
+/**
+ * struct anqp_cache_entry - Cached ANQP response
+ *
+ * The cache holds a reference to the ANQP data of the BSS entry that was used
+ * for the query, so the data remains available after the BSS entry expires.
+ */
+struct anqp_cache_entry {
+	struct dl_list list;
+	u8 bssid[ETH_ALEN];
+	u8 hessid[ETH_ALEN];
+	u8 ssid[SSID_MAX_LEN];
+	size_t ssid_len;
+	int domain_id; /* ANQP Domain ID or -1 if not advertised */
+	bool all; /* all ANQP elements were requested */
+	struct os_reltime fetched;
+	struct wpa_bss_anqp *anqp;
+};
+
+
+/* Get the ANQP Domain ID from the Hotspot 2.0 Indication element */
+static int interworking_anqp_domain_id(struct wpa_bss *bss)
+{
+	const u8 *ie, *pos, *end;
+	u8 conf;
+
+	ie = wpa_bss_get_vendor_ie(bss, HS20_IE_VENDOR_TYPE);
+	if (!ie || ie[1] < 5)
+		return -1;
+	pos = ie + 6;
+	end = ie + 2 + ie[1];
+	conf = *pos++;
+	if (!(conf & HS20_ANQP_DOMAIN_ID_PRESENT))
+		return -1;
+	if (conf & HS20_PPS_MO_ID_PRESENT)
+		pos += 2;
+	if (end - pos < 2)
+		return -1;
+	return WPA_GET_LE16(pos);
+}
+
+
+static bool interworking_same_anqp_domain(struct wpa_bss *a, struct wpa_bss *b)
+{
+	int id_a, id_b;
+
+	if (is_zero_ether_addr(a->hessid) ||
+	    os_memcmp(a->hessid, b->hessid, ETH_ALEN) != 0)
+		return false;
+	if (a->ssid_len != b->ssid_len ||
+	    os_memcmp(a->ssid, b->ssid, a->ssid_len) != 0)
+		return false;
+
+	/* Different ANQP Domain IDs within the same ESS indicate different
+	 * ANQP information */
+	id_a = interworking_anqp_domain_id(a);
+	id_b = interworking_anqp_domain_id(b);
+	return id_a < 0 || id_b < 0 || id_a == id_b;
+}
+
+
+static void interworking_anqp_cache_del(struct wpa_supplicant *wpa_s,
+					struct anqp_cache_entry *entry)
+{
+	dl_list_del(&entry->list);
+	wpa_bss_anqp_free(entry->anqp);
+	os_free(entry);
+	wpa_s->anqp_cache_entries--;
+}
+
+
+static void interworking_anqp_cache_add(struct wpa_supplicant *wpa_s,
+					struct wpa_bss *bss)
+{
+	struct anqp_cache_entry *entry, *tmp;
+
+	if (!wpa_s->conf->anqp_cache_ttl || !bss->anqp)
+		return;
+
+	dl_list_for_each_safe(entry, tmp, &wpa_s->anqp_cache,
+			      struct anqp_cache_entry, list) {
+		if (os_memcmp(entry->bssid, bss->bssid, ETH_ALEN) == 0 &&
+		    entry->ssid_len == bss->ssid_len &&
+		    os_memcmp(entry->ssid, bss->ssid, bss->ssid_len) == 0)
+			interworking_anqp_cache_del(wpa_s, entry);
+	}
+
+	if (wpa_s->anqp_cache_entries >= ANQP_CACHE_MAX_ENTRIES) {
+		/* Remove the oldest entry */
+		entry = dl_list_last(&wpa_s->anqp_cache,
+				     struct anqp_cache_entry, list);
+		if (entry)
+			interworking_anqp_cache_del(wpa_s, entry);
+	}
+
+	entry = os_zalloc(sizeof(*entry));
+	if (!entry)
+		return;
+	os_memcpy(entry->bssid, bss->bssid, ETH_ALEN);
+	os_memcpy(entry->hessid, bss->hessid, ETH_ALEN);
+	os_memcpy(entry->ssid, bss->ssid, bss->ssid_len);
+	entry->ssid_len = bss->ssid_len;
+	entry->domain_id = interworking_anqp_domain_id(bss);
+	entry->all = wpa_s->fetch_all_anqp;
+	os_get_reltime(&entry->fetched);
+	entry->anqp = bss->anqp;
+	entry->anqp->users++;
+	dl_list_add(&wpa_s->anqp_cache, &entry->list);
+	wpa_s->anqp_cache_entries++;
+}
+
+
+static struct anqp_cache_entry *
+interworking_anqp_cache_get(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
+{
+	struct anqp_cache_entry *entry, *tmp;
+	struct os_reltime now;
+	int domain_id;
+
+	if (!wpa_s->conf->anqp_cache_ttl || dl_list_empty(&wpa_s->anqp_cache))
+		return NULL;
+
+	os_get_reltime(&now);
+	domain_id = interworking_anqp_domain_id(bss);
+	dl_list_for_each_safe(entry, tmp, &wpa_s->anqp_cache,
+			      struct anqp_cache_entry, list) {
+		if (os_reltime_expired(&now, &entry->fetched,
+				       wpa_s->conf->anqp_cache_ttl)) {
+			interworking_anqp_cache_del(wpa_s, entry);
+			continue;
+		}
+		if (wpa_s->fetch_all_anqp && !entry->all)
+			continue;
+		if (entry->ssid_len != bss->ssid_len ||
+		    os_memcmp(entry->ssid, bss->ssid, bss->ssid_len) != 0)
+			continue;
+		if (os_memcmp(entry->bssid, bss->bssid, ETH_ALEN) == 0)
+			return entry;
+		/* ANQP Domain ID 0 indicates that some of the ANQP
+		 * information is unique to the AP */
+		if (!is_zero_ether_addr(bss->hessid) &&
+		    os_memcmp(entry->hessid, bss->hessid, ETH_ALEN) == 0 &&
+		    domain_id > 0 && entry->domain_id == domain_id)
+			return entry;
+	}
+
+	return NULL;
+}
+
+
 static struct wpa_bss_anqp *
 interworking_match_anqp_info(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 {
@@ -2633,10 +2804,7 @@ interworking_match_anqp_info(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 			continue;
 		if (!(other->flags & WPA_BSS_ANQP_FETCH_TRIED))
 			continue;
-		if (os_memcmp(bss->hessid, other->hessid, ETH_ALEN) != 0)
-			continue;
-		if (bss->ssid_len != other->ssid_len ||
-		    os_memcmp(bss->ssid, other->ssid, bss->ssid_len) != 0)
+		if (!interworking_same_anqp_domain(bss, other))
 			continue;
 
 		wpa_msg(wpa_s, MSG_DEBUG,
@@ -2651,15 +2819,104 @@ interworking_match_anqp_info(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 }
 
 
+/* Check whether a query to another BSS that will provide shared ANQP data for
+ * this BSS is in progress */
+static bool interworking_anqp_fetch_pending_domain(
+	struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
+{
+	struct wpa_bss *other;
+
+	if (is_zero_ether_addr(bss->hessid))
+		return false;
+
+	dl_list_for_each(other, &wpa_s->bss, struct wpa_bss, list) {
+		if (other != bss &&
+		    (other->flags & WPA_BSS_ANQP_FETCH_PENDING) &&
+		    interworking_same_anqp_domain(bss, other))
+			return true;
+	}
+
+	return false;
+}
+
+
+/* Returns: 1 if a query was started, 0 if not, or -1 on failure */
+static int interworking_anqp_fetch_bss(struct wpa_supplicant *wpa_s,
+				       struct wpa_bss *bss)
+{
+	struct anqp_cache_entry *entry;
+
+	if (!(bss->caps & IEEE80211_CAP_ESS))
+		return 0;
+	if (!wpa_bss_ext_capab(bss, WLAN_EXT_CAPAB_INTERWORKING))
+		return 0; /* AP does not support Interworking */
+	if (disallowed_bssid(wpa_s, bss->bssid) ||
+	    disallowed_ssid(wpa_s, bss->ssid, bss->ssid_len))
+		return 0; /* Disallowed BSS */
+	if (bss->flags & WPA_BSS_ANQP_FETCH_TRIED)
+		return 0;
+
+	entry = interworking_anqp_cache_get(wpa_s, bss);
+	if (entry) {
+		wpa_msg(wpa_s, MSG_DEBUG,
+			"Interworking: Use cached ANQP data from BSSID " MACSTR
+			" for " MACSTR,
+			MAC2STR(entry->bssid), MAC2STR(bss->bssid));
+		if (bss->anqp != entry->anqp) {
+			wpa_bss_anqp_free(bss->anqp);
+			bss->anqp = entry->anqp;
+			bss->anqp->users++;
+		}
+		bss->flags |= WPA_BSS_ANQP_FETCH_TRIED;
+		wpa_s->anqp_stats.cache_hits++;
+		return 0;
+	}
+
+	if (bss->anqp == NULL) {
+		bss->anqp = interworking_match_anqp_info(wpa_s, bss);
+		if (bss->anqp) {
+			/* Shared data already fetched */
+			wpa_s->anqp_stats.shared++;
+			return 0;
+		}
+		if (interworking_anqp_fetch_pending_domain(wpa_s, bss)) {
+			/* Wait for the response to share it */
+			return 0;
+		}
+		bss->anqp = wpa_bss_anqp_alloc();
+		if (bss->anqp == NULL)
+			return -1;
+	}
+
+	bss->flags |= WPA_BSS_ANQP_FETCH_TRIED;
+	wpa_msg(wpa_s, MSG_INFO, "Starting ANQP fetch for "
+		MACSTR " (HESSID " MACSTR ")",
+		MAC2STR(bss->bssid), MAC2STR(bss->hessid));
+	if (interworking_anqp_send_req(wpa_s, bss) < 0)
+		return 0;
+
+	bss->flags |= WPA_BSS_ANQP_FETCH_PENDING;
+	wpa_s->anqp_fetch_freq = bss->freq;
+	wpa_s->anqp_fetch_pending++;
+	if (wpa_s->anqp_fetch_pending > wpa_s->anqp_stats.max_pending)
+		wpa_s->anqp_stats.max_pending = wpa_s->anqp_fetch_pending;
+	wpa_s->anqp_stats.queries++;
+	return 1;
+}
+
+
 static void interworking_next_anqp_fetch(struct wpa_supplicant *wpa_s)
 {
 	struct wpa_bss *bss;
-	int found = 0;
+	struct os_reltime age;
+	unsigned int max_pending;
+	int pass;
 
 	wpa_printf(MSG_DEBUG, "Interworking: next_anqp_fetch - "
-		   "fetch_anqp_in_progress=%d fetch_osu_icon_in_progress=%d",
+		   "fetch_anqp_in_progress=%d fetch_osu_icon_in_progress=%d pending=%u",
 		   wpa_s->fetch_anqp_in_progress,
-		   wpa_s->fetch_osu_icon_in_progress);
+		   wpa_s->fetch_osu_icon_in_progress,
+		   wpa_s->anqp_fetch_pending);
 
 	if (eloop_terminated() || !wpa_s->fetch_anqp_in_progress) {
 		wpa_printf(MSG_DEBUG, "Interworking: Stop next-ANQP-fetch");
@@ -2674,57 +2931,48 @@ static void interworking_next_anqp_fetch(struct wpa_supplicant *wpa_s)
 	}
 #endif /* CONFIG_HS20 */
 
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
-		if (!(bss->caps & IEEE80211_CAP_ESS))
-			continue;
-		if (!wpa_bss_ext_capab(bss, WLAN_EXT_CAPAB_INTERWORKING))
-			continue; /* AP does not support Interworking */
-		if (disallowed_bssid(wpa_s, bss->bssid) ||
-		    disallowed_ssid(wpa_s, bss->ssid, bss->ssid_len))
-			continue; /* Disallowed BSS */
-
-		if (!(bss->flags & WPA_BSS_ANQP_FETCH_TRIED)) {
-			if (bss->anqp == NULL) {
-				bss->anqp = interworking_match_anqp_info(wpa_s,
-									 bss);
-				if (bss->anqp) {
-					/* Shared data already fetched */
-					continue;
-				}
-				bss->anqp = wpa_bss_anqp_alloc();
-				if (bss->anqp == NULL)
-					break;
+	/*
+	 * Queue queries for BSSes on the same channel as the previous query
+	 * first to reduce the number of channel switches.
+	 */
+	max_pending = wpa_s->conf->anqp_max_parallel;
+	for (pass = 0; pass < 2; pass++) {
+		dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+			if (wpa_s->anqp_fetch_pending >= max_pending)
+				return;
+			if (pass == 0 && bss->freq != wpa_s->anqp_fetch_freq)
+				continue;
+			if (interworking_anqp_fetch_bss(wpa_s, bss) < 0) {
+				pass = 2;
+				break;
 			}
-			found++;
-			bss->flags |= WPA_BSS_ANQP_FETCH_TRIED;
-			wpa_msg(wpa_s, MSG_INFO, "Starting ANQP fetch for "
-				MACSTR " (HESSID " MACSTR ")",
-				MAC2STR(bss->bssid), MAC2STR(bss->hessid));
-			interworking_anqp_send_req(wpa_s, bss);
-			break;
 		}
 	}
 
-	if (found == 0) {
+	if (wpa_s->anqp_fetch_pending)
+		return;
+
 #ifdef CONFIG_HS20
-		if (wpa_s->fetch_osu_info) {
-			if (wpa_s->num_prov_found == 0 &&
-			    wpa_s->fetch_osu_waiting_scan &&
-			    wpa_s->num_osu_scans < 3) {
-				wpa_printf(MSG_DEBUG, "HS 2.0: No OSU providers seen - try to scan again");
-				hs20_start_osu_scan(wpa_s);
-				return;
-			}
-			wpa_printf(MSG_DEBUG, "Interworking: Next icon");
-			hs20_osu_icon_fetch(wpa_s);
+	if (wpa_s->fetch_osu_info) {
+		if (wpa_s->num_prov_found == 0 &&
+		    wpa_s->fetch_osu_waiting_scan &&
+		    wpa_s->num_osu_scans < 3) {
+			wpa_printf(MSG_DEBUG, "HS 2.0: No OSU providers seen - try to scan again");
+			hs20_start_osu_scan(wpa_s);
 			return;
 		}
-#endif /* CONFIG_HS20 */
-		wpa_msg(wpa_s, MSG_INFO, "ANQP fetch completed");
-		wpa_s->fetch_anqp_in_progress = 0;
-		if (wpa_s->network_select)
-			interworking_select_network(wpa_s);
+		wpa_printf(MSG_DEBUG, "Interworking: Next icon");
+		hs20_osu_icon_fetch(wpa_s);
+		return;
 	}
+#endif /* CONFIG_HS20 */
+	os_reltime_age(&wpa_s->anqp_fetch_start, &age);
+	wpa_s->anqp_stats.last_fetch_usec = age.sec * 1000000ULL + age.usec;
+	wpa_s->anqp_stats.total_fetch_usec += wpa_s->anqp_stats.last_fetch_usec;
+	wpa_msg(wpa_s, MSG_INFO, "ANQP fetch completed");
+	wpa_s->fetch_anqp_in_progress = 0;
+	if (wpa_s->network_select)
+		interworking_select_network(wpa_s);
 }
 
 
@@ -2732,10 +2980,19 @@ void interworking_start_fetch_anqp(struct wpa_supplicant *wpa_s)
 {
 	struct wpa_bss *bss;
 
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list)
-		bss->flags &= ~WPA_BSS_ANQP_FETCH_TRIED;
+	/*
+	 * Queries from an earlier fetch may still be in progress. Their
+	 * response callbacks decrement anqp_fetch_pending and the responses
+	 * are used for this fetch, so those BSSes are not queried again.
+	 */
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		if (!(bss->flags & WPA_BSS_ANQP_FETCH_PENDING))
+			bss->flags &= ~WPA_BSS_ANQP_FETCH_TRIED;
+	}
 
 	wpa_s->fetch_anqp_in_progress = 1;
+	wpa_s->anqp_stats.fetches++;
+	os_get_reltime(&wpa_s->anqp_fetch_start);
 
 	/*
 	 * Start actual ANQP operation from eloop call to make sure the loop
@@ -2769,6 +3026,113 @@ void interworking_stop_fetch_anqp(struct wpa_supplicant *wpa_s)
 }
 
 
+/**
+ * interworking_connection_completed - Record Interworking connection time
+ * @wpa_s: Pointer to wpa_supplicant data
+ *
+ * This is called when a connection is completed to update the time from the
+ * start of network selection and ANQP fetch to connection for connections
+ * that were started with interworking_connect().
+ */
+void interworking_connection_completed(struct wpa_supplicant *wpa_s)
+{
+	struct os_reltime age;
+
+	if (!wpa_s->interworking_connect_timing)
+		return;
+	wpa_s->interworking_connect_timing = 0;
+	if (!wpa_s->current_ssid || !wpa_s->current_ssid->parent_cred)
+		return;
+
+	if (os_reltime_initialized(&wpa_s->anqp_select_start)) {
+		os_reltime_age(&wpa_s->anqp_select_start, &age);
+		wpa_s->anqp_stats.select_to_connect_usec =
+			age.sec * 1000000ULL + age.usec;
+		wpa_s->anqp_select_start.sec = 0;
+		wpa_s->anqp_select_start.usec = 0;
+	}
+	if (os_reltime_initialized(&wpa_s->anqp_fetch_start)) {
+		os_reltime_age(&wpa_s->anqp_fetch_start, &age);
+		wpa_s->anqp_stats.fetch_to_connect_usec =
+			age.sec * 1000000ULL + age.usec;
+	}
+}
+
+
+/**
+ * interworking_anqp_stats - Write ANQP fetch statistics into a text buffer
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written into the buffer
+ */
+int interworking_anqp_stats(struct wpa_supplicant *wpa_s, char *buf,
+			    size_t buflen)
+{
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "fetches=%u\n"
+			  "queries=%u\n"
+			  "failures=%u\n"
+			  "shared=%u\n"
+			  "cache_hits=%u\n"
+			  "cache_entries=%u\n"
+			  "pending=%u\n"
+			  "max_pending=%u\n"
+			  "last_fetch_usec=%llu\n"
+			  "total_fetch_usec=%llu\n"
+			  "select_to_connect_usec=%llu\n"
+			  "fetch_to_connect_usec=%llu\n",
+			  wpa_s->anqp_stats.fetches,
+			  wpa_s->anqp_stats.queries,
+			  wpa_s->anqp_stats.failures,
+			  wpa_s->anqp_stats.shared,
+			  wpa_s->anqp_stats.cache_hits,
+			  wpa_s->anqp_cache_entries,
+			  wpa_s->anqp_fetch_pending,
+			  wpa_s->anqp_stats.max_pending,
+			  wpa_s->anqp_stats.last_fetch_usec,
+			  wpa_s->anqp_stats.total_fetch_usec,
+			  wpa_s->anqp_stats.select_to_connect_usec,
+			  wpa_s->anqp_stats.fetch_to_connect_usec);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
+/**
+ * interworking_flush - Flush the ANQP cache and statistics
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void interworking_flush(struct wpa_supplicant *wpa_s)
+{
+	struct anqp_cache_entry *entry;
+
+	while ((entry = dl_list_first(&wpa_s->anqp_cache,
+				      struct anqp_cache_entry, list)))
+		interworking_anqp_cache_del(wpa_s, entry);
+	os_memset(&wpa_s->anqp_stats, 0, sizeof(wpa_s->anqp_stats));
+	wpa_s->interworking_connect_timing = 0;
+}
+
+
+void interworking_init(struct wpa_supplicant *wpa_s)
+{
+	dl_list_init(&wpa_s->anqp_cache);
+}
+
+
+void interworking_deinit(struct wpa_supplicant *wpa_s)
+{
+	wpa_s->fetch_anqp_in_progress = 0;
+	eloop_cancel_timeout(interworking_continue_anqp, wpa_s, NULL);
+	if (wpa_s->anqp_cache.next)
+		interworking_flush(wpa_s);
+}
+
+
 int anqp_send_req(struct wpa_supplicant *wpa_s, const u8 *dst, int freq,
 		  u16 info_ids[], size_t num_ids, u32 subtypes,
 		  u32 mbo_subtypes)
@@ -3127,7 +3491,8 @@ void anqp_resp_cb(void *ctx, const u8 *dst, u8 dialog_token,
 	 * may exist for the same AP.
 	 */
 	dl_list_for_each_reverse(tmp, &wpa_s->bss, struct wpa_bss, list) {
-		if (tmp == wpa_s->interworking_gas_bss &&
+		if ((tmp == wpa_s->interworking_gas_bss ||
+		     (tmp->flags & WPA_BSS_ANQP_FETCH_PENDING)) &&
 		    os_memcmp(tmp->bssid, dst, ETH_ALEN) == 0) {
 			bss = tmp;
 			break;
@@ -3192,6 +3557,7 @@ int interworking_select(struct wpa_supplicant *wpa_s, int auto_select,
 	wpa_s->auto_select = !!auto_select;
 	wpa_s->fetch_all_anqp = 0;
 	wpa_s->fetch_osu_info = 0;
+	os_get_reltime(&wpa_s->anqp_select_start);
 	wpa_msg(wpa_s, MSG_DEBUG,
 		"Interworking: Start scan for network selection");
 	wpa_s->scan_res_handler = interworking_scan_res_handler;
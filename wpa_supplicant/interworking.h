@@ -33,5 +33,11 @@ int interworking_home_sp_cred(struct wpa_supplicant *wpa_s,
 			      struct wpabuf *domain_names);
 int domain_name_list_contains(struct wpabuf *domain_names,
 			      const char *domain, int exact_match);
+void interworking_connection_completed(struct wpa_supplicant *wpa_s);
+int interworking_anqp_stats(struct wpa_supplicant *wpa_s, char *buf,
+			    size_t buflen);
+void interworking_flush(struct wpa_supplicant *wpa_s);
+void interworking_init(struct wpa_supplicant *wpa_s);
+void interworking_deinit(struct wpa_supplicant *wpa_s);
 
 #endif /* INTERWORKING_H */
@@ -166,12 +166,17 @@ static bool matches_local(struct wpa_supplicant *wpa_s,
 }
 
 
+#define MESH_LLID_MAP_WORDS (65536 / 32)
+
 /* check if local link id is already used with another peer */
 static bool llid_in_use(struct wpa_supplicant *wpa_s, u16 llid)
 {
 	struct sta_info *sta;
 	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
 
+	if (hapd->mesh_llid_map)
+		return !!(hapd->mesh_llid_map[llid / 32] & BIT(llid % 32));
+
 	for (sta = hapd->sta_list; sta; sta = sta->next) {
 		if (sta->my_lid == llid)
 			return true;
@@ -181,17 +186,43 @@ static bool llid_in_use(struct wpa_supplicant *wpa_s, u16 llid)
 }
 
 
+static void llid_release(struct hostapd_data *hapd, u16 llid)
+{
+	if (llid && hapd->mesh_llid_map)
+		hapd->mesh_llid_map[llid / 32] &= ~BIT(llid % 32);
+}
+
+
 /* generate an llid for a link and set to initial state */
 static void mesh_mpm_init_link(struct wpa_supplicant *wpa_s,
 			       struct sta_info *sta)
 {
+	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
+	struct sta_info *tmp;
 	u16 llid;
 
+	llid_release(hapd, sta->my_lid);
+	sta->my_lid = 0;
+
+	if (!hapd->mesh_llid_map) {
+		/* If this fails, llid_in_use() falls back to the STA list */
+		hapd->mesh_llid_map = os_calloc(MESH_LLID_MAP_WORDS,
+						sizeof(u32));
+		for (tmp = hapd->sta_list; hapd->mesh_llid_map && tmp;
+		     tmp = tmp->next) {
+			if (tmp->my_lid)
+				hapd->mesh_llid_map[tmp->my_lid / 32] |=
+					BIT(tmp->my_lid % 32);
+		}
+	}
+
 	do {
 		if (os_get_random((u8 *) &llid, sizeof(llid)) < 0)
 			llid = 0; /* continue */
 	} while (!llid || llid_in_use(wpa_s, llid));
 
+	if (hapd->mesh_llid_map)
+		hapd->mesh_llid_map[llid / 32] |= BIT(llid % 32);
 	sta->my_lid = llid;
 	sta->peer_lid = 0;
 	sta->peer_aid = 0;
@@ -1398,6 +1429,7 @@ void mesh_mpm_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	if (sta->plink_state == PLINK_ESTAB)
 		hapd->num_plinks--;
+	llid_release(hapd, sta->my_lid);
 	eloop_cancel_timeout(plink_timer, ELOOP_ALL_CTX, sta);
 	eloop_cancel_timeout(mesh_auth_timer, ELOOP_ALL_CTX, sta);
 }
@@ -364,11 +364,8 @@ int mesh_rsn_auth_sae_sta(struct wpa_supplicant *wpa_s,
 		return -1;
 	}
 
-	if (!sta->sae) {
-		sta->sae = os_zalloc(sizeof(*sta->sae));
-		if (sta->sae == NULL)
-			return -1;
-	}
+	if (!sta->sae && ap_sta_alloc_sae(sta) < 0)
+		return -1;
 
 	pmksa = wpa_auth_pmksa_get(hapd->wpa_auth, sta->addr, NULL);
 	if (pmksa) {
@@ -96,6 +96,7 @@ void wpas_p2p_sd_response(struct wpa_supplicant *wpa_s, int freq,
 			  const u8 *dst, u8 dialog_token,
 			  const struct wpabuf *resp_tlvs);
 void wpas_p2p_sd_service_update(struct wpa_supplicant *wpa_s);
+int wpas_p2p_sd_stats(struct wpa_supplicant *wpa_s, char *buf, size_t buflen);
 void wpas_p2p_service_flush(struct wpa_supplicant *wpa_s);
 int wpas_p2p_service_add_bonjour(struct wpa_supplicant *wpa_s,
 				 struct wpabuf *query, struct wpabuf *resp);
@@ -145,17 +145,55 @@ static int p2p_sd_dns_uncompress(char *buf, size_t buf_len, const u8 *msg,
 }
 
 
+/*
+ * Hash of a Bonjour query key. Queries that match each other (see
+ * match_bonjour_query()) have the same uncompressed DNS name and the same DNS
+ * Type and Version, so that is used as the key. A key that cannot be
+ * uncompressed can match only a binary identical key, so the raw name is used
+ * in that case.
+ */
+static u32 p2p_srv_bonjour_hash(const u8 *query, size_t query_len)
+{
+	char name[256];
+	const u8 *key;
+	size_t i, key_len;
+	u32 hash = 2166136261U;
+
+	if (query_len < 3) {
+		key = query;
+		key_len = query_len;
+	} else if (p2p_sd_dns_uncompress(name, sizeof(name), query,
+					 query_len - 3, 0) == 0) {
+		key = (const u8 *) name;
+		key_len = os_strlen(name);
+	} else {
+		key = query;
+		key_len = query_len - 3;
+	}
+
+	for (i = 0; i < key_len; i++)
+		hash = (hash ^ key[i]) * 16777619U;
+	for (i = query_len < 3 ? query_len : query_len - 3; i < query_len; i++)
+		hash = (hash ^ query[i]) * 16777619U;
+
+	return hash;
+}
+
+
 static struct p2p_srv_bonjour *
 wpas_p2p_service_get_bonjour(struct wpa_supplicant *wpa_s,
 			     const struct wpabuf *query)
 {
 	struct p2p_srv_bonjour *bsrv;
 	size_t len;
+	u32 hash;
 
 	len = wpabuf_len(query);
-	dl_list_for_each(bsrv, &wpa_s->global->p2p_srv_bonjour,
-			 struct p2p_srv_bonjour, list) {
-		if (len == wpabuf_len(bsrv->query) &&
+	hash = p2p_srv_bonjour_hash(wpabuf_head(query), len);
+	for (bsrv = wpa_s->global->p2p_srv_bonjour_hash[
+		     hash % P2P_SRV_BONJOUR_HASH_SIZE];
+	     bsrv; bsrv = bsrv->hnext) {
+		if (bsrv->hash == hash && len == wpabuf_len(bsrv->query) &&
 		    os_memcmp(wpabuf_head(query), wpabuf_head(bsrv->query),
 			      len) == 0)
 			return bsrv;
@@ -222,18 +260,37 @@ static void wpas_sd_add_not_found(struct wpabuf *resp, u8 srv_proto,
 }
 
 
-static void wpas_sd_all_bonjour(struct wpa_supplicant *wpa_s,
-				struct wpabuf *resp, u8 srv_trans_id)
+/*
+ * Add cached response TLVs using the requested Service Transaction ID. As when
+ * building the response, only the TLVs that fit completely in resp are added.
+ */
+static void wpas_sd_add_cached(struct wpa_supplicant *wpa_s,
+			       struct wpabuf *resp, const struct wpabuf *tlvs,
+			       u8 srv_trans_id)
 {
-	struct p2p_srv_bonjour *bsrv;
-	u8 *len_pos;
+	const u8 *pos = wpabuf_head(tlvs);
+	const u8 *end = pos + wpabuf_len(tlvs);
+	size_t tlv_len;
+	u8 *tlv;
+
+	wpa_s->global->p2p_sd_stats.cache_hits++;
+	while (end - pos >= 5) {
+		tlv_len = 2 + WPA_GET_LE16(pos);
+		if (wpabuf_tailroom(resp) < tlv_len)
+			break;
+		tlv = wpabuf_put(resp, tlv_len);
+		os_memcpy(tlv, pos, tlv_len);
+		tlv[3] = srv_trans_id;
+		pos += tlv_len;
+	}
+}
 
-	wpa_printf(MSG_DEBUG, "P2P: SD Request for all Bonjour services");
 
-	if (dl_list_empty(&wpa_s->global->p2p_srv_bonjour)) {
-		wpa_printf(MSG_DEBUG, "P2P: Bonjour protocol not available");
-		return;
-	}
+static void wpas_sd_build_all_bonjour(struct wpa_supplicant *wpa_s,
+				      struct wpabuf *resp, u8 srv_trans_id)
+{
+	struct p2p_srv_bonjour *bsrv;
+	u8 *len_pos;
 
 	dl_list_for_each(bsrv, &wpa_s->global->p2p_srv_bonjour,
 			 struct p2p_srv_bonjour, list) {
@@ -258,6 +315,40 @@ static void wpas_sd_all_bonjour(struct wpa_supplicant *wpa_s,
 }
 
 
+static void wpas_sd_all_bonjour(struct wpa_supplicant *wpa_s,
+				struct wpabuf *resp, u8 srv_trans_id)
+{
+	struct wpa_global *global = wpa_s->global;
+	struct p2p_srv_bonjour *bsrv;
+	size_t len = 0;
+
+	wpa_printf(MSG_DEBUG, "P2P: SD Request for all Bonjour services");
+
+	if (dl_list_empty(&global->p2p_srv_bonjour)) {
+		wpa_printf(MSG_DEBUG, "P2P: Bonjour protocol not available");
+		return;
+	}
+
+	if (!global->p2p_sd_all_bonjour) {
+		dl_list_for_each(bsrv, &global->p2p_srv_bonjour,
+				 struct p2p_srv_bonjour, list)
+			len += 5 + wpabuf_len(bsrv->query) +
+				wpabuf_len(bsrv->resp);
+		global->p2p_sd_all_bonjour = wpabuf_alloc(len);
+		if (!global->p2p_sd_all_bonjour) {
+			wpas_sd_build_all_bonjour(wpa_s, resp, srv_trans_id);
+			return;
+		}
+		wpas_sd_build_all_bonjour(wpa_s, global->p2p_sd_all_bonjour,
+					  0);
+		global->p2p_sd_stats.cache_builds++;
+	}
+
+	wpas_sd_add_cached(wpa_s, resp, global->p2p_sd_all_bonjour,
+			   srv_trans_id);
+}
+
+
 static int match_bonjour_query(struct p2p_srv_bonjour *bsrv, const u8 *query,
 			       size_t query_len)
 {
@@ -292,6 +383,7 @@ static void wpas_sd_req_bonjour(struct wpa_supplicant *wpa_s,
 	struct p2p_srv_bonjour *bsrv;
 	u8 *len_pos;
 	int matches = 0;
+	u32 hash;
 
 	wpa_hexdump_ascii(MSG_DEBUG, "P2P: SD Request for Bonjour",
 			  query, query_len);
@@ -307,9 +399,12 @@ static void wpas_sd_req_bonjour(struct wpa_supplicant *wpa_s,
 		return;
 	}
 
-	dl_list_for_each(bsrv, &wpa_s->global->p2p_srv_bonjour,
-			 struct p2p_srv_bonjour, list) {
-		if (!match_bonjour_query(bsrv, query, query_len))
+	hash = p2p_srv_bonjour_hash(query, query_len);
+	for (bsrv = wpa_s->global->p2p_srv_bonjour_hash[
+		     hash % P2P_SRV_BONJOUR_HASH_SIZE];
+	     bsrv; bsrv = bsrv->hnext) {
+		if (bsrv->hash != hash ||
+		    !match_bonjour_query(bsrv, query, query_len))
 			continue;
 
 		if (wpabuf_tailroom(resp) <
@@ -356,19 +451,12 @@ static void wpas_sd_req_bonjour(struct wpa_supplicant *wpa_s,
 }
 
 
-static void wpas_sd_all_upnp(struct wpa_supplicant *wpa_s,
-			     struct wpabuf *resp, u8 srv_trans_id)
+static void wpas_sd_build_all_upnp(struct wpa_supplicant *wpa_s,
+				   struct wpabuf *resp, u8 srv_trans_id)
 {
 	struct p2p_srv_upnp *usrv;
 	u8 *len_pos;
 
-	wpa_printf(MSG_DEBUG, "P2P: SD Request for all UPnP services");
-
-	if (dl_list_empty(&wpa_s->global->p2p_srv_upnp)) {
-		wpa_printf(MSG_DEBUG, "P2P: UPnP protocol not available");
-		return;
-	}
-
 	dl_list_for_each(usrv, &wpa_s->global->p2p_srv_upnp,
 			 struct p2p_srv_upnp, list) {
 		if (wpabuf_tailroom(resp) < 5 + 1 + os_strlen(usrv->service))
@@ -392,6 +480,38 @@ static void wpas_sd_all_upnp(struct wpa_supplicant *wpa_s,
 }
 
 
+static void wpas_sd_all_upnp(struct wpa_supplicant *wpa_s,
+			     struct wpabuf *resp, u8 srv_trans_id)
+{
+	struct wpa_global *global = wpa_s->global;
+	struct p2p_srv_upnp *usrv;
+	size_t len = 0;
+
+	wpa_printf(MSG_DEBUG, "P2P: SD Request for all UPnP services");
+
+	if (dl_list_empty(&global->p2p_srv_upnp)) {
+		wpa_printf(MSG_DEBUG, "P2P: UPnP protocol not available");
+		return;
+	}
+
+	if (!global->p2p_sd_all_upnp) {
+		dl_list_for_each(usrv, &global->p2p_srv_upnp,
+				 struct p2p_srv_upnp, list)
+			len += 5 + 1 + os_strlen(usrv->service);
+		global->p2p_sd_all_upnp = wpabuf_alloc(len);
+		if (!global->p2p_sd_all_upnp) {
+			wpas_sd_build_all_upnp(wpa_s, resp, srv_trans_id);
+			return;
+		}
+		wpas_sd_build_all_upnp(wpa_s, global->p2p_sd_all_upnp, 0);
+		global->p2p_sd_stats.cache_builds++;
+	}
+
+	wpas_sd_add_cached(wpa_s, resp, global->p2p_sd_all_upnp,
+			   srv_trans_id);
+}
+
+
 static void wpas_sd_req_upnp(struct wpa_supplicant *wpa_s,
 			     struct wpabuf *resp, u8 srv_trans_id,
 			     const u8 *query, size_t query_len)
@@ -712,7 +832,9 @@ void wpas_sd_request(void *ctx, int freq, const u8 *sa, u8 dialog_token,
 		os_free(buf);
 	}
 
+	wpa_s->global->p2p_sd_stats.requests++;
 	if (wpa_s->p2p_sd_over_ctrl_iface) {
+		wpa_s->global->p2p_sd_stats.external++;
 		wpas_notify_p2p_sd_request(wpa_s, freq, sa, dialog_token,
 					   update_indic, tlvs, tlvs_len);
 		return; /* to be processed by an external program */
@@ -806,6 +928,8 @@ done:
 				   update_indic, tlvs, tlvs_len);
 
 	wpas_p2p_sd_response(wpa_s, freq, sa, dialog_token, resp);
+	wpa_s->global->p2p_sd_stats.responses++;
+	wpa_s->global->p2p_sd_stats.resp_bytes += wpabuf_len(resp);
 
 	wpabuf_free(resp);
 }
@@ -1119,13 +1243,51 @@ void wpas_p2p_sd_response(struct wpa_supplicant *wpa_s, int freq,
 
 void wpas_p2p_sd_service_update(struct wpa_supplicant *wpa_s)
 {
+	wpabuf_free(wpa_s->global->p2p_sd_all_bonjour);
+	wpa_s->global->p2p_sd_all_bonjour = NULL;
+	wpabuf_free(wpa_s->global->p2p_sd_all_upnp);
+	wpa_s->global->p2p_sd_all_upnp = NULL;
+
 	if (wpa_s->global->p2p)
 		p2p_sd_service_update(wpa_s->global->p2p);
 }
 
 
-static void wpas_p2p_srv_bonjour_free(struct p2p_srv_bonjour *bsrv)
+int wpas_p2p_sd_stats(struct wpa_supplicant *wpa_s, char *buf, size_t buflen)
 {
+	struct p2p_sd_stats *stats = &wpa_s->global->p2p_sd_stats;
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "requests=%u\n"
+			  "external=%u\n"
+			  "responses=%u\n"
+			  "resp_bytes=%llu\n"
+			  "cache_hits=%u\n"
+			  "cache_builds=%u\n",
+			  stats->requests, stats->external, stats->responses,
+			  stats->resp_bytes, stats->cache_hits,
+			  stats->cache_builds);
+	if (os_snprintf_error(buflen, ret))
+		return -1;
+	return ret;
+}
+
+
+static void wpas_p2p_srv_bonjour_free(struct wpa_global *global,
+				      struct p2p_srv_bonjour *bsrv)
+{
+	struct p2p_srv_bonjour **pos;
+
+	pos = &global->p2p_srv_bonjour_hash[bsrv->hash %
+					    P2P_SRV_BONJOUR_HASH_SIZE];
+	while (*pos) {
+		if (*pos == bsrv) {
+			*pos = bsrv->hnext;
+			break;
+		}
+		pos = &(*pos)->hnext;
+	}
 	dl_list_del(&bsrv->list);
 	wpabuf_free(bsrv->query);
 	wpabuf_free(bsrv->resp);
@@ -1148,7 +1310,7 @@ void wpas_p2p_service_flush(struct wpa_supplicant *wpa_s)
 
 	dl_list_for_each_safe(bsrv, bn, &wpa_s->global->p2p_srv_bonjour,
 			      struct p2p_srv_bonjour, list)
-		wpas_p2p_srv_bonjour_free(bsrv);
+		wpas_p2p_srv_bonjour_free(wpa_s->global, bsrv);
 
 	dl_list_for_each_safe(usrv, un, &wpa_s->global->p2p_srv_upnp,
 			      struct p2p_srv_upnp, list)
@@ -1209,13 +1371,19 @@ int wpas_p2p_service_add_bonjour(struct wpa_supplicant *wpa_s,
 				 struct wpabuf *query, struct wpabuf *resp)
 {
 	struct p2p_srv_bonjour *bsrv;
+	unsigned int idx;
 
 	bsrv = os_zalloc(sizeof(*bsrv));
 	if (bsrv == NULL)
 		return -1;
 	bsrv->query = query;
 	bsrv->resp = resp;
+	bsrv->hash = p2p_srv_bonjour_hash(wpabuf_head(query),
+					  wpabuf_len(query));
 	dl_list_add(&wpa_s->global->p2p_srv_bonjour, &bsrv->list);
+	idx = bsrv->hash % P2P_SRV_BONJOUR_HASH_SIZE;
+	bsrv->hnext = wpa_s->global->p2p_srv_bonjour_hash[idx];
+	wpa_s->global->p2p_srv_bonjour_hash[idx] = bsrv;
 
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
@@ -1230,7 +1398,7 @@ int wpas_p2p_service_del_bonjour(struct wpa_supplicant *wpa_s,
 	bsrv = wpas_p2p_service_get_bonjour(wpa_s, query);
 	if (bsrv == NULL)
 		return -1;
-	wpas_p2p_srv_bonjour_free(bsrv);
+	wpas_p2p_srv_bonjour_free(wpa_s->global, bsrv);
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
 }
@@ -0,0 +1,954 @@
+/*
+ * wpa_supplicant - Scan result processing benchmark
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This program links the supplicant core with a driver wrapper that does not
+ * touch any radio. Each scan cycle the wrapper hands out a synthetic set of
+ * scan results (configurable number of BSSs, IE mix, share of BSSs that
+ * advertise the SSID of a configured network, and BSSID churn between
+ * cycles). The results are then pushed through the same steps the scan
+ * results event uses:
+ *
+ * fetch:  wpa_supplicant_get_scan_results() up to and including the sort
+ * bss:    wpa_bss_update_start()/wpa_bss_update_scan_res()/wpa_bss_update_end()
+ * select: wpa_supplicant_pick_network()
+ *
+ * Time and heap allocations of each step are recorded per cycle. Allocations
+ * are counted by wrapping the C library allocator at link time
+ * (-Wl,--wrap=...), so this needs a GNU compatible linker.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "utils/slab.h"
+#include "common/ieee802_11_defs.h"
+#include "drivers/driver.h"
+#include "fst/fst.h"
+#include "config.h"
+#include "wpa_supplicant_i.h"
+#include "bss.h"
+#include "scan.h"
+
+
+#define BENCH_SEED 0x5ca9be9c
+
+enum bench_mix {
+	BENCH_MIX_BASIC,
+	BENCH_MIX_HT,
+	BENCH_MIX_HE,
+	BENCH_MIX_FULL,
+};
+
+static const char * const bench_mix_txt[] = {
+	"basic", "ht", "he", "full"
+};
+
+enum bench_phase {
+	BENCH_PHASE_FETCH,
+	BENCH_PHASE_BSS,
+	BENCH_PHASE_SELECT,
+	BENCH_PHASE_TOTAL,
+	NUM_BENCH_PHASES
+};
+
+struct bench_chan {
+	int freq;
+	u8 chan;
+	u8 sec; /* HT secondary channel offset */
+	u8 seg0; /* VHT 80 MHz center channel, 0 for 2.4 GHz */
+};
+
+static const struct bench_chan bench_chans[] = {
+	{ 2412, 1, 0, 0 }, { 2437, 6, 0, 0 }, { 2462, 11, 0, 0 },
+	{ 5180, 36, 1, 42 }, { 5200, 40, 3, 42 }, { 5220, 44, 1, 42 },
+	{ 5240, 48, 3, 42 }, { 5500, 100, 1, 106 }, { 5520, 104, 3, 106 },
+	{ 5540, 108, 1, 106 }, { 5560, 112, 3, 106 }, { 5745, 149, 1, 155 },
+	{ 5765, 153, 3, 155 }, { 5785, 157, 1, 155 }, { 5805, 161, 3, 155 },
+};
+
+struct bench_bss {
+	u8 bssid[ETH_ALEN];
+	const struct bench_chan *chan;
+	char ssid[SSID_MAX_LEN + 1];
+	int rsn;
+	int level;
+	u64 tsf;
+};
+
+struct bench_alloc {
+	u64 count;
+	u64 bytes;
+};
+
+struct bench_ctx {
+	struct wpa_supplicant *wpa_s;
+	u8 own_addr[ETH_ALEN];
+
+	enum bench_mix mix;
+	unsigned int num_bss;
+	unsigned int num_networks;
+	unsigned int overlap;
+	unsigned int churn;
+	unsigned int cycles;
+	unsigned int warmup;
+	unsigned int max_bss;
+
+	struct bench_bss *bss;
+	unsigned int churn_pos;
+	u32 next_id;
+	u32 seed;
+
+	struct wpa_scan_results *pending;
+	u64 ie_bytes;
+
+	unsigned int measured;
+	unsigned int selected;
+	u32 *lat[NUM_BENCH_PHASES];
+	struct bench_alloc alloc[NUM_BENCH_PHASES];
+};
+
+static struct bench_ctx *bench_ctx;
+
+
+/* Allocation counting */
+
+static struct bench_alloc bench_heap;
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t nmemb, size_t size);
+void * __real_realloc(void *ptr, size_t size);
+char * __real_strdup(const char *s);
+void * __wrap_malloc(size_t size);
+void * __wrap_calloc(size_t nmemb, size_t size);
+void * __wrap_realloc(void *ptr, size_t size);
+char * __wrap_strdup(const char *s);
+
+
+void * __wrap_malloc(size_t size)
+{
+	bench_heap.count++;
+	bench_heap.bytes += size;
+	return __real_malloc(size);
+}
+
+
+void * __wrap_calloc(size_t nmemb, size_t size)
+{
+	bench_heap.count++;
+	bench_heap.bytes += nmemb * size;
+	return __real_calloc(nmemb, size);
+}
+
+
+void * __wrap_realloc(void *ptr, size_t size)
+{
+	bench_heap.count++;
+	bench_heap.bytes += size;
+	return __real_realloc(ptr, size);
+}
+
+
+char * __wrap_strdup(const char *s)
+{
+	bench_heap.count++;
+	bench_heap.bytes += os_strlen(s) + 1;
+	return __real_strdup(s);
+}
+
+
+static u64 bench_usec(const struct os_reltime *t)
+{
+	return (u64) t->sec * 1000000 + t->usec;
+}
+
+
+static u32 bench_rand(struct bench_ctx *ctx)
+{
+	ctx->seed = ctx->seed * 1103515245 + 12345;
+	return ctx->seed >> 8;
+}
+
+
+/* Driver wrapper */
+
+static void * bench_drv_init2(void *ctx, const char *ifname,
+			      void *global_priv)
+{
+	return bench_ctx;
+}
+
+
+static void bench_drv_deinit(void *priv)
+{
+}
+
+
+static int bench_drv_get_bssid(void *priv, u8 *bssid)
+{
+	os_memset(bssid, 0, ETH_ALEN);
+	return 0;
+}
+
+
+static int bench_drv_get_ssid(void *priv, u8 *ssid)
+{
+	return 0;
+}
+
+
+static const u8 * bench_drv_get_mac_addr(void *priv)
+{
+	struct bench_ctx *ctx = priv;
+
+	return ctx->own_addr;
+}
+
+
+static int bench_drv_get_capa(void *priv, struct wpa_driver_capa *capa)
+{
+	os_memset(capa, 0, sizeof(*capa));
+	capa->key_mgmt = WPA_DRIVER_CAPA_KEY_MGMT_WPA2 |
+		WPA_DRIVER_CAPA_KEY_MGMT_WPA2_PSK;
+	capa->enc = WPA_DRIVER_CAPA_ENC_CCMP | WPA_DRIVER_CAPA_ENC_TKIP;
+	capa->auth = WPA_DRIVER_AUTH_OPEN;
+	capa->max_scan_ssids = WPAS_MAX_SCAN_SSIDS;
+	return 0;
+}
+
+
+static int bench_mode_add(struct hostapd_hw_modes *mode,
+			  enum hostapd_hw_mode hw_mode, int first, int last,
+			  int step)
+{
+	static const int rates_b[] = { 10, 20, 55, 110 };
+	static const int rates_ofdm[] = { 60, 90, 120, 180, 240, 360, 480,
+					  540 };
+	int freq, i;
+
+	mode->mode = hw_mode;
+	mode->num_channels = (last - first) / step + 1;
+	mode->channels = os_calloc(mode->num_channels,
+				   sizeof(struct hostapd_channel_data));
+	mode->rates = os_calloc(ARRAY_SIZE(rates_b) + ARRAY_SIZE(rates_ofdm),
+				sizeof(int));
+	if (!mode->channels || !mode->rates)
+		return -1;
+
+	for (i = 0, freq = first; freq <= last; i++, freq += step) {
+		mode->channels[i].freq = freq;
+		mode->channels[i].chan = hw_mode == HOSTAPD_MODE_IEEE80211G ?
+			(freq - 2407) / 5 : (freq - 5000) / 5;
+		mode->channels[i].allowed_bw = HOSTAPD_CHAN_WIDTH_80;
+	}
+
+	if (hw_mode == HOSTAPD_MODE_IEEE80211G) {
+		os_memcpy(mode->rates, rates_b, sizeof(rates_b));
+		mode->num_rates = ARRAY_SIZE(rates_b);
+	}
+	os_memcpy(&mode->rates[mode->num_rates], rates_ofdm,
+		  sizeof(rates_ofdm));
+	mode->num_rates += ARRAY_SIZE(rates_ofdm);
+
+	mode->ht_capab = HT_CAP_INFO_SUPP_CHANNEL_WIDTH_SET;
+	mode->he_capab[IEEE80211_MODE_INFRA].he_supported = 1;
+	if (hw_mode == HOSTAPD_MODE_IEEE80211G) {
+		mode->he_capab[IEEE80211_MODE_INFRA].phy_cap[
+			HE_PHYCAP_CHANNEL_WIDTH_SET_IDX] =
+			HE_PHYCAP_CHANNEL_WIDTH_SET_40MHZ_IN_2G;
+	} else {
+		mode->vht_capab = VHT_CAP_SUPP_CHAN_WIDTH_160MHZ;
+		mode->he_capab[IEEE80211_MODE_INFRA].phy_cap[
+			HE_PHYCAP_CHANNEL_WIDTH_SET_IDX] =
+			HE_PHYCAP_CHANNEL_WIDTH_SET_40MHZ_80MHZ_IN_5G |
+			HE_PHYCAP_CHANNEL_WIDTH_SET_160MHZ_IN_5G;
+	}
+
+	return 0;
+}
+
+
+static struct hostapd_hw_modes *
+bench_drv_get_hw_feature_data(void *priv, u16 *num_modes, u16 *flags,
+			      u8 *dfs_domain)
+{
+	struct hostapd_hw_modes *modes;
+	int i;
+
+	*num_modes = 0;
+	*flags = 0;
+	*dfs_domain = 0;
+
+	modes = os_calloc(2, sizeof(struct hostapd_hw_modes));
+	if (!modes)
+		return NULL;
+	if (bench_mode_add(&modes[0], HOSTAPD_MODE_IEEE80211G, 2412, 2472,
+			   5) ||
+	    bench_mode_add(&modes[1], HOSTAPD_MODE_IEEE80211A, 5180, 5825,
+			   5)) {
+		for (i = 0; i < 2; i++) {
+			os_free(modes[i].channels);
+			os_free(modes[i].rates);
+		}
+		os_free(modes);
+		return NULL;
+	}
+	*num_modes = 2;
+
+	return modes;
+}
+
+
+static int bench_drv_scan2(void *priv, struct wpa_driver_scan_params *params)
+{
+	return 0;
+}
+
+
+static struct wpa_scan_results * bench_drv_get_scan_results2(void *priv)
+{
+	struct bench_ctx *ctx = priv;
+	struct wpa_scan_results *res = ctx->pending;
+
+	ctx->pending = NULL;
+	return res;
+}
+
+
+static const struct wpa_driver_ops bench_driver_ops = {
+	.name = "bench",
+	.desc = "synthetic scan results for benchmarking",
+	.init2 = bench_drv_init2,
+	.deinit = bench_drv_deinit,
+	.get_bssid = bench_drv_get_bssid,
+	.get_ssid = bench_drv_get_ssid,
+	.get_mac_addr = bench_drv_get_mac_addr,
+	.get_capa = bench_drv_get_capa,
+	.get_hw_feature_data = bench_drv_get_hw_feature_data,
+	.scan2 = bench_drv_scan2,
+	.get_scan_results2 = bench_drv_get_scan_results2,
+};
+
+const struct wpa_driver_ops *const wpa_drivers[] =
+{
+	&bench_driver_ops,
+	NULL
+};
+
+
+/* Scan result generation */
+
+static void bench_bss_init(struct bench_ctx *ctx, unsigned int idx)
+{
+	struct bench_bss *b = &ctx->bss[idx];
+	u32 id = ctx->next_id++;
+
+	b->bssid[0] = 0x02;
+	b->bssid[1] = 0x00;
+	WPA_PUT_BE32(&b->bssid[2], id);
+	b->chan = &bench_chans[id % ARRAY_SIZE(bench_chans)];
+	b->level = -35 - (int) (bench_rand(ctx) % 55);
+	b->tsf = bench_rand(ctx);
+
+	if (ctx->num_networks && bench_rand(ctx) % 100 < ctx->overlap) {
+		os_snprintf(b->ssid, sizeof(b->ssid), "net-%u",
+			    bench_rand(ctx) % ctx->num_networks);
+		b->rsn = 1;
+	} else {
+		/* Groups of a few BSSs share an ESS as in a typical
+		 * enterprise or apartment scan */
+		os_snprintf(b->ssid, sizeof(b->ssid), "other-%u", id / 4);
+		b->rsn = (id / 4) % 5 != 0;
+	}
+}
+
+
+static void bench_put_ie(struct wpabuf *buf, u8 eid, const void *data,
+			 size_t len)
+{
+	wpabuf_put_u8(buf, eid);
+	wpabuf_put_u8(buf, len);
+	wpabuf_put_data(buf, data, len);
+}
+
+
+static void bench_put_rsn(struct wpabuf *buf)
+{
+	static const u8 rsn[] = {
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x04, 0x01, 0x00,
+		0x00, 0x0f, 0xac, 0x04, 0x01, 0x00, 0x00, 0x0f,
+		0xac, 0x02, 0x0c, 0x00
+	};
+
+	bench_put_ie(buf, WLAN_EID_RSN, rsn, sizeof(rsn));
+}
+
+
+static void bench_put_ht(struct wpabuf *buf, const struct bench_chan *chan)
+{
+	u8 cap[26], oper[22];
+
+	os_memset(cap, 0, sizeof(cap));
+	WPA_PUT_LE16(cap, HT_CAP_INFO_SUPP_CHANNEL_WIDTH_SET |
+		     HT_CAP_INFO_SHORT_GI20MHZ | HT_CAP_INFO_SHORT_GI40MHZ);
+	cap[3] = 0xff;
+	cap[4] = 0xff;
+	bench_put_ie(buf, WLAN_EID_HT_CAP, cap, sizeof(cap));
+
+	os_memset(oper, 0, sizeof(oper));
+	oper[0] = chan->chan;
+	if (chan->sec)
+		oper[1] = chan->sec | HT_INFO_HT_PARAM_STA_CHNL_WIDTH;
+	bench_put_ie(buf, WLAN_EID_HT_OPERATION, oper, sizeof(oper));
+}
+
+
+static void bench_put_vht(struct wpabuf *buf, const struct bench_chan *chan)
+{
+	u8 cap[12], oper[5];
+
+	os_memset(cap, 0, sizeof(cap));
+	WPA_PUT_LE32(cap, VHT_CAP_SHORT_GI_80);
+	WPA_PUT_LE16(&cap[4], 0xfffa);
+	WPA_PUT_LE16(&cap[8], 0xfffa);
+	bench_put_ie(buf, WLAN_EID_VHT_CAP, cap, sizeof(cap));
+
+	os_memset(oper, 0, sizeof(oper));
+	oper[0] = CHANWIDTH_80MHZ;
+	oper[1] = chan->seg0;
+	WPA_PUT_LE16(&oper[3], 0xfffa);
+	bench_put_ie(buf, WLAN_EID_VHT_OPERATION, oper, sizeof(oper));
+}
+
+
+static void bench_put_he(struct wpabuf *buf, const struct bench_chan *chan)
+{
+	u8 cap[1 + IEEE80211_HE_CAPAB_MIN_LEN + 4], oper[1 + 6];
+
+	os_memset(cap, 0, sizeof(cap));
+	cap[0] = WLAN_EID_EXT_HE_CAPABILITIES;
+	cap[1 + 6 + HE_PHYCAP_CHANNEL_WIDTH_SET_IDX] = chan->seg0 ?
+		HE_PHYCAP_CHANNEL_WIDTH_SET_40MHZ_80MHZ_IN_5G :
+		HE_PHYCAP_CHANNEL_WIDTH_SET_40MHZ_IN_2G;
+	WPA_PUT_LE16(&cap[1 + IEEE80211_HE_CAPAB_MIN_LEN], 0xfffa);
+	WPA_PUT_LE16(&cap[1 + IEEE80211_HE_CAPAB_MIN_LEN + 2], 0xfffa);
+	bench_put_ie(buf, WLAN_EID_EXTENSION, cap, sizeof(cap));
+
+	os_memset(oper, 0, sizeof(oper));
+	oper[0] = WLAN_EID_EXT_HE_OPERATION;
+	oper[4] = 0x01; /* BSS color */
+	WPA_PUT_LE16(&oper[5], 0xfffa);
+	bench_put_ie(buf, WLAN_EID_EXTENSION, oper, sizeof(oper));
+}
+
+
+static void bench_put_rnr(struct bench_ctx *ctx, struct wpabuf *buf,
+			  const struct bench_bss *b)
+{
+	unsigned int i, count = 4;
+	u8 *len;
+
+	wpabuf_put_u8(buf, WLAN_EID_REDUCED_NEIGHBOR_REPORT);
+	len = wpabuf_put(buf, 1);
+	/* TBTT Information Header: TBTT Information Count and Length */
+	wpabuf_put_u8(buf, (count - 1) << 4);
+	wpabuf_put_u8(buf, 13);
+	wpabuf_put_u8(buf, 131); /* operating class */
+	wpabuf_put_u8(buf, 37);
+	for (i = 0; i < count; i++) {
+		wpabuf_put_u8(buf, 255); /* TBTT offset unknown */
+		wpabuf_put_data(buf, b->bssid, ETH_ALEN - 1);
+		wpabuf_put_u8(buf, 0x80 + i);
+		wpabuf_put_le32(buf, bench_rand(ctx)); /* short SSID */
+		wpabuf_put_u8(buf, 0x04); /* BSS parameters */
+		wpabuf_put_u8(buf, 0xfe); /* 20 MHz PSD */
+	}
+	*len = (u8 *) wpabuf_put(buf, 0) - len - 1;
+}
+
+
+static void bench_put_mbssid(struct wpabuf *buf, const struct bench_bss *b)
+{
+	unsigned int i;
+	u8 *len, *sub_len;
+
+	wpabuf_put_u8(buf, WLAN_EID_MULTIPLE_BSSID);
+	len = wpabuf_put(buf, 1);
+	wpabuf_put_u8(buf, 2); /* MaxBSSID Indicator: up to 4 BSSs */
+	for (i = 1; i < 4; i++) {
+		wpabuf_put_u8(buf, 0); /* Nontransmitted BSSID Profile */
+		sub_len = wpabuf_put(buf, 1);
+		wpabuf_put_u8(buf, WLAN_EID_NONTRANSMITTED_BSSID_CAPA);
+		wpabuf_put_u8(buf, 2);
+		wpabuf_put_le16(buf, WLAN_CAPABILITY_ESS |
+				WLAN_CAPABILITY_PRIVACY);
+		wpabuf_put_u8(buf, WLAN_EID_SSID);
+		wpabuf_put_u8(buf, os_strlen(b->ssid) + 2);
+		wpabuf_put_str(buf, b->ssid);
+		wpabuf_printf(buf, "-%u", i);
+		wpabuf_put_u8(buf, WLAN_EID_MULTIPLE_BSSID_INDEX);
+		wpabuf_put_u8(buf, 1);
+		wpabuf_put_u8(buf, i);
+		*sub_len = (u8 *) wpabuf_put(buf, 0) - sub_len - 1;
+	}
+	*len = (u8 *) wpabuf_put(buf, 0) - len - 1;
+}
+
+
+static struct wpabuf * bench_bss_ies(struct bench_ctx *ctx,
+				     const struct bench_bss *b)
+{
+	static const u8 rates_2g[] = {
+		0x82, 0x84, 0x8b, 0x96, 0x0c, 0x12, 0x18, 0x24
+	};
+	static const u8 ext_rates_2g[] = { 0x30, 0x48, 0x60, 0x6c };
+	static const u8 rates_5g[] = {
+		0x8c, 0x12, 0x98, 0x24, 0xb0, 0x48, 0x60, 0x6c
+	};
+	static const u8 ext_capab[] = {
+		0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x40
+	};
+	static const u8 wmm[] = {
+		0x00, 0x50, 0xf2, 0x01, 0x01, 0x80, 0x00, 0x03,
+		0xa4, 0x00, 0x00, 0x27, 0xa4, 0x00, 0x00, 0x42,
+		0x43, 0x5e, 0x00, 0x62, 0x32, 0x2f, 0x00
+	};
+	const struct bench_chan *chan = b->chan;
+	struct wpabuf *buf;
+	u8 bss_load[5];
+
+	buf = wpabuf_alloc(512);
+	if (!buf)
+		return NULL;
+
+	bench_put_ie(buf, WLAN_EID_SSID, b->ssid, os_strlen(b->ssid));
+	if (chan->seg0) {
+		bench_put_ie(buf, WLAN_EID_SUPP_RATES, rates_5g,
+			     sizeof(rates_5g));
+	} else {
+		bench_put_ie(buf, WLAN_EID_SUPP_RATES, rates_2g,
+			     sizeof(rates_2g));
+	}
+	bench_put_ie(buf, WLAN_EID_DS_PARAMS, &chan->chan, 1);
+	if (ctx->mix >= BENCH_MIX_HE) {
+		/* Station count and channel utilization move between
+		 * beacons, so the IEs of a BSS rarely stay identical */
+		WPA_PUT_LE16(bss_load, bench_rand(ctx) % 32);
+		bss_load[2] = bench_rand(ctx);
+		WPA_PUT_LE16(&bss_load[3], 0);
+		bench_put_ie(buf, WLAN_EID_BSS_LOAD, bss_load,
+			     sizeof(bss_load));
+	}
+	if (b->rsn)
+		bench_put_rsn(buf);
+	if (!chan->seg0)
+		bench_put_ie(buf, WLAN_EID_EXT_SUPP_RATES, ext_rates_2g,
+			     sizeof(ext_rates_2g));
+	if (ctx->mix >= BENCH_MIX_HT)
+		bench_put_ht(buf, chan);
+	if (ctx->mix >= BENCH_MIX_FULL) {
+		bench_put_rnr(ctx, buf, b);
+		bench_put_mbssid(buf, b);
+	}
+	if (ctx->mix >= BENCH_MIX_HE && chan->seg0)
+		bench_put_vht(buf, chan);
+	if (ctx->mix >= BENCH_MIX_HT)
+		bench_put_ie(buf, WLAN_EID_EXT_CAPAB, ext_capab,
+			     sizeof(ext_capab));
+	if (ctx->mix >= BENCH_MIX_HE)
+		bench_put_he(buf, chan);
+	if (ctx->mix >= BENCH_MIX_HT)
+		bench_put_ie(buf, WLAN_EID_VENDOR_SPECIFIC, wmm, sizeof(wmm));
+
+	return buf;
+}
+
+
+static struct wpa_scan_results * bench_gen_results(struct bench_ctx *ctx)
+{
+	struct wpa_scan_results *res;
+	unsigned int i, churn;
+
+	churn = ctx->num_bss * ctx->churn / 100;
+	for (i = 0; i < churn; i++) {
+		bench_bss_init(ctx, ctx->churn_pos);
+		ctx->churn_pos = (ctx->churn_pos + 1) % ctx->num_bss;
+	}
+
+	res = os_zalloc(sizeof(*res));
+	if (!res)
+		return NULL;
+	res->res = os_calloc(ctx->num_bss, sizeof(struct wpa_scan_res *));
+	if (!res->res) {
+		os_free(res);
+		return NULL;
+	}
+
+	for (i = 0; i < ctx->num_bss; i++) {
+		struct bench_bss *b = &ctx->bss[i];
+		struct wpa_scan_res *r;
+		struct wpabuf *ies;
+		size_t len;
+
+		ies = bench_bss_ies(ctx, b);
+		if (!ies) {
+			wpa_scan_results_free(res);
+			return NULL;
+		}
+		len = wpabuf_len(ies);
+		r = os_zalloc(sizeof(*r) + 2 * len);
+		if (!r) {
+			wpabuf_free(ies);
+			wpa_scan_results_free(res);
+			return NULL;
+		}
+		os_memcpy(r->bssid, b->bssid, ETH_ALEN);
+		r->freq = b->chan->freq;
+		r->beacon_int = 100;
+		r->caps = WLAN_CAPABILITY_ESS;
+		if (b->rsn)
+			r->caps |= WLAN_CAPABILITY_PRIVACY;
+		r->flags = WPA_SCAN_QUAL_INVALID | WPA_SCAN_NOISE_INVALID |
+			WPA_SCAN_LEVEL_DBM;
+		r->level = b->level + (int) (bench_rand(ctx) % 7) - 3;
+		b->tsf += 102400;
+		r->tsf = b->tsf;
+		r->ie_len = len;
+		r->beacon_ie_len = len;
+		os_memcpy(r + 1, wpabuf_head(ies), len);
+		os_memcpy((u8 *) (r + 1) + len, wpabuf_head(ies), len);
+		wpabuf_free(ies);
+		ctx->ie_bytes += len;
+
+		res->res[res->num++] = r;
+	}
+
+	return res;
+}
+
+
+/* Benchmark */
+
+static int bench_add_networks(struct bench_ctx *ctx)
+{
+	struct wpa_config *conf = ctx->wpa_s->conf;
+	char val[2 * PMK_LEN + 1];
+	unsigned int i;
+
+	for (i = 0; i < ctx->num_networks; i++) {
+		struct wpa_ssid *ssid;
+
+		ssid = wpa_config_add_network(conf);
+		if (!ssid)
+			return -1;
+		wpa_config_set_network_defaults(ssid);
+		os_snprintf(val, sizeof(val), "\"net-%u\"", i);
+		if (wpa_config_set(ssid, "ssid", val, 0) < 0 ||
+		    wpa_config_set(ssid, "key_mgmt", "WPA-PSK", 0) < 0)
+			return -1;
+		os_memset(val, 'a' + i % 6, 2 * PMK_LEN);
+		val[2 * PMK_LEN] = '\0';
+		if (wpa_config_set(ssid, "psk", val, 0) < 0)
+			return -1;
+	}
+
+	return wpa_config_update_prio_list(conf);
+}
+
+
+static void bench_phase_end(struct bench_ctx *ctx, enum bench_phase phase,
+			    struct os_reltime *start,
+			    const struct bench_alloc *alloc_start,
+			    u32 *lat)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	lat[phase] = bench_usec(&diff);
+	ctx->alloc[phase].count += bench_heap.count - alloc_start->count;
+	ctx->alloc[phase].bytes += bench_heap.bytes - alloc_start->bytes;
+	*start = now;
+}
+
+
+static int bench_cycle(struct bench_ctx *ctx, int measure)
+{
+	struct wpa_supplicant *wpa_s = ctx->wpa_s;
+	struct wpa_scan_results *res;
+	struct wpa_ssid *ssid = NULL;
+	struct wpa_bss *selected;
+	struct os_reltime start, t;
+	struct bench_alloc alloc_start, alloc_total;
+	u32 lat[NUM_BENCH_PHASES];
+	unsigned int i, n = ctx->measured;
+
+	ctx->pending = bench_gen_results(ctx);
+	if (!ctx->pending)
+		return -1;
+
+	alloc_total = bench_heap;
+	os_get_reltime(&start);
+	t = start;
+
+	/* Let wpa_supplicant_get_scan_results() stop after sorting so that
+	 * the BSS table update can be timed on its own below. */
+	alloc_start = bench_heap;
+	wpa_s->ignore_post_flush_scan_res = 1;
+	res = wpa_supplicant_get_scan_results(wpa_s, NULL, 1);
+	if (!res)
+		return -1;
+	bench_phase_end(ctx, BENCH_PHASE_FETCH, &t, &alloc_start, lat);
+
+	alloc_start = bench_heap;
+	wpa_bss_update_start(wpa_s);
+	for (i = 0; i < res->num; i++)
+		wpa_bss_update_scan_res(wpa_s, res->res[i], &res->fetch_time);
+	wpa_bss_update_end(wpa_s, NULL, 1);
+	bench_phase_end(ctx, BENCH_PHASE_BSS, &t, &alloc_start, lat);
+
+	alloc_start = bench_heap;
+	selected = wpa_supplicant_pick_network(wpa_s, &ssid);
+	bench_phase_end(ctx, BENCH_PHASE_SELECT, &t, &alloc_start, lat);
+
+	bench_phase_end(ctx, BENCH_PHASE_TOTAL, &start, &alloc_total, lat);
+	wpa_scan_results_free(res);
+
+	if (!measure) {
+		os_memset(ctx->alloc, 0, sizeof(ctx->alloc));
+		return 0;
+	}
+
+	for (i = 0; i < NUM_BENCH_PHASES; i++)
+		ctx->lat[i][n] = lat[i];
+	if (selected)
+		ctx->selected++;
+	ctx->measured++;
+
+	return 0;
+}
+
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+	u32 x = *(const u32 *) a, y = *(const u32 *) b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+
+static u32 bench_percentile(const u32 *v, unsigned int n, unsigned int pct)
+{
+	unsigned int i;
+
+	if (n == 0)
+		return 0;
+	i = (n * pct + 99) / 100;
+	if (i > 0)
+		i--;
+	return v[i];
+}
+
+
+static void bench_report(struct bench_ctx *ctx)
+{
+	static const char * const names[NUM_BENCH_PHASES] = {
+		"fetch", "bss", "select", "total"
+	};
+	unsigned int i, n = ctx->measured;
+	unsigned int gen = ctx->cycles + ctx->warmup;
+
+	printf("bss=%u networks=%u overlap=%u%% churn=%u%% mix=%s "
+	       "cycles=%u warmup=%u\n",
+	       ctx->num_bss, ctx->num_networks, ctx->overlap, ctx->churn,
+	       bench_mix_txt[ctx->mix], n, ctx->warmup);
+	printf("ie_bytes_per_bss=%llu bss_table=%zu bss_max_count=%u "
+	       "selected=%u\n",
+	       (unsigned long long) (ctx->ie_bytes /
+				     ((u64) gen * ctx->num_bss)),
+	       ctx->wpa_s->num_bss, ctx->max_bss, ctx->selected);
+
+	printf("%-6s %10s %10s %10s %10s %12s %12s\n",
+	       "phase", "p50", "p90", "p99", "max", "allocs", "bytes");
+	for (i = 0; i < NUM_BENCH_PHASES; i++) {
+		u32 *v = ctx->lat[i];
+
+		qsort(v, n, sizeof(u32), bench_cmp_u32);
+		printf("%-6s %10u %10u %10u %10u %12.1f %12.1f\n", names[i],
+		       bench_percentile(v, n, 50), bench_percentile(v, n, 90),
+		       bench_percentile(v, n, 99), n ? v[n - 1] : 0,
+		       n ? (double) ctx->alloc[i].count / n : 0.0,
+		       n ? (double) ctx->alloc[i].bytes / n : 0.0);
+	}
+	printf("(latency in usec; allocations and bytes per cycle)\n");
+}
+
+
+static void usage(void)
+{
+	printf("usage: scan_bench [-dh] [-n <BSSs>] [-s <networks>] "
+	       "[-o <overlap %%>] [-c <churn %%>]\n"
+	       "                  [-m <basic|ht|he|full>] [-i <cycles>] "
+	       "[-w <warmup>] [-M <max BSSs>]\n"
+	       "\n"
+	       "options:\n"
+	       "   -h   show this usage\n"
+	       "   -d   increase debugging verbosity (-dd even more)\n"
+	       "   -n   number of BSSs in each scan (default: 500)\n"
+	       "   -s   number of configured networks (default: 20)\n"
+	       "   -o   percentage of BSSs advertising the SSID of a "
+	       "configured\n"
+	       "        network (default: 10)\n"
+	       "   -c   percentage of BSSIDs replaced in each scan "
+	       "(default: 5)\n"
+	       "   -m   information element mix (default: he)\n"
+	       "        basic: SSID, rates, DS, RSN\n"
+	       "        ht:    basic + HT, Extended Capabilities, WMM\n"
+	       "        he:    ht + BSS Load, VHT (5 GHz), HE\n"
+	       "        full:  he + Reduced Neighbor Report, "
+	       "Multiple BSSID\n"
+	       "   -i   number of measured scan cycles (default: 100)\n"
+	       "   -w   number of warm-up cycles before measuring "
+	       "(default: 2)\n"
+	       "   -M   bss_max_count (default: twice the number of BSSs)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct bench_ctx ctx;
+	struct wpa_interface iface;
+	struct wpa_params params;
+	struct wpa_global *global = NULL;
+	int c, debug = 0, ret = 1;
+	unsigned int i;
+
+	if (os_program_init())
+		return -1;
+
+	os_memset(&ctx, 0, sizeof(ctx));
+	ctx.mix = BENCH_MIX_HE;
+	ctx.num_bss = 500;
+	ctx.num_networks = 20;
+	ctx.overlap = 10;
+	ctx.churn = 5;
+	ctx.cycles = 100;
+	ctx.warmup = 2;
+	ctx.seed = BENCH_SEED;
+	os_memcpy(ctx.own_addr, "\x02\xfe\x00\x00\x00\x01", ETH_ALEN);
+	bench_ctx = &ctx;
+
+	for (;;) {
+		c = getopt(argc, argv, "c:dhi:m:M:n:o:s:w:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'c':
+			ctx.churn = atoi(optarg);
+			break;
+		case 'd':
+			debug++;
+			break;
+		case 'i':
+			ctx.cycles = atoi(optarg);
+			break;
+		case 'm':
+			for (i = 0; i < ARRAY_SIZE(bench_mix_txt); i++) {
+				if (os_strcmp(optarg, bench_mix_txt[i]) == 0)
+					break;
+			}
+			if (i == ARRAY_SIZE(bench_mix_txt)) {
+				usage();
+				return -1;
+			}
+			ctx.mix = i;
+			break;
+		case 'M':
+			ctx.max_bss = atoi(optarg);
+			break;
+		case 'n':
+			ctx.num_bss = atoi(optarg);
+			break;
+		case 'o':
+			ctx.overlap = atoi(optarg);
+			break;
+		case 's':
+			ctx.num_networks = atoi(optarg);
+			break;
+		case 'w':
+			ctx.warmup = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (ctx.num_bss == 0 || ctx.cycles == 0 || ctx.overlap > 100 ||
+	    ctx.churn > 100) {
+		usage();
+		return -1;
+	}
+	if (ctx.max_bss == 0)
+		ctx.max_bss = 2 * ctx.num_bss;
+
+	wpa_debug_level = debug > 1 ? MSG_DEBUG :
+		(debug ? MSG_INFO : MSG_WARNING);
+
+	ctx.bss = os_calloc(ctx.num_bss, sizeof(struct bench_bss));
+	for (i = 0; i < NUM_BENCH_PHASES; i++)
+		ctx.lat[i] = os_calloc(ctx.cycles, sizeof(u32));
+	if (!ctx.bss || !ctx.lat[0] || !ctx.lat[1] || !ctx.lat[2] ||
+	    !ctx.lat[3])
+		goto out;
+	for (i = 0; i < ctx.num_bss; i++)
+		bench_bss_init(&ctx, i);
+
+	os_memset(&params, 0, sizeof(params));
+	params.wpa_debug_level = wpa_debug_level;
+	global = wpa_supplicant_init(&params);
+	if (!global)
+		goto out;
+
+	os_memset(&iface, 0, sizeof(iface));
+	iface.ifname = "bench0";
+	iface.driver = bench_driver_ops.name;
+	ctx.wpa_s = wpa_supplicant_add_iface(global, &iface, NULL);
+	if (!ctx.wpa_s) {
+		wpa_printf(MSG_ERROR, "Failed to add the interface");
+		goto out;
+	}
+	ctx.wpa_s->conf->bss_max_count = ctx.max_bss;
+	if (bench_add_networks(&ctx) < 0) {
+		wpa_printf(MSG_ERROR, "Failed to add networks");
+		goto out;
+	}
+
+	for (i = 0; i < ctx.warmup + ctx.cycles; i++) {
+		if (bench_cycle(&ctx, i >= ctx.warmup) < 0) {
+			wpa_printf(MSG_ERROR, "Scan cycle %u failed", i);
+			goto out;
+		}
+	}
+
+	bench_report(&ctx);
+	ret = 0;
+
+out:
+	if (ctx.pending)
+		wpa_scan_results_free(ctx.pending);
+	if (global)
+		wpa_supplicant_deinit(global);
+	fst_global_deinit();
+	os_free(ctx.bss);
+	for (i = 0; i < NUM_BENCH_PHASES; i++)
+		os_free(ctx.lat[i]);
+	slab_flush();
+	wpabuf_pool_flush();
+	os_program_deinit();
+
+	return ret;
+}
@@ -390,6 +390,13 @@ static int wpa_cli_cmd_note(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int wpa_cli_cmd_eloop_profile(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	return wpa_cli_cmd(ctrl, "ELOOP_PROFILE", 0, argc, argv);
+}
+
+
 static int wpa_cli_cmd_mib(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_ctrl_command(ctrl, "MIB");
@@ -1082,6 +1089,12 @@ static int wpa_cli_cmd_level(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 #endif /* notyet */
 
+static int wpa_cli_cmd_monitor_stats(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "MONITOR_STATS");
+}
+
 static int wpa_cli_cmd_identity(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	char cmd[256], *pos, *end;
@@ -2398,6 +2411,13 @@ static int wpa_cli_cmd_p2p_service_flush(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int wpa_cli_cmd_p2p_service_stats(struct wpa_ctrl *ctrl, int argc,
+					 char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "P2P_SERVICE_STATS");
+}
+
+
 static int wpa_cli_cmd_p2p_service_add(struct wpa_ctrl *ctrl, int argc,
 				       char *argv[])
 {
@@ -2724,6 +2744,13 @@ static int wpa_cli_cmd_fetch_anqp(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int wpa_cli_cmd_anqp_stats(struct wpa_ctrl *ctrl, int argc,
+				  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "ANQP_STATS");
+}
+
+
 static int wpa_cli_cmd_stop_fetch_anqp(struct wpa_ctrl *ctrl, int argc,
 				       char *argv[])
 {
@@ -3349,9 +3376,15 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "note", wpa_cli_cmd_note, NULL,
 	  cli_cmd_flag_none,
 	  "<text> = add a note to wpa_supplicant debug log" },
+	{ "eloop_profile", wpa_cli_cmd_eloop_profile, NULL,
+	  cli_cmd_flag_none,
+	  "[RESET] = show or clear event loop handler profiling data" },
 	{ "mib", wpa_cli_cmd_mib, NULL,
 	  cli_cmd_flag_none,
 	  "= get MIB variables (dot1x, dot11)" },
+	{ "monitor_stats", wpa_cli_cmd_monitor_stats, NULL,
+	  cli_cmd_flag_none,
+	  "= show event delivery statistics of attached monitors" },
 #ifdef notyet
 	{ "help", wpa_cli_cmd_help, wpa_cli_complete_help,
 	  cli_cmd_flag_none,
@@ -3749,6 +3782,9 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "p2p_service_flush", wpa_cli_cmd_p2p_service_flush, NULL,
 	  cli_cmd_flag_none,
 	  "= remove all stored service entries" },
+	{ "p2p_service_stats", wpa_cli_cmd_p2p_service_stats, NULL,
+	  cli_cmd_flag_none,
+	  "= show service discovery responder statistics" },
 	{ "p2p_service_add", wpa_cli_cmd_p2p_service_add, NULL,
 	  cli_cmd_flag_none,
 	  "<bonjour|upnp|asp> <query|version> <response|service> = add a local "
@@ -3817,6 +3853,8 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 #ifdef CONFIG_INTERWORKING
 	{ "fetch_anqp", wpa_cli_cmd_fetch_anqp, NULL, cli_cmd_flag_none,
 	  "= fetch ANQP information for all APs" },
+	{ "anqp_stats", wpa_cli_cmd_anqp_stats, NULL, cli_cmd_flag_none,
+	  "= show ANQP fetch statistics" },
 	{ "stop_fetch_anqp", wpa_cli_cmd_stop_fetch_anqp, NULL,
 	  cli_cmd_flag_none,
 	  "= stop fetch_anqp operation" },
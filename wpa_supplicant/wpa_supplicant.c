@@ -60,10 +60,12 @@
 #include "scan.h"
 #include "offchannel.h"
 #include "hs20_supplicant.h"
+#include "interworking.h"
 #include "wnm_sta.h"
 #include "wpas_kay.h"
 #include "mesh.h"
 #include "dpp_supplicant.h"
+#include "wpas_stats_shm.h"
 #ifdef CONFIG_MESH
 #include "ap/ap_config.h"
 #include "ap/hostapd.h"
@@ -524,6 +526,7 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 
 	bgscan_deinit(wpa_s);
 	autoscan_deinit(wpa_s);
+	wpas_stats_shm_deinit(wpa_s);
 	scard_deinit(wpa_s->scard);
 	wpa_s->scard = NULL;
 	wpa_sm_set_scard_ctx(wpa_s->wpa, NULL);
@@ -641,6 +644,10 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 
 	wpas_mac_addr_rand_scan_clear(wpa_s, MAC_ADDR_RAND_ALL);
 
+#ifdef CONFIG_INTERWORKING
+	interworking_deinit(wpa_s);
+#endif /* CONFIG_INTERWORKING */
+
 	/*
 	 * Need to remove any pending gas-query radio work before the
 	 * gas_query_deinit() call because gas_query::work has not yet been set
@@ -973,6 +980,9 @@ void wpa_supplicant_set_state(struct wpa_supplicant *wpa_s,
 		wpas_connect_work_done(wpa_s);
 		/* Reinitialize normal_scan counter */
 		wpa_s->normal_scans = 0;
+#ifdef CONFIG_INTERWORKING
+		interworking_connection_completed(wpa_s);
+#endif /* CONFIG_INTERWORKING */
 	}
 
 #ifdef CONFIG_P2P
@@ -6903,6 +6913,9 @@ static int wpa_supplicant_init_iface(struct wpa_supplicant *wpa_s,
 #ifdef CONFIG_HS20
 	hs20_init(wpa_s);
 #endif /* CONFIG_HS20 */
+#ifdef CONFIG_INTERWORKING
+	interworking_init(wpa_s);
+#endif /* CONFIG_INTERWORKING */
 #ifdef CONFIG_MBO
 	if (!wpa_s->disable_mbo_oce && wpa_s->conf->oce) {
 		if ((wpa_s->conf->oce & OCE_STA) &&
@@ -6920,6 +6933,9 @@ static int wpa_supplicant_init_iface(struct wpa_supplicant *wpa_s,
 
 	wpa_supplicant_set_default_scan_ies(wpa_s);
 
+	if (wpas_stats_shm_init(wpa_s) < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -7616,6 +7632,9 @@ void wpa_supplicant_update_config(struct wpa_supplicant *wpa_s)
 		wpa_supplicant_reset_bgscan(wpa_s);
 #endif /* CONFIG_BGSCAN */
 
+	if (wpa_s->conf->changed_parameters & CFG_CHANGED_STATS_SHM)
+		wpas_stats_shm_init(wpa_s);
+
 #ifdef CONFIG_WPS
 	wpas_wps_update_config(wpa_s);
 #endif /* CONFIG_WPS */
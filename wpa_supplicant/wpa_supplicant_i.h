@@ -261,6 +261,8 @@ struct wpa_params {
 
 struct p2p_srv_bonjour {
 	struct dl_list list;
+	struct p2p_srv_bonjour *hnext; /* next entry in p2p_srv_bonjour_hash */
+	u32 hash; /* hash of the DNS query key */
 	struct wpabuf *query;
 	struct wpabuf *resp;
 };
@@ -293,7 +295,21 @@ struct wpa_global {
 	u8 p2p_dev_addr[ETH_ALEN];
 	struct os_reltime p2p_go_wait_client;
 	struct dl_list p2p_srv_bonjour; /* struct p2p_srv_bonjour */
+#define P2P_SRV_BONJOUR_HASH_SIZE 256
+	struct p2p_srv_bonjour *p2p_srv_bonjour_hash[P2P_SRV_BONJOUR_HASH_SIZE];
 	struct dl_list p2p_srv_upnp; /* struct p2p_srv_upnp */
+	/* Cached response TLVs for all Bonjour/UPnP services; cleared on
+	 * service updates */
+	struct wpabuf *p2p_sd_all_bonjour;
+	struct wpabuf *p2p_sd_all_upnp;
+	struct p2p_sd_stats {
+		unsigned int requests; /* SD requests received */
+		unsigned int external; /* requests left to an external program */
+		unsigned int responses; /* SD responses generated */
+		unsigned int cache_hits; /* responses using cached TLVs */
+		unsigned int cache_builds; /* cached TLV rebuilds */
+		unsigned long long resp_bytes; /* total response TLV octets */
+	} p2p_sd_stats;
 	int p2p_disabled;
 	int cross_connection;
 	int p2p_long_listen; /* remaining time in long Listen state in ms */
@@ -1208,7 +1224,26 @@ struct wpa_supplicant {
 	unsigned int fetch_osu_info:1;
 	unsigned int fetch_osu_waiting_scan:1;
 	unsigned int fetch_osu_icon_in_progress:1;
+	unsigned int interworking_connect_timing:1;
 	struct wpa_bss *interworking_gas_bss;
+	unsigned int anqp_fetch_pending; /* ANQP fetch queries in progress */
+	int anqp_fetch_freq; /* frequency of the last ANQP fetch query */
+	struct dl_list anqp_cache; /* struct anqp_cache_entry */
+	unsigned int anqp_cache_entries;
+	struct os_reltime anqp_select_start;
+	struct os_reltime anqp_fetch_start;
+	struct {
+		unsigned int fetches;
+		unsigned int queries;
+		unsigned int failures;
+		unsigned int shared;
+		unsigned int cache_hits;
+		unsigned int max_pending;
+		unsigned long long last_fetch_usec;
+		unsigned long long total_fetch_usec;
+		unsigned long long select_to_connect_usec;
+		unsigned long long fetch_to_connect_usec;
+	} anqp_stats;
 	unsigned int osu_icon_id;
 	struct dl_list icon_head; /* struct icon_entry */
 	struct osu_provider *osu_prov;
@@ -1524,6 +1559,10 @@ struct wpa_supplicant {
 	unsigned int enable_dscp_policy_capa:1;
 	unsigned int connection_dscp:1;
 	unsigned int wait_for_dscp_req:1;
+
+#ifdef CONFIG_STATS_SHM
+	struct stats_shm *stats_shm;
+#endif /* CONFIG_STATS_SHM */
 };
 
 
@@ -0,0 +1,133 @@
+/*
+ * wpa_supplicant - Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "eloop.h"
+#include "common/stats_shm.h"
+#include "wpa_supplicant_i.h"
+#include "driver_i.h"
+#include "config.h"
+#include "wpas_stats_shm.h"
+
+
+static void wpas_stats_shm_update(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_supplicant *wpa_s = eloop_ctx;
+	unsigned int interval = wpa_s->conf->stats_shm_interval;
+	struct stats_shm_iface *rec;
+	struct wpa_signal_info si;
+	struct hostap_sta_driver_data sta;
+	struct os_reltime age;
+	int signal_res = -1, pktcnt_res = -1;
+
+	/* Query the driver outside the sequence lock to keep the time readers
+	 * may need to retry short. */
+	if (wpa_s->wpa_state == WPA_COMPLETED) {
+		os_memset(&si, 0, sizeof(si));
+		signal_res = wpa_drv_signal_poll(wpa_s, &si);
+		os_memset(&sta, 0, sizeof(sta));
+		pktcnt_res = wpa_drv_pktcnt_poll(wpa_s, &sta);
+	}
+
+	stats_shm_write_begin(wpa_s->stats_shm);
+
+	rec = stats_shm_data(wpa_s->stats_shm);
+	os_memset(rec, 0, sizeof(*rec));
+	os_strlcpy(rec->ifname, wpa_s->ifname, sizeof(rec->ifname));
+	rec->wpa_state = wpa_s->wpa_state;
+	if (wpa_s->wpa_state >= WPA_ASSOCIATED) {
+		os_memcpy(rec->bssid, wpa_s->bssid, ETH_ALEN);
+		rec->freq = wpa_s->assoc_freq;
+		if (wpa_s->current_ssid &&
+		    wpa_s->current_ssid->ssid_len <= sizeof(rec->ssid)) {
+			rec->ssid_len = wpa_s->current_ssid->ssid_len;
+			os_memcpy(rec->ssid, wpa_s->current_ssid->ssid,
+				  rec->ssid_len);
+		}
+	}
+	if (os_reltime_initialized(&wpa_s->session_start)) {
+		os_reltime_age(&wpa_s->session_start, &age);
+		rec->connected_sec = age.sec;
+	}
+	if (signal_res == 0) {
+		rec->signal = si.current_signal;
+		rec->avg_signal = si.avg_signal;
+		rec->noise = si.current_noise;
+		rec->txrate = si.current_txrate;
+		if (si.frequency)
+			rec->freq = si.frequency;
+	}
+	if (pktcnt_res == 0) {
+		rec->rx_packets = sta.rx_packets;
+		rec->tx_packets = sta.tx_packets;
+		rec->rx_bytes = sta.rx_bytes;
+		rec->tx_bytes = sta.tx_bytes;
+		rec->tx_retry_failed = sta.tx_retry_failed;
+	}
+
+	stats_shm_write_end(wpa_s->stats_shm, 0);
+
+	eloop_register_timeout(interval / 1000, (interval % 1000) * 1000,
+			       wpas_stats_shm_update, wpa_s, NULL);
+}
+
+
+/**
+ * wpas_stats_shm_init - Start or restart exporting interface statistics
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is called during interface initialization and whenever the stats_shm
+ * parameters are changed at runtime. Any previous region is removed first.
+ * The region is created as <stats_shm>-<ifname>.
+ */
+int wpas_stats_shm_init(struct wpa_supplicant *wpa_s)
+{
+	char fname[256];
+	int res;
+
+	wpas_stats_shm_deinit(wpa_s);
+
+	if (!wpa_s->conf->stats_shm || !wpa_s->conf->stats_shm[0])
+		return 0;
+
+	/* The configuration may be shared between interfaces (e.g., P2P group
+	 * interfaces), so each interface gets a region of its own. */
+	res = os_snprintf(fname, sizeof(fname), "%s-%s",
+			  wpa_s->conf->stats_shm, wpa_s->ifname);
+	if (os_snprintf_error(sizeof(fname), res)) {
+		wpa_printf(MSG_ERROR,
+			   "Too long shared memory statistics file name");
+		return -1;
+	}
+
+	wpa_s->stats_shm = stats_shm_create(fname, STATS_SHM_TYPE_STA,
+					    sizeof(struct stats_shm_iface),
+					    0, 0,
+					    wpa_s->conf->stats_shm_interval);
+	if (!wpa_s->stats_shm) {
+		wpa_printf(MSG_ERROR,
+			   "Could not create shared memory statistics file %s",
+			   fname);
+		return -1;
+	}
+
+	wpas_stats_shm_update(wpa_s, NULL);
+	return 0;
+}
+
+
+void wpas_stats_shm_deinit(struct wpa_supplicant *wpa_s)
+{
+	if (!wpa_s->stats_shm)
+		return;
+	eloop_cancel_timeout(wpas_stats_shm_update, wpa_s, NULL);
+	stats_shm_destroy(wpa_s->stats_shm);
+	wpa_s->stats_shm = NULL;
+}
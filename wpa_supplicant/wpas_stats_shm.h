@@ -0,0 +1,29 @@
+/*
+ * wpa_supplicant - Shared memory statistics export
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef WPAS_STATS_SHM_H
+#define WPAS_STATS_SHM_H
+
+#ifdef CONFIG_STATS_SHM
+
+int wpas_stats_shm_init(struct wpa_supplicant *wpa_s);
+void wpas_stats_shm_deinit(struct wpa_supplicant *wpa_s);
+
+#else /* CONFIG_STATS_SHM */
+
+static inline int wpas_stats_shm_init(struct wpa_supplicant *wpa_s)
+{
+	return 0;
+}
+
+static inline void wpas_stats_shm_deinit(struct wpa_supplicant *wpa_s)
+{
+}
+
+#endif /* CONFIG_STATS_SHM */
+
+#endif /* WPAS_STATS_SHM_H */
@@ -10,6 +10,7 @@ import os
 import stat
 import socket
 import select
+import struct
 
 counter = 0
 
@@ -101,10 +102,13 @@ class Ctrl:
             return r
         raise Exception("Timeout on waiting response")
 
-    def attach(self):
+    def attach(self, params=None):
         if self.attached:
             return None
-        res = self.request("ATTACH")
+        cmd = "ATTACH"
+        if params:
+            cmd += " " + params
+        res = self.request(cmd)
         if "OK" in res:
             self.attached = True
             return None
@@ -117,7 +121,7 @@ class Ctrl:
             self.attached = False
             return None
         while self.pending():
-            ev = self.recv()
+            ev = self.s.recv(65536)
         res = self.request("DETACH")
         if "FAIL" not in res:
             self.attached = False
@@ -147,3 +151,25 @@ class Ctrl:
         except UnicodeDecodeError as e:
             r = res
         return r
+
+    def recv_batch(self):
+        """Receive a batched event message (ATTACH batch=1)
+
+        Returns a tuple of the sequence number of the first event, the
+        total number of lost events, and the list of events."""
+        res = self.s.recv(65536)
+        if len(res) < 14 or res[0:4] != b"EVB1":
+            raise Exception("Not a batched event message")
+        seq, lost, count = struct.unpack('<IIH', res[4:14])
+        events = []
+        pos = 14
+        for i in range(count):
+            if pos + 2 > len(res):
+                raise Exception("Truncated batched event message")
+            elen, = struct.unpack('<H', res[pos:pos + 2])
+            pos += 2
+            if pos + elen > len(res):
+                raise Exception("Truncated batched event message")
+            events.append(res[pos:pos + elen].decode())
+            pos += elen
+        return seq, lost, events